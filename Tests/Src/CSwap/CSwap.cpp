@@ -1,12 +1,20 @@
 #include <Build.h>
 
 #include "CSwap.h"
+#include "SwapchainStateMachine.h"
+#include "Utils/ScratchArray.h"
 
 #include <cstdint>
 
+#include <algorithm>
 #include <atomic>
 #include <bit>
+#include <memory>
+#include <new>
 #include <thread>
+#include <vector>
+
+#include <Concurrency/Mutex.h> // Faster mutexes
 
 #if BUILD_IS_CONFIG_DEBUG
 	#include <stdexcept>
@@ -17,7 +25,6 @@
 #include <dxgi1_6.h>
 #include <Presentation.h>
 
-#include <Concurrency/Mutex.h> // Faster mutexes
 
 #pragma comment(lib, "Synchronization.lib")
 
@@ -132,64 +139,20 @@ DXGI_ALPHA_MODE ToDXGIAlphaMode(VkCompositeAlphaFlagBitsKHR compositeAlpha)
 	}
 }
 
-static constexpr uint32_t c_WinCSMaxBufferCount = 8;
-
-static constexpr uint8_t c_WinCSBufferRenderable      = 0;
-static constexpr uint8_t c_WinCSBufferRendering       = 1;
-static constexpr uint8_t c_WinCSBufferDoubleRendering = 2;
-static constexpr uint8_t c_WinCSBufferWaiting         = 3;
-static constexpr uint8_t c_WinCSBufferDoubleWaiting   = 4;
-static constexpr uint8_t c_WinCSBufferPresentable     = 5;
-static constexpr uint8_t c_WinCSBufferPresenting      = 6;
+static constexpr uint32_t c_WinCSMaxBufferCount      = c_SwapchainMaxBufferCount;
+static constexpr uint32_t c_WinCSInlineWaitCount     = 8;
+static constexpr uint32_t c_WinCSMaxQueueFamilyCount = 8;
 
 //
-// EventThread1: Either waits for a buffer retirement or a buffer rendered.
-//	Buffer rendered is a buffer that was specified to be done after a semaphore being signaled
-// EventThread2: Wait for VBlank to immediately present. Always transitions a single Presentable buffer to Presenting
+// The buffer state machine lives in SwapchainStateMachine, this file only feeds it Windows events.
+// All swapchains share a small pool of present threads (WinCSPresentScheduler), each thread services up to c_WinCSPresentThreadMaxSwapchains swapchains:
+//	Compositor clock: Calls OnVBlank for every swapchain of the thread. Always transitions a single Presentable buffer to Presenting
+//	Signal event:     Set by the retire fence and every present fence of a swapchain, polls its buffers for retirement or a finished render
+//	Wake event:       Set whenever a swapchain is added to or removed from the thread
 //
-// FIFO Transitions:
-//	vkAcquireNextImageKHR:
-//		Renderable:      Transition to Rendering, Signal semaphore and fence immediately
-//		Rendering:       Not acquired
-//      DoubleRendering: Not acquired
-//		Waiting:         Not acquired
-//      DoubleWaiting:   Not acquired
-//      Presentable:     Not acquired
-//      Presenting:      Not acquired
-//	vkQueuePresentKHR:
-//		Renderable:      Not presentable
-//		Rendering:       If pPresentInfo->waitSemaphoreCount > 0 transition to Waiting, otherwise transition to Presentable
-//      DoubleRendering: Not used
-//      Waiting:         Not presentable
-//      DoubleWaiting:   Not presentable
-//      Presentable:     Not presentable
-//      Presenting:      Not presentable
-//	EventThread1:
-//		OnBufferRetire:   Transition to Renderable if buffer is Presenting
-//		OnBufferRendered: Transition to Presentable if buffer is Waiting
-//	EventThread2: Transition oldest Presentable to Presenting
-//
-// Mailbox Transitions:
-//	vkAcquireNextImageKHR:
-//		Renderable:      Transition to Rendering, Signal semaphore and fence immediately
-//		Rendering:       Not acquired
-//		DoubleRendering: Not acquired
-//		Waiting:         Transition to DoubleRendering, Signal semaphore and fence on bufferRendered
-//		DoubleWaiting:   Not acquired
-//		Presentable:     Transition to Rendering, Signal semaphore and fence immediately
-//		Presenting:      Not acquired
-//	vkQueuePresentKHR:
-//		Renderable:      Not presentable
-//		Rendering:       If pPresentInfo->waitSemaphoreCount > 0 transition to Waiting, otherwise transition to Presentable
-//		DoubleRendering: If pPresentInfo->waitSemaphoreCount > 0 transition to DoubleWaiting, otherwise transition to Presentable
-//		Waiting:         Not presentable
-//		DoubleWaiting:   Not presentable
-//		Presentable:     Not presentable
-//		Presenting:      Not presentable
-//	EventThread1:
-//		OnBufferRetire:   Transition to Renderable if buffer is Presenting
-//		OnBufferRendered: Transition to Presentable if buffer is Waiting, if buffer is DoubleWaiting, skip transition unless fence value is the current expected fence value
-//	EventThread2: Transition newest Presentable to Presenting
+// Resizing never recreates the whole swapchain. vkResizeWinCSSwapchainEXT marks every buffer stale, each one is recreated at the
+// new size once Acquire hands it out, which only happens after it retired. Until then stale buffers keep presenting at their
+// old size, so presentation never waits on a resize and at most one buffer is being replaced at a time.
 //
 
 struct WinCSSurface
@@ -215,24 +178,30 @@ struct WinCSSwapchainBuffer
 	HANDLE               TextureHandle;
 	ID3D11Fence*         PresentFence;
 	HANDLE               PresentFenceHandle;
-	UINT64               PresentFenceValue;
 	VkImage              vkImage;
 	VkDeviceMemory       vkImageMemory;
 	VkSemaphore          vkTimeline;
-	std::atomic_bool     Invalidated;
-	std::atomic_uint8_t  State;
+	UINT                 Width;         // Size the buffer was created at, only changes while the app thread has it acquired
+	UINT                 Height;
+	uint64_t             RenderedValue; // Last PresentFence value handed to OnBufferRendered, present thread only
+};
+
+// Hands buffers picked by SwapchainStateMachine::OnVBlank to the IPresentationManager
+struct WinCSCompositor : public SwapchainCompositor
+{
+	void Present(uint32_t imageIndex) override;
+
+	struct WinCSSwapchain* Swapchain = nullptr;
 };
 
 struct WinCSSwapchain
 {
 	WinCSSurface* Surface;
 
-	std::atomic_uint32_t UsableBufferCount;
 	uint32_t             BufferCount;
-	uint32_t             BufferIndex;
 	WinCSSwapchainBuffer Buffers[c_WinCSMaxBufferCount];
-	uint32_t             PresentQueue[c_WinCSMaxBufferCount];
-	HANDLE               Events[3 + c_WinCSMaxBufferCount]; // [0]: Lost, [1]: Terminate, [2]: OnBufferRetire, [3,...]: OnBufferRendered
+	HANDLE               LostEvent;   // TODO: Not waited on, losing the Presentation Manager is not handled yet
+	HANDLE               SignalEvent; // Auto reset, set by RetireFence and every PresentFence
 	ID3D11Fence*         RetireFence;
 
 	UINT                          Width;
@@ -243,16 +212,125 @@ struct WinCSSwapchain
 	VkPresentModeKHR              PresentMode;
 	VkSurfaceTransformFlagBitsKHR Transform;
 
+	// Kept to recreate buffers after a resize
+	VkFormat                     ImageFormat;
+	VkImageUsageFlags            ImageUsage;
+	VkSharingMode                ImageSharingMode;
+	uint32_t                     QueueFamilyIndexCount;
+	uint32_t                     QueueFamilyIndices[c_WinCSMaxQueueFamilyCount];
+	VkAllocationCallbacks        Allocator;
+	const VkAllocationCallbacks* pAllocator; // nullptr or &Allocator
+
+	PFN_vkGetMemoryWin32HandlePropertiesKHR GetMemoryWin32HandleProperties;
+
 	VkQueue Queue;
 
-	Concurrency::Mutex Mtx;
-	std::atomic_bool   EventThreadsRunning;
-	std::thread        EventThread1;
-	std::thread        EventThread2; // Could potentially be a single global thread that presents for every created swapchain
+	WinCSCompositor       Compositor;
+	SteadySwapchainClock  Clock;
+	SwapchainStateMachine State;
+
+	struct WinCSPresentThread* PresentThread;
+};
+
+// DCompositionWaitForCompositorClock takes at most MAXIMUM_WAIT_OBJECTS - 1 handles, one of which is the wake event
+static constexpr uint32_t c_WinCSPresentThreadMaxSwapchains = MAXIMUM_WAIT_OBJECTS - 2;
+
+struct WinCSPresentThread
+{
+	std::thread          Thread;
+	HANDLE               WakeEvent = nullptr; // Auto reset
+	Concurrency::Mutex   Mtx;                 // Guards Running and Swapchains, held by the thread while servicing them
+	bool                 Running        = true;
+	uint32_t             SwapchainCount = 0;
+	WinCSSwapchain*      Swapchains[c_WinCSPresentThreadMaxSwapchains];
+	std::atomic_uint64_t Generation     = 0; // Bumped on every change to Swapchains
+	std::atomic_uint64_t SeenGeneration = 0; // Generation the thread last built its wait handles from
 };
 
-static void WinCSEventThreadFunc1(WinCSSwapchain* swapchain);
-static void WinCSEventThreadFunc2(WinCSSwapchain* swapchain);
+struct WinCSPresentScheduler
+{
+public:
+	~WinCSPresentScheduler();
+
+public:
+	Concurrency::Mutex                               Mtx;
+	uint32_t                                         ThreadCount = 1; // Threads swapchains are spread over, more are started once all of them are full
+	std::vector<std::unique_ptr<WinCSPresentThread>> Threads;
+};
+
+struct WinCSPresentStats
+{
+	std::atomic_uint64_t PresentCount        = 0;
+	std::atomic_uint64_t WaitSpillCount      = 0;
+	std::atomic_uint64_t HeapAllocationCount = 0;
+	std::atomic_uint64_t ThreadWakeups       = 0;
+	std::atomic_uint64_t ClockWakeups        = 0;
+	std::atomic_uint64_t IdleVBlanks         = 0;
+	std::atomic_uint64_t ResizeCount         = 0;
+	std::atomic_uint64_t RecreateCount       = 0;
+};
+
+static WinCSPresentStats        g_WinCSPresentStats;
+static WinCSPresentScheduler    g_WinCSPresentScheduler; // Declared after the stats, its threads are stopped before they are destroyed
+static thread_local LinearArena g_WinCSPresentArena(4096); // Spill space for wait semaphore arrays, reset on every present
+
+static bool WinCSAddToPresentThread(WinCSSwapchain* swapchain);
+static void WinCSRemoveFromPresentThread(WinCSSwapchain* swapchain);
+static void WinCSStopPresentThread(WinCSPresentThread* thread);
+static void WinCSPresentThreadFunc(WinCSPresentThread* thread);
+
+static VkResult WinCSCreateBufferImage(VkDevice device, WinCSSwapchain* swapchain, WinCSSwapchainBuffer& buffer);
+static void     WinCSDestroyBufferImage(VkDevice device, WinCSSwapchain* swapchain, WinCSSwapchainBuffer& buffer);
+static VkResult WinCSRecreateBuffer(VkDevice device, WinCSSwapchain* swapchain, uint32_t imageIndex);
+
+void vkGetWinCSPresentStatsEXT(
+	VkWinCSPresentStatsEXT* pStats)
+{
+#if BUILD_IS_CONFIG_DEBUG
+	if (!pStats)
+		throw std::runtime_error("Nullptrs passed to vkGetWinCSPresentStatsEXT");
+#endif
+
+	pStats->presentCount        = g_WinCSPresentStats.PresentCount;
+	pStats->waitSpillCount      = g_WinCSPresentStats.WaitSpillCount;
+	pStats->heapAllocationCount = g_WinCSPresentStats.HeapAllocationCount;
+	pStats->threadWakeups       = g_WinCSPresentStats.ThreadWakeups;
+	pStats->clockWakeups        = g_WinCSPresentStats.ClockWakeups;
+	pStats->idleVBlanks         = g_WinCSPresentStats.IdleVBlanks;
+	pStats->resizeCount         = g_WinCSPresentStats.ResizeCount;
+	pStats->recreateCount       = g_WinCSPresentStats.RecreateCount;
+}
+
+void vkSetWinCSPresentThreadCountEXT(
+	uint32_t threadCount)
+{
+	g_WinCSPresentScheduler.Mtx.Lock();
+	g_WinCSPresentScheduler.ThreadCount = std::max<uint32_t>(threadCount, 1);
+	g_WinCSPresentScheduler.Mtx.Unlock();
+}
+
+VkResult vkResizeWinCSSwapchainEXT(
+	VkDevice       device,
+	VkSwapchainKHR swapchain,
+	VkExtent2D     extent)
+{
+#if BUILD_IS_CONFIG_DEBUG
+	if (!device || !swapchain)
+		throw std::runtime_error("Nullptrs passed to vkResizeWinCSSwapchainEXT");
+#endif
+	if (extent.width == 0 || extent.height == 0 || extent.width > 0xFFFF || extent.height > 0xFFFF)
+		return VK_ERROR_INITIALIZATION_FAILED;
+
+	WinCSSwapchain* pSwapchain = (WinCSSwapchain*) swapchain;
+	if (extent.width == pSwapchain->Width && extent.height == pSwapchain->Height)
+		return VK_SUCCESS;
+
+	pSwapchain->Width  = extent.width;
+	pSwapchain->Height = extent.height;
+	pSwapchain->State.Invalidate();
+	++g_WinCSPresentStats.ResizeCount;
+	return VK_SUCCESS;
+}
 
 VkResult vkCreateWinCSSurfaceEXT(
 	VkInstance                         instance,
@@ -631,13 +709,13 @@ VkResult wincs_surface_vkCreateSwapchainKHR(
 	{
 		WinCSSwapchain* swapchain = nullptr;
 		HRESULT         hr;
-		IDXGIResource1* dxgiResource = nullptr;
 		do
 		{
 			if (pCreateInfo->minImageCount >= c_WinCSMaxBufferCount ||
 				pCreateInfo->imageExtent.width == 0 ||
 				pCreateInfo->imageExtent.height == 0 ||
-				pCreateInfo->imageArrayLayers != 1)
+				pCreateInfo->imageArrayLayers != 1 ||
+				(pCreateInfo->imageSharingMode == VK_SHARING_MODE_CONCURRENT && pCreateInfo->queueFamilyIndexCount > c_WinCSMaxQueueFamilyCount))
 				break;
 
 			{
@@ -686,9 +764,14 @@ VkResult wincs_surface_vkCreateSwapchainKHR(
 				break;
 
 			if (pAllocator)
-				swapchain = (WinCSSwapchain*) pAllocator->pfnAllocation(pAllocator->pUserData, sizeof(WinCSSwapchain), alignof(WinCSSwapchain), VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+			{
+				void* memory = pAllocator->pfnAllocation(pAllocator->pUserData, sizeof(WinCSSwapchain), alignof(WinCSSwapchain), VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+				swapchain    = memory ? new (memory) WinCSSwapchain() : nullptr; // Atomics and SwapchainStateMachine need constructing
+			}
 			else
+			{
 				swapchain = new WinCSSwapchain();
+			}
 			if (!swapchain)
 			{
 				result = VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -707,78 +790,67 @@ VkResult wincs_surface_vkCreateSwapchainKHR(
 			swapchain->AlphaMode   = ToDXGIAlphaMode(pCreateInfo->compositeAlpha);
 			swapchain->PresentMode = pCreateInfo->presentMode;
 			swapchain->Transform   = pCreateInfo->preTransform;
-			if (pCreateInfo->minImageCount < 2)
-				swapchain->BufferCount = 2;
-			else
-				swapchain->BufferCount = pCreateInfo->minImageCount;
-			swapchain->UsableBufferCount = swapchain->BufferCount;
-			swapchain->BufferIndex       = 0;
-			swapchain->RetireFence       = nullptr;
+			swapchain->BufferCount = std::clamp<uint32_t>(pCreateInfo->minImageCount, 2, c_WinCSMaxBufferCount);
+			swapchain->RetireFence = nullptr;
+
+			swapchain->ImageFormat           = pCreateInfo->imageFormat;
+			swapchain->ImageUsage            = pCreateInfo->imageUsage;
+			swapchain->ImageSharingMode      = pCreateInfo->imageSharingMode;
+			swapchain->QueueFamilyIndexCount = pCreateInfo->imageSharingMode == VK_SHARING_MODE_CONCURRENT ? pCreateInfo->queueFamilyIndexCount : 0;
+			for (uint32_t i = 0; i < swapchain->QueueFamilyIndexCount; ++i)
+				swapchain->QueueFamilyIndices[i] = pCreateInfo->pQueueFamilyIndices[i];
+			if (pAllocator)
+				swapchain->Allocator = *pAllocator;
+			swapchain->pAllocator                     = pAllocator ? &swapchain->Allocator : nullptr;
+			swapchain->GetMemoryWin32HandleProperties = pVkGetMemoryWin32HandlePropertiesKHR;
+
+			swapchain->Compositor.Swapchain = swapchain;
+			SwapchainStateMachineSpec stateSpec {
+				.BufferCount = swapchain->BufferCount,
+				.PresentMode = swapchain->PresentMode == VK_PRESENT_MODE_MAILBOX_KHR ? SwapchainPresentMode::Mailbox : SwapchainPresentMode::Fifo,
+				.Compositor  = &swapchain->Compositor,
+				.Clock       = &swapchain->Clock
+			};
+			if (!swapchain->State.Init(&stateSpec))
+				break;
 			for (uint32_t i = 0; i < swapchain->BufferCount; ++i)
 			{
-				swapchain->PresentQueue[i] = ~0U;
-
 				auto& buffer              = swapchain->Buffers[i];
 				buffer.PresentationBuffer = nullptr;
 				buffer.Texture            = nullptr;
 				buffer.TextureHandle      = nullptr;
 				buffer.PresentFence       = nullptr;
 				buffer.PresentFenceHandle = nullptr;
-				buffer.PresentFenceValue  = 0;
 				buffer.vkImage            = nullptr;
 				buffer.vkImageMemory      = nullptr;
 				buffer.vkTimeline         = nullptr;
-				buffer.Invalidated        = false;
-				buffer.State              = c_WinCSBufferRenderable;
+				buffer.Width              = swapchain->Width;
+				buffer.Height             = swapchain->Height;
+				buffer.RenderedValue      = 0;
 			}
-			for (uint32_t i = 0; i < 3 + c_WinCSMaxBufferCount; ++i)
-				swapchain->Events[i] = nullptr;
-			hr = surface->Manager->GetLostEvent(&swapchain->Events[0]);
+			swapchain->LostEvent     = nullptr;
+			swapchain->SignalEvent   = nullptr;
+			swapchain->PresentThread = nullptr;
+			hr                       = surface->Manager->GetLostEvent(&swapchain->LostEvent);
 			if (hr < S_OK)
 				break;
 			hr = surface->Manager->GetPresentRetiringFence(__uuidof(ID3D11Fence), (void**) &swapchain->RetireFence);
 			if (hr < S_OK)
 				break;
-			swapchain->Events[1] = CreateEventW(nullptr, TRUE, FALSE, nullptr);
-			swapchain->Events[2] = CreateEventW(nullptr, TRUE, FALSE, nullptr);
-			if (!swapchain->Events[1] || !swapchain->Events[2])
+			swapchain->SignalEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+			if (!swapchain->SignalEvent)
 				break;
 
 			uint32_t i = 0;
 			for (; i < swapchain->BufferCount; ++i)
 			{
-				auto& buffer             = swapchain->Buffers[i];
-				swapchain->Events[3 + i] = CreateEventW(nullptr, TRUE, FALSE, nullptr);
-				if (!swapchain->Events[3 + i])
-					break;
+				auto& buffer = swapchain->Buffers[i];
 
-				D3D11_TEXTURE2D_DESC textureDesc {
-					.Width          = swapchain->Width,
-					.Height         = swapchain->Height,
-					.MipLevels      = 1,
-					.ArraySize      = 1,
-					.Format         = swapchain->Format,
-					.SampleDesc     = {1, 0},
-					.Usage          = D3D11_USAGE_DEFAULT,
-					.BindFlags      = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET,
-					.CPUAccessFlags = 0,
-					.MiscFlags      = D3D11_RESOURCE_MISC_SHARED | D3D11_RESOURCE_MISC_SHARED_NTHANDLE
-				};
-				hr = surface->D3D11Device->CreateTexture2D(&textureDesc, nullptr, &buffer.Texture);
-				if (hr < S_OK)
-					break;
-				hr = surface->Manager->AddBufferFromResource(buffer.Texture, &buffer.PresentationBuffer);
-				if (hr < S_OK)
+				result = WinCSCreateBufferImage(device, swapchain, buffer);
+				if (result < VK_SUCCESS)
 					break;
 
-				hr = buffer.Texture->QueryInterface(&dxgiResource);
-				if (hr < S_OK)
-					break;
-				hr = dxgiResource->CreateSharedHandle(nullptr, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE, nullptr, &buffer.TextureHandle);
-				dxgiResource->Release();
-				dxgiResource = nullptr;
-				if (hr < S_OK)
-					break;
+				result = VK_ERROR_INITIALIZATION_FAILED;
 
 				hr = surface->D3D11Device->CreateFence(0, D3D11_FENCE_FLAG_SHARED, __uuidof(ID3D11Fence), (void**) &buffer.PresentFence);
 				if (hr < S_OK)
@@ -787,63 +859,6 @@ VkResult wincs_surface_vkCreateSwapchainKHR(
 				if (hr < S_OK)
 					break;
 
-				VkMemoryWin32HandlePropertiesKHR handleProps {
-					.sType = VK_STRUCTURE_TYPE_MEMORY_WIN32_HANDLE_PROPERTIES_KHR,
-					.pNext = nullptr
-				};
-				result = pVkGetMemoryWin32HandlePropertiesKHR(device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT, buffer.TextureHandle, &handleProps);
-				if (result < VK_SUCCESS)
-					break;
-
-				VkExternalMemoryImageCreateInfo emiCreateInfo {
-					.sType       = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
-					.pNext       = nullptr,
-					.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT
-				};
-				VkImageCreateInfo iCreateInfo {
-					.sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-					.pNext                 = &emiCreateInfo,
-					.flags                 = 0,
-					.imageType             = VK_IMAGE_TYPE_2D,
-					.format                = pCreateInfo->imageFormat,
-					.extent                = {swapchain->Width, swapchain->Height, 1},
-					.mipLevels             = 1,
-					.arrayLayers           = 1,
-					.samples               = VK_SAMPLE_COUNT_1_BIT,
-					.tiling                = VK_IMAGE_TILING_OPTIMAL,
-					.usage                 = pCreateInfo->imageUsage,
-					.sharingMode           = pCreateInfo->imageSharingMode,
-					.queueFamilyIndexCount = pCreateInfo->queueFamilyIndexCount,
-					.pQueueFamilyIndices   = pCreateInfo->pQueueFamilyIndices,
-					.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
-				};
-				result = vkCreateImage(device, &iCreateInfo, pAllocator, &buffer.vkImage);
-				if (result < VK_SUCCESS)
-					break;
-
-				VkMemoryRequirements mReq {};
-				vkGetImageMemoryRequirements(device, buffer.vkImage, &mReq);
-
-				VkImportMemoryWin32HandleInfoKHR imHandleInfo {
-					.sType      = VK_STRUCTURE_TYPE_IMPORT_MEMORY_WIN32_HANDLE_INFO_KHR,
-					.pNext      = nullptr,
-					.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT,
-					.handle     = buffer.TextureHandle,
-					.name       = nullptr
-				};
-				VkMemoryAllocateInfo mAllocInfo {
-					.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-					.pNext           = &imHandleInfo,
-					.allocationSize  = mReq.size,
-					.memoryTypeIndex = (uint32_t) std::countr_zero(handleProps.memoryTypeBits)
-				};
-				result = vkAllocateMemory(device, &mAllocInfo, pAllocator, &buffer.vkImageMemory);
-				if (result < VK_SUCCESS)
-					break;
-				result = vkBindImageMemory(device, buffer.vkImage, buffer.vkImageMemory, 0);
-				if (result < VK_SUCCESS)
-					break;
-
 				VkSemaphoreTypeCreateInfo stCreateInfo {
 					.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
 					.pNext         = nullptr,
@@ -875,9 +890,8 @@ VkResult wincs_surface_vkCreateSwapchainKHR(
 			if (i < swapchain->BufferCount)
 				break;
 
-			swapchain->EventThreadsRunning = true;
-			swapchain->EventThread1        = std::thread(&WinCSEventThreadFunc1, swapchain);
-			swapchain->EventThread2        = std::thread(&WinCSEventThreadFunc2, swapchain);
+			if (!WinCSAddToPresentThread(swapchain))
+				break;
 
 			*pSwapchain = (VkSwapchainKHR) swapchain;
 			return VK_SUCCESS;
@@ -891,32 +905,27 @@ VkResult wincs_surface_vkCreateSwapchainKHR(
 				auto& buffer = swapchain->Buffers[i];
 				if (buffer.vkTimeline)
 					vkDestroySemaphore(device, buffer.vkTimeline, pAllocator);
-				if (buffer.vkImage)
-					vkDestroyImage(device, buffer.vkImage, pAllocator);
-				if (buffer.vkImageMemory)
-					vkFreeMemory(device, buffer.vkImageMemory, pAllocator);
 				if (buffer.PresentFenceHandle)
 					CloseHandle(buffer.PresentFenceHandle);
 				if (buffer.PresentFence)
 					buffer.PresentFence->Release();
-				if (buffer.TextureHandle)
-					CloseHandle(buffer.TextureHandle);
-				if (buffer.Texture)
-					buffer.Texture->Release();
-				if (buffer.PresentationBuffer)
-					buffer.PresentationBuffer->Release();
-			}
-			for (uint32_t i = 0; i < 3 + swapchain->BufferCount; ++i)
-			{
-				if (swapchain->Events[i])
-					CloseHandle(swapchain->Events[i]);
+				WinCSDestroyBufferImage(device, swapchain, buffer);
 			}
+			if (swapchain->SignalEvent)
+				CloseHandle(swapchain->SignalEvent);
+			if (swapchain->LostEvent)
+				CloseHandle(swapchain->LostEvent);
 			if (swapchain->RetireFence)
 				swapchain->RetireFence->Release();
 			if (pAllocator)
+			{
+				swapchain->~WinCSSwapchain();
 				pAllocator->pfnFree(pAllocator->pUserData, swapchain);
+			}
 			else
-				free(swapchain);
+			{
+				delete swapchain;
+			}
 		}
 	}
 
@@ -939,31 +948,29 @@ void wincs_surface_vkDestroySwapchainKHR(
 
 	WinCSSwapchain* pSwapchain = (WinCSSwapchain*) swapchain;
 
-	pSwapchain->Surface->Swapchain  = nullptr;
-	pSwapchain->EventThreadsRunning = false;
-	SetEvent(pSwapchain->Events[1]);
-	pSwapchain->EventThread1.join();
-	pSwapchain->EventThread2.join();
+	pSwapchain->Surface->Swapchain = nullptr;
+	WinCSRemoveFromPresentThread(pSwapchain);
 
 	for (uint32_t i = 0; i < pSwapchain->BufferCount; ++i)
 	{
 		auto& buffer = pSwapchain->Buffers[i];
 		vkDestroySemaphore(device, buffer.vkTimeline, pAllocator);
-		vkDestroyImage(device, buffer.vkImage, pAllocator);
-		vkFreeMemory(device, buffer.vkImageMemory, pAllocator);
 		CloseHandle(buffer.PresentFenceHandle);
 		buffer.PresentFence->Release();
-		CloseHandle(buffer.TextureHandle);
-		buffer.Texture->Release();
-		buffer.PresentationBuffer->Release();
+		WinCSDestroyBufferImage(device, pSwapchain, buffer);
 	}
-	for (uint32_t i = 0; i < 3 + pSwapchain->BufferCount; ++i)
-		CloseHandle(pSwapchain->Events[i]);
+	CloseHandle(pSwapchain->SignalEvent);
+	CloseHandle(pSwapchain->LostEvent);
 	pSwapchain->RetireFence->Release();
 	if (pAllocator)
+	{
+		pSwapchain->~WinCSSwapchain();
 		pAllocator->pfnFree(pAllocator->pUserData, swapchain);
+	}
 	else
+	{
 		delete pSwapchain;
+	}
 }
 
 VkResult wincs_surface_vkGetSwapchainImagesKHR(
@@ -1011,7 +1018,8 @@ VkResult wincs_surface_vkAcquireNextImageKHR(
 		throw std::runtime_error("Nullptrs passed to wincs_surface_vkGetSwapchainImagesKHR");
 #endif
 
-	WinCSSwapchain* pSwapchain = (WinCSSwapchain*) swapchain;
+	WinCSSwapchain*       pSwapchain        = (WinCSSwapchain*) swapchain;
+	std::atomic_uint32_t& usableBufferCount = pSwapchain->State.UsableBufferCount();
 
 	if (timeout != ~0ULL)
 	{
@@ -1023,18 +1031,18 @@ VkResult wincs_surface_vkAcquireNextImageKHR(
 		while (end > now)
 		{
 			DWORD timeLeft = (DWORD) std::min<size_t>(end - now, INFINITE - 1);
-			WaitOnAddress(&pSwapchain->UsableBufferCount, &compareValue, 4, timeLeft);
-			if (pSwapchain->UsableBufferCount)
+			WaitOnAddress(&usableBufferCount, &compareValue, 4, timeLeft);
+			if (usableBufferCount)
 				break;
 			QueryPerformanceCounter((LARGE_INTEGER*) &now);
 		}
-		if (!pSwapchain->UsableBufferCount)
+		if (!usableBufferCount)
 			return VK_TIMEOUT;
 	}
 	else
 	{
 		uint32_t compareValue = 0;
-		WaitOnAddress(&pSwapchain->UsableBufferCount, &compareValue, 4, INFINITE);
+		WaitOnAddress(&usableBufferCount, &compareValue, 4, INFINITE);
 	}
 
 	VkSemaphoreSubmitInfo wait {
@@ -1062,77 +1070,42 @@ VkResult wincs_surface_vkAcquireNextImageKHR(
 		.signalSemaphoreInfoCount = 1,
 		.pSignalSemaphoreInfos    = &signal
 	};
-	switch (pSwapchain->PresentMode)
-	{
-	case VK_PRESENT_MODE_FIFO_KHR:
+	uint32_t imageIndex = 0;
+	uint64_t waitValue  = 0;
+	if (!pSwapchain->State.Acquire(&imageIndex, &waitValue))
+		return VK_NOT_READY;
+
+	// A stale buffer is never handed out with a render pending, so it is replaced before the caller sees it
+	VkResult result = VK_SUCCESS;
+	if (pSwapchain->State.IsStale(imageIndex))
 	{
-		pSwapchain->Mtx.Lock();
-		uint32_t startIndex = pSwapchain->BufferIndex;
-		do
+		result = WinCSRecreateBuffer(device, pSwapchain, imageIndex);
+		if (result < VK_SUCCESS)
 		{
-			uint32_t currentIndex   = pSwapchain->BufferIndex;
-			auto&    buffer         = pSwapchain->Buffers[currentIndex];
-			pSwapchain->BufferIndex = (currentIndex + 1) % pSwapchain->BufferCount;
-			uint8_t state           = buffer.State.load();
-			if (state != c_WinCSBufferRenderable)
-				continue;
-			buffer.State = c_WinCSBufferDoubleRendering; // Transition to Rendering
-			--pSwapchain->UsableBufferCount;             // And decrement usable buffer count
-			pSwapchain->Mtx.Unlock();
-			*pImageIndex = currentIndex;
-			if (semaphore)
-				return vkQueueSubmit2(pSwapchain->Queue, 1, &submit, fence);
-			else if (fence)
-				return vkQueueSubmit2(pSwapchain->Queue, 0, nullptr, fence);
+			pSwapchain->State.Release(imageIndex);
+			return result;
 		}
-		while (pSwapchain->BufferIndex != startIndex);
-		pSwapchain->Mtx.Unlock();
-		break;
+		result = VK_SUBOPTIMAL_KHR; // The image at imageIndex changed, anything made from it has to be recreated
 	}
-	case VK_PRESENT_MODE_MAILBOX_KHR:
+
+	*pImageIndex = imageIndex;
+	if (waitValue) // Re-acquired a Waiting buffer, signal once its previous present finished rendering
 	{
-		pSwapchain->Mtx.Lock();
-		uint32_t startIndex = pSwapchain->BufferIndex;
-		do
-		{
-			uint32_t currentIndex   = pSwapchain->BufferIndex;
-			pSwapchain->BufferIndex = (currentIndex + 1) % pSwapchain->BufferCount;
-			if (pSwapchain->PresentQueue[0] == currentIndex)
-				continue;
-			auto&   buffer = pSwapchain->Buffers[currentIndex];
-			uint8_t state  = buffer.State.load();
-			switch (state)
-			{
-			case c_WinCSBufferRenderable:
-			case c_WinCSBufferPresentable:
-				buffer.State = c_WinCSBufferRendering; // Transition to Rendering
-				--pSwapchain->UsableBufferCount;       // And decrement usable buffer count
-				pSwapchain->Mtx.Unlock();
-				*pImageIndex = currentIndex;
-				if (semaphore)
-					return vkQueueSubmit2(pSwapchain->Queue, 1, &submit, fence);
-				else
-					return vkQueueSubmit2(pSwapchain->Queue, 0, nullptr, fence);
-			case c_WinCSBufferWaiting:
-				buffer.State = c_WinCSBufferDoubleRendering; // Transition to DoubleRendering
-				--pSwapchain->UsableBufferCount;             // And decrement usable buffer count
-				pSwapchain->Mtx.Unlock();
-				if (!semaphore)
-					submit.signalSemaphoreInfoCount = 0;
-				submit.waitSemaphoreInfoCount = 1;
-				submit.pWaitSemaphoreInfos    = &wait;
-				wait.semaphore                = buffer.vkTimeline;
-				wait.value                    = buffer.PresentFenceValue;
-				*pImageIndex                  = currentIndex;
-				return vkQueueSubmit2(pSwapchain->Queue, 1, &submit, fence);
-			}
-		}
-		while (pSwapchain->BufferIndex != startIndex);
-		pSwapchain->Mtx.Unlock();
-		break;
+		if (!semaphore)
+			submit.signalSemaphoreInfoCount = 0;
+		submit.waitSemaphoreInfoCount = 1;
+		submit.pWaitSemaphoreInfos    = &wait;
+		wait.semaphore                = pSwapchain->Buffers[imageIndex].vkTimeline;
+		wait.value                    = waitValue;
+		return vkQueueSubmit2(pSwapchain->Queue, 1, &submit, fence);
 	}
-	}
-	return VK_NOT_READY;
+
+	VkResult submitResult = VK_SUCCESS;
+	if (semaphore)
+		submitResult = vkQueueSubmit2(pSwapchain->Queue, 1, &submit, fence);
+	else if (fence)
+		submitResult = vkQueueSubmit2(pSwapchain->Queue, 0, nullptr, fence);
+	return submitResult < VK_SUCCESS ? submitResult : result;
 }
 
 VkResult wincs_surface_vkQueuePresentKHR(
@@ -1144,6 +1117,25 @@ VkResult wincs_surface_vkQueuePresentKHR(
 		throw std::runtime_error("Nullptrs passed to wincs_surface_vkQueuePresentKHR");
 #endif
 
+	LinearArena& arena            = g_WinCSPresentArena;
+	uint64_t     blockAllocations = arena.BlockAllocations();
+	arena.Reset();
+
+	ScratchArray<VkSemaphoreSubmitInfo, c_WinCSInlineWaitCount> waits(pPresentInfo->waitSemaphoreCount, arena);
+	for (uint32_t j = 0; j < pPresentInfo->waitSemaphoreCount; ++j)
+	{
+		waits[j] = {
+			.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.pNext       = nullptr,
+			.semaphore   = pPresentInfo->pWaitSemaphores[j],
+			.value       = 0,
+			.stageMask   = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+			.deviceIndex = 0
+		};
+	}
+	if (waits.spilled())
+		++g_WinCSPresentStats.WaitSpillCount;
+
 	VkResult result = VK_SUCCESS;
 	for (uint32_t i = 0; i < pPresentInfo->swapchainCount; ++i)
 	{
@@ -1153,69 +1145,21 @@ VkResult wincs_surface_vkQueuePresentKHR(
 		VkResult subResult = VK_SUCCESS;
 		do
 		{
-			if (imageIndex >= swapchain->BufferCount)
+			uint64_t renderValue = 0;
+			if (!swapchain->State.Present(imageIndex, pPresentInfo->waitSemaphoreCount > 0, &renderValue))
 			{
 				subResult = VK_SUBOPTIMAL_KHR;
 				break;
 			}
 
-			auto&   buffer = swapchain->Buffers[imageIndex];
-			uint8_t state  = buffer.State;
-			if (state != c_WinCSBufferRendering &&
-				state != c_WinCSBufferDoubleRendering)
+			if (pPresentInfo->waitSemaphoreCount)
 			{
-				subResult = VK_SUBOPTIMAL_KHR;
-				break;
-			}
-
-			if (!pPresentInfo->waitSemaphoreCount)
-			{
-				buffer.State = c_WinCSBufferPresentable; // Transition to Presentable
-				switch (swapchain->PresentMode)
-				{
-				case VK_PRESENT_MODE_FIFO_KHR:
-					swapchain->Mtx.Lock();
-					for (uint32_t j = 0; j < swapchain->BufferCount; ++j)
-					{
-						if (swapchain->PresentQueue[j] == ~0U)
-						{
-							swapchain->PresentQueue[j] = imageIndex;
-							break;
-						}
-					}
-					swapchain->Mtx.Unlock();
-					break;
-				case VK_PRESENT_MODE_MAILBOX_KHR:
-					swapchain->Mtx.Lock();
-					if (swapchain->PresentQueue[0] != ~0U)
-					{
-						++swapchain->UsableBufferCount; // Increment usable buffer count
-						swapchain->UsableBufferCount.notify_one();
-					}
-					swapchain->PresentQueue[0] = imageIndex;
-					swapchain->Mtx.Unlock();
-					break;
-				}
-			}
-			else
-			{
-				VkSemaphoreSubmitInfo* waits = new VkSemaphoreSubmitInfo[pPresentInfo->waitSemaphoreCount];
-				for (uint32_t j = 0; j < pPresentInfo->waitSemaphoreCount; ++j)
-				{
-					waits[j] = {
-						.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-						.pNext       = nullptr,
-						.semaphore   = pPresentInfo->pWaitSemaphores[i],
-						.value       = 0,
-						.stageMask   = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
-						.deviceIndex = 0
-					};
-				}
+				auto&                 buffer = swapchain->Buffers[imageIndex];
 				VkSemaphoreSubmitInfo signal {
 					.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
 					.pNext       = nullptr,
 					.semaphore   = buffer.vkTimeline,
-					.value       = ++buffer.PresentFenceValue,
+					.value       = renderValue,
 					.stageMask   = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
 					.deviceIndex = 0
 				};
@@ -1224,27 +1168,13 @@ VkResult wincs_surface_vkQueuePresentKHR(
 					.pNext                    = nullptr,
 					.flags                    = 0,
 					.waitSemaphoreInfoCount   = pPresentInfo->waitSemaphoreCount,
-					.pWaitSemaphoreInfos      = waits,
+					.pWaitSemaphoreInfos      = waits.data(),
 					.commandBufferInfoCount   = 0,
 					.signalSemaphoreInfoCount = 1,
 					.pSignalSemaphoreInfos    = &signal
 				};
-				if (state == c_WinCSBufferDoubleRendering)
-				{
-					buffer.State = c_WinCSBufferDoubleWaiting; // Transition to DoubleWaiting
-				}
-				else
-				{
-					buffer.State = c_WinCSBufferWaiting; // Transition to Waiting
-					if (swapchain->PresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-					{
-						++swapchain->UsableBufferCount; // And increment usable buffer count
-						swapchain->UsableBufferCount.notify_one();
-					}
-				}
-				subResult = vkQueueSubmit2(queue, 1, &submit, nullptr);
-				delete[] waits;
-				HRESULT hr = buffer.PresentFence->SetEventOnCompletion(buffer.PresentFenceValue, swapchain->Events[3 + imageIndex]);
+				subResult  = vkQueueSubmit2(queue, 1, &submit, nullptr);
+				HRESULT hr = buffer.PresentFence->SetEventOnCompletion(renderValue, swapchain->SignalEvent);
 				if (hr < S_OK)
 				{
 					subResult = VK_SUBOPTIMAL_KHR;
@@ -1280,154 +1210,361 @@ VkResult wincs_surface_vkQueuePresentKHR(
 		}
 		while (false);
 	}
+
+	++g_WinCSPresentStats.PresentCount;
+	g_WinCSPresentStats.HeapAllocationCount += arena.BlockAllocations() - blockAllocations;
 	return result;
 }
 
-void WinCSEventThreadFunc1(WinCSSwapchain* swapchain)
+VkResult WinCSCreateBufferImage(VkDevice device, WinCSSwapchain* swapchain, WinCSSwapchainBuffer& buffer)
+{
+	WinCSSurface*   surface      = swapchain->Surface;
+	IDXGIResource1* dxgiResource = nullptr;
+
+	D3D11_TEXTURE2D_DESC textureDesc {
+		.Width          = buffer.Width,
+		.Height         = buffer.Height,
+		.MipLevels      = 1,
+		.ArraySize      = 1,
+		.Format         = swapchain->Format,
+		.SampleDesc     = {1, 0},
+		.Usage          = D3D11_USAGE_DEFAULT,
+		.BindFlags      = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET,
+		.CPUAccessFlags = 0,
+		.MiscFlags      = D3D11_RESOURCE_MISC_SHARED | D3D11_RESOURCE_MISC_SHARED_NTHANDLE
+	};
+	HRESULT hr = surface->D3D11Device->CreateTexture2D(&textureDesc, nullptr, &buffer.Texture);
+	if (hr < S_OK)
+		return VK_ERROR_INITIALIZATION_FAILED;
+	hr = surface->Manager->AddBufferFromResource(buffer.Texture, &buffer.PresentationBuffer);
+	if (hr < S_OK)
+		return VK_ERROR_INITIALIZATION_FAILED;
+
+	hr = buffer.Texture->QueryInterface(&dxgiResource);
+	if (hr < S_OK)
+		return VK_ERROR_INITIALIZATION_FAILED;
+	hr = dxgiResource->CreateSharedHandle(nullptr, DXGI_SHARED_RESOURCE_READ | DXGI_SHARED_RESOURCE_WRITE, nullptr, &buffer.TextureHandle);
+	dxgiResource->Release();
+	dxgiResource = nullptr;
+	if (hr < S_OK)
+		return VK_ERROR_INITIALIZATION_FAILED;
+
+	VkMemoryWin32HandlePropertiesKHR handleProps {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_WIN32_HANDLE_PROPERTIES_KHR,
+		.pNext = nullptr
+	};
+	VkResult result = swapchain->GetMemoryWin32HandleProperties(device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT, buffer.TextureHandle, &handleProps);
+	if (result < VK_SUCCESS)
+		return result;
+
+	VkExternalMemoryImageCreateInfo emiCreateInfo {
+		.sType       = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+		.pNext       = nullptr,
+		.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT
+	};
+	VkImageCreateInfo iCreateInfo {
+		.sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.pNext                 = &emiCreateInfo,
+		.flags                 = 0,
+		.imageType             = VK_IMAGE_TYPE_2D,
+		.format                = swapchain->ImageFormat,
+		.extent                = {buffer.Width, buffer.Height, 1},
+		.mipLevels             = 1,
+		.arrayLayers           = 1,
+		.samples               = VK_SAMPLE_COUNT_1_BIT,
+		.tiling                = VK_IMAGE_TILING_OPTIMAL,
+		.usage                 = swapchain->ImageUsage,
+		.sharingMode           = swapchain->ImageSharingMode,
+		.queueFamilyIndexCount = swapchain->QueueFamilyIndexCount,
+		.pQueueFamilyIndices   = swapchain->QueueFamilyIndices,
+		.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
+	};
+	result = vkCreateImage(device, &iCreateInfo, swapchain->pAllocator, &buffer.vkImage);
+	if (result < VK_SUCCESS)
+		return result;
+
+	VkMemoryRequirements mReq {};
+	vkGetImageMemoryRequirements(device, buffer.vkImage, &mReq);
+
+	VkImportMemoryWin32HandleInfoKHR imHandleInfo {
+		.sType      = VK_STRUCTURE_TYPE_IMPORT_MEMORY_WIN32_HANDLE_INFO_KHR,
+		.pNext      = nullptr,
+		.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_D3D11_TEXTURE_BIT,
+		.handle     = buffer.TextureHandle,
+		.name       = nullptr
+	};
+	VkMemoryAllocateInfo mAllocInfo {
+		.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.pNext           = &imHandleInfo,
+		.allocationSize  = mReq.size,
+		.memoryTypeIndex = (uint32_t) std::countr_zero(handleProps.memoryTypeBits)
+	};
+	result = vkAllocateMemory(device, &mAllocInfo, swapchain->pAllocator, &buffer.vkImageMemory);
+	if (result < VK_SUCCESS)
+		return result;
+	return vkBindImageMemory(device, buffer.vkImage, buffer.vkImageMemory, 0);
+}
+
+// Also cleans up after a failed WinCSCreateBufferImage, PresentFence and vkTimeline outlive the images
+void WinCSDestroyBufferImage(VkDevice device, WinCSSwapchain* swapchain, WinCSSwapchainBuffer& buffer)
+{
+	if (buffer.vkImage)
+		vkDestroyImage(device, buffer.vkImage, swapchain->pAllocator);
+	if (buffer.vkImageMemory)
+		vkFreeMemory(device, buffer.vkImageMemory, swapchain->pAllocator);
+	if (buffer.TextureHandle)
+		CloseHandle(buffer.TextureHandle);
+	if (buffer.Texture)
+		buffer.Texture->Release();
+	if (buffer.PresentationBuffer)
+		buffer.PresentationBuffer->Release();
+	buffer.vkImage            = nullptr;
+	buffer.vkImageMemory      = nullptr;
+	buffer.TextureHandle      = nullptr;
+	buffer.Texture            = nullptr;
+	buffer.PresentationBuffer = nullptr;
+}
+
+// Only called for a buffer the app thread has acquired, it retired and finished rendering so nothing else uses its images
+VkResult WinCSRecreateBuffer(VkDevice device, WinCSSwapchain* swapchain, uint32_t imageIndex)
+{
+	auto& buffer = swapchain->Buffers[imageIndex];
+
+	// The surface's D3D11 device is single threaded and shared with the present thread, which only waits for one buffer
+	WinCSPresentThread* thread = swapchain->PresentThread;
+	thread->Mtx.Lock();
+	WinCSDestroyBufferImage(device, swapchain, buffer);
+	buffer.Width    = swapchain->Width;
+	buffer.Height   = swapchain->Height;
+	VkResult result = WinCSCreateBufferImage(device, swapchain, buffer);
+	thread->Mtx.Unlock();
+	if (result < VK_SUCCESS)
+		return result;
+
+	swapchain->State.OnBufferRecreated(imageIndex);
+	++g_WinCSPresentStats.RecreateCount;
+	return VK_SUCCESS;
+}
+
+WinCSPresentScheduler::~WinCSPresentScheduler()
+{
+	// Only reached with threads left if swapchains were never destroyed
+	for (auto& thread : Threads)
+		WinCSStopPresentThread(thread.get());
+}
+
+bool WinCSAddToPresentThread(WinCSSwapchain* swapchain)
 {
-	while (swapchain->EventThreadsRunning)
+	auto& scheduler = g_WinCSPresentScheduler;
+	scheduler.Mtx.Lock();
+
+	// Least loaded thread, unless fewer than ThreadCount threads are running
+	WinCSPresentThread* thread = nullptr;
+	if (scheduler.Threads.size() >= scheduler.ThreadCount)
 	{
-		DWORD eventIndex = WaitForMultipleObjects(3 + swapchain->BufferCount, swapchain->Events, FALSE, INFINITE);
-		if (eventIndex < WAIT_OBJECT_0 || eventIndex >= WAIT_OBJECT_0 + 3 + swapchain->BufferCount)
+		for (auto& candidate : scheduler.Threads)
 		{
-			// TODO: Problems happened, let's assume it didn't happen for the time being
-			continue;
+			if (candidate->SwapchainCount < c_WinCSPresentThreadMaxSwapchains &&
+				(!thread || candidate->SwapchainCount < thread->SwapchainCount))
+				thread = candidate.get();
 		}
-		if (eventIndex == WAIT_OBJECT_0) // Lost event
+	}
+	if (!thread)
+	{
+		auto newThread       = std::make_unique<WinCSPresentThread>();
+		newThread->WakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+		if (!newThread->WakeEvent)
 		{
-			// TODO: Presentation Manager was lost, but for the moment let's assume it didn't happen
-			continue;
+			scheduler.Mtx.Unlock();
+			return false;
 		}
-		if (eventIndex == WAIT_OBJECT_0 + 1) // Terminate event
-			break;
-		ResetEvent(swapchain->Events[eventIndex]);
-		if (eventIndex == WAIT_OBJECT_0 + 2) // OnBufferRetire
-		{
-			for (uint32_t i = 0; i < swapchain->BufferCount; ++i)
-			{
-				auto& buffer = swapchain->Buffers[i];
-				if (buffer.State != c_WinCSBufferPresenting)
-					continue;
-				boolean available = FALSE;
-				buffer.PresentationBuffer->IsAvailable(&available);
-				if (available)
-				{
-					buffer.State = c_WinCSBufferRenderable; // Transition to Renderable state
-					++swapchain->UsableBufferCount;         // And increment usable buffer count
-					swapchain->UsableBufferCount.notify_one();
-				}
-			}
+		thread         = newThread.get();
+		thread->Thread = std::thread(&WinCSPresentThreadFunc, thread);
+		scheduler.Threads.emplace_back(std::move(newThread));
+	}
+
+	thread->Mtx.Lock();
+	thread->Swapchains[thread->SwapchainCount++] = swapchain;
+	++thread->Generation;
+	thread->Mtx.Unlock();
+	swapchain->PresentThread = thread;
+	SetEvent(thread->WakeEvent);
+	scheduler.Mtx.Unlock();
+	return true;
+}
+
+void WinCSRemoveFromPresentThread(WinCSSwapchain* swapchain)
+{
+	auto& scheduler = g_WinCSPresentScheduler;
+	scheduler.Mtx.Lock();
+
+	WinCSPresentThread* thread = swapchain->PresentThread;
+	thread->Mtx.Lock();
+	for (uint32_t i = 0; i < thread->SwapchainCount; ++i)
+	{
+		if (thread->Swapchains[i] != swapchain)
 			continue;
+		thread->Swapchains[i] = thread->Swapchains[--thread->SwapchainCount];
+		break;
+	}
+	uint64_t generation = ++thread->Generation;
+	bool     empty      = thread->SwapchainCount == 0;
+	thread->Mtx.Unlock();
+	swapchain->PresentThread = nullptr;
+
+	if (empty)
+	{
+		WinCSStopPresentThread(thread);
+		std::erase_if(scheduler.Threads, [thread](const auto& other) { return other.get() == thread; });
+	}
+	else
+	{
+		// The thread may still be waiting on SignalEvent, which is closed once this returns
+		SetEvent(thread->WakeEvent);
+		uint64_t seenGeneration = thread->SeenGeneration.load();
+		while (seenGeneration < generation)
+		{
+			thread->SeenGeneration.wait(seenGeneration);
+			seenGeneration = thread->SeenGeneration.load();
 		}
+	}
+	scheduler.Mtx.Unlock();
+}
 
-		// OnBufferRendered
-		uint32_t imageIndex = (uint32_t) (eventIndex - WAIT_OBJECT_0 - 3);
-		swapchain->Mtx.Lock();
-		auto& buffer = swapchain->Buffers[imageIndex];
-		if (buffer.State == c_WinCSBufferWaiting)
+void WinCSStopPresentThread(WinCSPresentThread* thread)
+{
+	thread->Mtx.Lock();
+	thread->Running = false;
+	thread->Mtx.Unlock();
+	SetEvent(thread->WakeEvent);
+	thread->Thread.join();
+	CloseHandle(thread->WakeEvent);
+	thread->WakeEvent = nullptr;
+}
+
+// Polls every buffer, a single auto reset SignalEvent covers the retire fence and every present fence
+static void WinCSServiceSwapchain(WinCSSwapchain* swapchain)
+{
+	auto& state = swapchain->State;
+	for (uint32_t i = 0; i < swapchain->BufferCount; ++i)
+	{
+		auto&   buffer      = swapchain->Buffers[i];
+		uint8_t bufferState = state.BufferState(i);
+		if (bufferState == c_SwapchainBufferPresenting)
+		{
+			boolean available = FALSE;
+			buffer.PresentationBuffer->IsAvailable(&available);
+			if (available)
+				state.OnBufferRetired(i);
+		}
+		else if (bufferState == c_SwapchainBufferWaiting ||
+				 bufferState == c_SwapchainBufferDoubleWaiting)
 		{
-			buffer.State = c_WinCSBufferPresentable; // Transition to Presentable state
+			// A DoubleWaiting buffer reports its superseded render too, so the state machine can count the drop
+			uint64_t completedValue = buffer.PresentFence->GetCompletedValue();
+			if (completedValue == buffer.RenderedValue ||
+				(bufferState == c_SwapchainBufferWaiting && completedValue < state.RenderValue(i)))
+				continue;
+			buffer.RenderedValue = completedValue;
+			state.OnBufferRendered(i, completedValue);
 		}
-		else if (buffer.State == c_WinCSBufferDoubleWaiting)
+	}
+}
+
+void WinCSPresentThreadFunc(WinCSPresentThread* thread)
+{
+	HANDLE          handles[1 + c_WinCSPresentThreadMaxSwapchains] { thread->WakeEvent }; // [0]: Wake, [1,...]: SignalEvent of swapchains[i - 1]
+	WinCSSwapchain* swapchains[c_WinCSPresentThreadMaxSwapchains] {};
+	uint32_t        swapchainCount = 0;
+	uint64_t        generation     = ~0ULL;
+	while (true)
+	{
+		DWORD eventIndex = WAIT_OBJECT_0;
+		if (generation == thread->Generation.load())
 		{
-			UINT64 value = buffer.PresentFence->GetCompletedValue();
-			if (value != buffer.PresentFenceValue)
+			eventIndex = DCompositionWaitForCompositorClock(1 + swapchainCount, handles, INFINITE);
+			++g_WinCSPresentStats.ThreadWakeups;
+			if (eventIndex < WAIT_OBJECT_0 || eventIndex > WAIT_OBJECT_0 + 1 + swapchainCount)
 			{
-				swapchain->Mtx.Unlock();
-				continue; // Skip old present
+				// TODO: Problems happened, let's assume it didn't happen for the time being
+				continue;
 			}
+		}
 
-			buffer.State = c_WinCSBufferPresentable; // Transition to Presentable state
+		thread->Mtx.Lock();
+		if (!thread->Running)
+		{
+			thread->Mtx.Unlock();
+			break;
 		}
-		switch (swapchain->PresentMode)
+		if (generation != thread->Generation.load())
 		{
-		case VK_PRESENT_MODE_FIFO_KHR:
-			for (uint32_t i = 0; i < swapchain->BufferCount; ++i)
+			// Swapchains changed, rebuild the wait handles and poll everything as signals may have been missed meanwhile
+			generation     = thread->Generation.load();
+			swapchainCount = thread->SwapchainCount;
+			for (uint32_t i = 0; i < swapchainCount; ++i)
 			{
-				if (swapchain->PresentQueue[i] == ~0U)
-				{
-					swapchain->PresentQueue[i] = imageIndex;
-					break;
-				}
+				swapchains[i]  = thread->Swapchains[i];
+				handles[1 + i] = swapchains[i]->SignalEvent;
+				WinCSServiceSwapchain(swapchains[i]);
 			}
-			break;
-		case VK_PRESENT_MODE_MAILBOX_KHR:
-			if (swapchain->PresentQueue[0] != ~0U)
+			thread->SeenGeneration = generation;
+			thread->SeenGeneration.notify_all();
+		}
+		else if (eventIndex == WAIT_OBJECT_0 + 1 + swapchainCount) // Compositor clock
+		{
+			++g_WinCSPresentStats.ClockWakeups;
+			for (uint32_t i = 0; i < swapchainCount; ++i)
 			{
-				++swapchain->UsableBufferCount; // Increment usable buffer count
-				swapchain->UsableBufferCount.notify_one();
+				if (!swapchains[i]->State.OnVBlank()) // Calls WinCSCompositor::Present if a buffer is ready
+					++g_WinCSPresentStats.IdleVBlanks;
 			}
-			swapchain->PresentQueue[0] = imageIndex;
-			break;
 		}
-		swapchain->Mtx.Unlock();
+		else if (eventIndex > WAIT_OBJECT_0) // SignalEvent
+		{
+			WinCSServiceSwapchain(swapchains[eventIndex - WAIT_OBJECT_0 - 1]);
+		}
+		thread->Mtx.Unlock();
 	}
 }
 
-void WinCSEventThreadFunc2(WinCSSwapchain* swapchain)
+void WinCSCompositor::Present(uint32_t imageIndex)
 {
-	while (swapchain->EventThreadsRunning)
-	{
-		DWORD eventIndex = DCompositionWaitForCompositorClock(2, swapchain->Events, INFINITE);
-		if (eventIndex < WAIT_OBJECT_0 || eventIndex >= WAIT_OBJECT_0 + 3 + swapchain->BufferCount)
-		{
-			// TODO: Problems happened, let's assume it didn't happen for the time being
-			continue;
-		}
-		if (eventIndex == WAIT_OBJECT_0) // Lost event
-		{
-			// TODO: Presentation Manager was lost, but for the moment let's assume it didn't happen
-			continue;
-		}
-		if (eventIndex == WAIT_OBJECT_0 + 1) // Terminate event
-			break;
-
-		swapchain->Mtx.Lock();
-		uint32_t imageIndex = swapchain->PresentQueue[0];
-		for (uint32_t i = 1; i < swapchain->BufferCount; ++i)
-			swapchain->PresentQueue[i - 1] = swapchain->PresentQueue[i];
-		swapchain->PresentQueue[swapchain->BufferCount - 1] = ~0U;
-		swapchain->Mtx.Unlock();
-		if (imageIndex == ~0U)
-			continue; // Skip frame as nothing was presented
-
-		WinCSSurface* surface = swapchain->Surface;
-
-		auto& buffer = swapchain->Buffers[imageIndex];
-		buffer.State = c_WinCSBufferPresenting; // Transition to Presenting
-		RECT rect {
-			.left   = 0,
-			.top    = 0,
-			.right  = (LONG) swapchain->Width,
-			.bottom = (LONG) swapchain->Height
-		};
-		surface->Surface->SetSourceRect(&rect);
-		surface->Surface->SetAlphaMode(swapchain->AlphaMode);
-		surface->Surface->SetColorSpace(swapchain->ColorSpace);
-		surface->Surface->SetBuffer(buffer.PresentationBuffer);
-
-		/*POINT pos {};
-		GetCursorPos(&pos);
-		SetWindowPos(surface->HWnd, nullptr, pos.x + 5, pos.y + 5, 0, 0, SWP_NOSIZE | SWP_NOREDRAW | SWP_NOACTIVATE | SWP_NOOWNERZORDER | SWP_NOZORDER | SWP_NOSENDCHANGING);*/
-
-		/*RECT rect2 {};
-		GetWindowRect(surface->HWnd, &rect2);
-
-		PresentationTransform transform {
-			.M11 = 1.0f,
-			.M12 = 0.0f,
-			.M21 = 0.0f,
-			.M22 = 1.0f,
-			.M31 = 500.0f - rect2.left,
-			.M32 = 500.0f - rect2.top
-		};
-		surface->Surface->SetTransform(&transform);*/
-		// surface->Surface->SetLetterboxingMargins(100.0f, 50.0f, 75.0f, 100.0f);
-
-		SystemInterruptTime time { 0 };
-		surface->Manager->SetTargetTime(time);
-		UINT64 id = surface->Manager->GetNextPresentId();
-		surface->Manager->Present();
-		swapchain->RetireFence->SetEventOnCompletion(id, swapchain->Events[2]);
-	}
+	WinCSSurface* surface = Swapchain->Surface;
+
+	auto& buffer = Swapchain->Buffers[imageIndex];
+	RECT rect {
+		.left   = 0,
+		.top    = 0,
+		.right  = (LONG) buffer.Width, // Stale buffers still carry their old size
+		.bottom = (LONG) buffer.Height
+	};
+	surface->Surface->SetSourceRect(&rect);
+	surface->Surface->SetAlphaMode(Swapchain->AlphaMode);
+	surface->Surface->SetColorSpace(Swapchain->ColorSpace);
+	surface->Surface->SetBuffer(buffer.PresentationBuffer);
+
+	/*POINT pos {};
+	GetCursorPos(&pos);
+	SetWindowPos(surface->HWnd, nullptr, pos.x + 5, pos.y + 5, 0, 0, SWP_NOSIZE | SWP_NOREDRAW | SWP_NOACTIVATE | SWP_NOOWNERZORDER | SWP_NOZORDER | SWP_NOSENDCHANGING);*/
+
+	/*RECT rect2 {};
+	GetWindowRect(surface->HWnd, &rect2);
+
+	PresentationTransform transform {
+		.M11 = 1.0f,
+		.M12 = 0.0f,
+		.M21 = 0.0f,
+		.M22 = 1.0f,
+		.M31 = 500.0f - rect2.left,
+		.M32 = 500.0f - rect2.top
+	};
+	surface->Surface->SetTransform(&transform);*/
+	// surface->Surface->SetLetterboxingMargins(100.0f, 50.0f, 75.0f, 100.0f);
+
+	SystemInterruptTime time { 0 };
+	surface->Manager->SetTargetTime(time);
+	UINT64 id = surface->Manager->GetNextPresentId();
+	surface->Manager->Present();
+	Swapchain->RetireFence->SetEventOnCompletion(id, Swapchain->SignalEvent);
 }
\ No newline at end of file
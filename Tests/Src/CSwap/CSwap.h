@@ -30,12 +30,41 @@ struct VkWinCSSwapchainQueueInfoEXT
 	VkQueue         queue;
 };
 
+// Process wide counters for the present path
+struct VkWinCSPresentStatsEXT
+{
+	uint64_t presentCount;        // Calls to wincs_surface_vkQueuePresentKHR
+	uint64_t waitSpillCount;      // Presents whose wait semaphores did not fit the inline array
+	uint64_t heapAllocationCount; // Heap allocations made while presenting, zero once the scratch arena has warmed up
+	uint64_t threadWakeups;       // Times a present thread woke up, divide by presentCount for wakeups per frame
+	uint64_t clockWakeups;        // Wakeups caused by the compositor clock
+	uint64_t idleVBlanks;         // Compositor clock ticks a swapchain had nothing new to show for
+	uint64_t resizeCount;         // Calls to vkResizeWinCSSwapchainEXT that changed the size
+	uint64_t recreateCount;       // Buffers recreated at a new size
+};
+
 VkResult vkCreateWinCSSurfaceEXT(
 	VkInstance                         instance,
 	const VkWinCSSurfaceCreateInfoEXT* pCreateInfo,
 	const VkAllocationCallbacks*       pAllocator,
 	VkSurfaceKHR*                      pSurface);
 
+void vkGetWinCSPresentStatsEXT(
+	VkWinCSPresentStatsEXT* pStats);
+
+// Number of present threads shared by all swapchains, only affects swapchains created afterwards.
+// Each thread services at most 62 swapchains, more threads are started when all of them are full
+void vkSetWinCSPresentThreadCountEXT(
+	uint32_t threadCount);
+
+// Resizes a swapchain without recreating it. Buffers are recreated one at a time as they are acquired, the stale ones keep
+// presenting at their old size meanwhile. vkAcquireNextImageKHR returns VK_SUBOPTIMAL_KHR when the acquired image was
+// recreated, vkGetSwapchainImagesKHR then returns the new image at that index
+VkResult vkResizeWinCSSwapchainEXT(
+	VkDevice       device,
+	VkSwapchainKHR swapchain,
+	VkExtent2D     extent);
+
 // VK_EXT_wincs_surface Overrides VK_KHR_surface
 
 void wincs_surface_vkDestroySurfaceKHR(
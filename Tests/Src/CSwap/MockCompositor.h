@@ -0,0 +1,41 @@
+#pragma once
+
+#include "SwapchainStateMachine.h"
+
+#include <cstdint>
+
+// Clock that only moves when told to, so simulations replay exactly
+struct MockSwapchainClock : public SwapchainClock
+{
+public:
+	uint64_t Now() override { return Time; }
+
+	void Advance(uint64_t ns) { Time += ns; }
+	void AdvanceTo(uint64_t time)
+	{
+		if (time > Time)
+			Time = time;
+	}
+
+public:
+	uint64_t Time = 0;
+};
+
+// Flip model compositor, the previously scanned out buffer retires as soon as a new one is latched
+struct MockCompositor : public SwapchainCompositor
+{
+public:
+	void Present(uint32_t imageIndex) override
+	{
+		uint32_t previous = Front;
+		Front             = imageIndex;
+		++Flips;
+		if (previous != ~0U && State)
+			State->OnBufferRetired(previous);
+	}
+
+public:
+	SwapchainStateMachine* State = nullptr;
+	uint32_t               Front = ~0U;
+	uint64_t               Flips = 0;
+};
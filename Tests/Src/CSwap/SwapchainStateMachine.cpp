@@ -0,0 +1,271 @@
+#include "SwapchainStateMachine.h"
+
+#include <chrono>
+
+uint64_t SteadySwapchainClock::Now()
+{
+	return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SwapchainStateMachine::SwapchainStateMachine()
+	: m_BufferCount(0),
+	  m_BufferIndex(0),
+	  m_Generation(0),
+	  m_PresentMode(SwapchainPresentMode::Fifo),
+	  m_Compositor(nullptr),
+	  m_Clock(nullptr),
+	  m_UsableBufferCount(0)
+{
+}
+
+bool SwapchainStateMachine::Init(const SwapchainStateMachineSpec* spec)
+{
+	if (!spec || !spec->Compositor || spec->BufferCount < 2 || spec->BufferCount > c_SwapchainMaxBufferCount)
+		return false;
+
+	m_BufferCount       = spec->BufferCount;
+	m_BufferIndex       = 0;
+	m_Generation        = 0;
+	m_PresentMode       = spec->PresentMode;
+	m_Compositor        = spec->Compositor;
+	m_Clock             = spec->Clock;
+	m_UsableBufferCount = m_BufferCount;
+	for (uint32_t i = 0; i < c_SwapchainMaxBufferCount; ++i)
+	{
+		auto& buffer       = m_Buffers[i];
+		buffer.State       = c_SwapchainBufferRenderable;
+		buffer.RenderValue = 0;
+		buffer.PresentTime = 0;
+		buffer.Generation  = 0;
+	}
+	return true;
+}
+
+bool SwapchainStateMachine::Acquire(uint32_t* imageIndex, uint64_t* waitValue)
+{
+	++m_Counters.Acquires;
+	*waitValue = 0;
+
+	// Transitions are compare exchanges as the event and clock threads can move the same buffer concurrently
+	uint32_t startIndex = m_BufferIndex;
+	do
+	{
+		uint32_t currentIndex = m_BufferIndex;
+		m_BufferIndex         = (currentIndex + 1) % m_BufferCount;
+
+		auto&   buffer = m_Buffers[currentIndex];
+		uint8_t state  = buffer.State.load();
+		switch (state)
+		{
+		case c_SwapchainBufferRenderable:
+			if (!buffer.State.compare_exchange_strong(state, c_SwapchainBufferRendering))
+				continue;
+			break;
+		case c_SwapchainBufferPresentable:
+			if (m_PresentMode != SwapchainPresentMode::Mailbox ||
+				m_PresentMailbox.peek() == currentIndex ||
+				!buffer.State.compare_exchange_strong(state, c_SwapchainBufferRendering))
+				continue;
+			break;
+		case c_SwapchainBufferWaiting:
+			// A stale buffer may only be handed out once its render is done, as the caller recreates it right away
+			if (m_PresentMode != SwapchainPresentMode::Mailbox ||
+				buffer.Generation != m_Generation ||
+				!buffer.State.compare_exchange_strong(state, c_SwapchainBufferDoubleRendering))
+				continue;
+			*waitValue = buffer.RenderValue.load();
+			break;
+		default:
+			continue;
+		}
+
+		--m_UsableBufferCount;
+		*imageIndex = currentIndex;
+		return true;
+	}
+	while (m_BufferIndex != startIndex);
+
+	++m_Counters.AcquireStarved;
+	return false;
+}
+
+bool SwapchainStateMachine::Present(uint32_t imageIndex, bool waitForRender, uint64_t* renderValue)
+{
+	if (imageIndex >= m_BufferCount)
+		return false;
+
+	auto&   buffer = m_Buffers[imageIndex];
+	uint8_t state  = buffer.State.load();
+	if (state != c_SwapchainBufferRendering &&
+		state != c_SwapchainBufferDoubleRendering)
+		return false;
+
+	++m_Counters.Presents;
+	buffer.PresentTime = m_Clock ? m_Clock->Now() : 0;
+	if (!waitForRender)
+	{
+		*renderValue = buffer.RenderValue.load();
+		buffer.State = c_SwapchainBufferPresentable;
+		QueuePresentable(imageIndex);
+		return true;
+	}
+
+	*renderValue = ++buffer.RenderValue;
+	if (state == c_SwapchainBufferDoubleRendering)
+	{
+		buffer.State = c_SwapchainBufferDoubleWaiting;
+	}
+	else
+	{
+		buffer.State = c_SwapchainBufferWaiting;
+		if (m_PresentMode == SwapchainPresentMode::Mailbox)
+			MakeUsable(); // Waiting buffers can be re-acquired in mailbox mode
+	}
+	return true;
+}
+
+bool SwapchainStateMachine::Release(uint32_t imageIndex)
+{
+	if (imageIndex >= m_BufferCount)
+		return false;
+
+	uint8_t state = c_SwapchainBufferRendering;
+	if (!m_Buffers[imageIndex].State.compare_exchange_strong(state, c_SwapchainBufferRenderable))
+		return false;
+	MakeUsable();
+	return true;
+}
+
+void SwapchainStateMachine::Invalidate()
+{
+	++m_Generation;
+	++m_Counters.Invalidations;
+}
+
+void SwapchainStateMachine::OnBufferRecreated(uint32_t imageIndex)
+{
+	if (imageIndex >= m_BufferCount || m_Buffers[imageIndex].Generation == m_Generation)
+		return;
+
+	m_Buffers[imageIndex].Generation = m_Generation;
+	++m_Counters.Recreations;
+}
+
+void SwapchainStateMachine::OnBufferRendered(uint32_t imageIndex, uint64_t completedValue)
+{
+	if (imageIndex >= m_BufferCount)
+		return;
+
+	auto&   buffer = m_Buffers[imageIndex];
+	uint8_t state  = buffer.State.load();
+	if (state == c_SwapchainBufferDoubleWaiting)
+	{
+		if (completedValue != buffer.RenderValue.load())
+		{
+			++m_Counters.MailboxDrops; // Skip old present, it was superseded before it finished rendering
+			return;
+		}
+	}
+	else if (state != c_SwapchainBufferWaiting)
+	{
+		return; // Re-acquired before the old present finished rendering
+	}
+	if (!buffer.State.compare_exchange_strong(state, c_SwapchainBufferPresentable))
+		return;
+	if (state == c_SwapchainBufferWaiting && m_PresentMode == SwapchainPresentMode::Mailbox)
+		--m_UsableBufferCount; // Heading for the mailbox, no longer acquirable
+	QueuePresentable(imageIndex);
+}
+
+void SwapchainStateMachine::OnBufferRetired(uint32_t imageIndex)
+{
+	if (imageIndex >= m_BufferCount)
+		return;
+
+	uint8_t state = c_SwapchainBufferPresenting;
+	if (m_Buffers[imageIndex].State.compare_exchange_strong(state, c_SwapchainBufferRenderable))
+		MakeUsable();
+}
+
+bool SwapchainStateMachine::OnVBlank()
+{
+	++m_Counters.VBlanks;
+
+	uint32_t imageIndex = ~0U;
+	if (m_PresentMode == SwapchainPresentMode::Mailbox)
+		imageIndex = m_PresentMailbox.take();
+	else if (!m_PresentQueue.try_pop(imageIndex))
+		imageIndex = ~0U;
+	if (imageIndex == ~0U)
+	{
+		++m_Counters.IdleVBlanks;
+		return false;
+	}
+
+	uint8_t state = c_SwapchainBufferPresentable;
+	if (!m_Buffers[imageIndex].State.compare_exchange_strong(state, c_SwapchainBufferPresenting))
+	{
+		// Acquire took it back between take() and here, it counted the buffer as usable when it was not
+		++m_UsableBufferCount;
+		++m_Counters.IdleVBlanks;
+		return false;
+	}
+
+	RecordScanOut(imageIndex);
+	m_Compositor->Present(imageIndex);
+	return true;
+}
+
+SwapchainStateMachineStats SwapchainStateMachine::Stats() const
+{
+	return SwapchainStateMachineStats {
+		.Acquires       = m_Counters.Acquires,
+		.AcquireStarved = m_Counters.AcquireStarved,
+		.Presents       = m_Counters.Presents,
+		.MailboxDrops   = m_Counters.MailboxDrops,
+		.VBlanks        = m_Counters.VBlanks,
+		.IdleVBlanks    = m_Counters.IdleVBlanks,
+		.ScanOuts       = m_Counters.ScanOuts,
+		.TotalLatency   = m_Counters.TotalLatency,
+		.MaxLatency     = m_Counters.MaxLatency,
+		.Invalidations  = m_Counters.Invalidations,
+		.Recreations    = m_Counters.Recreations
+	};
+}
+
+void SwapchainStateMachine::QueuePresentable(uint32_t imageIndex)
+{
+	switch (m_PresentMode)
+	{
+	case SwapchainPresentMode::Fifo:
+		// Every buffer is queued at most once, so the ring can never be full
+		m_PresentQueue.try_push(imageIndex);
+		break;
+	case SwapchainPresentMode::Mailbox:
+		if (m_PresentMailbox.exchange(imageIndex) != ~0U)
+		{
+			++m_Counters.MailboxDrops;
+			MakeUsable(); // Replaced buffer goes back to being acquirable
+		}
+		break;
+	}
+}
+
+void SwapchainStateMachine::MakeUsable()
+{
+	++m_UsableBufferCount;
+	m_UsableBufferCount.notify_one();
+}
+
+void SwapchainStateMachine::RecordScanOut(uint32_t imageIndex)
+{
+	++m_Counters.ScanOuts;
+	if (!m_Clock)
+		return;
+
+	uint64_t latency = m_Clock->Now() - m_Buffers[imageIndex].PresentTime.load();
+	m_Counters.TotalLatency += latency;
+	uint64_t maxLatency      = m_Counters.MaxLatency.load();
+	while (latency > maxLatency && !m_Counters.MaxLatency.compare_exchange_weak(maxLatency, latency))
+		;
+}
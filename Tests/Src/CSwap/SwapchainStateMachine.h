@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Utils/Ring.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+
+//
+// Platform independent buffer state machine behind the composition swapchain.
+// The platform layer owns images, fences and events and forwards them here:
+//	App thread:   Acquire, Present
+//	Event thread: OnBufferRendered, OnBufferRetired
+//	Clock thread: OnVBlank, which hands the chosen buffer to the SwapchainCompositor
+//
+// FIFO Transitions:
+//	Acquire:
+//		Renderable:      Transition to Rendering
+//		Otherwise:       Not acquired
+//	Present:
+//		Rendering:       If waiting for render transition to Waiting, otherwise transition to Presentable
+//		Otherwise:       Not presentable
+//	OnBufferRetired:     Transition to Renderable if buffer is Presenting
+//	OnBufferRendered:    Transition to Presentable if buffer is Waiting
+//	OnVBlank:            Transition oldest Presentable to Presenting
+//
+// Mailbox Transitions:
+//	Acquire:
+//		Renderable:      Transition to Rendering
+//		Waiting:         Transition to DoubleRendering, caller waits for the previous render before signaling
+//		Presentable:     Transition to Rendering, unless it is the buffer waiting in the mailbox
+//		Otherwise:       Not acquired
+//	Present:
+//		Rendering:       If waiting for render transition to Waiting, otherwise transition to Presentable
+//		DoubleRendering: If waiting for render transition to DoubleWaiting, otherwise transition to Presentable
+//		Otherwise:       Not presentable
+//	OnBufferRetired:     Transition to Renderable if buffer is Presenting
+//	OnBufferRendered:    Transition to Presentable if buffer is Waiting, if buffer is DoubleWaiting, skip transition unless the value is the latest render value
+//	OnVBlank:            Transition newest Presentable to Presenting, older ones were dropped back to being acquirable
+//
+// Staggered resize:
+//	Invalidate:          Every buffer becomes stale, stale buffers keep presenting at their old size
+//	Acquire:             Skips stale Waiting buffers, so a stale buffer is only handed out once nothing renders to or scans it out
+//	OnBufferRecreated:   The caller recreated the stale buffer it acquired, which is then current again
+//	Release:             Rendering to Renderable, for an acquired buffer the caller could not use
+//
+
+static constexpr uint32_t c_SwapchainMaxBufferCount = 8;
+
+static constexpr uint8_t c_SwapchainBufferRenderable      = 0;
+static constexpr uint8_t c_SwapchainBufferRendering       = 1;
+static constexpr uint8_t c_SwapchainBufferDoubleRendering = 2;
+static constexpr uint8_t c_SwapchainBufferWaiting         = 3;
+static constexpr uint8_t c_SwapchainBufferDoubleWaiting   = 4;
+static constexpr uint8_t c_SwapchainBufferPresentable     = 5;
+static constexpr uint8_t c_SwapchainBufferPresenting      = 6;
+
+enum class SwapchainPresentMode : uint8_t
+{
+	Fifo,
+	Mailbox
+};
+
+// Receives the buffer to scan out on a VBlank. The buffer must later be reported back through SwapchainStateMachine::OnBufferRetired
+struct SwapchainCompositor
+{
+	virtual ~SwapchainCompositor() = default;
+
+	virtual void Present(uint32_t imageIndex) = 0;
+};
+
+// Monotonic time in nanoseconds, only used for latency stats
+struct SwapchainClock
+{
+	virtual ~SwapchainClock() = default;
+
+	virtual uint64_t Now() = 0;
+};
+
+struct SteadySwapchainClock : public SwapchainClock
+{
+	uint64_t Now() override;
+};
+
+struct SwapchainStateMachineSpec
+{
+	uint32_t             BufferCount = 2;
+	SwapchainPresentMode PresentMode = SwapchainPresentMode::Fifo;
+	SwapchainCompositor* Compositor  = nullptr;
+	SwapchainClock*      Clock       = nullptr; // Optional, latency stats stay zero without one
+};
+
+struct SwapchainStateMachineStats
+{
+	uint64_t Acquires       = 0;
+	uint64_t AcquireStarved = 0; // Acquire calls that found no usable buffer
+	uint64_t Presents       = 0;
+	uint64_t MailboxDrops   = 0; // Presents superseded by a newer one before reaching a VBlank
+	uint64_t VBlanks        = 0;
+	uint64_t IdleVBlanks    = 0; // VBlanks with nothing new to scan out
+	uint64_t ScanOuts       = 0;
+	uint64_t TotalLatency   = 0; // Sum of Present to scan out time in ns
+	uint64_t MaxLatency     = 0;
+	uint64_t Invalidations  = 0;
+	uint64_t Recreations    = 0; // Stale buffers recreated after an Invalidate
+};
+
+struct SwapchainStateMachine
+{
+public:
+	SwapchainStateMachine();
+	SwapchainStateMachine(const SwapchainStateMachine&) = delete;
+
+	SwapchainStateMachine& operator=(const SwapchainStateMachine&) = delete;
+
+	bool Init(const SwapchainStateMachineSpec* spec);
+
+	// App thread, returns false when no buffer is usable.
+	// A non zero *waitValue means the buffer is still being rendered by its previous present, the caller must wait for that render value before signaling
+	bool Acquire(uint32_t* imageIndex, uint64_t* waitValue);
+	// App thread, returns false if the buffer was not acquired.
+	// With waitForRender the buffer only becomes presentable once OnBufferRendered reports *renderValue
+	bool Present(uint32_t imageIndex, bool waitForRender, uint64_t* renderValue);
+
+	// App thread, returns false unless the buffer is Rendering, a DoubleRendering buffer has to be presented
+	bool Release(uint32_t imageIndex);
+
+	// App thread, marks every buffer stale. Any stale buffer Acquire hands out can be recreated on the spot
+	void Invalidate();
+	void OnBufferRecreated(uint32_t imageIndex);
+	bool IsStale(uint32_t imageIndex) const { return m_Buffers[imageIndex].Generation != m_Generation; }
+
+	// Event thread
+	void OnBufferRendered(uint32_t imageIndex, uint64_t completedValue);
+	void OnBufferRetired(uint32_t imageIndex);
+
+	// Clock thread, returns true if a buffer was handed to the compositor
+	bool OnVBlank();
+
+	uint8_t  BufferState(uint32_t imageIndex) const { return m_Buffers[imageIndex].State.load(); }
+	uint64_t RenderValue(uint32_t imageIndex) const { return m_Buffers[imageIndex].RenderValue.load(); }
+	uint32_t BufferCount() const { return m_BufferCount; }
+
+	SwapchainPresentMode       PresentMode() const { return m_PresentMode; }
+	SwapchainStateMachineStats Stats() const;
+
+	// Number of buffers Acquire can currently take, waiters can block on it becoming non zero
+	std::atomic_uint32_t& UsableBufferCount() { return m_UsableBufferCount; }
+
+private:
+	void QueuePresentable(uint32_t imageIndex);
+	void MakeUsable();
+	void RecordScanOut(uint32_t imageIndex);
+
+private:
+	struct Buffer
+	{
+		std::atomic_uint8_t  State       = c_SwapchainBufferRenderable;
+		std::atomic_uint64_t RenderValue = 0;
+		std::atomic_uint64_t PresentTime = 0;
+		uint64_t             Generation  = 0; // m_Generation the buffer was last created at, app thread only
+	};
+
+	struct Counters
+	{
+		std::atomic_uint64_t Acquires       = 0;
+		std::atomic_uint64_t AcquireStarved = 0;
+		std::atomic_uint64_t Presents       = 0;
+		std::atomic_uint64_t MailboxDrops   = 0;
+		std::atomic_uint64_t VBlanks        = 0;
+		std::atomic_uint64_t IdleVBlanks    = 0;
+		std::atomic_uint64_t ScanOuts       = 0;
+		std::atomic_uint64_t TotalLatency   = 0;
+		std::atomic_uint64_t MaxLatency     = 0;
+		std::atomic_uint64_t Invalidations  = 0;
+		std::atomic_uint64_t Recreations    = 0;
+	};
+
+private:
+	uint32_t             m_BufferCount;
+	uint32_t             m_BufferIndex; // Next buffer Acquire looks at, app thread only
+	uint64_t             m_Generation;  // Bumped by Invalidate, app thread only
+	SwapchainPresentMode m_PresentMode;
+	SwapchainCompositor* m_Compositor;
+	SwapchainClock*      m_Clock;
+
+	std::atomic_uint32_t m_UsableBufferCount;
+	Buffer               m_Buffers[c_SwapchainMaxBufferCount];
+
+	MPSCRing<uint32_t, c_SwapchainMaxBufferCount> m_PresentQueue;   // FIFO: Presentable buffers in present order
+	AtomicMailbox<uint32_t, ~0U>                  m_PresentMailbox; // MAILBOX: Newest Presentable buffer
+
+	Counters m_Counters;
+};
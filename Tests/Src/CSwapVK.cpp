@@ -1,5 +1,6 @@
 #include "CSwap/CSwap.h"
 #include "Shared.h"
+#include "Utils/FrameTimings.h"
 #include "Utils/TupleVector.h"
 
 #include <format>
@@ -18,6 +19,10 @@ static constexpr const char* c_DeviceExtensions[] {
 	nullptr
 };
 
+// Window size in eighths of its starting size, stepped through by --resize-storm
+static constexpr uint32_t c_ResizeStormScales[] { 8, 7, 6, 5, 4, 5, 6, 7 };
+static constexpr uint32_t c_ResizeStormScaleCount = sizeof(c_ResizeStormScales) / sizeof(*c_ResizeStormScales);
+
 struct SwapchainState
 {
 	Wnd::Handle*                      Window    = nullptr;
@@ -30,20 +35,29 @@ struct SwapchainState
 
 bool InitSwapchainState(SwapchainState* swapchain, Wnd::Handle* window, bool withFrames = false);
 void DeInitSwapchainState(SwapchainState* swapchain);
+bool ResizeSwapchainState(SwapchainState* swapchain);
+bool RecreateSwapchainImage(SwapchainState* swapchain, Vk::SwapchainFrameState* frame);
 
 int CSwapVK(size_t argc, const std::string_view* argv)
 {
 	int64_t numFramesInFlight = 1;
 	int64_t numSwapchains     = 1;
+	int64_t numPresentThreads = 1;
+	int64_t resizeInterval    = 0;
+
+	std::string timingsPath;
 	for (size_t i = 1; i < argc; ++i)
 	{
 		if (argv[i] == "-h" || argv[i] == "--help")
 		{
 			std::cout << "STMS Help\n"
 						 "Options:\n"
-						 "  '-h' | '--help':       Shows this help info\n"
-						 "  '-f' | '--frames':     Set number of frames in flight, default 1, minimum 1\n"
-						 "  '-s' | '--swapchains': Set number of swapchains to create, default 4, minimum 1\n";
+						 "  '-h' | '--help':            Shows this help info\n"
+						 "  '-f' | '--frames':          Set number of frames in flight, default 1, minimum 1\n"
+						 "  '-s' | '--swapchains':      Set number of swapchains to create, default 4, minimum 1\n"
+						 "  '-t' | '--present-threads': Set number of present threads shared by the swapchains, default 1, minimum 1\n"
+						 "  '-r' | '--resize-storm':    Resize the windows every this many ms, default 0 (off)\n"
+						 "  '--timings' <path>:         Write per frame timings to '<path>.csv' and the percentiles to '<path>.json' at exit\n";
 			return 0;
 		}
 		else if (argv[i] == "-f" || argv[i] == "--frames")
@@ -68,7 +82,36 @@ int CSwapVK(size_t argc, const std::string_view* argv)
 				return 1;
 			}
 		}
+		else if (argv[i] == "-t" || argv[i] == "--present-threads")
+		{
+			if (++i >= argc)
+				break;
+			numPresentThreads = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numPresentThreads < 1)
+			{
+				std::cout << "Number of present threads needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-r" || argv[i] == "--resize-storm")
+		{
+			if (++i >= argc)
+				break;
+			resizeInterval = std::strtoll(argv[i].data(), nullptr, 10);
+			if (resizeInterval < 0)
+			{
+				std::cout << "Resize interval needs to be 0 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--timings")
+		{
+			if (++i >= argc)
+				break;
+			timingsPath = argv[i];
+		}
 	}
+	vkSetWinCSPresentThreadCountEXT((uint32_t) numPresentThreads);
 
 	{
 		Wnd::ContextSpec spec {};
@@ -110,6 +153,12 @@ int CSwapVK(size_t argc, const std::string_view* argv)
 	}
 
 	TupleVector<VkSemaphore, uint64_t> timelines((size_t) numSwapchains);
+	TupleVector<uint32_t, uint32_t>    windowSizes((size_t) numSwapchains);
+	for (int64_t i = 0; i < numSwapchains; ++i)
+	{
+		auto [width, height] = windowSizes[i];
+		Wnd::GetWindowSize(swapchains[i].Window, width, height);
+	}
 
 	VkSemaphoreWaitInfo waitInfo {
 		.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
@@ -230,24 +279,46 @@ int CSwapVK(size_t argc, const std::string_view* argv)
 		.pSignalSemaphoreInfos    = signals
 	};
 
-	using Clock = std::chrono::high_resolution_clock;
-	Clock::time_point start, end;
+	FrameTimings timings;
+	{
+		FrameTimingsSpec spec {};
+		spec.Name           = "CSwapVK";
+		spec.SwapchainCount = (uint32_t) numSwapchains;
+		spec.Path           = timingsPath;
+		timings.Init(&spec);
+	}
 
-	double avgDeltaTime    = 0.0;
-	double avgPresentTime  = 0.0;
-	double avgWaitTime     = 0.0;
-	auto   previousTime    = Clock::now();
-	auto   updateTitleTime = previousTime;
-	auto   startTime       = previousTime;
+	uint64_t frameIndex      = 0;
+	double   avgWakeups      = 0.0;
+	uint64_t previousTime    = FrameTimings::Now();
+	uint64_t updateTitleTime = previousTime;
+	uint64_t resizeTime      = previousTime;
+	uint32_t resizeStep      = 0;
 	while (!Wnd::QuitSignaled())
 	{
-		auto   currentTime = Clock::now();
-		double deltaTime   = std::chrono::duration_cast<std::chrono::duration<double>>(currentTime - previousTime).count();
-		previousTime       = currentTime;
-		avgDeltaTime       = avgDeltaTime * 0.99 + deltaTime * 0.01;
-		bool updateTitle   = currentTime - updateTitleTime > std::chrono::duration<double>(1.0);
+		uint64_t currentTime = FrameTimings::Now();
+		uint64_t deltaTime   = currentTime - previousTime;
+		previousTime         = currentTime;
+		bool updateTitle     = currentTime - updateTitleTime > 1'000'000'000;
+		VkWinCSPresentStatsEXT presentStats {};
 		if (updateTitle)
+		{
 			updateTitleTime = currentTime;
+			vkGetWinCSPresentStatsEXT(&presentStats);
+			avgWakeups = presentStats.presentCount ? presentStats.threadWakeups / (double) presentStats.presentCount : 0.0;
+		}
+
+		if (resizeInterval && currentTime - resizeTime >= (uint64_t) resizeInterval * 1'000'000)
+		{
+			resizeTime     = currentTime;
+			resizeStep     = (resizeStep + 1) % c_ResizeStormScaleCount;
+			uint32_t scale = c_ResizeStormScales[resizeStep];
+			for (int64_t i = 0; i < numSwapchains; ++i)
+			{
+				auto [width, height] = windowSizes[i];
+				Wnd::SetWindowSize(swapchains[i].Window, width * scale / 8, height * scale / 8);
+			}
+		}
 
 		Wnd::PollEvents();
 		if (Wnd::QuitSignaled())
@@ -264,35 +335,48 @@ int CSwapVK(size_t argc, const std::string_view* argv)
 			value                   = swapchains[i].Frames[curFrame].TimelineValue;
 		}
 
-		double waitTime = 0.0, presentTime = 0.0;
-		start = Clock::now();
+		uint64_t waitStart = FrameTimings::Now();
 		VK_EXPECT(vkWaitSemaphores, Vk::g_Context->Device, &waitInfo, ~0ULL);
-		end       = Clock::now();
-		waitTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+		uint64_t waitTime = FrameTimings::Now() - waitStart;
 
 		for (int64_t i = 0; i < numSwapchains; ++i)
 		{
 			auto& swapchain = swapchains[i];
 			auto& frame     = swapchain.Frames[Vk::g_Context->CurrentFrame];
-			for (auto& destroy : frame.Destroys)
-				destroy();
-			frame.Destroys.clear();
+			Vk::ReclaimDestroys(&frame);
 
-			VK_INVALID(wincs_surface_vkAcquireNextImageKHR, Vk::g_Context->Device, swapchain.Swapchain, ~0ULL, frame.ImageReady, nullptr, &frame.ImageIndex)
-			{
+			FrameTimingSample sample {};
+			sample.Frame     = frameIndex;
+			sample.Swapchain = (uint32_t) i;
+			sample.Set(FrameTimingStage::Wait, waitTime);
+			if (frameIndex)
+				sample.Set(FrameTimingStage::Frame, deltaTime);
+
+			uint64_t stageStart = FrameTimings::Now();
+			if (!ResizeSwapchainState(&swapchain))
 				continue;
-			}
+			VkResult acquireResult = wincs_surface_vkAcquireNextImageKHR(Vk::g_Context->Device, swapchain.Swapchain, ~0ULL, frame.ImageReady, nullptr, &frame.ImageIndex);
+			if (!Helpers::VkValidate(acquireResult, "wincs_surface_vkAcquireNextImageKHR") ||
+				acquireResult == VK_NOT_READY) // Only stale buffers that are still rendering were left
+				continue;
+			if (acquireResult == VK_SUBOPTIMAL_KHR &&
+				!RecreateSwapchainImage(&swapchain, &frame))
+				continue;
+			uint64_t stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Acquire, stageEnd - stageStart);
 
 			if (updateTitle)
 			{
-				Wnd::SetWindowTitle(swapchain.Window, std::format("DXGISwapVK Window {}, FrameTime {:.4} us, FPS {:.5}, PresentTime {:.4} us, WaitTime {:.4} us", i, avgDeltaTime * 1e6, 1.0 / avgDeltaTime, avgPresentTime * 1e6, avgWaitTime * 1e6));
+				Wnd::SetWindowTitle(swapchain.Window, std::format("CSwapVK Window {}, {}, PresentAllocs {}, Wakeups/Frame {:.3}, IdleVBlanks {}", i, timings.Summary((uint32_t) i), presentStats.heapAllocationCount, avgWakeups, presentStats.idleVBlanks));
 			}
+			stageStart = FrameTimings::Now();
 
-			VK_INVALID(vkResetCommandPool, Vk::g_Context->Device, frame.Pool, 0)
-			{
+			if (!Vk::ResetCommandBuffers(&frame))
 				continue;
-			}
-			VK_INVALID(vkBeginCommandBuffer, frame.CmdBuf, &beginInfo)
+			VkCommandBuffer cmdBuf = Vk::AcquireCommandBuffer(&frame);
+			if (!cmdBuf)
+				continue;
+			VK_INVALID(vkBeginCommandBuffer, cmdBuf, &beginInfo)
 			{
 				continue;
 			}
@@ -301,7 +385,7 @@ int CSwapVK(size_t argc, const std::string_view* argv)
 			preImageBarrier.image        = swapchain.Images.entry<0>(frame.ImageIndex);
 			colAttach.imageView          = swapchain.Images.entry<1>(frame.ImageIndex);
 			depInfo.pImageMemoryBarriers = &preImageBarrier;
-			vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+			vkCmdPipelineBarrier2(cmdBuf, &depInfo);
 
 			/*colAttach.clearValue.color.float32[0]  = 0.5f + 0.5f * sinf(0.17f + std::chrono::duration_cast<std::chrono::duration<float>>(currentTime - startTime).count() * 3.1415f);
 			colAttach.clearValue.color.float32[1]  = 0.5f + 0.5f * sinf(std::chrono::duration_cast<std::chrono::duration<float>>(currentTime - startTime).count() * 3.10f);
@@ -311,18 +395,21 @@ int CSwapVK(size_t argc, const std::string_view* argv)
 			colAttach.clearValue.color.float32[1] *= colAttach.clearValue.color.float32[3];
 			colAttach.clearValue.color.float32[2] *= colAttach.clearValue.color.float32[3];*/
 			renderingInfo.renderArea.extent = swapchain.Extents;
-			vkCmdBeginRendering(frame.CmdBuf, &renderingInfo);
-			vkCmdEndRendering(frame.CmdBuf);
+			vkCmdBeginRendering(cmdBuf, &renderingInfo);
+			vkCmdEndRendering(cmdBuf);
 
 			depInfo.pImageMemoryBarriers = &postImageBarrier;
-			vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+			vkCmdPipelineBarrier2(cmdBuf, &depInfo);
 
-			VK_INVALID(vkEndCommandBuffer, frame.CmdBuf)
+			VK_INVALID(vkEndCommandBuffer, cmdBuf)
 			{
 				continue;
 			}
+			stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Record, stageEnd - stageStart);
+			stageStart = stageEnd;
 
-			cmdBufInfo.commandBuffer = frame.CmdBuf;
+			cmdBufInfo.commandBuffer = cmdBuf;
 			imageReadyWait.semaphore = frame.ImageReady;
 			signals[0].semaphore     = frame.RenderDone;
 			signals[1].semaphore     = frame.Timeline;
@@ -331,6 +418,8 @@ int CSwapVK(size_t argc, const std::string_view* argv)
 			{
 				continue;
 			}
+			stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Submit, stageEnd - stageStart);
 
 			VkPresentInfoKHR presentInfo {
 				.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
@@ -342,18 +431,24 @@ int CSwapVK(size_t argc, const std::string_view* argv)
 				.pImageIndices      = &frame.ImageIndex,
 				.pResults           = nullptr
 			};
-			start = Clock::now();
+			stageStart = FrameTimings::Now();
 			VK_INVALID(wincs_surface_vkQueuePresentKHR, Vk::g_Context->Queue, &presentInfo)
 			{
 				continue;
 			}
-			end          = Clock::now();
-			presentTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+			sample.Set(FrameTimingStage::Present, FrameTimings::Now() - stageStart);
+			timings.Record(sample);
 		}
 		Vk::NextFrame();
-
-		avgPresentTime = avgPresentTime * 0.99 + presentTime * 0.01;
-		avgWaitTime    = avgWaitTime * 0.99 + waitTime * 0.01;
+		timings.Collect();
+		++frameIndex;
+	}
+	timings.Report();
+	timings.DeInit();
+	{
+		VkWinCSPresentStatsEXT presentStats {};
+		vkGetWinCSPresentStatsEXT(&presentStats);
+		std::cout << std::format("CSwapVK {} presents, {} idle VBlanks, {} resizes, {} buffers recreated\n", presentStats.presentCount, presentStats.idleVBlanks, presentStats.resizeCount, presentStats.recreateCount);
 	}
 
 	for (int64_t i = 0; i < numSwapchains; ++i)
@@ -502,6 +597,59 @@ bool InitSwapchainState(SwapchainState* swapchain, Wnd::Handle* window, bool wit
 	return false;
 }
 
+// Only hands the new size to the swapchain, the buffers are recreated as they are acquired
+bool ResizeSwapchainState(SwapchainState* swapchain)
+{
+	VkSurfaceCapabilitiesKHR caps {};
+	VK_INVALID(wincs_surface_vkGetPhysicalDeviceSurfaceCapabilitiesKHR, Vk::g_Context->PhysicalDevice, swapchain->Surface, &caps)
+	{
+		return false;
+	}
+
+	VkExtent2D extents { caps.currentExtent.width * 2, caps.currentExtent.height * 2 };
+	if (extents.width == 0 || extents.height == 0)
+		return false; // Minimized
+	if (extents.width == swapchain->Extents.width && extents.height == swapchain->Extents.height)
+		return true;
+
+	VK_INVALID(vkResizeWinCSSwapchainEXT, Vk::g_Context->Device, swapchain->Swapchain, extents)
+	{
+		return false;
+	}
+	swapchain->Extents = extents;
+	return true;
+}
+
+// The acquired image was recreated at the current size, its old view goes once the frame that last used it retired
+bool RecreateSwapchainImage(SwapchainState* swapchain, Vk::SwapchainFrameState* frame)
+{
+	uint32_t imageCount = (uint32_t) swapchain->Images.size();
+	VK_INVALID(wincs_surface_vkGetSwapchainImagesKHR, Vk::g_Context->Device, swapchain->Swapchain, &imageCount, swapchain->Images.column<0>())
+	{
+		return false;
+	}
+
+	auto [image, view] = swapchain->Images[frame->ImageIndex];
+	Vk::DeferDestroy(frame, Vk::DestroyType::ImageView, (uint64_t) view, frame->TimelineValue);
+	view = nullptr;
+
+	VkImageViewCreateInfo ivCreateInfo {
+		.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		.pNext            = nullptr,
+		.flags            = 0,
+		.image            = image,
+		.viewType         = VK_IMAGE_VIEW_TYPE_2D,
+		.format           = VK_FORMAT_B8G8R8A8_UNORM,
+		.components       = {},
+		.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+	};
+	VK_INVALID(vkCreateImageView, Vk::g_Context->Device, &ivCreateInfo, nullptr, &view)
+	{
+		return false;
+	}
+	return true;
+}
+
 void DeInitSwapchainState(SwapchainState* swapchain)
 {
 	if (!Vk::g_Context || !swapchain)
@@ -1,10 +1,12 @@
 #include "Shared.h"
+#include "Utils/FrameTimings.h"
+#include "Utils/ScratchArray.h"
 
 #include <cstddef>
 #include <cstdint>
 
-#include <chrono>
 #include <iostream>
+#include <string>
 #include <string_view>
 
 static constexpr const char* c_InstanceExtensions[] {
@@ -15,6 +17,8 @@ static constexpr const char* c_DeviceExtensions[] {
 	nullptr
 };
 
+static constexpr uint32_t c_InlineWaitSemaphoreCount = 8;
+
 struct DCompSwapchain
 {
 	uint32_t CurrentImage = ~0U;
@@ -30,9 +34,10 @@ struct DCompSwapchain
 		ID3D11Resource*       D3D11FrontResource = nullptr;
 		IDCompositionTexture* DCompTexture       = nullptr;
 		HANDLE                ShareHandle        = nullptr;
-		VkDeviceMemory        ResolveMemory      = nullptr;
+		VkDeviceMemory        ResolveMemory      = nullptr; // Imported from the D3D11 texture, so never sub-allocated
 		VkImage               ResolveImage       = nullptr;
 		VkImage               Image              = nullptr;
+		Vk::DeviceAllocation* ImageMemory        = nullptr;
 		VkSemaphore           AcquireSemaphore   = nullptr;
 		ID3D11Fence*          AvailabilityFence  = nullptr;
 		VkCommandPool         Pool               = nullptr;
@@ -40,13 +45,14 @@ struct DCompSwapchain
 		VkSemaphore           Timeline           = nullptr;
 		uint64_t              TimelineValue      = 0;
 	};
-	DCompBuffer*   Buffers            = nullptr;
-	HANDLE*        AvailabilityEvents = nullptr;
-	VkDeviceMemory ImageMemory        = nullptr;
+	DCompBuffer* Buffers            = nullptr;
+	HANDLE*      AvailabilityEvents = nullptr;
 
 	Wnd::Handle*          Window     = nullptr;
 	IDCompositionTarget*  CompTarget = nullptr;
 	IDCompositionVisual3* CompVisual = nullptr;
+
+	LinearArena PresentArena { 4096 }; // Spill space for wait semaphore arrays, reset on every present
 };
 
 struct DCompSwapchainSpec
@@ -65,6 +71,25 @@ static bool DCompSwapchainPresent(DCompSwapchain* swapchain, uint32_t image, uin
 
 int DCompVK(size_t argc, const std::string_view* argv)
 {
+	std::string timingsPath;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "DCompVK Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':    Shows this help info\n"
+						 "  '--timings' <path>: Write per frame timings to '<path>.csv' and the percentiles to '<path>.json' at exit\n";
+			return 0;
+		}
+		else if (argv[i] == "--timings")
+		{
+			if (++i >= argc)
+				break;
+			timingsPath = argv[i];
+		}
+	}
+
 	{
 		Wnd::ContextSpec spec {};
 		spec.SeparateThread = true;
@@ -151,8 +176,6 @@ int DCompVK(size_t argc, const std::string_view* argv)
 
 	auto& frame = Vk::g_Context->Frames[0];
 
-	using Clock = std::chrono::high_resolution_clock;
-
 	VkCommandBufferBeginInfo beginInfo {
 		.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
 		.pNext            = nullptr,
@@ -264,31 +287,38 @@ int DCompVK(size_t argc, const std::string_view* argv)
 		.pSignalSemaphoreInfos    = signals
 	};
 
-	double avgDeltaTime    = 0.0;
-	double avgPresentTime  = 0.0;
-	double avgWaitTime     = 0.0;
-	auto   previousTime    = Clock::now();
-	auto   updateTitleTime = previousTime;
+	FrameTimings timings;
+	{
+		FrameTimingsSpec spec {};
+		spec.Name           = "DCompVK";
+		spec.SwapchainCount = 1;
+		spec.Path           = timingsPath;
+		timings.Init(&spec);
+	}
+
+	uint64_t frameIndex      = 0;
+	uint64_t previousTime    = FrameTimings::Now();
+	uint64_t updateTitleTime = previousTime;
 	while (!Wnd::QuitSignaled())
 	{
 		if (Wnd::GetWantsClose(window))
 			break;
 
-		Clock::time_point start, end;
-		double            waitTime    = 0.0;
-		double            presentTime = 0.0;
-
-		auto   currentTime = Clock::now();
-		double deltaTime   = std::chrono::duration_cast<std::chrono::duration<double>>(currentTime - previousTime).count();
-		previousTime       = currentTime;
-		avgDeltaTime       = avgDeltaTime * 0.99 + deltaTime * 0.01;
-		bool updateTitle   = currentTime - updateTitleTime > std::chrono::duration<double>(0.25);
+		uint64_t currentTime = FrameTimings::Now();
+		uint64_t deltaTime   = currentTime - previousTime;
+		previousTime         = currentTime;
+		bool updateTitle     = currentTime - updateTitleTime > 250'000'000;
 		if (updateTitle)
 		{
 			updateTitleTime = currentTime;
-			Wnd::SetWindowTitle(window, std::format("FrameTime: {:.4} us, FPS {:.5} FPS, PresentTime: {:.4} us, WaitTime: {:.4} us", avgDeltaTime * 1e6, 1.0 / avgDeltaTime, avgPresentTime * 1e6, avgWaitTime * 1e6));
+			Wnd::SetWindowTitle(window, timings.Summary(0));
 		}
 
+		FrameTimingSample sample {};
+		sample.Frame = frameIndex;
+		if (frameIndex)
+			sample.Set(FrameTimingStage::Frame, deltaTime);
+
 		// Wait for currentFrame - framesInFlight to finish
 		{
 			VkSemaphoreWaitInfo waitInfo {
@@ -299,50 +329,60 @@ int DCompVK(size_t argc, const std::string_view* argv)
 				.pSemaphores    = &frame.Timeline,
 				.pValues        = &frame.TimelineValue
 			};
-			start = Clock::now();
+			uint64_t waitStart = FrameTimings::Now();
 			vkWaitSemaphores(Vk::g_Context->Device, &waitInfo, ~0ULL);
-			end       = Clock::now();
-			waitTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+			sample.Set(FrameTimingStage::Wait, FrameTimings::Now() - waitStart);
 		}
 
+		uint64_t stageStart = FrameTimings::Now();
 		DCompSwapchainAcquireNextImage(&swapchain, ~0ULL, imageReady, &imageIndex);
+		uint64_t stageEnd = FrameTimings::Now();
+		sample.Set(FrameTimingStage::Acquire, stageEnd - stageStart);
+		stageStart = stageEnd;
 
-		VK_VALIDATE(vkResetCommandPool, Vk::g_Context->Device, frame.Pool, 0);
-		VK_VALIDATE(vkBeginCommandBuffer, frame.CmdBuf, &beginInfo);
+		Vk::ResetCommandBuffers(&frame);
+		VkCommandBuffer cmdBuf = Vk::AcquireCommandBuffer(&frame);
+		VK_VALIDATE(vkBeginCommandBuffer, cmdBuf, &beginInfo);
 
 		swapchainImagePreBarrier.image  = images[imageIndex];
 		swapchainImagePostBarrier.image = images[imageIndex];
 		depInfo.pImageMemoryBarriers    = &swapchainImagePreBarrier;
-		vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+		vkCmdPipelineBarrier2(cmdBuf, &depInfo);
 
 		colAttach.imageView             = imageViews[imageIndex];
 		renderingInfo.renderArea.extent = { swapchain.Width, swapchain.Height };
-		vkCmdBeginRendering(frame.CmdBuf, &renderingInfo);
+		vkCmdBeginRendering(cmdBuf, &renderingInfo);
 
-		vkCmdEndRendering(frame.CmdBuf);
+		vkCmdEndRendering(cmdBuf);
 
 		depInfo.pImageMemoryBarriers = &swapchainImagePostBarrier;
-		vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+		vkCmdPipelineBarrier2(cmdBuf, &depInfo);
 
-		VK_VALIDATE(vkEndCommandBuffer, frame.CmdBuf);
+		VK_VALIDATE(vkEndCommandBuffer, cmdBuf);
+		stageEnd = FrameTimings::Now();
+		sample.Set(FrameTimingStage::Record, stageEnd - stageStart);
+		stageStart = stageEnd;
 
-		cmdBufInfo.commandBuffer = frame.CmdBuf;
+		cmdBufInfo.commandBuffer = cmdBuf;
 		imageReadyWait.semaphore = imageReady;
 		signals[0].semaphore     = frame.RenderDone;
 		signals[1].semaphore     = frame.Timeline;
 		signals[1].value         = ++frame.TimelineValue;
 		VK_VALIDATE(vkQueueSubmit2, Vk::g_Context->Queue, 1, &submit, nullptr);
+		stageEnd = FrameTimings::Now();
+		sample.Set(FrameTimingStage::Submit, stageEnd - stageStart);
+		stageStart = stageEnd;
 
-		start = Clock::now();
 		DCompSwapchainPresent(&swapchain, imageIndex, 1, &frame.RenderDone);
-		end          = Clock::now();
-		presentTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
-
-		avgWaitTime    = avgWaitTime * 0.99 + waitTime * 0.01;
-		avgPresentTime = avgPresentTime * 0.99 + presentTime * 0.01;
+		sample.Set(FrameTimingStage::Present, FrameTimings::Now() - stageStart);
+		timings.Record(sample);
+		timings.Collect();
+		++frameIndex;
 
 		Wnd::PollEvents();
 	}
+	timings.Report();
+	timings.DeInit();
 
 	DeInitDCompSwapchain(&swapchain);
 	Wnd::Destroy(window);
@@ -460,17 +500,11 @@ bool InitDCompSwapchain(DCompSwapchain* swapchain, const DCompSwapchainSpec* spe
 		.allocationSize  = 0,
 		.memoryTypeIndex = 0
 	};
-	VkMemoryAllocateInfo mAllocInfo {
-		.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.pNext           = nullptr,
-		.allocationSize  = 0,
-		.memoryTypeIndex = 0
-	};
 	VkCommandPoolCreateInfo pCreateInfo {
 		.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
 		.pNext            = nullptr,
 		.flags            = 0,
-		.queueFamilyIndex = 0
+		.queueFamilyIndex = Vk::g_Context->QueueFamily
 	};
 	VkCommandBufferAllocateInfo allocInfo {
 		.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
@@ -559,9 +593,6 @@ bool InitDCompSwapchain(DCompSwapchain* swapchain, const DCompSwapchainSpec* spe
 		.imageMemoryBarrierCount  = 2,
 		.pImageMemoryBarriers     = nullptr
 	};
-	size_t   imageMemorySize     = 0;
-	size_t   imageMemoryOffset   = 0;
-	uint32_t imageMemoryTypeBits = ~0U;
 
 	HR_INVALID(DX::g_Context->DCompDevice->CreateTargetForHwnd, Wnd::GetNativeHandle(swapchain->Window), true, &swapchain->CompTarget)
 	{
@@ -650,26 +681,9 @@ bool InitDCompSwapchain(DCompSwapchain* swapchain, const DCompSwapchainSpec* spe
 		{
 			goto INITFAILED;
 		}
-		vkGetImageMemoryRequirements(Vk::g_Context->Device, buffer.Image, &mReq);
-		imageMemoryTypeBits &= mReq.memoryTypeBits;
-		imageMemorySize      = (imageMemorySize + mReq.alignment - 1) / mReq.alignment * mReq.alignment + mReq.size;
-	}
-	mAllocInfo.allocationSize  = imageMemorySize;
-	mAllocInfo.memoryTypeIndex = Vk::FindDeviceMemoryIndex(imageMemoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-	VK_INVALID(vkAllocateMemory, Vk::g_Context->Device, &mAllocInfo, nullptr, &swapchain->ImageMemory)
-	{
-		goto INITFAILED;
-	}
-	for (uint32_t i = 0; i < swapchain->ImageCount; ++i)
-	{
-		auto& buffer = swapchain->Buffers[i];
-		vkGetImageMemoryRequirements(Vk::g_Context->Device, buffer.Image, &mReq);
-		imageMemoryOffset = (imageMemoryOffset + mReq.alignment - 1) / mReq.alignment * mReq.alignment;
-		VK_INVALID(vkBindImageMemory, Vk::g_Context->Device, buffer.Image, swapchain->ImageMemory, imageMemoryOffset)
-		{
+		buffer.ImageMemory = Vk::AllocateImageMemory(buffer.Image, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (!buffer.ImageMemory)
 			goto INITFAILED;
-		}
-		imageMemoryOffset += mReq.size;
 	}
 	for (uint32_t i = 0; i < swapchain->ImageCount; ++i)
 	{
@@ -742,6 +756,7 @@ void DeInitDCompSwapchain(DCompSwapchain* swapchain)
 		vkDestroyImage(Vk::g_Context->Device, buffer.Image, nullptr);
 		vkDestroyImage(Vk::g_Context->Device, buffer.ResolveImage, nullptr);
 		vkFreeMemory(Vk::g_Context->Device, buffer.ResolveMemory, nullptr);
+		Vk::FreeDeviceMemory(buffer.ImageMemory);
 		if (buffer.AvailabilityFence)
 			buffer.AvailabilityFence->Release();
 		if (swapchain->AvailabilityEvents[i])
@@ -764,7 +779,6 @@ void DeInitDCompSwapchain(DCompSwapchain* swapchain)
 	swapchain->Buffers      = nullptr;
 	swapchain->ImageCount   = 0;
 	swapchain->CurrentImage = 0;
-	vkFreeMemory(Vk::g_Context->Device, swapchain->ImageMemory, nullptr);
 	if (swapchain->CompVisual)
 		swapchain->CompVisual->Release();
 	swapchain->CompVisual = nullptr;
@@ -849,7 +863,8 @@ bool DCompSwapchainPresent(DCompSwapchain* swapchain, uint32_t image, uint32_t w
 
 	auto& buffer = swapchain->Buffers[image];
 	{
-		VkSemaphoreSubmitInfo* waitSemas = new VkSemaphoreSubmitInfo[waitSemaphoreCount];
+		swapchain->PresentArena.Reset();
+		ScratchArray<VkSemaphoreSubmitInfo, c_InlineWaitSemaphoreCount> waitSemas(waitSemaphoreCount, swapchain->PresentArena);
 		for (uint32_t i = 0; i < waitSemaphoreCount; ++i)
 		{
 			waitSemas[i] = {
@@ -880,7 +895,7 @@ bool DCompSwapchainPresent(DCompSwapchain* swapchain, uint32_t image, uint32_t w
 			.pNext                    = nullptr,
 			.flags                    = 0,
 			.waitSemaphoreInfoCount   = waitSemaphoreCount,
-			.pWaitSemaphoreInfos      = waitSemas,
+			.pWaitSemaphoreInfos      = waitSemas.data(),
 			.commandBufferInfoCount   = 1,
 			.pCommandBufferInfos      = &cmdBufInfo,
 			.signalSemaphoreInfoCount = 1,
@@ -890,7 +905,6 @@ bool DCompSwapchainPresent(DCompSwapchain* swapchain, uint32_t image, uint32_t w
 		{
 			return false;
 		}
-		delete[] waitSemas;
 
 		VkSemaphoreWaitInfo waitInfo {
 			.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
@@ -1,8 +1,9 @@
 #include "Shared.h"
+#include "Utils/FrameTimings.h"
 #include "Utils/TupleVector.h"
 
-#include <chrono>
 #include <iostream>
+#include <string>
 
 static constexpr const char* c_InstanceExtensions[] {
 	nullptr
@@ -43,6 +44,8 @@ int DXGISwapVK(size_t argc, const std::string_view* argv)
 {
 	int64_t numFramesInFlight = 1;
 	int64_t numSwapchains     = 1;
+
+	std::string timingsPath;
 	for (size_t i = 1; i < argc; ++i)
 	{
 		if (argv[i] == "-h" || argv[i] == "--help")
@@ -51,7 +54,8 @@ int DXGISwapVK(size_t argc, const std::string_view* argv)
 						 "Options:\n"
 						 "  '-h' | '--help':       Shows this help info\n"
 						 "  '-f' | '--frames':     Set number of frames in flight, default 1, minimum 1\n"
-						 "  '-s' | '--swapchains': Set number of swapchains to create, default 4, minimum 1\n";
+						 "  '-s' | '--swapchains': Set number of swapchains to create, default 4, minimum 1\n"
+						 "  '--timings' <path>:    Write per frame timings to '<path>.csv' and the percentiles to '<path>.json' at exit\n";
 			return 0;
 		}
 		else if (argv[i] == "-f" || argv[i] == "--frames")
@@ -76,6 +80,12 @@ int DXGISwapVK(size_t argc, const std::string_view* argv)
 				return 1;
 			}
 		}
+		else if (argv[i] == "--timings")
+		{
+			if (++i >= argc)
+				break;
+			timingsPath = argv[i];
+		}
 	}
 
 	{
@@ -238,24 +248,28 @@ int DXGISwapVK(size_t argc, const std::string_view* argv)
 		.pSignalSemaphoreInfos    = &timelineSig
 	};
 
-	using Clock = std::chrono::high_resolution_clock;
-	Clock::time_point start, end;
+	FrameTimings timings;
+	{
+		FrameTimingsSpec spec {};
+		spec.Name           = "DXGISwapVK";
+		spec.SwapchainCount = (uint32_t) numSwapchains;
+		spec.Path           = timingsPath;
+		timings.Init(&spec);
+	}
 
-	double avgDeltaTime    = 0.0;
-	double avgPresentTime  = 0.0;
-	double avgWaitTime     = 0.0;
-	auto   previousTime    = Clock::now();
-	auto   updateTitleTime = previousTime;
-	auto   startTime       = previousTime;
+	uint64_t frameIndex      = 0;
+	uint64_t startTime       = FrameTimings::Now();
+	uint64_t previousTime    = startTime;
+	uint64_t updateTitleTime = startTime;
 	while (!Wnd::QuitSignaled())
 	{
-		auto   currentTime = Clock::now();
-		double deltaTime   = std::chrono::duration_cast<std::chrono::duration<double>>(currentTime - previousTime).count();
-		previousTime       = currentTime;
-		avgDeltaTime       = avgDeltaTime * 0.99 + deltaTime * 0.01;
-		bool updateTitle   = currentTime - updateTitleTime > std::chrono::duration<double>(1.0);
+		uint64_t currentTime = FrameTimings::Now();
+		uint64_t deltaTime   = currentTime - previousTime;
+		previousTime         = currentTime;
+		bool updateTitle     = currentTime - updateTitleTime > 1'000'000'000;
 		if (updateTitle)
 			updateTitleTime = currentTime;
+		float time = (float) ((currentTime - startTime) * 1e-9);
 
 		Wnd::PollEvents();
 		if (Wnd::QuitSignaled())
@@ -272,65 +286,73 @@ int DXGISwapVK(size_t argc, const std::string_view* argv)
 			value                   = swapchains[i].Frames[curFrame].TimelineValue;
 		}
 
-		double waitTime = 0.0, presentTime = 0.0;
-		start = Clock::now();
+		uint64_t waitStart = FrameTimings::Now();
 		VK_EXPECT(vkWaitSemaphores, Vk::g_Context->Device, &waitInfo, ~0ULL);
-		end       = Clock::now();
-		waitTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+		uint64_t waitTime = FrameTimings::Now() - waitStart;
 
 		for (int64_t i = 0; i < numSwapchains; ++i)
 		{
 			auto& swapchain = swapchains[i];
 			auto& frame     = swapchain.Frames[Vk::g_Context->CurrentFrame];
-			for (auto& destroy : frame.Destroys)
-				destroy();
-			frame.Destroys.clear();
+			Vk::ReclaimDestroys(&frame);
 
 			if (updateTitle)
 			{
-				Wnd::SetWindowTitle(swapchain.Window, std::format("DXGISwapVK Window {}, FrameTime {:.4} us, FPS {:.5}, PresentTime {:.4} us, WaitTime {:.4} us", i, avgDeltaTime * 1e6, 1.0 / avgDeltaTime, avgPresentTime * 1e6, avgWaitTime * 1e6));
+				Wnd::SetWindowTitle(swapchain.Window, std::format("DXGISwapVK Window {}, {}", i, timings.Summary((uint32_t) i)));
 			}
 
-			VK_INVALID(vkResetCommandPool, Vk::g_Context->Device, frame.Pool, 0)
-			{
+			FrameTimingSample sample {};
+			sample.Frame     = frameIndex;
+			sample.Swapchain = (uint32_t) i;
+			sample.Set(FrameTimingStage::Wait, waitTime);
+			if (frameIndex)
+				sample.Set(FrameTimingStage::Frame, deltaTime);
+
+			uint64_t stageStart = FrameTimings::Now();
+			if (!Vk::ResetCommandBuffers(&frame))
 				continue;
-			}
-			VK_INVALID(vkBeginCommandBuffer, frame.CmdBuf, &beginInfo)
+			VkCommandBuffer cmdBuf = Vk::AcquireCommandBuffer(&frame);
+			if (!cmdBuf)
+				continue;
+			VK_INVALID(vkBeginCommandBuffer, cmdBuf, &beginInfo)
 			{
 				continue;
 			}
 
 			depInfo.pImageMemoryBarriers = &preImageBarrier;
 			preImageBarrier.image        = swapchain.Image;
-			vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+			vkCmdPipelineBarrier2(cmdBuf, &depInfo);
 			preImageBarrier.image = swapchain.ResolveImage;
-			vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+			vkCmdPipelineBarrier2(cmdBuf, &depInfo);
 
 			colAttach.imageView                    = swapchain.View;
 			colAttach.resolveImageView             = swapchain.ResolveView;
-			colAttach.clearValue.color.float32[0]  = 0.5f + 0.5f * sinf(0.17f + std::chrono::duration_cast<std::chrono::duration<float>>(currentTime - startTime).count() * 3.1415f);
-			colAttach.clearValue.color.float32[1]  = 0.5f + 0.5f * sinf(std::chrono::duration_cast<std::chrono::duration<float>>(currentTime - startTime).count() * 3.10f);
-			colAttach.clearValue.color.float32[2]  = 0.5f + 0.5f * sinf(0.65f + std::chrono::duration_cast<std::chrono::duration<float>>(currentTime - startTime).count() * 3.2f);
-			colAttach.clearValue.color.float32[3]  = 0.5f + 0.5f * sinf(0.3f + std::chrono::duration_cast<std::chrono::duration<float>>(currentTime - startTime).count() * 0.5f);
+			colAttach.clearValue.color.float32[0]  = 0.5f + 0.5f * sinf(0.17f + time * 3.1415f);
+			colAttach.clearValue.color.float32[1]  = 0.5f + 0.5f * sinf(time * 3.10f);
+			colAttach.clearValue.color.float32[2]  = 0.5f + 0.5f * sinf(0.65f + time * 3.2f);
+			colAttach.clearValue.color.float32[3]  = 0.5f + 0.5f * sinf(0.3f + time * 0.5f);
 			colAttach.clearValue.color.float32[0] *= colAttach.clearValue.color.float32[3];
 			colAttach.clearValue.color.float32[1] *= colAttach.clearValue.color.float32[3];
 			colAttach.clearValue.color.float32[2] *= colAttach.clearValue.color.float32[3];
 			renderingInfo.renderArea.extent        = swapchain.Extents;
-			vkCmdBeginRendering(frame.CmdBuf, &renderingInfo);
-			vkCmdEndRendering(frame.CmdBuf);
+			vkCmdBeginRendering(cmdBuf, &renderingInfo);
+			vkCmdEndRendering(cmdBuf);
 
 			depInfo.pImageMemoryBarriers = &postImageBarrier;
 			postImageBarrier.image       = swapchain.Image;
-			vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+			vkCmdPipelineBarrier2(cmdBuf, &depInfo);
 			postImageBarrier.image = swapchain.ResolveImage;
-			vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+			vkCmdPipelineBarrier2(cmdBuf, &depInfo);
 
-			VK_INVALID(vkEndCommandBuffer, frame.CmdBuf)
+			VK_INVALID(vkEndCommandBuffer, cmdBuf)
 			{
 				continue;
 			}
+			uint64_t stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Record, stageEnd - stageStart);
+			stageStart = stageEnd;
 
-			cmdBufInfo.commandBuffer = frame.CmdBuf;
+			cmdBufInfo.commandBuffer = cmdBuf;
 			imageReadyWait.semaphore = frame.Timeline;
 			imageReadyWait.value     = frame.TimelineValue;
 			timelineSig.semaphore    = frame.Timeline;
@@ -339,21 +361,24 @@ int DXGISwapVK(size_t argc, const std::string_view* argv)
 			{
 				continue;
 			}
+			stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Submit, stageEnd - stageStart);
+			stageStart = stageEnd;
 
-			start = Clock::now();
 			DX::g_Context->D3D11DeviceContext->CopyResource(swapchain.BackBufferResource, swapchain.FrontBufferResource);
 			HR_INVALID(swapchain.Swapchain->Present, 0, 0)
 			{
 				continue;
 			}
-			end          = Clock::now();
-			presentTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+			sample.Set(FrameTimingStage::Present, FrameTimings::Now() - stageStart);
+			timings.Record(sample);
 		}
 		Vk::NextFrame();
-
-		avgPresentTime = avgPresentTime * 0.99 + presentTime * 0.01;
-		avgWaitTime    = avgWaitTime * 0.99 + waitTime * 0.01;
+		timings.Collect();
+		++frameIndex;
 	}
+	timings.Report();
+	timings.DeInit();
 
 	for (int64_t i = 0; i < numSwapchains; ++i)
 		DeInitDXGISwapchain(&swapchains[i]);
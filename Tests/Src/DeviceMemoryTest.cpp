@@ -0,0 +1,360 @@
+#include "Shared.h"
+
+#include <cstdlib>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+//
+// Integration test of the device memory sub-allocator, runs headless so a software device like lavapipe can run it.
+// Host visible buffers of varying sizes and device local images are allocated through the context, the buffers are filled
+// with a pattern per buffer. Three in four buffers are then freed to fragment the blocks and a defragmentation plan is
+// carried out with GPU copies into freshly bound buffers. Every surviving buffer has to keep its pattern throughout and
+// freeing everything has to leave no memory in use.
+//
+
+struct MemoryTestBuffer
+{
+	VkBuffer              Buffer     = nullptr;
+	Vk::DeviceAllocation* Allocation = nullptr;
+	VkDeviceSize          Size       = 0;
+};
+
+static constexpr uint32_t c_MemoryTestImageCount = 16;
+
+static uint32_t MemoryTestPattern(uint32_t buffer, VkDeviceSize word)
+{
+	return buffer * 0x9E37'79B9U ^ (uint32_t) word;
+}
+
+static bool RunDeviceMemoryTest(uint32_t bufferCount);
+static bool VerifyBuffers(const std::vector<MemoryTestBuffer>& buffers, const char* stage);
+static void PrintMemoryStats(const char* stage);
+
+int DeviceMemoryTest(size_t argc, const std::string_view* argv)
+{
+	int64_t     bufferCount = 512;
+	int64_t     blockSize   = 16;
+	std::string device;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "DeviceMemoryTest Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':    Shows this help info\n"
+						 "  '-n' | '--buffers': Set number of host visible buffers to allocate, default 512, minimum 4\n"
+						 "  '-b' | '--block':   Set device memory block size in MiB, default 16, minimum 1\n"
+						 "  '--device' <name>:  Use the Vulkan device whose name contains <name> or whose deviceUUID is <name>, default picks the best scoring device\n";
+			return 0;
+		}
+		else if (argv[i] == "-n" || argv[i] == "--buffers")
+		{
+			if (++i >= argc)
+				break;
+			bufferCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (bufferCount < 4)
+			{
+				std::cout << "Number of buffers needs to be 4 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-b" || argv[i] == "--block")
+		{
+			if (++i >= argc)
+				break;
+			blockSize = std::strtoll(argv[i].data(), nullptr, 10);
+			if (blockSize < 1)
+			{
+				std::cout << "Block size needs to be 1 MiB or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--device")
+		{
+			if (++i >= argc)
+				break;
+			device = argv[i];
+		}
+	}
+
+	{
+		Vk::ContextSpec vkSpec {};
+		vkSpec.AppName         = "DeviceMemoryTest";
+		vkSpec.AppVersion      = VK_MAKE_API_VERSION(0, 1, 0, 0);
+		vkSpec.Headless        = true;
+		vkSpec.Device          = device.empty() ? nullptr : device.c_str();
+		vkSpec.MemoryBlockSize = (VkDeviceSize) blockSize << 20;
+		if (!Vk::Init(&vkSpec))
+			return 1;
+	}
+	bool success = RunDeviceMemoryTest((uint32_t) bufferCount);
+	Vk::DeInit();
+	std::cout << (success ? "DeviceMemoryTest passed\n" : "DeviceMemoryTest failed\n");
+	return success ? 0 : 1;
+}
+
+bool RunDeviceMemoryTest(uint32_t bufferCount)
+{
+	VkDevice device = Vk::g_Context->Device;
+
+	VkBufferCreateInfo bCreateInfo {
+		.sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.pNext                 = nullptr,
+		.flags                 = 0,
+		.size                  = 0,
+		.usage                 = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		.sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+		.queueFamilyIndexCount = 0,
+		.pQueueFamilyIndices   = nullptr
+	};
+	VkImageCreateInfo iCreateInfo {
+		.sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.pNext                 = nullptr,
+		.flags                 = 0,
+		.imageType             = VK_IMAGE_TYPE_2D,
+		.format                = VK_FORMAT_R8G8B8A8_UNORM,
+		.extent                = { 256, 256, 1 },
+		.mipLevels             = 1,
+		.arrayLayers           = 1,
+		.samples               = VK_SAMPLE_COUNT_1_BIT,
+		.tiling                = VK_IMAGE_TILING_OPTIMAL,
+		.usage                 = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		.sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+		.queueFamilyIndexCount = 0,
+		.pQueueFamilyIndices   = nullptr,
+		.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
+	};
+	VkMemoryPropertyFlags hostFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	// The context owns memory of its own, like the upload ring, everything is measured against what it held before the test
+	Vk::DeviceMemoryStats baseline = Vk::GetDeviceMemoryStats();
+
+	std::vector<MemoryTestBuffer> buffers(bufferCount);
+	VkImage                       images[c_MemoryTestImageCount] {};
+	Vk::DeviceAllocation*         imageAllocations[c_MemoryTestImageCount] {};
+	VkCommandPool                 pool    = nullptr;
+	bool                          success = false;
+
+	// Sizes from 4 KiB to 256 KiB, spread so neighbouring buffers differ in size class
+	for (uint32_t i = 0; i < bufferCount; ++i)
+	{
+		auto& buffer     = buffers[i];
+		buffer.Size      = 4096 * (1 + i * 37 % 64);
+		bCreateInfo.size = buffer.Size;
+		VK_INVALID(vkCreateBuffer, device, &bCreateInfo, nullptr, &buffer.Buffer)
+		{
+			goto CLEANUP;
+		}
+		buffer.Allocation = Vk::AllocateBufferMemory(buffer.Buffer, hostFlags, (void*) (uintptr_t) (i + 1)); // Zero is left for the images
+		if (!buffer.Allocation || !buffer.Allocation->Mapped)
+		{
+			std::cout << std::format("Failed to allocate host visible memory for buffer {}\n", i);
+			goto CLEANUP;
+		}
+		uint32_t* data = (uint32_t*) buffer.Allocation->Mapped;
+		for (VkDeviceSize word = 0; word < buffer.Size / sizeof(uint32_t); ++word)
+			data[word] = MemoryTestPattern(i, word);
+	}
+	for (uint32_t i = 0; i < c_MemoryTestImageCount; ++i)
+	{
+		VK_INVALID(vkCreateImage, device, &iCreateInfo, nullptr, &images[i])
+		{
+			goto CLEANUP;
+		}
+		imageAllocations[i] = Vk::AllocateImageMemory(images[i], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (!imageAllocations[i])
+		{
+			std::cout << std::format("Failed to allocate device local memory for image {}\n", i);
+			goto CLEANUP;
+		}
+	}
+	PrintMemoryStats("Allocated");
+	{
+		auto stats = Vk::GetDeviceMemoryStats();
+		if (stats.BlockCount - baseline.BlockCount + stats.DedicatedCount - baseline.DedicatedCount >= bufferCount + c_MemoryTestImageCount)
+		{
+			std::cout << "Every resource got its own VkDeviceMemory, nothing was sub-allocated\n";
+			goto CLEANUP;
+		}
+	}
+	if (!VerifyBuffers(buffers, "after allocating"))
+		goto CLEANUP;
+
+	// Keep every fourth buffer, the rest leave holes all over the blocks
+	for (uint32_t i = 0; i < bufferCount; ++i)
+	{
+		if (i % 4 == 0)
+			continue;
+		vkDestroyBuffer(device, buffers[i].Buffer, nullptr);
+		Vk::FreeDeviceMemory(buffers[i].Allocation);
+		buffers[i] = {};
+	}
+	PrintMemoryStats("Fragmented");
+
+	{
+		VkCommandPoolCreateInfo pCreateInfo {
+			.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.pNext            = nullptr,
+			.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+			.queueFamilyIndex = Vk::g_Context->QueueFamily
+		};
+		VK_INVALID(vkCreateCommandPool, device, &pCreateInfo, nullptr, &pool)
+		{
+			goto CLEANUP;
+		}
+
+		// Each round empties at most one block per pool, stop once a round moves no buffer.
+		// Images are left where they are, their moves are dropped right away
+		std::vector<Vk::DeviceMemoryMove> moves(bufferCount + c_MemoryTestImageCount);
+		std::vector<VkBuffer>             newBuffers(moves.size());
+		uint32_t                          rounds = 0;
+		while (uint32_t moveCount = Vk::PlanDefragment(moves.data(), (uint32_t) moves.size()))
+		{
+			VkCommandBufferAllocateInfo allocInfo {
+				.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.pNext              = nullptr,
+				.commandPool        = pool,
+				.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = 1
+			};
+			VkCommandBufferBeginInfo beginInfo {
+				.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+				.pNext            = nullptr,
+				.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+				.pInheritanceInfo = nullptr
+			};
+			VkCommandBuffer cmdBuf = nullptr;
+			bool            valid  = VK_VALIDATE(vkAllocateCommandBuffers, device, &allocInfo, &cmdBuf);
+			if (valid)
+				valid = VK_VALIDATE(vkBeginCommandBuffer, cmdBuf, &beginInfo);
+			uint32_t bufferMoves = 0;
+			for (uint32_t i = 0; i < moveCount && valid; ++i)
+			{
+				newBuffers[i] = nullptr;
+				if (!moves[i].From->UserData)
+					continue;
+				auto& buffer     = buffers[(uintptr_t) moves[i].From->UserData - 1];
+				bCreateInfo.size = buffer.Size;
+				VK_INVALID(vkCreateBuffer, device, &bCreateInfo, nullptr, &newBuffers[i])
+				{
+					valid = false;
+					break;
+				}
+				VK_INVALID(vkBindBufferMemory, device, newBuffers[i], moves[i].To->Memory, moves[i].To->Offset)
+				{
+					valid = false;
+					break;
+				}
+				VkBufferCopy region {
+					.srcOffset = 0,
+					.dstOffset = 0,
+					.size      = buffer.Size
+				};
+				vkCmdCopyBuffer(cmdBuf, buffer.Buffer, newBuffers[i], 1, &region);
+				++bufferMoves;
+			}
+			if (valid)
+				valid = VK_VALIDATE(vkEndCommandBuffer, cmdBuf);
+			if (valid && bufferMoves)
+			{
+				uint64_t value = Vk::SubmitQueue(Vk::QueueType::Graphics, 1, &cmdBuf);
+				valid          = value && Vk::WaitQueue(Vk::QueueType::Graphics, value);
+			}
+			vkResetCommandPool(device, pool, 0);
+
+			// The copies are done, From and its buffer go and the new buffer takes over. Failed rounds and images drop the new side instead
+			for (uint32_t i = 0; i < moveCount; ++i)
+			{
+				if (valid && newBuffers[i])
+				{
+					auto& buffer = buffers[(uintptr_t) moves[i].From->UserData - 1];
+					vkDestroyBuffer(device, buffer.Buffer, nullptr);
+					Vk::FreeDeviceMemory(moves[i].From);
+					buffer.Buffer     = newBuffers[i];
+					buffer.Allocation = moves[i].To;
+				}
+				else
+				{
+					if (newBuffers[i])
+						vkDestroyBuffer(device, newBuffers[i], nullptr);
+					Vk::FreeDeviceMemory(moves[i].To);
+				}
+				newBuffers[i] = nullptr;
+			}
+			if (!valid)
+			{
+				std::cout << "Failed to carry out a defragmentation move\n";
+				goto CLEANUP;
+			}
+			if (!bufferMoves)
+				break;
+			++rounds;
+		}
+		std::cout << std::format("Defragmented in {} rounds\n", rounds);
+	}
+	PrintMemoryStats("Defragmented");
+	if (!VerifyBuffers(buffers, "after defragmenting"))
+		goto CLEANUP;
+	success = true;
+
+CLEANUP:
+	if (pool)
+		vkDestroyCommandPool(device, pool, nullptr);
+	for (auto& buffer : buffers)
+	{
+		if (buffer.Buffer)
+			vkDestroyBuffer(device, buffer.Buffer, nullptr);
+		Vk::FreeDeviceMemory(buffer.Allocation);
+	}
+	for (uint32_t i = 0; i < c_MemoryTestImageCount; ++i)
+	{
+		if (images[i])
+			vkDestroyImage(device, images[i], nullptr);
+		Vk::FreeDeviceMemory(imageAllocations[i]);
+	}
+	PrintMemoryStats("Freed");
+	auto stats = Vk::GetDeviceMemoryStats();
+	if (stats.AllocationCount != baseline.AllocationCount || stats.DedicatedCount != baseline.DedicatedCount || stats.UsedBytes != baseline.UsedBytes)
+	{
+		std::cout << "Freeing every allocation left memory in use\n";
+		success = false;
+	}
+	return success;
+}
+
+bool VerifyBuffers(const std::vector<MemoryTestBuffer>& buffers, const char* stage)
+{
+	for (uint32_t i = 0; i < buffers.size(); ++i)
+	{
+		auto& buffer = buffers[i];
+		if (!buffer.Allocation)
+			continue;
+		const uint32_t* data = (const uint32_t*) buffer.Allocation->Mapped;
+		for (VkDeviceSize word = 0; word < buffer.Size / sizeof(uint32_t); ++word)
+		{
+			if (data[word] != MemoryTestPattern(i, word))
+			{
+				std::cout << std::format("Buffer {} lost its contents {} at byte {}\n", i, stage, word * sizeof(uint32_t));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void PrintMemoryStats(const char* stage)
+{
+	auto stats = Vk::GetDeviceMemoryStats();
+	std::cout << std::format("  {:<14} {:>4} blocks {:>8.2f} MiB, {:>8.2f} MiB used in {:>5} allocations, {:>5} free ranges, largest {:>8.2f} MiB, {} dedicated {:.2f} MiB\n",
+							 stage,
+							 stats.BlockCount,
+							 stats.BlockBytes / 1048576.0,
+							 stats.UsedBytes / 1048576.0,
+							 stats.AllocationCount,
+							 stats.FreeRangeCount,
+							 stats.LargestFree / 1048576.0,
+							 stats.DedicatedCount,
+							 stats.DedicatedBytes / 1048576.0);
+}
@@ -0,0 +1,624 @@
+#include "Shared.h"
+#include "Utils/FrameTimings.h"
+#include "Utils/JobPool.h"
+#include "Utils/TupleVector.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr const char* c_InstanceExtensions[] {
+	VK_KHR_SURFACE_EXTENSION_NAME,
+	"VK_KHR_win32_surface",
+	nullptr
+};
+static constexpr const char* c_DeviceExtensions[] {
+	VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+	nullptr
+};
+
+static constexpr int64_t c_DefaultHeadlessFrameCount = 1000;
+static constexpr int64_t c_SweepSwapchainCounts[]    = { 1, 4, 16, 64 };
+
+struct MTMSSpec
+{
+	int64_t     Swapchains = 4;
+	int64_t     Threads    = 1;     // Recording threads, including the main thread which also acquires, submits and presents
+	int64_t     FrameCount = 0;     // Zero renders until the windows are closed
+	bool        Headless   = false;
+	bool        Sweep      = false;
+	std::string TimingsPath;
+};
+
+struct MTMSResult
+{
+	int64_t  Frames     = 0;
+	double   TotalTime  = 0.0; // s
+	double   RecordTime = 0.0; // s of wall time spent in Dispatch
+	uint64_t Steals     = 0;
+	uint64_t Allocs     = 0; // Heap allocations over every frame
+};
+
+// Output of one record job, read by the main thread once Dispatch returns
+struct MTMSRecord
+{
+	uint32_t        Swapchain   = 0;
+	VkCommandBuffer CmdBuf      = nullptr;
+	uint64_t        AcquireTime = 0;
+	uint64_t        RecordTime  = 0;
+};
+
+static bool RunMTMS(const MTMSSpec& spec, MTMSResult& result);
+static void PrintMTMSResult(const MTMSSpec& spec, const MTMSResult& result);
+
+int MTMS(size_t argc, const std::string_view* argv)
+{
+	MTMSSpec    spec {};
+	int64_t     numFramesInFlight = 1;
+	std::string device;
+	spec.Threads = std::clamp<int64_t>(std::thread::hardware_concurrency(), 1, Vk::c_MaxRecordThreads);
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "MTMS Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':        Shows this help info\n"
+						 "  '-f' | '--frames':      Set number of frames in flight, default 1, minimum 1\n"
+						 "  '-s' | '--swapchains':  Set number of swapchains to create, default 4, minimum 1\n"
+						 "  '-t' | '--threads':     Set number of recording threads including the main thread, default is the number of cores, minimum 1, maximum 64\n"
+						 "  '-n' | '--frame-count': Exit after rendering this many frames and print the averages, default runs until closed, or 1000 when headless or sweeping\n"
+						 "  '--sweep':              Run 1, 4, 16 and 64 swapchains on 1, 2, 4, ... up to the thread count, then compare the frame times\n"
+						 "  '--headless':           Render to offscreen images without any windows, works with software drivers like lavapipe\n"
+						 "  '--device' <name>:      Use the Vulkan device whose name contains <name> or whose deviceUUID is <name>, default picks the best scoring device\n"
+						 "  '--timings' <path>:     Write per frame timings to '<path>.csv' and the percentiles to '<path>.json' at exit\n";
+			return 0;
+		}
+		else if (argv[i] == "-f" || argv[i] == "--frames")
+		{
+			if (++i >= argc)
+				break;
+			numFramesInFlight = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numFramesInFlight < 1)
+			{
+				std::cout << "Frames In Flight needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-s" || argv[i] == "--swapchains")
+		{
+			if (++i >= argc)
+				break;
+			spec.Swapchains = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.Swapchains < 1)
+			{
+				std::cout << "Number of swapchains needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-t" || argv[i] == "--threads")
+		{
+			if (++i >= argc)
+				break;
+			spec.Threads = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.Threads < 1 || spec.Threads > Vk::c_MaxRecordThreads)
+			{
+				std::cout << std::format("Number of threads needs to be between 1 and {}!\n", Vk::c_MaxRecordThreads);
+				return 1;
+			}
+		}
+		else if (argv[i] == "-n" || argv[i] == "--frame-count")
+		{
+			if (++i >= argc)
+				break;
+			spec.FrameCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.FrameCount < 1)
+			{
+				std::cout << "Frame count needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--sweep")
+		{
+			spec.Sweep = true;
+		}
+		else if (argv[i] == "--headless")
+		{
+			spec.Headless = true;
+		}
+		else if (argv[i] == "--device")
+		{
+			if (++i >= argc)
+				break;
+			device = argv[i];
+		}
+		else if (argv[i] == "--timings")
+		{
+			if (++i >= argc)
+				break;
+			spec.TimingsPath = argv[i];
+		}
+	}
+	if ((spec.Headless || spec.Sweep) && !spec.FrameCount)
+		spec.FrameCount = c_DefaultHeadlessFrameCount;
+
+	if (!spec.Headless)
+	{
+		Wnd::ContextSpec wndSpec {};
+		wndSpec.SeparateThread = false;
+		if (!Wnd::Init(&wndSpec))
+			return 1;
+	}
+	{
+		Vk::ContextSpec vkSpec {};
+		vkSpec.AppName          = "MTMS";
+		vkSpec.AppVersion       = VK_MAKE_API_VERSION(0, 1, 0, 0);
+		vkSpec.InstanceExtCount = spec.Headless ? 0 : (uint32_t) (sizeof(c_InstanceExtensions) / sizeof(*c_InstanceExtensions) - 1);
+		vkSpec.InstanceExts     = spec.Headless ? nullptr : c_InstanceExtensions;
+		vkSpec.DeviceExtCount   = (uint32_t) (sizeof(c_DeviceExtensions) / sizeof(*c_DeviceExtensions) - 1); // Still needed for VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+		vkSpec.DeviceExts       = c_DeviceExtensions;
+		vkSpec.FramesInFlight   = (uint32_t) numFramesInFlight;
+		vkSpec.Headless         = spec.Headless;
+		vkSpec.Device           = device.empty() ? nullptr : device.c_str();
+		if (!Vk::Init(&vkSpec))
+		{
+			if (!spec.Headless)
+				Wnd::DeInit();
+			return 1;
+		}
+	}
+
+	int exitCode = 0;
+	if (spec.Sweep)
+	{
+		constexpr size_t c_SweepCount = sizeof(c_SweepSwapchainCounts) / sizeof(*c_SweepSwapchainCounts);
+
+		std::vector<int64_t> threadCounts;
+		for (int64_t threads = 1; threads < spec.Threads; threads *= 2)
+			threadCounts.emplace_back(threads);
+		threadCounts.emplace_back(spec.Threads);
+
+		std::vector<MTMSResult> results(c_SweepCount * threadCounts.size());
+		bool                    quit = false;
+		for (size_t i = 0; i < c_SweepCount && !exitCode && !quit; ++i)
+		{
+			for (size_t j = 0; j < threadCounts.size(); ++j)
+			{
+				MTMSSpec runSpec   = spec;
+				runSpec.Swapchains = c_SweepSwapchainCounts[i];
+				runSpec.Threads    = threadCounts[j];
+				if (!spec.TimingsPath.empty())
+					runSpec.TimingsPath = std::format("{}-{}-{}", spec.TimingsPath, runSpec.Swapchains, runSpec.Threads);
+				if (!RunMTMS(runSpec, results[i * threadCounts.size() + j]))
+				{
+					exitCode = 1;
+					break;
+				}
+				PrintMTMSResult(runSpec, results[i * threadCounts.size() + j]);
+				if (!spec.Headless && Wnd::QuitSignaled())
+				{
+					quit = true;
+					break;
+				}
+			}
+		}
+
+		// Frame time per swapchain count and thread count, with the speedup over a single thread
+		std::cout << std::format("MTMS sweep, {} frames in flight{}, frame times in us\n", numFramesInFlight, spec.Headless ? ", headless" : "");
+		std::cout << std::format("  {:>10}", "Swapchains");
+		for (int64_t threads : threadCounts)
+			std::cout << std::format(" {:>18}", std::format("{} threads", threads));
+		std::cout << '\n';
+		for (size_t i = 0; i < c_SweepCount; ++i)
+		{
+			auto& single = results[i * threadCounts.size()];
+			if (!single.Frames)
+				continue;
+			double singleTime = single.TotalTime / single.Frames;
+			std::cout << std::format("  {:>10}", c_SweepSwapchainCounts[i]);
+			for (size_t j = 0; j < threadCounts.size(); ++j)
+			{
+				auto& run = results[i * threadCounts.size() + j];
+				if (!run.Frames)
+					break;
+				double frameTime = run.TotalTime / run.Frames;
+				std::cout << std::format(" {:>18}", std::format("{:.2f} ({:.2f}x)", frameTime * 1e6, singleTime / frameTime));
+			}
+			std::cout << '\n';
+		}
+	}
+	else
+	{
+		MTMSResult result {};
+		if (RunMTMS(spec, result))
+		{
+			if (spec.FrameCount)
+				PrintMTMSResult(spec, result);
+		}
+		else
+		{
+			exitCode = 1;
+		}
+	}
+
+	Vk::DeInit();
+	if (!spec.Headless)
+		Wnd::DeInit();
+	return exitCode;
+}
+
+// Runs on any worker, each worker acquires from its own pool in the frame's recycler
+static VkCommandBuffer RecordSwapchain(Vk::SwapchainState& swapchain, uint32_t curFrame, uint32_t worker)
+{
+	auto&           frame      = swapchain.Frames[curFrame];
+	uint32_t        imageIndex = frame.ImageIndex;
+	VkCommandBuffer cmdBuf     = Vk::AcquireCommandBuffer(&frame, worker);
+	if (!cmdBuf)
+		return nullptr;
+
+	VkCommandBufferBeginInfo beginInfo {
+		.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext            = nullptr,
+		.flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		.pInheritanceInfo = nullptr
+	};
+	VkImageMemoryBarrier2 preImageBarrier {
+		.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+		.pNext               = nullptr,
+		.srcStageMask        = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+		.srcAccessMask       = VK_ACCESS_2_NONE,
+		.dstStageMask        = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+		.dstAccessMask       = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+		.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+		.newLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.image               = swapchain.Images.entry<0>(imageIndex),
+		.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+	};
+	VkImageMemoryBarrier2 postImageBarrier {
+		.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+		.pNext               = nullptr,
+		.srcStageMask        = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+		.srcAccessMask       = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+		.dstStageMask        = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+		.dstAccessMask       = VK_ACCESS_2_NONE,
+		.oldLayout           = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		.newLayout           = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.image               = swapchain.Images.entry<0>(imageIndex),
+		.subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
+	};
+	VkDependencyInfo depInfo {
+		.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.pNext                    = nullptr,
+		.dependencyFlags          = 0,
+		.memoryBarrierCount       = 0,
+		.bufferMemoryBarrierCount = 0,
+		.imageMemoryBarrierCount  = 1,
+		.pImageMemoryBarriers     = &preImageBarrier
+	};
+	VkRenderingAttachmentInfo colAttach {
+		.sType              = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+		.pNext              = nullptr,
+		.imageView          = swapchain.Images.entry<1>(imageIndex),
+		.imageLayout        = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		.resolveMode        = VK_RESOLVE_MODE_NONE,
+		.resolveImageView   = nullptr,
+		.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+		.loadOp             = VK_ATTACHMENT_LOAD_OP_CLEAR,
+		.storeOp            = VK_ATTACHMENT_STORE_OP_STORE,
+		.clearValue         = { .color = { .float32 = { 0.15f, 0.15f, 0.15f, 1.0f } } }
+	};
+	VkRenderingInfo renderingInfo {
+		.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO,
+		.pNext                = nullptr,
+		.flags                = 0,
+		.renderArea           = {{ 0, 0 }, swapchain.Extents},
+		.layerCount           = 1,
+		.viewMask             = 0,
+		.colorAttachmentCount = 1,
+		.pColorAttachments    = &colAttach,
+		.pDepthAttachment     = nullptr,
+		.pStencilAttachment   = nullptr
+	};
+
+	VK_INVALID(vkBeginCommandBuffer, cmdBuf, &beginInfo)
+	{
+		return nullptr;
+	}
+	{
+		Vk::GpuScope gpuScope(&frame, cmdBuf, "Clear");
+		vkCmdPipelineBarrier2(cmdBuf, &depInfo);
+		vkCmdBeginRendering(cmdBuf, &renderingInfo);
+		vkCmdEndRendering(cmdBuf);
+		depInfo.pImageMemoryBarriers = &postImageBarrier;
+		vkCmdPipelineBarrier2(cmdBuf, &depInfo);
+	}
+	VK_INVALID(vkEndCommandBuffer, cmdBuf)
+	{
+		return nullptr;
+	}
+	return cmdBuf;
+}
+
+bool RunMTMS(const MTMSSpec& spec, MTMSResult& result)
+{
+	int64_t             numSwapchains = spec.Swapchains;
+	bool                headless      = spec.Headless;
+	Vk::SwapchainState* swapchains    = new Vk::SwapchainState[numSwapchains];
+	for (int64_t i = 0; i < numSwapchains; ++i)
+	{
+		Wnd::Handle* window = nullptr;
+		if (!headless)
+		{
+			Wnd::Spec wndSpec {};
+			wndSpec.Title = std::format("MTMS Window {}", i);
+			window        = Wnd::Create(&wndSpec);
+		}
+
+		if (!Vk::InitSwapchainState(&swapchains[i], window, true))
+		{
+			if (window)
+				Wnd::Destroy(window);
+			for (int64_t j = 0; j < i; ++j)
+			{
+				auto oldWindow = swapchains[j].Window;
+				Vk::DeInitSwapchainState(&swapchains[j]);
+				if (oldWindow)
+					Wnd::Destroy(oldWindow);
+			}
+			delete[] swapchains;
+			return false;
+		}
+	}
+
+	JobPool pool;
+	pool.Init((uint32_t) spec.Threads);
+
+	FrameTimings timings;
+	{
+		std::string      name = std::format("MTMS {} threads", spec.Threads);
+		FrameTimingsSpec timingsSpec {};
+		timingsSpec.Name             = name;
+		timingsSpec.SwapchainCount   = (uint32_t) numSwapchains;
+		timingsSpec.Path             = spec.TimingsPath;
+		timingsSpec.ReportSwapchains = !spec.Sweep;
+		timings.Init(&timingsSpec);
+	}
+
+	TupleVector<VkSemaphore, uint64_t> timelines((size_t) numSwapchains);
+
+	VkSemaphoreWaitInfo waitInfo {
+		.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.pNext          = nullptr,
+		.flags          = 0,
+		.semaphoreCount = (uint32_t) timelines.size(),
+		.pSemaphores    = timelines.column<0>(),
+		.pValues        = timelines.column<1>()
+	};
+
+	uint64_t frameIndex      = 0;
+	uint64_t recordTime      = 0;
+	uint64_t allocs          = 0;
+	uint64_t startTime       = FrameTimings::Now();
+	uint64_t previousTime    = startTime;
+	uint64_t updateTitleTime = startTime;
+	while (headless || !Wnd::QuitSignaled())
+	{
+		if (spec.FrameCount && (int64_t) frameIndex >= spec.FrameCount)
+			break;
+
+		uint64_t currentTime = FrameTimings::Now();
+		uint64_t deltaTime   = currentTime - previousTime;
+		previousTime         = currentTime;
+		bool updateTitle     = currentTime - updateTitleTime > 1'000'000'000;
+		if (updateTitle)
+			updateTitleTime = currentTime;
+
+		if (!headless)
+		{
+			Wnd::PollEvents();
+			if (Wnd::QuitSignaled())
+				break;
+		}
+
+		uint32_t curFrame = Vk::g_Context->CurrentFrame;
+
+		for (int64_t i = 0; i < numSwapchains; ++i)
+		{
+			if (!headless && Wnd::GetWantsClose(swapchains[i].Window))
+				Wnd::SignalQuit();
+			auto [semaphore, value] = timelines[i];
+			semaphore               = swapchains[i].Frames[curFrame].Timeline;
+			value                   = swapchains[i].Frames[curFrame].TimelineValue;
+		}
+
+		uint64_t waitStart = FrameTimings::Now();
+		VK_EXPECT(vkWaitSemaphores, Vk::g_Context->Device, &waitInfo, ~0ULL);
+		uint64_t waitTime = FrameTimings::Now() - waitStart;
+
+		// Acquire on the main thread, the headless backend submits to the shared queue
+		uint32_t    recordCount = 0;
+		MTMSRecord* records     = Vk::FrameAllocate<MTMSRecord>((size_t) numSwapchains);
+		for (int64_t i = 0; i < numSwapchains; ++i)
+		{
+			auto& swapchain = swapchains[i];
+			if (!headless && Wnd::IsMinimized(swapchain.Window))
+				continue;
+
+			if (updateTitle && !headless)
+			{
+				Wnd::SetWindowTitle(swapchain.Window, std::format("MTMS Window {} ({} threads), {}, Allocs/Frame {}", i, pool.WorkerCount(), timings.Summary((uint32_t) i), Vk::g_Context->FrameAllocations));
+			}
+
+			auto& frame = swapchain.Frames[curFrame];
+
+			uint64_t acquireStart = FrameTimings::Now();
+			if (!Vk::SwapchainAcquireImage(&swapchain))
+				continue;
+			uint64_t acquireTime = FrameTimings::Now() - acquireStart;
+			if (!Vk::ResetCommandBuffers(&frame))
+				continue;
+			if (Vk::ResolveGpuTimestamps(&frame))
+			{
+				for (uint32_t j = 0; j < frame.Profiler.ResultCount; ++j)
+					timings.RecordGpu((uint32_t) i, frame.Profiler.Results[j].Name, frame.Profiler.Results[j].Duration);
+			}
+			records[recordCount++] = {
+				.Swapchain   = (uint32_t) i,
+				.CmdBuf      = nullptr,
+				.AcquireTime = acquireTime,
+				.RecordTime  = 0
+			};
+		}
+
+		uint64_t dispatchStart = FrameTimings::Now();
+		pool.Dispatch(recordCount, [&](uint32_t index, uint32_t worker) {
+			auto&    record      = records[index];
+			auto&    swapchain   = swapchains[record.Swapchain];
+			uint64_t recordStart = FrameTimings::Now();
+			record.CmdBuf        = RecordSwapchain(swapchain, curFrame, worker);
+			record.RecordTime    = FrameTimings::Now() - recordStart;
+		});
+		recordTime += FrameTimings::Now() - dispatchStart;
+
+		// The main thread is the only one touching the queue, every recorded swapchain goes out in one submit and one present
+		uint32_t                   batchCount       = 0;
+		Vk::SwapchainState**       batchSwapchains  = Vk::FrameAllocate<Vk::SwapchainState*>(recordCount);
+		VkSubmitInfo2*             batchSubmits     = Vk::FrameAllocate<VkSubmitInfo2>(recordCount);
+		VkCommandBufferSubmitInfo* batchCmdBufInfos = Vk::FrameAllocate<VkCommandBufferSubmitInfo>(recordCount);
+		VkSemaphoreSubmitInfo*     batchWaits       = Vk::FrameAllocate<VkSemaphoreSubmitInfo>(recordCount);
+		VkSemaphoreSubmitInfo*     batchSignals     = Vk::FrameAllocate<VkSemaphoreSubmitInfo>(2 * (size_t) recordCount);
+		for (uint32_t i = 0; i < recordCount; ++i)
+		{
+			auto& record = records[i];
+			if (!record.CmdBuf)
+				continue;
+
+			auto&    frame = swapchains[record.Swapchain].Frames[curFrame];
+			uint32_t j     = batchCount++;
+
+			batchCmdBufInfos[j] = {
+				.sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+				.pNext         = nullptr,
+				.commandBuffer = record.CmdBuf,
+				.deviceMask    = 0
+			};
+			batchWaits[j] = {
+				.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.pNext       = nullptr,
+				.semaphore   = frame.ImageReady,
+				.value       = 0,
+				.stageMask   = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+				.deviceIndex = 0
+			};
+			batchSignals[2 * j] = {
+				.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.pNext       = nullptr,
+				.semaphore   = frame.RenderDone,
+				.value       = 0,
+				.stageMask   = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
+				.deviceIndex = 0
+			};
+			batchSignals[2 * j + 1] = {
+				.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.pNext       = nullptr,
+				.semaphore   = frame.Timeline,
+				.value       = ++frame.TimelineValue,
+				.stageMask   = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT,
+				.deviceIndex = 0
+			};
+			batchSubmits[j] = {
+				.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+				.pNext                    = nullptr,
+				.flags                    = 0,
+				.waitSemaphoreInfoCount   = 1,
+				.pWaitSemaphoreInfos      = &batchWaits[j],
+				.commandBufferInfoCount   = 1,
+				.pCommandBufferInfos      = &batchCmdBufInfos[j],
+				.signalSemaphoreInfoCount = 2,
+				.pSignalSemaphoreInfos    = &batchSignals[2 * j]
+			};
+			batchSwapchains[j] = &swapchains[record.Swapchain];
+			records[j]         = record;
+		}
+
+		if (batchCount)
+		{
+			uint64_t stageStart = FrameTimings::Now();
+			if (VK_VALIDATE(vkQueueSubmit2, Vk::g_Context->Queue, batchCount, batchSubmits, nullptr))
+			{
+				uint64_t stageEnd    = FrameTimings::Now();
+				uint64_t batchSubmit = stageEnd - stageStart;
+				stageStart           = stageEnd;
+
+				bool     presented    = Vk::SwapchainPresentMany(batchSwapchains, batchCount);
+				uint64_t batchPresent = FrameTimings::Now() - stageStart;
+				for (uint32_t j = 0; j < batchCount && presented; ++j)
+				{
+					FrameTimingSample sample {};
+					sample.Frame     = frameIndex;
+					sample.Swapchain = records[j].Swapchain;
+					sample.Set(FrameTimingStage::Wait, waitTime);
+					sample.Set(FrameTimingStage::Acquire, records[j].AcquireTime);
+					sample.Set(FrameTimingStage::Record, records[j].RecordTime);
+					sample.Set(FrameTimingStage::Submit, batchSubmit);
+					sample.Set(FrameTimingStage::Present, batchPresent);
+					if (frameIndex)
+						sample.Set(FrameTimingStage::Frame, deltaTime);
+					timings.Record(sample);
+				}
+			}
+		}
+		Vk::NextFrame();
+		timings.Collect();
+		allocs += Vk::g_Context->FrameAllocations;
+
+		++frameIndex;
+		if (!batchCount && !headless)
+			Wnd::WaitForEvent();
+	}
+	result.Frames     = (int64_t) frameIndex;
+	result.TotalTime  = (FrameTimings::Now() - startTime) * 1e-9;
+	result.RecordTime = recordTime * 1e-9;
+	result.Steals     = pool.Steals();
+	result.Allocs     = allocs;
+	timings.Report();
+	timings.DeInit();
+
+	for (int64_t i = 0; i < numSwapchains; ++i)
+	{
+		auto window = swapchains[i].Window;
+		Vk::DeInitSwapchainState(&swapchains[i]);
+		if (window)
+			Wnd::Destroy(window);
+	}
+	delete[] swapchains;
+
+	pool.DeInit();
+	return true;
+}
+
+void PrintMTMSResult(const MTMSSpec& spec, const MTMSResult& result)
+{
+	if (!result.Frames)
+		return;
+	std::cout << std::format("MTMS {} swapchains, {} threads{}: {} frames in {:.4} s, FrameTime {:.4} us, FPS {:.5}, RecordTime {:.4} us, Steals/Frame {:.3}, Allocs/Frame {:.4}\n",
+							 spec.Swapchains,
+							 spec.Threads,
+							 spec.Headless ? ", headless" : "",
+							 result.Frames,
+							 result.TotalTime,
+							 result.TotalTime / result.Frames * 1e6,
+							 result.Frames / result.TotalTime,
+							 result.RecordTime / result.Frames * 1e6,
+							 result.Steals / (double) result.Frames,
+							 result.Allocs / (double) result.Frames);
+}
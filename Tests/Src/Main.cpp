@@ -1,11 +1,29 @@
+#include <Build.h>
+
 #include <cstdio>
+#include <cstring>
 
 #include <string_view>
 
+#if BUILD_IS_SYSTEM_WINDOWS
 int CSwapVK(size_t argc, const std::string_view* argv);
 int DCompVK(size_t argc, const std::string_view* argv);
+#endif
+int DeviceMemoryTest(size_t argc, const std::string_view* argv);
+#if BUILD_IS_SYSTEM_WINDOWS
 int DXGISwapVK(size_t argc, const std::string_view* argv);
+#endif
+int MTMS(size_t argc, const std::string_view* argv);
+int PipelineCacheBench(size_t argc, const std::string_view* argv);
+int PresentSchedulerBench(size_t argc, const std::string_view* argv);
+int QueueOverlapBench(size_t argc, const std::string_view* argv);
+int RingStress(size_t argc, const std::string_view* argv);
+int SlotMapTest(size_t argc, const std::string_view* argv);
 int STMS(size_t argc, const std::string_view* argv);
+int SwapchainSim(size_t argc, const std::string_view* argv);
+int TLSFBench(size_t argc, const std::string_view* argv);
+int TupleVectorAlgoBench(size_t argc, const std::string_view* argv);
+int TupleVectorBench(size_t argc, const std::string_view* argv);
 
 struct TestSpec
 {
@@ -15,6 +33,7 @@ struct TestSpec
 };
 
 static constexpr TestSpec c_Tests[] {
+#if BUILD_IS_SYSTEM_WINDOWS
 	{
      .Name       = "CSwapVK",
      .Desc       = "Composition Swapchain using Vulkan",
@@ -25,16 +44,74 @@ static constexpr TestSpec c_Tests[] {
      .Desc       = "DirectComposition using Vulkan",
      .Entrypoint = DCompVK,
 	 },
+#endif
+	{
+     .Name       = "DeviceMemoryTest",
+     .Desc       = "Device memory sub-allocator and defragmentation test, runs headless",
+     .Entrypoint = DeviceMemoryTest,
+	 },
+#if BUILD_IS_SYSTEM_WINDOWS
 	{
      .Name       = "DXGISwapVK",
      .Desc       = "DXGI SwapChain using Vulkan",
      .Entrypoint = DXGISwapVK,
 	 },
+#endif
+	{
+     .Name       = "MTMS",
+     .Desc       = "Multi Threaded Multiple Swapchains",
+     .Entrypoint = MTMS,
+	 },
+	{
+     .Name       = "PipelineCacheBench",
+     .Desc       = "Cold versus warm pipeline cache startup benchmark",
+     .Entrypoint = PipelineCacheBench,
+	 },
+	{
+     .Name       = "PresentSchedulerBench",
+     .Desc       = "Dedicated versus shared present thread wakeup benchmark",
+     .Entrypoint = PresentSchedulerBench,
+	 },
+	{
+     .Name       = "QueueOverlapBench",
+     .Desc       = "Single queue versus async compute and transfer queue overlap benchmark",
+     .Entrypoint = QueueOverlapBench,
+	 },
+	{
+     .Name       = "RingStress",
+     .Desc       = "Lock free ring and mailbox stress test",
+     .Entrypoint = RingStress,
+	 },
+	{
+     .Name       = "SlotMapTest",
+     .Desc       = "SlotMap handle and dense storage invariant test",
+     .Entrypoint = SlotMapTest,
+	 },
 	{
      .Name       = "STMS",
      .Desc       = "Single Threaded Multiple Swapchains",
      .Entrypoint = STMS,
 	 },
+	{
+     .Name       = "SwapchainSim",
+     .Desc       = "Composition swapchain state machine on a mock compositor",
+     .Entrypoint = SwapchainSim,
+	 },
+	{
+     .Name       = "TLSFBench",
+     .Desc       = "TLSF versus best fit sub-allocation benchmark",
+     .Entrypoint = TLSFBench,
+	 },
+	{
+     .Name       = "TupleVectorAlgoBench",
+     .Desc       = "TupleVector column algorithm check and unseq versus par_unseq benchmark",
+     .Entrypoint = TupleVectorAlgoBench,
+	 },
+	{
+     .Name       = "TupleVectorBench",
+     .Desc       = "TupleVector append throughput benchmark",
+     .Entrypoint = TupleVectorBench,
+	 },
 };
 
 int main(int argc, char** argv)
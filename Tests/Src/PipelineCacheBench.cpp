@@ -0,0 +1,272 @@
+#include "Shared.h"
+#include "Utils/FrameTimings.h"
+#include "Utils/JobPool.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//
+// Measures startup with a cold and a warm pipeline cache.
+// Every run brings up a headless context on the cache file, creates the same set of compute pipelines and tears the
+// context down again, which writes the cache back. The first run starts without a file, the rest load what it wrote.
+// Pipelines differ in their workgroup size specialization constant, so each one is a separate compile and cache entry.
+//
+
+// #version 450
+// layout(local_size_x_id = 0) in;
+// void main() {}
+static constexpr uint32_t c_ComputeShader[] {
+	0x0723'0203, 0x0001'0000, 0x0000'0000, 10, 0, // Magic, SPIR-V 1.0, generator, id bound, schema
+	0x0002'0011, 1,                              // OpCapability Shader
+	0x0003'000E, 0, 1,                           // OpMemoryModel Logical GLSL450
+	0x0005'000F, 5, 1, 0x6E69'616D, 0x0000'0000, // OpEntryPoint GLCompute %1 "main"
+	0x0006'0010, 1, 17, 1, 1, 1,                 // OpExecutionMode %1 LocalSize 1 1 1
+	0x0004'0047, 7, 1, 0,                        // OpDecorate %7 SpecId 0
+	0x0004'0047, 9, 11, 25,                      // OpDecorate %9 BuiltIn WorkgroupSize
+	0x0002'0013, 2,                              // %2 = OpTypeVoid
+	0x0003'0021, 3, 2,                           // %3 = OpTypeFunction %2
+	0x0004'0015, 5, 32, 0,                       // %5 = OpTypeInt 32 0
+	0x0004'0017, 6, 5, 3,                        // %6 = OpTypeVector %5 3
+	0x0004'0032, 5, 7, 1,                        // %7 = OpSpecConstant %5 1
+	0x0004'002B, 5, 8, 1,                        // %8 = OpConstant %5 1
+	0x0006'0033, 6, 9, 7, 8, 8,                  // %9 = OpSpecConstantComposite %6 %7 %8 %8
+	0x0005'0036, 2, 1, 0, 3,                     // %1 = OpFunction %2 None %3
+	0x0002'00F8, 4,                              // %4 = OpLabel
+	0x0001'00FD,                                 // OpReturn
+	0x0001'0038                                  // OpFunctionEnd
+};
+
+struct PipelineCacheRun
+{
+	uint64_t InitTime    = 0; // ns
+	uint64_t CreateTime  = 0; // ns
+	uint64_t DeInitTime  = 0; // ns, includes writing the cache
+	size_t   LoadedBytes = 0;
+	uint32_t FailedCount = 0;
+};
+
+static bool RunPipelineCache(const std::string& path, const std::string& device, uint32_t pipelineCount, uint32_t threadCount, PipelineCacheRun& run);
+
+int PipelineCacheBench(size_t argc, const std::string_view* argv)
+{
+	std::string path          = "PipelineCacheBench.bin";
+	int64_t     pipelineCount = 256;
+	int64_t     threadCount   = 1;
+	int64_t     warmRuns      = 3;
+	bool        keep          = false;
+	std::string device;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "PipelineCacheBench Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':      Shows this help info\n"
+						 "  '-p' | '--pipelines': Set number of compute pipelines to create per run, default 256, minimum 1\n"
+						 "  '-t' | '--threads':   Set number of threads creating pipelines through the shared cache, default 1, minimum 1\n"
+						 "  '-r' | '--runs':      Set number of warm runs after the cold one, default 3, minimum 1\n"
+						 "  '--path' <path>:      Pipeline cache file, default 'PipelineCacheBench.bin'\n"
+						 "  '--device' <name>:    Use the Vulkan device whose name contains <name> or whose deviceUUID is <name>, default picks the best scoring device\n"
+						 "  '--keep':             Keep the cache file around after the benchmark\n";
+			return 0;
+		}
+		else if (argv[i] == "-p" || argv[i] == "--pipelines")
+		{
+			if (++i >= argc)
+				break;
+			pipelineCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (pipelineCount < 1)
+			{
+				std::cout << "Number of pipelines needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-t" || argv[i] == "--threads")
+		{
+			if (++i >= argc)
+				break;
+			threadCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (threadCount < 1)
+			{
+				std::cout << "Number of threads needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-r" || argv[i] == "--runs")
+		{
+			if (++i >= argc)
+				break;
+			warmRuns = std::strtoll(argv[i].data(), nullptr, 10);
+			if (warmRuns < 1)
+			{
+				std::cout << "Number of warm runs needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--path")
+		{
+			if (++i >= argc)
+				break;
+			path = argv[i];
+		}
+		else if (argv[i] == "--device")
+		{
+			if (++i >= argc)
+				break;
+			device = argv[i];
+		}
+		else if (argv[i] == "--keep")
+		{
+			keep = true;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+
+	std::vector<PipelineCacheRun> runs((size_t) warmRuns + 1);
+	for (size_t i = 0; i < runs.size(); ++i)
+	{
+		if (!RunPipelineCache(path, device, (uint32_t) pipelineCount, (uint32_t) threadCount, runs[i]))
+			return 1;
+		if (i == 0 && !std::filesystem::exists(path, error))
+		{
+			std::cout << "The cold run did not write a pipeline cache, warm runs would be cold as well\n";
+			return 1;
+		}
+	}
+	if (!keep)
+		std::filesystem::remove(path, error);
+
+	std::cout << std::format("PipelineCacheBench, {} pipelines on {} threads, times in ms\n", pipelineCount, threadCount);
+	std::cout << std::format("  {:<6} {:>12} {:>10} {:>10} {:>10} {:>14} {:>8}\n", "Run", "Loaded (KiB)", "Init", "Create", "DeInit", "Per pipeline", "Failed");
+	for (size_t i = 0; i < runs.size(); ++i)
+	{
+		auto& run = runs[i];
+		std::cout << std::format("  {:<6} {:>12.1f} {:>10.3f} {:>10.3f} {:>10.3f} {:>14.2f} {:>8}\n",
+								 i == 0 ? "Cold" : std::format("Warm {}", i),
+								 run.LoadedBytes / 1024.0,
+								 run.InitTime * 1e-6,
+								 run.CreateTime * 1e-6,
+								 run.DeInitTime * 1e-6,
+								 run.CreateTime * 1e-3 / pipelineCount,
+								 run.FailedCount);
+	}
+	uint64_t warmCreateTime = 0;
+	for (size_t i = 1; i < runs.size(); ++i)
+		warmCreateTime += runs[i].CreateTime;
+	if (warmCreateTime)
+		std::cout << std::format("  Warm pipeline creation is {:.2f}x faster than cold\n", runs[0].CreateTime * (double) (runs.size() - 1) / warmCreateTime);
+	return 0;
+}
+
+bool RunPipelineCache(const std::string& path, const std::string& device, uint32_t pipelineCount, uint32_t threadCount, PipelineCacheRun& run)
+{
+	uint64_t initStart = FrameTimings::Now();
+	{
+		Vk::ContextSpec vkSpec {};
+		vkSpec.AppName           = "PipelineCacheBench";
+		vkSpec.AppVersion        = VK_MAKE_API_VERSION(0, 1, 0, 0);
+		vkSpec.Headless          = true; // No swapchains, so no window or surface extensions
+		vkSpec.PipelineCachePath = path.c_str();
+		vkSpec.Device            = device.empty() ? nullptr : device.c_str();
+		if (!Vk::Init(&vkSpec))
+			return false;
+	}
+	run.InitTime    = FrameTimings::Now() - initStart;
+	run.LoadedBytes = Vk::g_Context->PipelineCacheLoaded;
+
+	VkPhysicalDeviceProperties props {};
+	vkGetPhysicalDeviceProperties(Vk::g_Context->PhysicalDevice, &props);
+	uint32_t maxWorkgroupSize = std::min(props.limits.maxComputeWorkGroupSize[0], props.limits.maxComputeWorkGroupInvocations);
+
+	VkShaderModuleCreateInfo smCreateInfo {
+		.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		.pNext    = nullptr,
+		.flags    = 0,
+		.codeSize = sizeof(c_ComputeShader),
+		.pCode    = c_ComputeShader
+	};
+	VkPipelineLayoutCreateInfo plCreateInfo {
+		.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.pNext                  = nullptr,
+		.flags                  = 0,
+		.setLayoutCount         = 0,
+		.pSetLayouts            = nullptr,
+		.pushConstantRangeCount = 0,
+		.pPushConstantRanges    = nullptr
+	};
+	VkShaderModule   shader = nullptr;
+	VkPipelineLayout layout = nullptr;
+	bool             valid  = VK_VALIDATE(vkCreateShaderModule, Vk::g_Context->Device, &smCreateInfo, nullptr, &shader);
+	if (valid)
+		valid = VK_VALIDATE(vkCreatePipelineLayout, Vk::g_Context->Device, &plCreateInfo, nullptr, &layout);
+
+	std::vector<VkPipeline> pipelines(pipelineCount, nullptr);
+	std::atomic_uint32_t    failed = 0;
+	if (valid)
+	{
+		JobPool pool;
+		pool.Init(threadCount);
+
+		uint64_t createStart = FrameTimings::Now();
+		pool.Dispatch(pipelineCount, [&](uint32_t index, [[maybe_unused]] uint32_t worker) {
+			uint32_t                 workgroupSize = index % maxWorkgroupSize + 1;
+			VkSpecializationMapEntry mapEntry {
+				.constantID = 0,
+				.offset     = 0,
+				.size       = sizeof(uint32_t)
+			};
+			VkSpecializationInfo specInfo {
+				.mapEntryCount = 1,
+				.pMapEntries   = &mapEntry,
+				.dataSize      = sizeof(uint32_t),
+				.pData         = &workgroupSize
+			};
+			VkComputePipelineCreateInfo createInfo {
+				.sType              = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+				.pNext              = nullptr,
+				.flags              = 0,
+				.stage              = {
+					.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+					.pNext               = nullptr,
+					.flags               = 0,
+					.stage               = VK_SHADER_STAGE_COMPUTE_BIT,
+					.module              = shader,
+					.pName               = "main",
+					.pSpecializationInfo = &specInfo
+				},
+				.layout             = layout,
+				.basePipelineHandle = nullptr,
+				.basePipelineIndex  = -1
+			};
+			// Every thread passes the context's cache directly, it is internally synchronized
+			if (!VK_VALIDATE(vkCreateComputePipelines, Vk::g_Context->Device, Vk::g_Context->PipelineCache, 1, &createInfo, nullptr, &pipelines[index]))
+				failed.fetch_add(1, std::memory_order_relaxed);
+		});
+		run.CreateTime = FrameTimings::Now() - createStart;
+		pool.DeInit();
+	}
+	run.FailedCount = failed.load(std::memory_order_relaxed);
+
+	for (auto pipeline : pipelines)
+	{
+		if (pipeline)
+			vkDestroyPipeline(Vk::g_Context->Device, pipeline, nullptr);
+	}
+	if (layout)
+		vkDestroyPipelineLayout(Vk::g_Context->Device, layout, nullptr);
+	if (shader)
+		vkDestroyShaderModule(Vk::g_Context->Device, shader, nullptr);
+
+	uint64_t deinitStart = FrameTimings::Now();
+	Vk::DeInit();
+	run.DeInitTime = FrameTimings::Now() - deinitStart;
+	return valid;
+}
@@ -0,0 +1,399 @@
+#include <Build.h>
+
+#include "CSwap/SwapchainStateMachine.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if !BUILD_IS_SYSTEM_WINDOWS
+	#include <sys/resource.h>
+#endif
+
+//
+// Compares the present thread layouts of the composition swapchain without needing a compositor.
+// Dedicated: Every swapchain owns an event thread (retire, rendered) and a clock thread (VBlank), 2N threads in total
+// Shared:    A pool of K threads services the events and VBlanks of every swapchain, like WinCSPresentScheduler
+// App threads render instantly and the GPU completes on present, so the numbers only reflect presentation overhead.
+//
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Futex style event, the emulated counterpart of a Win32 auto reset event
+struct BenchEvent
+{
+public:
+	void Set()
+	{
+		++Sequence;
+		Sequence.notify_all();
+	}
+
+	uint32_t Wait(uint32_t seen)
+	{
+		Sequence.wait(seen);
+		return Sequence.load();
+	}
+
+public:
+	std::atomic_uint32_t Sequence = 0;
+};
+
+struct BenchSwapchain;
+
+// Retires the previously latched buffer like the retire fence does, through the swapchain's signal event
+struct BenchCompositor : public SwapchainCompositor
+{
+	void Present(uint32_t imageIndex) override;
+
+	BenchSwapchain* Swapchain = nullptr;
+	uint32_t        Front     = ~0U;
+};
+
+struct BenchSwapchain
+{
+	SwapchainStateMachine State;
+	BenchCompositor       Compositor;
+	std::atomic_uint64_t  CompletedValues[c_SwapchainMaxBufferCount] {}; // Emulated present fences
+	uint64_t              RenderedValues[c_SwapchainMaxBufferCount] {};  // Values already handed to OnBufferRendered
+	std::atomic_uint32_t  RetiredMask = 0;
+	std::atomic_bool      Signaled    = false;
+	BenchEvent*           SignalEvent = nullptr;
+
+	void Signal()
+	{
+		Signaled = true;
+		SignalEvent->Set();
+	}
+};
+
+void BenchCompositor::Present(uint32_t imageIndex)
+{
+	uint32_t previous = Front;
+	Front             = imageIndex;
+	if (previous == ~0U)
+		return;
+	Swapchain->RetiredMask |= 1U << previous;
+	Swapchain->Signal();
+}
+
+struct PresentSchedulerBenchSpec
+{
+	uint32_t SwapchainCount = 16;
+	uint32_t ThreadCount    = 0; // 0 runs the dedicated layout
+	uint32_t BufferCount    = 3;
+	uint64_t Frames         = 240;
+	uint64_t VBlankTime     = 4'166'667; // ns
+};
+
+struct PresentSchedulerBenchResult
+{
+	uint64_t Frames          = 0;
+	uint64_t ThreadWakeups   = 0; // Returns from a wait on a present thread
+	uint64_t ContextSwitches = 0; // Whole process, ~0ULL if unavailable
+	double   Seconds         = 0.0;
+};
+
+static uint64_t ContextSwitchCount()
+{
+#if BUILD_IS_SYSTEM_WINDOWS
+	return ~0ULL; // Would need NtQuerySystemInformation, every wakeup is at least one switch anyways
+#else
+	rusage usage {};
+	getrusage(RUSAGE_SELF, &usage);
+	return (uint64_t) usage.ru_nvcsw + (uint64_t) usage.ru_nivcsw;
+#endif
+}
+
+// Same polling WinCSServiceSwapchain does, retires first so the app gets its buffers back early
+static void ServiceBenchSwapchain(BenchSwapchain& swapchain)
+{
+	if (!swapchain.Signaled.exchange(false))
+		return;
+
+	uint32_t retired = swapchain.RetiredMask.exchange(0);
+	for (uint32_t i = 0; retired; ++i, retired >>= 1)
+	{
+		if (retired & 1)
+			swapchain.State.OnBufferRetired(i);
+	}
+	for (uint32_t i = 0; i < swapchain.State.BufferCount(); ++i)
+	{
+		if (swapchain.State.BufferState(i) != c_SwapchainBufferWaiting)
+			continue;
+		uint64_t completedValue = swapchain.CompletedValues[i].load();
+		if (completedValue == swapchain.RenderedValues[i] || completedValue < swapchain.State.RenderValue(i))
+			continue;
+		swapchain.RenderedValues[i] = completedValue;
+		swapchain.State.OnBufferRendered(i, completedValue);
+	}
+}
+
+static bool RunPresentSchedulerBench(const PresentSchedulerBenchSpec& spec, PresentSchedulerBenchResult& result)
+{
+	std::vector<std::unique_ptr<BenchSwapchain>> swapchains;
+	swapchains.reserve(spec.SwapchainCount);
+	for (uint32_t i = 0; i < spec.SwapchainCount; ++i)
+	{
+		auto swapchain                  = std::make_unique<BenchSwapchain>();
+		swapchain->Compositor.Swapchain = swapchain.get();
+		SwapchainStateMachineSpec stateSpec {
+			.BufferCount = spec.BufferCount,
+			.PresentMode = SwapchainPresentMode::Fifo,
+			.Compositor  = &swapchain->Compositor,
+			.Clock       = nullptr
+		};
+		if (!swapchain->State.Init(&stateSpec))
+		{
+			std::cout << std::format("Invalid swapchain state with {} buffers\n", spec.BufferCount);
+			return false;
+		}
+		swapchains.emplace_back(std::move(swapchain));
+	}
+
+	bool                    dedicated   = spec.ThreadCount == 0;
+	uint32_t                threadCount = dedicated ? spec.SwapchainCount : spec.ThreadCount;
+	std::vector<BenchEvent> signalEvents(threadCount); // Dedicated: one per swapchain, Shared: one per pool thread
+	for (uint32_t i = 0; i < spec.SwapchainCount; ++i)
+		swapchains[i]->SignalEvent = &signalEvents[i % threadCount];
+
+	BenchEvent           clockEvent;      // Dedicated clock threads wait on this directly
+	std::atomic_uint64_t clockTicks = 0;  // Shared threads are woken through their signal event and compare ticks
+	std::atomic_bool     running    = true;
+	std::atomic_uint64_t wakeups    = 0;
+
+	std::vector<std::thread> presentThreads;
+	if (dedicated)
+	{
+		for (uint32_t i = 0; i < spec.SwapchainCount; ++i)
+		{
+			BenchSwapchain* swapchain = swapchains[i].get();
+			presentThreads.emplace_back([&, swapchain]() {
+				uint64_t localWakeups = 0;
+				uint32_t seen         = 0;
+				while (running.load(std::memory_order_acquire))
+				{
+					seen = swapchain->SignalEvent->Wait(seen);
+					++localWakeups;
+					ServiceBenchSwapchain(*swapchain);
+				}
+				wakeups += localWakeups;
+			});
+			presentThreads.emplace_back([&, swapchain]() {
+				uint64_t localWakeups = 0;
+				uint32_t seen         = 0;
+				while (running.load(std::memory_order_acquire))
+				{
+					seen = clockEvent.Wait(seen);
+					++localWakeups;
+					swapchain->State.OnVBlank();
+				}
+				wakeups += localWakeups;
+			});
+		}
+	}
+	else
+	{
+		for (uint32_t t = 0; t < threadCount; ++t)
+		{
+			presentThreads.emplace_back([&, t]() {
+				BenchEvent& event        = signalEvents[t];
+				uint64_t    localWakeups = 0;
+				uint64_t    seenTicks    = 0;
+				uint32_t    seen         = 0;
+				while (running.load(std::memory_order_acquire))
+				{
+					seen = event.Wait(seen);
+					++localWakeups;
+					for (uint32_t i = t; i < spec.SwapchainCount; i += threadCount)
+						ServiceBenchSwapchain(*swapchains[i]);
+					uint64_t ticks = clockTicks.load();
+					if (ticks == seenTicks)
+						continue;
+					seenTicks = ticks;
+					for (uint32_t i = t; i < spec.SwapchainCount; i += threadCount)
+						swapchains[i]->State.OnVBlank();
+				}
+				wakeups += localWakeups;
+			});
+		}
+	}
+
+	std::atomic_bool clockRunning = true;
+	std::thread      clockThread([&]() {
+		auto next = Clock::now();
+		while (clockRunning.load(std::memory_order_acquire))
+		{
+			next += std::chrono::nanoseconds(spec.VBlankTime);
+			std::this_thread::sleep_until(next);
+			++clockTicks;
+			if (dedicated)
+			{
+				clockEvent.Set();
+			}
+			else
+			{
+				for (auto& event : signalEvents)
+					event.Set();
+			}
+		}
+	});
+
+	uint64_t                 startSwitches = ContextSwitchCount();
+	auto                     start         = Clock::now();
+	std::vector<std::thread> appThreads;
+	for (uint32_t i = 0; i < spec.SwapchainCount; ++i)
+	{
+		BenchSwapchain* swapchain = swapchains[i].get();
+		appThreads.emplace_back([&spec, swapchain]() {
+			auto& state = swapchain->State;
+			for (uint64_t frame = 0; frame < spec.Frames; ++frame)
+			{
+				uint32_t imageIndex = 0;
+				uint64_t waitValue  = 0;
+				while (!state.Acquire(&imageIndex, &waitValue))
+					state.UsableBufferCount().wait(0);
+
+				uint64_t renderValue = 0;
+				state.Present(imageIndex, true, &renderValue);
+				swapchain->CompletedValues[imageIndex] = renderValue; // GPU finished instantly
+				swapchain->Signal();
+			}
+		});
+	}
+	for (auto& thread : appThreads)
+		thread.join();
+	double   seconds     = std::chrono::duration_cast<std::chrono::duration<double>>(Clock::now() - start).count();
+	uint64_t endSwitches = ContextSwitchCount();
+
+	clockRunning = false;
+	clockThread.join();
+	running = false;
+	clockEvent.Set();
+	for (auto& event : signalEvents)
+		event.Set();
+	for (auto& thread : presentThreads)
+		thread.join();
+
+	result.Frames          = spec.Frames * spec.SwapchainCount;
+	result.ThreadWakeups   = wakeups;
+	result.ContextSwitches = startSwitches == ~0ULL ? ~0ULL : endSwitches - startSwitches;
+	result.Seconds         = seconds;
+	return true;
+}
+
+static void PrintBenchResult(const PresentSchedulerBenchSpec& spec, const PresentSchedulerBenchResult& result)
+{
+	std::string layout      = spec.ThreadCount ? std::format("Shared {}", spec.ThreadCount) : std::string("Dedicated");
+	uint32_t    threadCount = spec.ThreadCount ? spec.ThreadCount : 2 * spec.SwapchainCount;
+	double      wakeups     = result.ThreadWakeups / (double) result.Frames;
+	std::string switches    = result.ContextSwitches == ~0ULL ? std::string("n/a") : std::format("{:.3f}", result.ContextSwitches / (double) result.Frames);
+	std::cout << std::format("  {:<10} {:>4} present threads: {:>8.3f} wakeups/frame, {:>8} context switches/frame, {:>8.2f} FPS per swapchain\n",
+							 layout,
+							 threadCount,
+							 wakeups,
+							 switches,
+							 spec.Frames / result.Seconds);
+}
+
+int PresentSchedulerBench(size_t argc, const std::string_view* argv)
+{
+	PresentSchedulerBenchSpec spec {};
+	int64_t                   threadCount = 1;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "PresentSchedulerBench Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':       Shows this help info\n"
+						 "  '-s' | '--swapchains': Set number of swapchains, default 16, minimum 1\n"
+						 "  '-t' | '--threads':    Set number of shared present threads, default 1, minimum 1\n"
+						 "  '-b' | '--buffers':    Set number of buffers per swapchain, default 3\n"
+						 "  '-f' | '--frames':     Set number of frames presented per swapchain, default 240, minimum 1\n"
+						 "  '-r' | '--refresh':    Set emulated compositor refresh rate in Hz, default 240, minimum 1\n";
+			return 0;
+		}
+		else if (argv[i] == "-s" || argv[i] == "--swapchains")
+		{
+			if (++i >= argc)
+				break;
+			int64_t swapchainCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (swapchainCount < 1 || swapchainCount > 1024)
+			{
+				std::cout << "Number of swapchains needs to be between 1 and 1024!\n";
+				return 1;
+			}
+			spec.SwapchainCount = (uint32_t) swapchainCount;
+		}
+		else if (argv[i] == "-t" || argv[i] == "--threads")
+		{
+			if (++i >= argc)
+				break;
+			threadCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (threadCount < 1 || threadCount > 1024)
+			{
+				std::cout << "Number of threads needs to be between 1 and 1024!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-b" || argv[i] == "--buffers")
+		{
+			if (++i >= argc)
+				break;
+			int64_t bufferCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (bufferCount < 2 || bufferCount > c_SwapchainMaxBufferCount)
+			{
+				std::cout << std::format("Number of buffers needs to be between 2 and {}!\n", c_SwapchainMaxBufferCount);
+				return 1;
+			}
+			spec.BufferCount = (uint32_t) bufferCount;
+		}
+		else if (argv[i] == "-f" || argv[i] == "--frames")
+		{
+			if (++i >= argc)
+				break;
+			int64_t frames = std::strtoll(argv[i].data(), nullptr, 10);
+			if (frames < 1)
+			{
+				std::cout << "Number of frames needs to be 1 or higher!\n";
+				return 1;
+			}
+			spec.Frames = (uint64_t) frames;
+		}
+		else if (argv[i] == "-r" || argv[i] == "--refresh")
+		{
+			if (++i >= argc)
+				break;
+			int64_t refresh = std::strtoll(argv[i].data(), nullptr, 10);
+			if (refresh < 1)
+			{
+				std::cout << "Refresh rate needs to be 1 or higher!\n";
+				return 1;
+			}
+			spec.VBlankTime = 1'000'000'000ULL / (uint64_t) refresh;
+		}
+	}
+	spec.ThreadCount = (uint32_t) std::min<int64_t>(threadCount, spec.SwapchainCount);
+
+	std::cout << std::format("PresentSchedulerBench, {} swapchains, {} buffers, {} frames, VBlank {:.3f} ms\n", spec.SwapchainCount, spec.BufferCount, spec.Frames, spec.VBlankTime * 1e-6);
+	for (uint32_t sharedThreads : { 0U, spec.ThreadCount })
+	{
+		PresentSchedulerBenchSpec layoutSpec = spec;
+		layoutSpec.ThreadCount               = sharedThreads;
+
+		PresentSchedulerBenchResult result {};
+		if (!RunPresentSchedulerBench(layoutSpec, result))
+			return 1;
+		PrintBenchResult(layoutSpec, result);
+	}
+	return 0;
+}
@@ -0,0 +1,481 @@
+#include "Shared.h"
+#include "Utils/FrameTimings.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+//
+// Measures how much rendering, async compute and uploads gain from running on separate queues.
+// Every stream is recorded once: graphics clears a render target, compute clears a storage image (clears run on the
+// compute units, so it stands in for a compute pass) and transfer copies a host visible staging buffer to device local
+// memory. Serial submits all three to the graphics queue in one submit, Async submits each to its own queue and waits
+// for all three timelines. Streams touch separate resources, so no submit waits on another.
+//
+
+enum class OverlapMode : uint32_t
+{
+	Graphics, // Graphics stream alone on the graphics queue
+	Compute,  // Compute stream alone on the compute queue
+	Transfer, // Transfer stream alone on the transfer queue
+	Serial,   // All streams in one submit to the graphics queue
+	Async,    // Every stream on its own queue
+	Count
+};
+
+static constexpr const char* c_OverlapModeNames[] { "Graphics", "Compute", "Transfer", "Serial", "Async" };
+
+struct QueueOverlapSpec
+{
+	int64_t     Iterations = 200;
+	int64_t     Clears     = 16;   // Clears per graphics and compute stream
+	int64_t     ImageSize  = 2048; // Width and height of both clear targets
+	int64_t     UploadSize = 64;   // MiB copied by the transfer stream
+	std::string Device;
+};
+
+struct QueueOverlapResources
+{
+	VkImage        RenderImage   = nullptr;
+	VkImage        ComputeImage  = nullptr;
+	VkDeviceMemory RenderMemory  = nullptr;
+	VkDeviceMemory ComputeMemory = nullptr;
+	VkBuffer       Staging       = nullptr;
+	VkBuffer       Upload        = nullptr;
+	VkDeviceMemory StagingMemory = nullptr;
+	VkDeviceMemory UploadMemory  = nullptr;
+
+	VkCommandPool   Pools[Vk::c_QueueTypeCount] {};
+	VkCommandBuffer Serial[Vk::c_QueueTypeCount] {}; // From the graphics pool
+	VkCommandBuffer Async[Vk::c_QueueTypeCount] {};  // From the pool of every stream's own queue
+};
+
+static bool RunQueueOverlap(const QueueOverlapSpec& spec);
+static bool CreateOverlapResources(const QueueOverlapSpec& spec, QueueOverlapResources& resources);
+static void DestroyOverlapResources(QueueOverlapResources& resources);
+static bool RecordClears(VkCommandBuffer cmdBuf, VkImage image, uint32_t clears);
+static bool RecordUpload(VkCommandBuffer cmdBuf, VkBuffer staging, VkBuffer upload, VkDeviceSize size);
+
+int QueueOverlapBench(size_t argc, const std::string_view* argv)
+{
+	QueueOverlapSpec spec {};
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "QueueOverlapBench Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':       Shows this help info\n"
+						 "  '-n' | '--iterations': Set number of timed iterations per mode, default 200, minimum 1\n"
+						 "  '-c' | '--clears':     Set number of clears in the graphics and compute streams, default 16, minimum 1\n"
+						 "  '-s' | '--size':       Set width and height of the cleared images, default 2048, minimum 1\n"
+						 "  '-u' | '--upload':     Set MiB copied by the transfer stream, default 64, minimum 1\n"
+						 "  '--device' <name>:     Use the Vulkan device whose name contains <name> or whose deviceUUID is <name>, default picks the best scoring device\n";
+			return 0;
+		}
+		else if (argv[i] == "-n" || argv[i] == "--iterations")
+		{
+			if (++i >= argc)
+				break;
+			spec.Iterations = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.Iterations < 1)
+			{
+				std::cout << "Number of iterations needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-c" || argv[i] == "--clears")
+		{
+			if (++i >= argc)
+				break;
+			spec.Clears = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.Clears < 1)
+			{
+				std::cout << "Number of clears needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-s" || argv[i] == "--size")
+		{
+			if (++i >= argc)
+				break;
+			spec.ImageSize = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.ImageSize < 1)
+			{
+				std::cout << "Image size needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-u" || argv[i] == "--upload")
+		{
+			if (++i >= argc)
+				break;
+			spec.UploadSize = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.UploadSize < 1)
+			{
+				std::cout << "Upload size needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--device")
+		{
+			if (++i >= argc)
+				break;
+			spec.Device = argv[i];
+		}
+	}
+
+	{
+		Vk::ContextSpec vkSpec {};
+		vkSpec.AppName    = "QueueOverlapBench";
+		vkSpec.AppVersion = VK_MAKE_API_VERSION(0, 1, 0, 0);
+		vkSpec.Headless   = true;
+		vkSpec.Device     = spec.Device.empty() ? nullptr : spec.Device.c_str();
+		if (!Vk::Init(&vkSpec))
+			return 1;
+	}
+	bool success = RunQueueOverlap(spec);
+	Vk::DeInit();
+	return success ? 0 : 1;
+}
+
+bool RunQueueOverlap(const QueueOverlapSpec& spec)
+{
+	for (uint32_t i = 0; i < Vk::c_QueueTypeCount; ++i)
+	{
+		auto& queue = Vk::g_Context->Queues[i];
+		if (queue.Shared && i != (uint32_t) Vk::QueueType::Graphics)
+			std::cout << std::format("{} queue shares the graphics queue, it can not overlap\n", c_OverlapModeNames[i]);
+		else
+			std::cout << std::format("{} queue is family {} index {}\n", c_OverlapModeNames[i], queue.Family, queue.Index);
+	}
+
+	QueueOverlapResources resources {};
+	if (!CreateOverlapResources(spec, resources))
+	{
+		DestroyOverlapResources(resources);
+		return false;
+	}
+
+	FrameTimingHistogram histograms[(size_t) OverlapMode::Count] {};
+	int64_t              warmup  = std::max<int64_t>(spec.Iterations / 10, 1);
+	bool                 success = true;
+	for (uint32_t mode = 0; mode < (uint32_t) OverlapMode::Count && success; ++mode)
+	{
+		for (int64_t i = 0; i < warmup + spec.Iterations && success; ++i)
+		{
+			uint64_t start = FrameTimings::Now();
+
+			uint64_t values[Vk::c_QueueTypeCount] {};
+			switch ((OverlapMode) mode)
+			{
+			case OverlapMode::Graphics:
+			case OverlapMode::Compute:
+			case OverlapMode::Transfer:
+				values[mode] = Vk::SubmitQueue((Vk::QueueType) mode, 1, &resources.Async[mode]);
+				success      = values[mode] != 0;
+				break;
+			case OverlapMode::Serial:
+				values[(uint32_t) Vk::QueueType::Graphics] = Vk::SubmitQueue(Vk::QueueType::Graphics, Vk::c_QueueTypeCount, resources.Serial);
+				success                                    = values[(uint32_t) Vk::QueueType::Graphics] != 0;
+				break;
+			case OverlapMode::Async:
+				for (uint32_t j = 0; j < Vk::c_QueueTypeCount && success; ++j)
+				{
+					values[j] = Vk::SubmitQueue((Vk::QueueType) j, 1, &resources.Async[j]);
+					success   = values[j] != 0;
+				}
+				break;
+			default: break;
+			}
+			for (uint32_t j = 0; j < Vk::c_QueueTypeCount && success; ++j)
+			{
+				if (values[j])
+					success = Vk::WaitQueue((Vk::QueueType) j, values[j]);
+			}
+
+			if (i >= warmup)
+				histograms[mode].Add(FrameTimings::Now() - start);
+		}
+	}
+	if (!success)
+	{
+		// Drain whatever was submitted before the failure so the resources can go
+		vkDeviceWaitIdle(Vk::g_Context->Device);
+		DestroyOverlapResources(resources);
+		return false;
+	}
+	DestroyOverlapResources(resources);
+
+	std::cout << std::format("QueueOverlapBench, {} iterations, {} clears of {}x{}, {} MiB upload, times in ms\n", spec.Iterations, spec.Clears, spec.ImageSize, spec.ImageSize, spec.UploadSize);
+	std::cout << std::format("  {:<10} {:>10} {:>10} {:>10}\n", "Mode", "Mean", "p50", "p99");
+	for (uint32_t mode = 0; mode < (uint32_t) OverlapMode::Count; ++mode)
+	{
+		auto& histogram = histograms[mode];
+		std::cout << std::format("  {:<10} {:>10.3f} {:>10.3f} {:>10.3f}\n",
+								 c_OverlapModeNames[mode],
+								 histogram.Mean() * 1e-6,
+								 histogram.Percentile(0.5) * 1e-6,
+								 histogram.Percentile(0.99) * 1e-6);
+	}
+	double serialTime = histograms[(size_t) OverlapMode::Serial].Mean();
+	double asyncTime  = histograms[(size_t) OverlapMode::Async].Mean();
+	double aloneTime  = histograms[(size_t) OverlapMode::Graphics].Mean() + histograms[(size_t) OverlapMode::Compute].Mean() + histograms[(size_t) OverlapMode::Transfer].Mean();
+	if (asyncTime > 0.0)
+		std::cout << std::format("  Async is {:.2f}x faster than Serial, {:.0f}% of the streams' separate time\n", serialTime / asyncTime, asyncTime * 100.0 / aloneTime);
+	return true;
+}
+
+bool CreateOverlapResources(const QueueOverlapSpec& spec, QueueOverlapResources& resources)
+{
+	VkDevice device = Vk::g_Context->Device;
+
+	// Streams switch queues between modes, concurrent sharing saves ownership transfers when the queues differ in family
+	uint32_t families[Vk::c_QueueTypeCount] {};
+	uint32_t familyCount = 0;
+	for (auto& queue : Vk::g_Context->Queues)
+	{
+		bool known = false;
+		for (uint32_t i = 0; i < familyCount && !known; ++i)
+			known = families[i] == queue.Family;
+		if (!known)
+			families[familyCount++] = queue.Family;
+	}
+	VkSharingMode sharingMode = familyCount > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+
+	VkImageCreateInfo iCreateInfo {
+		.sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+		.pNext                 = nullptr,
+		.flags                 = 0,
+		.imageType             = VK_IMAGE_TYPE_2D,
+		.format                = VK_FORMAT_R8G8B8A8_UNORM,
+		.extent                = { (uint32_t) spec.ImageSize, (uint32_t) spec.ImageSize, 1 },
+		.mipLevels             = 1,
+		.arrayLayers           = 1,
+		.samples               = VK_SAMPLE_COUNT_1_BIT,
+		.tiling                = VK_IMAGE_TILING_OPTIMAL,
+		.usage                 = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+		.sharingMode           = sharingMode,
+		.queueFamilyIndexCount = familyCount > 1 ? familyCount : 0,
+		.pQueueFamilyIndices   = familyCount > 1 ? families : nullptr,
+		.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
+	};
+	VkBufferCreateInfo bCreateInfo {
+		.sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		.pNext                 = nullptr,
+		.flags                 = 0,
+		.size                  = (VkDeviceSize) spec.UploadSize << 20,
+		.usage                 = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		.sharingMode           = sharingMode,
+		.queueFamilyIndexCount = familyCount > 1 ? familyCount : 0,
+		.pQueueFamilyIndices   = familyCount > 1 ? families : nullptr
+	};
+	VkMemoryAllocateInfo allocInfo {
+		.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.pNext           = nullptr,
+		.allocationSize  = 0,
+		.memoryTypeIndex = 0
+	};
+	VkMemoryRequirements requirements {};
+
+	VK_INVALID(vkCreateImage, device, &iCreateInfo, nullptr, &resources.RenderImage)
+	{
+		return false;
+	}
+	iCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	VK_INVALID(vkCreateImage, device, &iCreateInfo, nullptr, &resources.ComputeImage)
+	{
+		return false;
+	}
+	VK_INVALID(vkCreateBuffer, device, &bCreateInfo, nullptr, &resources.Staging)
+	{
+		return false;
+	}
+	bCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	VK_INVALID(vkCreateBuffer, device, &bCreateInfo, nullptr, &resources.Upload)
+	{
+		return false;
+	}
+
+	struct Binding
+	{
+		VkImage               Image;
+		VkBuffer              Buffer;
+		VkDeviceMemory*       Memory;
+		VkMemoryPropertyFlags Flags;
+	};
+	Binding bindings[] {
+		{ resources.RenderImage, nullptr, &resources.RenderMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT },
+		{ resources.ComputeImage, nullptr, &resources.ComputeMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT },
+		{ nullptr, resources.Staging, &resources.StagingMemory, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT },
+		{ nullptr, resources.Upload, &resources.UploadMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT }
+	};
+	for (auto& binding : bindings)
+	{
+		if (binding.Image)
+			vkGetImageMemoryRequirements(device, binding.Image, &requirements);
+		else
+			vkGetBufferMemoryRequirements(device, binding.Buffer, &requirements);
+		allocInfo.allocationSize  = requirements.size;
+		allocInfo.memoryTypeIndex = Vk::FindDeviceMemoryIndex(requirements.memoryTypeBits, binding.Flags);
+		if (allocInfo.memoryTypeIndex == ~0U)
+		{
+			std::cout << "Failed to find memory for the benchmark resources\n";
+			return false;
+		}
+		VK_INVALID(vkAllocateMemory, device, &allocInfo, nullptr, binding.Memory)
+		{
+			return false;
+		}
+		bool bound = binding.Image ? VK_VALIDATE(vkBindImageMemory, device, binding.Image, *binding.Memory, 0)
+								   : VK_VALIDATE(vkBindBufferMemory, device, binding.Buffer, *binding.Memory, 0);
+		if (!bound)
+			return false;
+	}
+
+	VkCommandPoolCreateInfo pCreateInfo {
+		.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.pNext            = nullptr,
+		.flags            = 0,
+		.queueFamilyIndex = 0
+	};
+	VkCommandBufferAllocateInfo cbAllocInfo {
+		.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.pNext              = nullptr,
+		.commandPool        = nullptr,
+		.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandBufferCount = 1
+	};
+	for (uint32_t i = 0; i < Vk::c_QueueTypeCount; ++i)
+	{
+		pCreateInfo.queueFamilyIndex = Vk::g_Context->Queues[i].Family;
+		VK_INVALID(vkCreateCommandPool, device, &pCreateInfo, nullptr, &resources.Pools[i])
+		{
+			return false;
+		}
+		cbAllocInfo.commandPool = resources.Pools[i];
+		VK_INVALID(vkAllocateCommandBuffers, device, &cbAllocInfo, &resources.Async[i])
+		{
+			return false;
+		}
+	}
+	cbAllocInfo.commandPool        = resources.Pools[(uint32_t) Vk::QueueType::Graphics];
+	cbAllocInfo.commandBufferCount = Vk::c_QueueTypeCount;
+	VK_INVALID(vkAllocateCommandBuffers, device, &cbAllocInfo, resources.Serial)
+	{
+		return false;
+	}
+
+	// Command buffers are recorded once and resubmitted, every iteration waits for the previous one
+	VkDeviceSize uploadSize = (VkDeviceSize) spec.UploadSize << 20;
+	for (auto cmdBufs : { resources.Serial, resources.Async })
+	{
+		if (!RecordClears(cmdBufs[(uint32_t) Vk::QueueType::Graphics], resources.RenderImage, (uint32_t) spec.Clears) ||
+			!RecordClears(cmdBufs[(uint32_t) Vk::QueueType::Compute], resources.ComputeImage, (uint32_t) spec.Clears) ||
+			!RecordUpload(cmdBufs[(uint32_t) Vk::QueueType::Transfer], resources.Staging, resources.Upload, uploadSize))
+			return false;
+	}
+	return true;
+}
+
+void DestroyOverlapResources(QueueOverlapResources& resources)
+{
+	VkDevice device = Vk::g_Context->Device;
+	for (auto pool : resources.Pools)
+	{
+		if (pool)
+			vkDestroyCommandPool(device, pool, nullptr);
+	}
+	if (resources.RenderImage)
+		vkDestroyImage(device, resources.RenderImage, nullptr);
+	if (resources.ComputeImage)
+		vkDestroyImage(device, resources.ComputeImage, nullptr);
+	if (resources.Staging)
+		vkDestroyBuffer(device, resources.Staging, nullptr);
+	if (resources.Upload)
+		vkDestroyBuffer(device, resources.Upload, nullptr);
+	for (auto memory : { resources.RenderMemory, resources.ComputeMemory, resources.StagingMemory, resources.UploadMemory })
+	{
+		if (memory)
+			vkFreeMemory(device, memory, nullptr);
+	}
+	resources = {};
+}
+
+bool RecordClears(VkCommandBuffer cmdBuf, VkImage image, uint32_t clears)
+{
+	VkCommandBufferBeginInfo beginInfo {
+		.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext            = nullptr,
+		.flags            = 0,
+		.pInheritanceInfo = nullptr
+	};
+	VkImageMemoryBarrier2 imageBarrier {
+		.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+		.pNext               = nullptr,
+		.srcStageMask        = VK_PIPELINE_STAGE_2_NONE,
+		.srcAccessMask       = VK_ACCESS_2_NONE,
+		.dstStageMask        = VK_PIPELINE_STAGE_2_CLEAR_BIT,
+		.dstAccessMask       = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
+		.newLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.image               = image,
+		.subresourceRange    = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+	};
+	VkDependencyInfo depInfo {
+		.sType                    = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+		.pNext                    = nullptr,
+		.dependencyFlags          = 0,
+		.memoryBarrierCount       = 0,
+		.pMemoryBarriers          = nullptr,
+		.bufferMemoryBarrierCount = 0,
+		.pBufferMemoryBarriers    = nullptr,
+		.imageMemoryBarrierCount  = 1,
+		.pImageMemoryBarriers     = &imageBarrier
+	};
+	VkImageSubresourceRange range { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	VK_INVALID(vkBeginCommandBuffer, cmdBuf, &beginInfo)
+	{
+		return false;
+	}
+	vkCmdPipelineBarrier2(cmdBuf, &depInfo);
+	// Every clear waits for the previous one, so the stream is as long as its clear count
+	imageBarrier.srcStageMask  = VK_PIPELINE_STAGE_2_CLEAR_BIT;
+	imageBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	imageBarrier.oldLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	for (uint32_t i = 0; i < clears; ++i)
+	{
+		if (i > 0)
+			vkCmdPipelineBarrier2(cmdBuf, &depInfo);
+		float             shade = (float) (i + 1) / (float) clears;
+		VkClearColorValue color { .float32 = { shade, 1.0f - shade, 0.5f, 1.0f } };
+		vkCmdClearColorImage(cmdBuf, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &color, 1, &range);
+	}
+	return VK_VALIDATE(vkEndCommandBuffer, cmdBuf);
+}
+
+bool RecordUpload(VkCommandBuffer cmdBuf, VkBuffer staging, VkBuffer upload, VkDeviceSize size)
+{
+	VkCommandBufferBeginInfo beginInfo {
+		.sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext            = nullptr,
+		.flags            = 0,
+		.pInheritanceInfo = nullptr
+	};
+	VkBufferCopy region {
+		.srcOffset = 0,
+		.dstOffset = 0,
+		.size      = size
+	};
+	VK_INVALID(vkBeginCommandBuffer, cmdBuf, &beginInfo)
+	{
+		return false;
+	}
+	vkCmdCopyBuffer(cmdBuf, staging, upload, 1, &region);
+	return VK_VALIDATE(vkEndCommandBuffer, cmdBuf);
+}
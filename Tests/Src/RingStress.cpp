@@ -0,0 +1,230 @@
+#include "Utils/Ring.h"
+
+#include <cstdlib>
+
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::high_resolution_clock;
+
+static constexpr size_t   c_RingCapacity  = 64;
+static constexpr uint32_t c_MailboxEmpty  = ~0U;
+static constexpr int      c_ProducerShift = 40;
+
+static double SecondsSince(Clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::duration<double>>(Clock::now() - start).count();
+}
+
+static bool StressSPSC(int64_t count)
+{
+	SPSCRing<uint64_t, c_RingCapacity> ring;
+
+	auto        start = Clock::now();
+	std::thread producer([&]() {
+		for (int64_t i = 0; i < count; ++i)
+		{
+			while (!ring.try_push((uint64_t) i))
+				std::this_thread::yield();
+		}
+	});
+
+	bool     ordered  = true;
+	uint64_t expected = 0;
+	while (expected < (uint64_t) count)
+	{
+		uint64_t value;
+		if (!ring.try_pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		if (value != expected)
+			ordered = false;
+		++expected;
+	}
+	producer.join();
+	double seconds = SecondsSince(start);
+
+	if (!ordered || !ring.empty())
+	{
+		std::cout << "SPSCRing delivered values out of order\n";
+		return false;
+	}
+	std::cout << std::format("  {:<10} {:>10} items {:>10.3f} ms {:>8.2f} Mitems/s\n", "SPSCRing", count, seconds * 1e3, count / seconds * 1e-6);
+	return true;
+}
+
+static bool StressMPSC(int64_t producers, int64_t count)
+{
+	MPSCRing<uint64_t, c_RingCapacity> ring;
+
+	auto                     start = Clock::now();
+	std::vector<std::thread> threads;
+	threads.reserve((size_t) producers);
+	for (int64_t p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&ring, p, count]() {
+			for (int64_t i = 0; i < count; ++i)
+			{
+				while (!ring.try_push((uint64_t) p << c_ProducerShift | (uint64_t) i))
+					std::this_thread::yield();
+			}
+		});
+	}
+
+	// Values from a single producer must arrive in the order they were pushed
+	std::vector<uint64_t> nextExpected((size_t) producers, 0);
+	bool                  ordered = true;
+	int64_t               total   = producers * count;
+	for (int64_t received = 0; received < total;)
+	{
+		uint64_t value;
+		if (!ring.try_pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		uint64_t producer = value >> c_ProducerShift;
+		uint64_t index    = value & ((1ULL << c_ProducerShift) - 1);
+		if (producer >= (uint64_t) producers || nextExpected[producer] != index)
+			ordered = false;
+		else
+			++nextExpected[producer];
+		++received;
+	}
+	for (auto& thread : threads)
+		thread.join();
+	double seconds = SecondsSince(start);
+
+	if (!ordered || !ring.empty())
+	{
+		std::cout << "MPSCRing lost, duplicated or reordered values\n";
+		return false;
+	}
+	std::cout << std::format("  {:<10} {:>10} items {:>10.3f} ms {:>8.2f} Mitems/s ({} producers)\n", "MPSCRing", total, seconds * 1e3, total / seconds * 1e-6, producers);
+	return true;
+}
+
+static bool StressMailbox(int64_t producers, int64_t count)
+{
+	AtomicMailbox<uint32_t, c_MailboxEmpty> mailbox;
+
+	// Every posted value is either taken by the consumer or handed back to exactly one producer as replaced
+	std::atomic_uint64_t replaced = 0;
+	std::atomic_bool     done     = false;
+
+	auto                     start = Clock::now();
+	std::vector<std::thread> threads;
+	threads.reserve((size_t) producers);
+	for (int64_t p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&, p]() {
+			uint64_t localReplaced = 0;
+			for (int64_t i = 0; i < count; ++i)
+			{
+				if (mailbox.exchange((uint32_t) (p * count + i)) != c_MailboxEmpty)
+					++localReplaced;
+			}
+			replaced += localReplaced;
+		});
+	}
+	std::thread consumer([&]() {
+		uint64_t taken = 0;
+		while (!done.load(std::memory_order_acquire))
+		{
+			if (mailbox.take() != c_MailboxEmpty)
+				++taken;
+		}
+		if (mailbox.take() != c_MailboxEmpty)
+			++taken;
+		replaced += taken;
+	});
+	for (auto& thread : threads)
+		thread.join();
+	done = true;
+	consumer.join();
+	double seconds = SecondsSince(start);
+
+	int64_t total = producers * count;
+	if (replaced != (uint64_t) total || !mailbox.empty())
+	{
+		std::cout << std::format("AtomicMailbox accounted for {} of {} values\n", replaced.load(), total);
+		return false;
+	}
+	std::cout << std::format("  {:<10} {:>10} items {:>10.3f} ms {:>8.2f} Mitems/s ({} producers)\n", "Mailbox", total, seconds * 1e3, total / seconds * 1e-6, producers);
+	return true;
+}
+
+int RingStress(size_t argc, const std::string_view* argv)
+{
+	int64_t numItems     = 1'000'000;
+	int64_t numProducers = 4;
+	int64_t numRounds    = 1;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "RingStress Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':      Shows this help info\n"
+						 "  '-n' | '--items':     Set number of items pushed per producer, default 1000000, minimum 1\n"
+						 "  '-p' | '--producers': Set number of producer threads for MPSCRing and AtomicMailbox, default 4, minimum 1\n"
+						 "  '-r' | '--rounds':    Set number of times every stress test is repeated, default 1, minimum 1\n";
+			return 0;
+		}
+		else if (argv[i] == "-n" || argv[i] == "--items")
+		{
+			if (++i >= argc)
+				break;
+			numItems = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numItems < 1 || numItems >= (1LL << c_ProducerShift))
+			{
+				std::cout << "Number of items needs to be between 1 and 2^40!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-p" || argv[i] == "--producers")
+		{
+			if (++i >= argc)
+				break;
+			numProducers = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numProducers < 1 || numProducers > 1024)
+			{
+				std::cout << "Number of producers needs to be between 1 and 1024!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-r" || argv[i] == "--rounds")
+		{
+			if (++i >= argc)
+				break;
+			numRounds = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numRounds < 1)
+			{
+				std::cout << "Number of rounds needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+	}
+	if (numProducers * numItems >= (int64_t) c_MailboxEmpty)
+	{
+		std::cout << "Producers times items needs to fit in 32 bits for the mailbox test!\n";
+		return 1;
+	}
+
+	for (int64_t round = 0; round < numRounds; ++round)
+	{
+		std::cout << std::format("Round {}\n", round);
+		if (!StressSPSC(numItems) ||
+			!StressMPSC(numProducers, numItems) ||
+			!StressMailbox(numProducers, numItems))
+			return 1;
+	}
+	return 0;
+}
@@ -1,10 +1,11 @@
 #include "Shared.h"
+#include "Utils/FrameTimings.h"
 #include "Utils/TupleVector.h"
 
 #include <cstdlib>
 
-#include <chrono>
 #include <iostream>
+#include <string>
 
 static constexpr const char* c_InstanceExtensions[] {
 	VK_KHR_SURFACE_EXTENSION_NAME,
@@ -16,19 +17,75 @@ static constexpr const char* c_DeviceExtensions[] {
 	nullptr
 };
 
+static constexpr int64_t c_DefaultHeadlessFrameCount = 1000;
+static constexpr int64_t c_SweepSwapchainCounts[]    = { 1, 4, 16, 64 };
+
+static constexpr const char* c_PacingModeNames[] = { "throughput", "latency" };
+
+struct STMSSpec
+{
+	int64_t        Swapchains    = 4;
+	int64_t        FrameCount    = 0;     // Zero renders until the windows are closed
+	bool           Headless      = false;
+	bool           Batch         = false; // One vkQueueSubmit2 and one vkQueuePresentKHR for every swapchain
+	bool           Sweep         = false;
+	bool           Pace          = false; // Start frames through a Vk::FramePacer
+	Vk::PacingMode Pacing        = Vk::PacingMode::Throughput;
+	int64_t        LatencyTarget = 20;    // ms
+	std::string    TimingsPath;
+
+	Vk::SwapchainPolicySpec Present;
+	int64_t                 SwitchInterval = 0; // Frames between flipping Present.Preference, zero never switches
+};
+
+struct STMSResult
+{
+	int64_t Frames      = 0;
+	double  TotalTime   = 0.0; // s
+	double  SubmitTime  = 0.0; // s spent in vkQueueSubmit2
+	double  PresentTime = 0.0; // s spent presenting
+	double  LatencyMean = 0.0; // ms from frame start to GPU completion, only measured when paced
+	double  LatencyP50  = 0.0; // ms
+	double  LatencyP99  = 0.0; // ms
+	double  DelayTime   = 0.0; // s the pacer spent delaying frame starts
+
+	VkPresentModeKHR PresentMode = VK_PRESENT_MODE_FIFO_KHR; // First swapchain's selection at exit
+	uint32_t         ImageCount  = 0;
+	int64_t          Switches    = 0; // Policy switches that recreated a swapchain
+	uint64_t         Allocs      = 0; // Heap allocations over every frame
+};
+
+static const char* PresentModeName(VkPresentModeKHR mode);
+static bool        RunSTMS(const STMSSpec& spec, STMSResult& result);
+static void PrintSTMSResult(const STMSSpec& spec, const STMSResult& result);
+
 int STMS(size_t argc, const std::string_view* argv)
 {
-	int64_t numFramesInFlight = 1;
-	int64_t numSwapchains     = 4;
+	STMSSpec    spec {};
+	int64_t     numFramesInFlight = 1;
+	std::string device;
+	bool        comparePacing = false;
 	for (size_t i = 1; i < argc; ++i)
 	{
 		if (argv[i] == "-h" || argv[i] == "--help")
 		{
 			std::cout << "STMS Help\n"
 						 "Options:\n"
-						 "  '-h' | '--help':       Shows this help info\n"
-						 "  '-f' | '--frames':     Set number of frames in flight, default 1, minimum 1\n"
-						 "  '-s' | '--swapchains': Set number of swapchains to create, default 4, minimum 1\n";
+						 "  '-h' | '--help':        Shows this help info\n"
+						 "  '-f' | '--frames':      Set number of frames in flight, default 1, minimum 1\n"
+						 "  '-s' | '--swapchains':  Set number of swapchains to create, default 4, minimum 1\n"
+						 "  '-n' | '--frame-count': Exit after rendering this many frames and print the averages, default runs until closed, or 1000 when headless or sweeping\n"
+						 "  '-b' | '--batch':       Submit and present every swapchain with one vkQueueSubmit2 and one vkQueuePresentKHR\n"
+						 "  '--sweep':              Run 1, 4, 16 and 64 swapchains both one by one and batched, then compare the frame times\n"
+						 "  '--headless':           Render to offscreen images without any windows, works with software drivers like lavapipe\n"
+						 "  '--device' <name>:      Use the Vulkan device whose name contains <name> or whose deviceUUID is <name>, default picks the best scoring device\n"
+						 "  '--timings' <path>:     Write per frame timings to '<path>.csv' and the percentiles to '<path>.json' at exit\n"
+						 "  '--pacing' <mode>:      Pace frame starts with 'throughput', 'latency' to stay near the latency target, or 'compare' to run both, default unpaced\n"
+						 "  '--target' <ms>:        Set the latency target of '--pacing latency', default 20, minimum 1\n"
+						 "  '--present' <pref>:     Pick present mode and image count for 'latency' or 'throughput', default latency\n"
+						 "  '--mode' <mode>:        Use 'immediate', 'mailbox', 'fifo' or 'relaxed' when the surface supports it, default picked by '--present'\n"
+						 "  '--images' <count>:     Set number of swapchain images, clamped to the surface limits, default picked by '--present'\n"
+						 "  '--switch' <frames>:    Flip the present preference every this many frames to measure runtime switching, default never\n";
 			return 0;
 		}
 		else if (argv[i] == "-f" || argv[i] == "--frames")
@@ -46,54 +103,318 @@ int STMS(size_t argc, const std::string_view* argv)
 		{
 			if (++i >= argc)
 				break;
-			numSwapchains = std::strtoll(argv[i].data(), nullptr, 10);
-			if (numSwapchains < 1)
+			spec.Swapchains = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.Swapchains < 1)
 			{
 				std::cout << "Number of swapchains needs to be 1 or higher!\n";
 				return 1;
 			}
 		}
+		else if (argv[i] == "-n" || argv[i] == "--frame-count")
+		{
+			if (++i >= argc)
+				break;
+			spec.FrameCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.FrameCount < 1)
+			{
+				std::cout << "Frame count needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-b" || argv[i] == "--batch")
+		{
+			spec.Batch = true;
+		}
+		else if (argv[i] == "--sweep")
+		{
+			spec.Sweep = true;
+		}
+		else if (argv[i] == "--headless")
+		{
+			spec.Headless = true;
+		}
+		else if (argv[i] == "--device")
+		{
+			if (++i >= argc)
+				break;
+			device = argv[i];
+		}
+		else if (argv[i] == "--timings")
+		{
+			if (++i >= argc)
+				break;
+			spec.TimingsPath = argv[i];
+		}
+		else if (argv[i] == "--pacing")
+		{
+			if (++i >= argc)
+				break;
+			if (argv[i] == "throughput")
+			{
+				spec.Pacing = Vk::PacingMode::Throughput;
+			}
+			else if (argv[i] == "latency")
+			{
+				spec.Pacing = Vk::PacingMode::Latency;
+			}
+			else if (argv[i] == "compare")
+			{
+				comparePacing = true;
+			}
+			else
+			{
+				std::cout << "Pacing needs to be throughput, latency or compare!\n";
+				return 1;
+			}
+			spec.Pace = true;
+		}
+		else if (argv[i] == "--target")
+		{
+			if (++i >= argc)
+				break;
+			spec.LatencyTarget = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.LatencyTarget < 1)
+			{
+				std::cout << "Latency target needs to be 1 ms or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--present")
+		{
+			if (++i >= argc)
+				break;
+			if (argv[i] == "latency")
+			{
+				spec.Present.Preference = Vk::PresentPreference::Latency;
+			}
+			else if (argv[i] == "throughput")
+			{
+				spec.Present.Preference = Vk::PresentPreference::Throughput;
+			}
+			else
+			{
+				std::cout << "Present preference needs to be latency or throughput!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--mode")
+		{
+			if (++i >= argc)
+				break;
+			if (argv[i] == "immediate")
+			{
+				spec.Present.PresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			}
+			else if (argv[i] == "mailbox")
+			{
+				spec.Present.PresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+			}
+			else if (argv[i] == "fifo")
+			{
+				spec.Present.PresentMode = VK_PRESENT_MODE_FIFO_KHR;
+			}
+			else if (argv[i] == "relaxed")
+			{
+				spec.Present.PresentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+			}
+			else
+			{
+				std::cout << "Present mode needs to be immediate, mailbox, fifo or relaxed!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--images")
+		{
+			if (++i >= argc)
+				break;
+			int64_t imageCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (imageCount < 1)
+			{
+				std::cout << "Number of swapchain images needs to be 1 or higher!\n";
+				return 1;
+			}
+			spec.Present.ImageCount = (uint32_t) imageCount;
+		}
+		else if (argv[i] == "--switch")
+		{
+			if (++i >= argc)
+				break;
+			spec.SwitchInterval = std::strtoll(argv[i].data(), nullptr, 10);
+			if (spec.SwitchInterval < 1)
+			{
+				std::cout << "Switch interval needs to be 1 frame or higher!\n";
+				return 1;
+			}
+		}
 	}
+	if (comparePacing && spec.Sweep)
+	{
+		std::cout << "'--pacing compare' and '--sweep' can't be combined!\n";
+		return 1;
+	}
+	if ((spec.Headless || spec.Sweep || comparePacing) && !spec.FrameCount)
+		spec.FrameCount = c_DefaultHeadlessFrameCount;
 
+	if (!spec.Headless)
 	{
-		Wnd::ContextSpec spec {};
-		spec.SeparateThread = false;
-		if (!Wnd::Init(&spec))
+		Wnd::ContextSpec wndSpec {};
+		wndSpec.SeparateThread = false;
+		if (!Wnd::Init(&wndSpec))
 			return 1;
 	}
 	{
-		Vk::ContextSpec spec {};
-		spec.AppName          = "STMS";
-		spec.AppVersion       = VK_MAKE_API_VERSION(0, 1, 0, 0);
-		spec.InstanceExtCount = (uint32_t) (sizeof(c_InstanceExtensions) / sizeof(*c_InstanceExtensions) - 1);
-		spec.InstanceExts     = c_InstanceExtensions;
-		spec.DeviceExtCount   = (uint32_t) (sizeof(c_DeviceExtensions) / sizeof(*c_DeviceExtensions) - 1);
-		spec.DeviceExts       = c_DeviceExtensions;
-		spec.FramesInFlight   = (uint32_t) numFramesInFlight;
-		if (!Vk::Init(&spec))
-		{
-			Wnd::DeInit();
+		Vk::ContextSpec vkSpec {};
+		vkSpec.AppName          = "STMS";
+		vkSpec.AppVersion       = VK_MAKE_API_VERSION(0, 1, 0, 0);
+		vkSpec.InstanceExtCount = spec.Headless ? 0 : (uint32_t) (sizeof(c_InstanceExtensions) / sizeof(*c_InstanceExtensions) - 1);
+		vkSpec.InstanceExts     = spec.Headless ? nullptr : c_InstanceExtensions;
+		vkSpec.DeviceExtCount   = (uint32_t) (sizeof(c_DeviceExtensions) / sizeof(*c_DeviceExtensions) - 1); // Still needed for VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+		vkSpec.DeviceExts       = c_DeviceExtensions;
+		vkSpec.FramesInFlight   = (uint32_t) numFramesInFlight;
+		vkSpec.Headless         = spec.Headless;
+		vkSpec.Device           = device.empty() ? nullptr : device.c_str();
+		if (!Vk::Init(&vkSpec))
+		{
+			if (!spec.Headless)
+				Wnd::DeInit();
 			return 1;
 		}
 	}
 
-	Vk::SwapchainState* swapchains = new Vk::SwapchainState[numSwapchains];
+	int exitCode = 0;
+	if (spec.Sweep)
+	{
+		constexpr size_t c_SweepCount = sizeof(c_SweepSwapchainCounts) / sizeof(*c_SweepSwapchainCounts);
+
+		STMSResult results[c_SweepCount][2] {};
+		size_t     completed = 0;
+		for (size_t i = 0; i < c_SweepCount && !exitCode; ++i)
+		{
+			for (int batch = 0; batch < 2; ++batch)
+			{
+				STMSSpec runSpec   = spec;
+				runSpec.Swapchains = c_SweepSwapchainCounts[i];
+				runSpec.Batch      = batch != 0;
+				if (!spec.TimingsPath.empty())
+					runSpec.TimingsPath = std::format("{}-{}-{}", spec.TimingsPath, runSpec.Swapchains, runSpec.Batch ? "batch" : "serial");
+				if (!RunSTMS(runSpec, results[i][batch]))
+				{
+					exitCode = 1;
+					break;
+				}
+				PrintSTMSResult(runSpec, results[i][batch]);
+			}
+			if (!exitCode)
+				completed = i + 1;
+			if (!spec.Headless && Wnd::QuitSignaled())
+				break;
+		}
+
+		// Per frame cost of both modes, Submit+Present is what batching is meant to cut down on
+		std::cout << std::format("STMS sweep, {} frames in flight{}, times in us per frame\n", numFramesInFlight, spec.Headless ? ", headless" : "");
+		std::cout << std::format("  {:>10} {:>12} {:>12} {:>22} {:>22}\n", "Swapchains", "Serial", "Batched", "Serial Submit+Present", "Batched Submit+Present");
+		for (size_t i = 0; i < completed; ++i)
+		{
+			auto& serial  = results[i][0];
+			auto& batched = results[i][1];
+			if (!serial.Frames || !batched.Frames)
+				continue;
+			std::cout << std::format("  {:>10} {:>12.2f} {:>12.2f} {:>22.2f} {:>22.2f}\n",
+									 c_SweepSwapchainCounts[i],
+									 serial.TotalTime / serial.Frames * 1e6,
+									 batched.TotalTime / batched.Frames * 1e6,
+									 (serial.SubmitTime + serial.PresentTime) / serial.Frames * 1e6,
+									 (batched.SubmitTime + batched.PresentTime) / batched.Frames * 1e6);
+		}
+	}
+	else if (comparePacing)
+	{
+		// Same workload under both modes, latency pacing should give up little FPS for a much shorter frame start to GPU completion
+		constexpr uint32_t c_PacingModeCount = (uint32_t) Vk::PacingMode::Count;
+
+		STMSResult results[c_PacingModeCount] {};
+		for (uint32_t mode = 0; mode < c_PacingModeCount; ++mode)
+		{
+			STMSSpec runSpec = spec;
+			runSpec.Pacing   = (Vk::PacingMode) mode;
+			if (!spec.TimingsPath.empty())
+				runSpec.TimingsPath = std::format("{}-{}", spec.TimingsPath, c_PacingModeNames[mode]);
+			if (!RunSTMS(runSpec, results[mode]))
+			{
+				exitCode = 1;
+				break;
+			}
+			PrintSTMSResult(runSpec, results[mode]);
+			if (!spec.Headless && Wnd::QuitSignaled())
+				break;
+		}
+
+		std::cout << std::format("STMS pacing, {} swapchains, {} frames in flight, {} ms latency target{}\n", spec.Swapchains, numFramesInFlight, spec.LatencyTarget, spec.Headless ? ", headless" : "");
+		std::cout << std::format("  {:>10} {:>10} {:>14} {:>14} {:>14} {:>16}\n", "Mode", "FPS", "Latency mean", "Latency p50", "Latency p99", "Delayed/Frame");
+		for (uint32_t mode = 0; mode < c_PacingModeCount; ++mode)
+		{
+			auto& result = results[mode];
+			if (!result.Frames)
+				continue;
+			std::cout << std::format("  {:>10} {:>10.1f} {:>11.3f} ms {:>11.3f} ms {:>11.3f} ms {:>13.2f} us\n",
+									 c_PacingModeNames[mode],
+									 result.Frames / result.TotalTime,
+									 result.LatencyMean,
+									 result.LatencyP50,
+									 result.LatencyP99,
+									 result.DelayTime / result.Frames * 1e6);
+		}
+	}
+	else
+	{
+		STMSResult result {};
+		if (RunSTMS(spec, result))
+		{
+			if (spec.FrameCount)
+				PrintSTMSResult(spec, result);
+		}
+		else
+		{
+			exitCode = 1;
+		}
+	}
+
+	Vk::DeInit();
+	if (!spec.Headless)
+		Wnd::DeInit();
+	return exitCode;
+}
+
+bool RunSTMS(const STMSSpec& spec, STMSResult& result)
+{
+	int64_t             numSwapchains = spec.Swapchains;
+	bool                headless      = spec.Headless;
+	Vk::SwapchainState* swapchains    = new Vk::SwapchainState[numSwapchains];
 	for (int64_t i = 0; i < numSwapchains; ++i)
 	{
-		Wnd::Spec spec {};
-		spec.Title = std::format("STMS Window {}", i);
-		// spec.Flags         |= Wnd::WindowCreateFlag::NoBitmap;
-		Wnd::Handle* window = Wnd::Create(&spec);
+		Wnd::Handle* window = nullptr;
+		if (!headless)
+		{
+			Wnd::Spec wndSpec {};
+			wndSpec.Title = std::format("STMS Window {}", i);
+			// wndSpec.Flags         |= Wnd::WindowCreateFlag::NoBitmap;
+			window = Wnd::Create(&wndSpec);
+		}
 
+		swapchains[i].Policy.Spec = spec.Present;
 		if (!Vk::InitSwapchainState(&swapchains[i], window, true))
 		{
-			Wnd::Destroy(window);
+			if (window)
+				Wnd::Destroy(window);
 			for (int64_t j = 0; j < i; ++j)
+			{
+				auto oldWindow = swapchains[j].Window;
 				Vk::DeInitSwapchainState(&swapchains[j]);
-			Vk::DeInit();
-			Wnd::DeInit();
+				if (oldWindow)
+					Wnd::Destroy(oldWindow);
+			}
 			delete[] swapchains;
-			return 1;
+			return false;
 		}
 	}
 
@@ -218,73 +539,134 @@ int STMS(size_t argc, const std::string_view* argv)
 		.pSignalSemaphoreInfos    = signals
 	};
 
-	using Clock = std::chrono::high_resolution_clock;
-	Clock::time_point start, end;
+	FrameTimings timings;
+	{
+		FrameTimingsSpec timingsSpec {};
+		timingsSpec.Name             = spec.Batch ? "STMS batched" : "STMS";
+		timingsSpec.SwapchainCount   = (uint32_t) numSwapchains;
+		timingsSpec.Path             = spec.TimingsPath;
+		timingsSpec.ReportSwapchains = !spec.Sweep;
+		timings.Init(&timingsSpec);
+	}
 
-	double avgDeltaTime    = 0.0;
-	double avgPresentTime  = 0.0;
-	double avgWaitTime     = 0.0;
-	auto   previousTime    = Clock::now();
-	auto   updateTitleTime = previousTime;
-	while (!Wnd::QuitSignaled())
+	int64_t  renderedFrames  = 0;
+	uint64_t submitTime      = 0;
+	uint64_t presentTime     = 0;
+	uint64_t allocs          = 0;
+	uint64_t startTime       = FrameTimings::Now();
+	uint64_t previousTime    = startTime;
+	uint64_t updateTitleTime = startTime;
+
+	Vk::FramePacer pacer {};
+	if (spec.Pace)
+		Vk::InitFramePacer(&pacer, spec.Pacing, (uint64_t) spec.LatencyTarget * 1'000'000);
+	while (headless || !Wnd::QuitSignaled())
 	{
-		auto   currentTime = Clock::now();
-		double deltaTime   = std::chrono::duration_cast<std::chrono::duration<double>>(currentTime - previousTime).count();
-		previousTime       = currentTime;
-		avgDeltaTime       = avgDeltaTime * 0.99 + deltaTime * 0.01;
-		bool updateTitle   = currentTime - updateTitleTime > std::chrono::duration<double>(1.0);
+		if (spec.FrameCount && renderedFrames >= spec.FrameCount)
+			break;
+
+		// The pacer only decides when the frame starts, the frame's own timelines are still waited on below
+		uint64_t paceTime = spec.Pace ? Vk::PacerBeginFrame(&pacer) : 0;
+
+		// Swapchains whose selection changed recreate on their next acquire, frames still in flight keep presenting the old images
+		if (spec.SwitchInterval && renderedFrames && renderedFrames % spec.SwitchInterval == 0)
+		{
+			Vk::SwapchainPolicySpec present = spec.Present;
+			if ((renderedFrames / spec.SwitchInterval) % 2)
+				present.Preference = spec.Present.Preference == Vk::PresentPreference::Latency ? Vk::PresentPreference::Throughput : Vk::PresentPreference::Latency;
+			for (int64_t i = 0; i < numSwapchains; ++i)
+			{
+				if (Vk::SwapchainSetPolicy(&swapchains[i], &present))
+					++result.Switches;
+			}
+		}
+
+		uint64_t currentTime = FrameTimings::Now();
+		uint64_t deltaTime   = currentTime - previousTime;
+		previousTime         = currentTime;
+		bool updateTitle     = currentTime - updateTitleTime > 1'000'000'000;
 		if (updateTitle)
 			updateTitleTime = currentTime;
 
-		Wnd::PollEvents();
-		if (Wnd::QuitSignaled())
-			break;
+		if (!headless)
+		{
+			Wnd::PollEvents();
+			if (Wnd::QuitSignaled())
+				break;
+		}
 
 		uint32_t curFrame = Vk::g_Context->CurrentFrame;
 
 		for (int64_t i = 0; i < numSwapchains; ++i)
 		{
-			if (Wnd::GetWantsClose(swapchains[i].Window))
+			if (!headless && Wnd::GetWantsClose(swapchains[i].Window))
 				Wnd::SignalQuit();
 			auto [semaphore, value] = timelines[i];
 			semaphore               = swapchains[i].Frames[curFrame].Timeline;
 			value                   = swapchains[i].Frames[curFrame].TimelineValue;
 		}
 
-		double waitTime = 0.0, presentTime = 0.0;
-		start = Clock::now();
+		uint64_t waitStart = FrameTimings::Now();
 		VK_EXPECT(vkWaitSemaphores, Vk::g_Context->Device, &waitInfo, ~0ULL);
-		end       = Clock::now();
-		waitTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+		uint64_t waitTime = FrameTimings::Now() - waitStart + paceTime;
+
+		// Batched swapchains are recorded here and submitted and presented together after the loop
+		uint32_t                   batchCount       = 0;
+		Vk::SwapchainState**       batchSwapchains  = nullptr;
+		FrameTimingSample*         batchSamples     = nullptr;
+		VkSubmitInfo2*             batchSubmits     = nullptr;
+		VkCommandBufferSubmitInfo* batchCmdBufInfos = nullptr;
+		VkSemaphoreSubmitInfo*     batchWaits       = nullptr;
+		VkSemaphoreSubmitInfo*     batchSignals     = nullptr;
+		if (spec.Batch)
+		{
+			batchSwapchains  = Vk::FrameAllocate<Vk::SwapchainState*>((size_t) numSwapchains);
+			batchSamples     = Vk::FrameAllocate<FrameTimingSample>((size_t) numSwapchains);
+			batchSubmits     = Vk::FrameAllocate<VkSubmitInfo2>((size_t) numSwapchains);
+			batchCmdBufInfos = Vk::FrameAllocate<VkCommandBufferSubmitInfo>((size_t) numSwapchains);
+			batchWaits       = Vk::FrameAllocate<VkSemaphoreSubmitInfo>((size_t) numSwapchains);
+			batchSignals     = Vk::FrameAllocate<VkSemaphoreSubmitInfo>(2 * (size_t) numSwapchains);
+		}
 
 		size_t renderedSwapchains = 0;
 		for (int64_t i = 0; i < numSwapchains; ++i)
 		{
 			auto& swapchain = swapchains[i];
-			if (Wnd::IsMinimized(swapchain.Window))
+			if (!headless && Wnd::IsMinimized(swapchain.Window))
 				continue;
 
-			if (updateTitle)
+			if (updateTitle && !headless)
 			{
-				Wnd::SetWindowTitle(swapchain.Window, std::format("STMS Window {}, FrameTime {:.4} us, FPS {:.5}, PresentTime {:.4} us, WaitTime {:.4} us", i, avgDeltaTime * 1e6, 1.0 / avgDeltaTime, avgPresentTime * 1e6, avgWaitTime * 1e6));
+				Wnd::SetWindowTitle(swapchain.Window, std::format("STMS Window {}{}, {} x{}, {}, Allocs/Frame {}", i, spec.Batch ? " batched" : "", PresentModeName(swapchain.Policy.PresentMode), swapchain.Policy.ImageCount, timings.Summary((uint32_t) i), Vk::g_Context->FrameAllocations));
 			}
 
 			auto& frame = swapchain.Frames[curFrame];
-			for (auto& destroy : frame.Destroys)
-				destroy();
-			frame.Destroys.clear();
-			waitTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
 
-			start = Clock::now();
+			FrameTimingSample sample {};
+			sample.Frame     = (uint64_t) renderedFrames;
+			sample.Swapchain = (uint32_t) i;
+			sample.Set(FrameTimingStage::Wait, waitTime);
+			if (renderedFrames)
+				sample.Set(FrameTimingStage::Frame, deltaTime);
+
+			uint64_t stageStart = FrameTimings::Now();
 			if (!Vk::SwapchainAcquireImage(&swapchain))
 				continue;
-			end = Clock::now();
+			uint64_t stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Acquire, stageEnd - stageStart);
+			stageStart = stageEnd;
 
-			VK_INVALID(vkResetCommandPool, Vk::g_Context->Device, frame.Pool, 0)
-			{
+			if (!Vk::ResetCommandBuffers(&frame))
 				continue;
+			if (Vk::ResolveGpuTimestamps(&frame))
+			{
+				for (uint32_t j = 0; j < frame.Profiler.ResultCount; ++j)
+					timings.RecordGpu((uint32_t) i, frame.Profiler.Results[j].Name, frame.Profiler.Results[j].Duration);
 			}
-			VK_INVALID(vkBeginCommandBuffer, frame.CmdBuf, &beginInfo)
+			VkCommandBuffer cmdBuf = Vk::AcquireCommandBuffer(&frame);
+			if (!cmdBuf)
+				continue;
+			VK_INVALID(vkBeginCommandBuffer, cmdBuf, &beginInfo)
 			{
 				continue;
 			}
@@ -294,18 +676,47 @@ int STMS(size_t argc, const std::string_view* argv)
 			colAttach.imageView             = swapchain.Images.entry<1>(frame.ImageIndex);
 			renderingInfo.renderArea.extent = swapchain.Extents;
 			depInfo.pImageMemoryBarriers    = &preImageBarrier;
-			vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
-			vkCmdBeginRendering(frame.CmdBuf, &renderingInfo);
-			vkCmdEndRendering(frame.CmdBuf);
-			depInfo.pImageMemoryBarriers = &postImageBarrier;
-			vkCmdPipelineBarrier2(frame.CmdBuf, &depInfo);
+			{
+				Vk::GpuScope gpuScope(&frame, cmdBuf, "Clear");
+				vkCmdPipelineBarrier2(cmdBuf, &depInfo);
+				vkCmdBeginRendering(cmdBuf, &renderingInfo);
+				vkCmdEndRendering(cmdBuf);
+				depInfo.pImageMemoryBarriers = &postImageBarrier;
+				vkCmdPipelineBarrier2(cmdBuf, &depInfo);
+			}
 
-			VK_INVALID(vkEndCommandBuffer, frame.CmdBuf)
+			VK_INVALID(vkEndCommandBuffer, cmdBuf)
 			{
 				continue;
 			}
+			stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Record, stageEnd - stageStart);
+			stageStart = stageEnd;
 
-			cmdBufInfo.commandBuffer = frame.CmdBuf;
+			if (spec.Batch)
+			{
+				uint32_t j = batchCount++;
+
+				batchCmdBufInfos[j]               = cmdBufInfo;
+				batchCmdBufInfos[j].commandBuffer = cmdBuf;
+				batchWaits[j]                     = imageReadyWait;
+				batchWaits[j].semaphore           = frame.ImageReady;
+				batchSignals[2 * j]               = signals[0];
+				batchSignals[2 * j].semaphore     = frame.RenderDone;
+				batchSignals[2 * j + 1]           = signals[1];
+				batchSignals[2 * j + 1].semaphore = frame.Timeline;
+				batchSignals[2 * j + 1].value     = ++frame.TimelineValue;
+
+				batchSubmits[j]                       = submit;
+				batchSubmits[j].pWaitSemaphoreInfos   = &batchWaits[j];
+				batchSubmits[j].pCommandBufferInfos   = &batchCmdBufInfos[j];
+				batchSubmits[j].pSignalSemaphoreInfos = &batchSignals[2 * j];
+				batchSwapchains[j]                    = &swapchain;
+				batchSamples[j]                       = sample;
+				continue;
+			}
+
+			cmdBufInfo.commandBuffer = cmdBuf;
 			imageReadyWait.semaphore = frame.ImageReady;
 			signals[0].semaphore     = frame.RenderDone;
 			signals[1].semaphore     = frame.Timeline;
@@ -314,31 +725,125 @@ int STMS(size_t argc, const std::string_view* argv)
 			{
 				continue;
 			}
+			stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Submit, stageEnd - stageStart);
+			submitTime += stageEnd - stageStart;
+			stageStart  = stageEnd;
 
-			start = Clock::now();
 			if (!Vk::SwapchainPresent(&swapchain))
 				continue;
-			end          = Clock::now();
-			presentTime += std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+			stageEnd = FrameTimings::Now();
+			sample.Set(FrameTimingStage::Present, stageEnd - stageStart);
+			presentTime += stageEnd - stageStart;
+			timings.Record(sample);
 			++renderedSwapchains;
 		}
+
+		// Every batched sample gets the time of the one submit and the one present it was part of
+		if (batchCount)
+		{
+			uint64_t stageStart = FrameTimings::Now();
+			if (VK_VALIDATE(vkQueueSubmit2, Vk::g_Context->Queue, batchCount, batchSubmits, nullptr))
+			{
+				uint64_t stageEnd    = FrameTimings::Now();
+				uint64_t batchSubmit = stageEnd - stageStart;
+				submitTime          += batchSubmit;
+				stageStart           = stageEnd;
+
+				bool     presented    = Vk::SwapchainPresentMany(batchSwapchains, batchCount);
+				uint64_t batchPresent = FrameTimings::Now() - stageStart;
+				presentTime          += batchPresent;
+				if (presented)
+				{
+					for (uint32_t j = 0; j < batchCount; ++j)
+					{
+						batchSamples[j].Set(FrameTimingStage::Submit, batchSubmit);
+						batchSamples[j].Set(FrameTimingStage::Present, batchPresent);
+						timings.Record(batchSamples[j]);
+					}
+					renderedSwapchains += batchCount;
+				}
+			}
+		}
+		if (spec.Pace)
+			Vk::PacerEndFrame(&pacer);
 		Vk::NextFrame();
+		timings.Collect();
+		allocs += Vk::g_Context->FrameAllocations;
 
-		avgPresentTime = avgPresentTime * 0.99 + presentTime * 0.01;
-		avgWaitTime    = avgWaitTime * 0.99 + waitTime * 0.01;
-		if (!renderedSwapchains)
+		++renderedFrames;
+		if (!renderedSwapchains && !headless)
 			Wnd::WaitForEvent();
 	}
+	result.Frames      = renderedFrames;
+	result.TotalTime   = (FrameTimings::Now() - startTime) * 1e-9;
+	result.SubmitTime  = submitTime * 1e-9;
+	result.PresentTime = presentTime * 1e-9;
+	result.LatencyMean = pacer.Latency.Mean() * 1e-6;
+	result.LatencyP50  = pacer.Latency.Percentile(0.5) * 1e-6;
+	result.LatencyP99  = pacer.Latency.Percentile(0.99) * 1e-6;
+	result.DelayTime   = pacer.Delayed * 1e-9;
+	result.PresentMode = swapchains[0].Policy.PresentMode;
+	result.ImageCount  = swapchains[0].Policy.ImageCount;
+	result.Allocs      = allocs;
+	timings.Report();
+	timings.DeInit();
 
 	for (int64_t i = 0; i < numSwapchains; ++i)
 	{
 		auto window = swapchains[i].Window;
 		Vk::DeInitSwapchainState(&swapchains[i]);
-		Wnd::Destroy(window);
+		if (window)
+			Wnd::Destroy(window);
 	}
 	delete[] swapchains;
+	return true;
+}
 
-	Vk::DeInit();
-	Wnd::DeInit();
-	return 0;
-}
\ No newline at end of file
+void PrintSTMSResult(const STMSSpec& spec, const STMSResult& result)
+{
+	if (!result.Frames)
+		return;
+	std::string pacing;
+	if (spec.Pace)
+	{
+		pacing = std::format(", Latency {:.4} ms, p50 {:.4} ms, p99 {:.4} ms, Delayed {:.4} us",
+							 result.LatencyMean,
+							 result.LatencyP50,
+							 result.LatencyP99,
+							 result.DelayTime / result.Frames * 1e6);
+	}
+	std::string present;
+	if (!spec.Headless)
+	{
+		present = std::format(", {} x{}", PresentModeName(result.PresentMode), result.ImageCount);
+		if (spec.SwitchInterval)
+			present += std::format(", {} switches", result.Switches);
+	}
+	std::cout << std::format("STMS {} swapchains{}{}{}{}: {} frames in {:.4} s, FrameTime {:.4} us, FPS {:.5}, SubmitTime {:.4} us, PresentTime {:.4} us, Allocs/Frame {:.4}{}\n",
+							 spec.Swapchains,
+							 spec.Batch ? ", batched" : "",
+							 spec.Headless ? ", headless" : "",
+							 present,
+							 spec.Pace ? std::format(", {} paced", c_PacingModeNames[(uint32_t) spec.Pacing]) : std::string {},
+							 result.Frames,
+							 result.TotalTime,
+							 result.TotalTime / result.Frames * 1e6,
+							 result.Frames / result.TotalTime,
+							 result.SubmitTime / result.Frames * 1e6,
+							 result.PresentTime / result.Frames * 1e6,
+							 result.Allocs / (double) result.Frames,
+							 pacing);
+}
+
+const char* PresentModeName(VkPresentModeKHR mode)
+{
+	switch (mode)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR: return "IMMEDIATE";
+	case VK_PRESENT_MODE_MAILBOX_KHR: return "MAILBOX";
+	case VK_PRESENT_MODE_FIFO_KHR: return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR: return "FIFO_RELAXED";
+	default: return "Unknown";
+	}
+}
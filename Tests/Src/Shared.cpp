@@ -1,17 +1,17 @@
 #include "Shared.h"
+#include "Utils/MappedFile.h"
 
+#include <cstddef>
+#include <cstring>
+
+#include <algorithm>
 #include <atomic>
+#include <bit>
 #include <iostream>
 #include <thread>
 #include <vector>
 
 #include <Concurrency/Mutex.h>
-#include <UTF/UTF.h>
-
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "dxgi.lib")
-#pragma comment(lib, "dcomp.lib")
-#pragma comment(lib, "dwmapi.lib")
 
 namespace Helpers
 {
@@ -19,35 +19,157 @@ namespace Helpers
 	{
 		std::cout << std::format("{} returned unexpected {}\n", func, string_VkResult(result));
 	}
-
-	void HrReport(HRESULT result, std::string_view func)
-	{
-		std::cout << std::format("{} returned unexpected {:08X}\n", func, (uint32_t) result);
-	}
 } // namespace Helpers
 
 namespace Vk
 {
+	static constexpr uint32_t   c_MaxPhysicalDevices     = 16;
+	static constexpr uint32_t   c_MaxQueueFamilies       = 16;
+	static constexpr VkExtent2D c_HeadlessDefaultExtents = { 1280, 720 };
+	static constexpr uint32_t   c_PipelineCacheMagic     = 0x4350'5447; // "GTPC"
+	static constexpr uint32_t   c_PipelineCacheVersion   = 1;
+
+	// Number of VkBool32 members in the core feature structs, sType and pNext excluded
+	static constexpr size_t c_Vk11FeatureCount = (offsetof(VkPhysicalDeviceVulkan11Features, shaderDrawParameters) - offsetof(VkPhysicalDeviceVulkan11Features, storageBuffer16BitAccess)) / sizeof(VkBool32) + 1;
+	static constexpr size_t c_Vk12FeatureCount = (offsetof(VkPhysicalDeviceVulkan12Features, subgroupBroadcastDynamicId) - offsetof(VkPhysicalDeviceVulkan12Features, samplerMirrorClampToEdge)) / sizeof(VkBool32) + 1;
+	static constexpr size_t c_Vk13FeatureCount = (offsetof(VkPhysicalDeviceVulkan13Features, maintenance4) - offsetof(VkPhysicalDeviceVulkan13Features, robustImageAccess)) / sizeof(VkBool32) + 1;
+
 	Context* g_Context = nullptr;
 
-	bool InitFrameState(Context* context, FrameState* frame)
+	// T is FrameState or SwapchainFrameState, a FramePool block is sized for FramesInFlight of the larger one
+	template <class T>
+	static T* AllocateFrames(Context* context)
 	{
-		if (!context || !frame)
+		static_assert(sizeof(T) <= sizeof(SwapchainFrameState) && alignof(T) <= alignof(SwapchainFrameState));
+		T* frames = (T*) context->FramePool->Allocate();
+		for (uint32_t i = 0; i < context->FramesInFlight; ++i)
+			new (&frames[i]) T();
+		return frames;
+	}
+
+	template <class T>
+	static void FreeFrames(Context* context, T* frames)
+	{
+		for (uint32_t i = 0; i < context->FramesInFlight; ++i)
+			frames[i].~T();
+		context->FramePool->Free(frames);
+	}
+
+	static void DestroyHeadlessImages(VkDeviceMemory memory, TupleVector<VkImage, VkImageView>& images)
+	{
+		for (auto [image, view] : images)
+		{
+			if (view)
+				vkDestroyImageView(g_Context->Device, view, nullptr);
+			if (image)
+				vkDestroyImage(g_Context->Device, image, nullptr);
+		}
+		images.clear();
+		if (memory)
+			vkFreeMemory(g_Context->Device, memory, nullptr);
+	}
+
+	// Creates c_HeadlessImageCount images in a single allocation, sized by Extents, then the window, then c_HeadlessDefaultExtents
+	static bool CreateHeadlessImages(SwapchainState* swapchain)
+	{
+		auto& headless = swapchain->Headless;
+		if (!swapchain->Extents.width || !swapchain->Extents.height)
+		{
+			if (swapchain->Window)
+				Wnd::GetWindowSize(swapchain->Window, swapchain->Extents.width, swapchain->Extents.height);
+			if (!swapchain->Extents.width || !swapchain->Extents.height)
+				swapchain->Extents = c_HeadlessDefaultExtents;
+		}
+
+		VkImageCreateInfo createInfo {
+			.sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.pNext                 = nullptr,
+			.flags                 = 0,
+			.imageType             = VK_IMAGE_TYPE_2D,
+			.format                = VK_FORMAT_B8G8R8A8_UNORM,
+			.extent                = { swapchain->Extents.width, swapchain->Extents.height, 1 },
+			.mipLevels             = 1,
+			.arrayLayers           = 1,
+			.samples               = VK_SAMPLE_COUNT_1_BIT,
+			.tiling                = VK_IMAGE_TILING_OPTIMAL,
+			.usage                 = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			.sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 0,
+			.pQueueFamilyIndices   = nullptr,
+			.initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED
+		};
+		VkDeviceSize offsets[c_HeadlessImageCount];
+		VkDeviceSize size     = 0;
+		uint32_t     typeBits = ~0U;
+		swapchain->Images.resize(c_HeadlessImageCount);
+		for (uint32_t i = 0; i < c_HeadlessImageCount; ++i)
+		{
+			VK_INVALID(vkCreateImage, g_Context->Device, &createInfo, nullptr, &swapchain->Images.entry<0>(i))
+			{
+				DestroyHeadlessImages(nullptr, swapchain->Images);
+				return false;
+			}
+			VkMemoryRequirements requirements {};
+			vkGetImageMemoryRequirements(g_Context->Device, swapchain->Images.entry<0>(i), &requirements);
+			offsets[i]  = (size + requirements.alignment - 1) / requirements.alignment * requirements.alignment;
+			size        = offsets[i] + requirements.size;
+			typeBits   &= requirements.memoryTypeBits;
+		}
+
+		VkMemoryAllocateInfo allocInfo {
+			.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.pNext           = nullptr,
+			.allocationSize  = size,
+			.memoryTypeIndex = FindDeviceMemoryIndex(typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+		};
+		if (allocInfo.memoryTypeIndex == ~0U)
+		{
+			std::cout << "Failed to find device local memory for headless swapchain images\n";
+			DestroyHeadlessImages(nullptr, swapchain->Images);
 			return false;
+		}
+		VK_INVALID(vkAllocateMemory, g_Context->Device, &allocInfo, nullptr, &headless.Memory)
+		{
+			DestroyHeadlessImages(nullptr, swapchain->Images);
+			return false;
+		}
 
-		VkCommandPoolCreateInfo pCreateInfo {
-			.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		VkImageViewCreateInfo ivCreateInfo {
+			.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
 			.pNext            = nullptr,
 			.flags            = 0,
-			.queueFamilyIndex = 0
-		};
-		VkCommandBufferAllocateInfo allocInfo {
-			.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-			.pNext              = nullptr,
-			.commandPool        = nullptr,
-			.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-			.commandBufferCount = 1
+			.image            = nullptr,
+			.viewType         = VK_IMAGE_VIEW_TYPE_2D,
+			.format           = VK_FORMAT_B8G8R8A8_UNORM,
+			.components       = {},
+			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
 		};
+		for (uint32_t i = 0; i < c_HeadlessImageCount; ++i)
+		{
+			VK_INVALID(vkBindImageMemory, g_Context->Device, swapchain->Images.entry<0>(i), headless.Memory, offsets[i])
+			{
+				DestroyHeadlessImages(headless.Memory, swapchain->Images);
+				headless.Memory = nullptr;
+				return false;
+			}
+			ivCreateInfo.image = swapchain->Images.entry<0>(i);
+			VK_INVALID(vkCreateImageView, g_Context->Device, &ivCreateInfo, nullptr, &swapchain->Images.entry<1>(i))
+			{
+				DestroyHeadlessImages(headless.Memory, swapchain->Images);
+				headless.Memory = nullptr;
+				return false;
+			}
+		}
+
+		// Fresh images were never presented, so nothing needs waiting on before they are acquired
+		headless.NextImage = 0;
+		for (uint32_t i = 0; i < c_HeadlessImageCount; ++i)
+			headless.PresentValues[i] = 0;
+		return true;
+	}
+
+	static bool InitHeadlessSwapchain(SwapchainState* swapchain)
+	{
 		VkSemaphoreTypeCreateInfo stCreateInfo {
 			.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
 			.pNext         = nullptr,
@@ -59,33 +181,119 @@ namespace Vk
 			.pNext = &stCreateInfo,
 			.flags = 0
 		};
-		VK_INVALID(vkCreateCommandPool, context->Device, &pCreateInfo, nullptr, &frame->Pool)
+		VK_INVALID(vkCreateSemaphore, g_Context->Device, &sCreateInfo, nullptr, &swapchain->Headless.Timeline)
 		{
 			return false;
 		}
-		allocInfo.commandPool = frame->Pool;
-		VK_INVALID(vkAllocateCommandBuffers, context->Device, &allocInfo, &frame->CmdBuf)
+		swapchain->Headless.Value = 0;
+		if (!CreateHeadlessImages(swapchain))
 		{
-			vkDestroyCommandPool(context->Device, frame->Pool, nullptr);
-			frame->Pool = nullptr;
+			vkDestroySemaphore(g_Context->Device, swapchain->Headless.Timeline, nullptr);
+			swapchain->Headless.Timeline = nullptr;
 			return false;
 		}
+		return true;
+	}
+
+	static void DeInitHeadlessSwapchain(SwapchainState* swapchain)
+	{
+		auto&               headless = swapchain->Headless;
+		VkSemaphoreWaitInfo waitInfo {
+			.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.pNext          = nullptr,
+			.flags          = 0,
+			.semaphoreCount = 1,
+			.pSemaphores    = &headless.Timeline,
+			.pValues        = &headless.Value
+		};
+		vkWaitSemaphores(g_Context->Device, &waitInfo, ~0ULL);
+		DestroyHeadlessImages(headless.Memory, swapchain->Images);
+		vkDestroySemaphore(g_Context->Device, headless.Timeline, nullptr);
+		headless.Memory   = nullptr;
+		headless.Timeline = nullptr;
+		headless.Value    = 0;
+	}
+
+	static size_t DestroyRetired(DestroyQueue& queue, uint64_t completed)
+	{
+		size_t start = queue.Head;
+		for (; queue.Head < queue.Entries.size(); ++queue.Head)
+		{
+			auto& entry = queue.Entries[queue.Head];
+			if (entry.RetireValue > completed)
+				break;
+
+			switch (entry.Type)
+			{
+			case DestroyType::ImageView: vkDestroyImageView(g_Context->Device, (VkImageView) entry.Handle, nullptr); break;
+			case DestroyType::Image: vkDestroyImage(g_Context->Device, (VkImage) entry.Handle, nullptr); break;
+			case DestroyType::Buffer: vkDestroyBuffer(g_Context->Device, (VkBuffer) entry.Handle, nullptr); break;
+			case DestroyType::DeviceMemory: vkFreeMemory(g_Context->Device, (VkDeviceMemory) entry.Handle, nullptr); break;
+			case DestroyType::Allocation: FreeDeviceMemory((DeviceAllocation*) entry.Handle); break;
+			case DestroyType::Semaphore: vkDestroySemaphore(g_Context->Device, (VkSemaphore) entry.Handle, nullptr); break;
+			case DestroyType::CommandPool: vkDestroyCommandPool(g_Context->Device, (VkCommandPool) entry.Handle, nullptr); break;
+			case DestroyType::Swapchain: vkDestroySwapchainKHR(g_Context->Device, (VkSwapchainKHR) entry.Handle, nullptr); break;
+			}
+		}
+		size_t destroyed = queue.Head - start;
+
+		// Compact once the retired front outgrows the live entries, clear keeps the capacity
+		if (queue.Head == queue.Entries.size())
+		{
+			queue.Entries.clear();
+			queue.Head = 0;
+		}
+		else if (queue.Head > queue.Entries.size() / 2)
+		{
+			queue.Entries.erase(queue.Entries.begin(), queue.Entries.begin() + queue.Head);
+			queue.Head = 0;
+		}
+		return destroyed;
+	}
+
+	bool InitFrameState(Context* context, FrameState* frame)
+	{
+		if (!context || !frame)
+			return false;
+
+		VkSemaphoreTypeCreateInfo stCreateInfo {
+			.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.pNext         = nullptr,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue  = 0
+		};
+		VkSemaphoreCreateInfo sCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &stCreateInfo,
+			.flags = 0
+		};
 		VK_INVALID(vkCreateSemaphore, context->Device, &sCreateInfo, nullptr, &frame->Timeline)
 		{
-			vkDestroyCommandPool(context->Device, frame->Pool, nullptr);
-			frame->CmdBuf = nullptr;
-			frame->Pool   = nullptr;
 			return false;
 		}
 		sCreateInfo.pNext = nullptr;
 		VK_INVALID(vkCreateSemaphore, context->Device, &sCreateInfo, nullptr, &frame->RenderDone)
 		{
 			vkDestroySemaphore(context->Device, frame->Timeline, nullptr);
-			vkDestroyCommandPool(context->Device, frame->Pool, nullptr);
-			frame->CmdBuf = nullptr;
-			frame->Pool   = nullptr;
+			frame->Timeline = nullptr;
 			return false;
 		}
+		if (context->TimestampPeriod > 0.0f)
+		{
+			VkQueryPoolCreateInfo qpCreateInfo {
+				.sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+				.pNext              = nullptr,
+				.flags              = 0,
+				.queryType          = VK_QUERY_TYPE_TIMESTAMP,
+				.queryCount         = 2 * c_MaxGpuMarkers,
+				.pipelineStatistics = 0
+			};
+			// Profiling is optional, a frame without a pool just drops its markers
+			if (VK_VALIDATE(vkCreateQueryPool, context->Device, &qpCreateInfo, nullptr, &frame->Profiler.Pool))
+				vkResetQueryPool(context->Device, frame->Profiler.Pool, 0, 2 * c_MaxGpuMarkers);
+			else
+				frame->Profiler.Pool = nullptr;
+		}
 		return true;
 	}
 
@@ -103,424 +311,1324 @@ namespace Vk
 			.pValues        = &frame->TimelineValue
 		};
 		vkWaitSemaphores(g_Context->Device, &waitInfo, ~0ULL);
-		for (auto& destroy : frame->Destroys)
-			destroy();
+		DestroyRetired(frame->Destroys, ~0ULL);
+		frame->Destroys.Entries.shrink_to_fit();
+		// The frame and its timeline are about to go, so NextFrame must not look at them for the upload partitions the frame used
+		if (context->Uploads.Partitions)
+		{
+			for (uint32_t i = 0; i < context->FramesInFlight; ++i)
+			{
+				auto&    partition = context->Uploads.Partitions[i];
+				uint32_t waitCount = std::min(partition.WaitCount.load(std::memory_order_relaxed), c_MaxUploadWaits);
+				for (uint32_t j = 0; j < waitCount;)
+				{
+					if (partition.Frames[j] == frame)
+					{
+						partition.Frames[j] = partition.Frames[--waitCount];
+						partition.Values[j] = partition.Values[waitCount];
+					}
+					else
+					{
+						++j;
+					}
+				}
+				partition.WaitCount.store(waitCount, std::memory_order_relaxed);
+			}
+		}
+		for (auto& slot : frame->Commands.Slots)
+		{
+			if (slot.Pool)
+				vkDestroyCommandPool(context->Device, slot.Pool, nullptr);
+			while (slot.Chunks)
+			{
+				CommandBufferChunk* next = slot.Chunks->Next;
+				delete slot.Chunks;
+				slot.Chunks = next;
+			}
+			slot = {};
+		}
+		if (frame->Profiler.Pool)
+			vkDestroyQueryPool(context->Device, frame->Profiler.Pool, nullptr);
 		vkDestroySemaphore(context->Device, frame->RenderDone, nullptr);
 		vkDestroySemaphore(context->Device, frame->Timeline, nullptr);
-		vkDestroyCommandPool(context->Device, frame->Pool, nullptr);
+		frame->Profiler   = {};
 		frame->RenderDone = nullptr;
 		frame->Timeline   = nullptr;
 	}
 
-	bool Init(const ContextSpec* spec)
+	VkCommandBuffer AcquireCommandBuffer(FrameState* frame, uint32_t thread)
 	{
-		if (spec && spec->FramesInFlight < 1)
-			return false;
-
-		Context* context = new Context();
+		if (!g_Context || !frame || thread >= c_MaxRecordThreads)
+			return nullptr;
 
-		// Create Instance
+		auto& slot = frame->Commands.Slots[thread];
+		if (!slot.Pool)
 		{
-			VkApplicationInfo appInfo {
-				.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-				.pNext              = nullptr,
-				.pApplicationName   = spec ? spec->AppName : "TestApp",
-				.applicationVersion = spec ? spec->AppVersion : VK_MAKE_API_VERSION(0, 1, 0, 0),
-				.pEngineName        = "Tests",
-				.engineVersion      = VK_MAKE_API_VERSION(0, 1, 0, 0),
-				.apiVersion         = VK_API_VERSION_1_3
-			};
-			VkInstanceCreateInfo createInfo {
-				.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-				.pNext                   = nullptr,
-				.flags                   = 0,
-				.pApplicationInfo        = &appInfo,
-				.enabledLayerCount       = 0,
-				.ppEnabledLayerNames     = nullptr,
-				.enabledExtensionCount   = spec ? spec->InstanceExtCount : 0,
-				.ppEnabledExtensionNames = spec ? spec->InstanceExts : nullptr
+			VkCommandPoolCreateInfo createInfo {
+				.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.pNext            = nullptr,
+				.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = g_Context->QueueFamily
 			};
-			VK_INVALID(vkCreateInstance, &createInfo, nullptr, &context->Instance)
+			VK_INVALID(vkCreateCommandPool, g_Context->Device, &createInfo, nullptr, &slot.Pool)
 			{
-				delete context;
-				return false;
+				return nullptr;
 			}
 		}
-		// Select Physical Device
+
+		if (slot.Current && slot.Used < c_CommandBufferChunkSize)
+			return slot.Current->CmdBufs[slot.Used++];
+
+		// Move on to the next chunk, chunks left over from earlier frames already hold allocated command buffers
+		CommandBufferChunk* next = slot.Current ? slot.Current->Next : slot.Chunks;
+		if (!next)
 		{
-			uint32_t count = 0;
-			VK_INVALID(vkEnumeratePhysicalDevices, context->Instance, &count, nullptr)
-			{
-				vkDestroyInstance(context->Instance, nullptr);
-				delete context;
-				return false;
-			}
-			VkPhysicalDevice* devices = new VkPhysicalDevice[count];
-			VK_INVALID(vkEnumeratePhysicalDevices, context->Instance, &count, devices)
-			{
-				delete[] devices;
-				vkDestroyInstance(context->Instance, nullptr);
-				delete context;
-				return false;
-			}
-			for (uint32_t i = 0; i < count; ++i)
-			{
-				VkPhysicalDeviceProperties props {};
-				vkGetPhysicalDeviceProperties(devices[i], &props);
-				if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
-				{
-					context->PhysicalDevice = devices[i];
-					break;
-				}
-			}
-			delete[] devices;
-			if (!context->PhysicalDevice)
+			next = new CommandBufferChunk();
+
+			VkCommandBufferAllocateInfo allocInfo {
+				.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.pNext              = nullptr,
+				.commandPool        = slot.Pool,
+				.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = c_CommandBufferChunkSize
+			};
+			VK_INVALID(vkAllocateCommandBuffers, g_Context->Device, &allocInfo, next->CmdBufs)
 			{
-				std::cout << "Failed to find appropriate Vulkan Physical Device\n";
-				vkDestroyInstance(context->Instance, nullptr);
-				delete context;
-				return false;
+				delete next;
+				return nullptr;
 			}
+			if (slot.Current)
+				slot.Current->Next = next;
+			else
+				slot.Chunks = next;
 		}
-		// Create Device
+		slot.Current = next;
+		slot.Used    = 1;
+		return next->CmdBufs[0];
+	}
+
+	bool ResetCommandBuffers(FrameState* frame)
+	{
+		if (!g_Context || !frame)
+			return false;
+
+		uint64_t completed = 0;
+		VK_INVALID(vkGetSemaphoreCounterValue, g_Context->Device, frame->Timeline, &completed)
 		{
-			float                   prios[] { 1.0f };
-			VkDeviceQueueCreateInfo qCreateInfo {
-				.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-				.pNext            = nullptr,
-				.flags            = 0,
-				.queueFamilyIndex = 0,
-				.queueCount       = 1,
-				.pQueuePriorities = prios
-			};
-			VkPhysicalDeviceVulkan13Features Vk13DeviceFeatures = {
-				.sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
-				.pNext            = nullptr,
-				.synchronization2 = VK_TRUE,
-				.dynamicRendering = VK_TRUE
-			};
-			VkPhysicalDeviceVulkan12Features Vk12DeviceFeatures = {
-				.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
-				.pNext             = &Vk13DeviceFeatures,
-				.timelineSemaphore = VK_TRUE
-			};
-			VkPhysicalDeviceVulkan11Features Vk11DeviceFeatures = {
-				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
-				.pNext = &Vk12DeviceFeatures
-			};
-			VkPhysicalDeviceFeatures2 DeviceFeatures = {
-				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-				.pNext = &Vk11DeviceFeatures
-			};
-			VkDeviceCreateInfo createInfo {
-				.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-				.pNext                   = spec ? &spec->DeviceFeatures : &DeviceFeatures,
-				.flags                   = 0,
-				.queueCreateInfoCount    = 1,
-				.pQueueCreateInfos       = &qCreateInfo,
-				.enabledLayerCount       = 0,
-				.ppEnabledLayerNames     = nullptr,
-				.enabledExtensionCount   = spec ? spec->DeviceExtCount : 0,
-				.ppEnabledExtensionNames = spec ? spec->DeviceExts : nullptr,
-				.pEnabledFeatures        = nullptr
-			};
-			VK_INVALID(vkCreateDevice, context->PhysicalDevice, &createInfo, nullptr, &context->Device)
-			{
-				vkDestroyInstance(context->Instance, nullptr);
-				delete context;
-				return false;
-			}
-			vkGetDeviceQueue(context->Device, 0, 0, &context->Queue);
+			return false;
 		}
-		context->FramesInFlight = spec ? spec->FramesInFlight : 1;
-		context->CurrentFrame   = 0;
-		context->Frames         = new FrameState[context->FramesInFlight];
-		for (uint32_t i = 0; i < context->FramesInFlight; ++i)
+		if (completed < frame->TimelineValue)
+			return false;
+
+		bool success = true;
+		for (auto& slot : frame->Commands.Slots)
 		{
-			if (!InitFrameState(context, &context->Frames[i]))
+			if (!slot.Current)
+				continue;
+			VK_INVALID(vkResetCommandPool, g_Context->Device, slot.Pool, 0)
 			{
-				for (uint32_t j = 0; j < i; ++j)
-					DeInitFrameState(context, &context->Frames[j]);
-				delete[] context->Frames;
-				vkDestroyDevice(context->Device, nullptr);
-				vkDestroyInstance(context->Instance, nullptr);
-				delete context;
-				return false;
+				success = false;
+				continue;
 			}
+			slot.Current = nullptr;
+			slot.Used    = 0;
 		}
-		g_Context = context;
-		return true;
+		return success;
 	}
 
-	void DeInit()
+	void DeferDestroy(FrameState* frame, DestroyType type, uint64_t handle, uint64_t retireValue)
 	{
-		if (!g_Context)
+		if (!frame || !handle)
 			return;
-		if (g_Context->Frames)
+		frame->Destroys.Entries.emplace_back(DeferredDestroy { type, handle, retireValue });
+	}
+
+	size_t ReclaimDestroys(FrameState* frame)
+	{
+		if (!g_Context || !frame || frame->Destroys.Head == frame->Destroys.Entries.size())
+			return 0;
+
+		uint64_t completed = 0;
+		VK_INVALID(vkGetSemaphoreCounterValue, g_Context->Device, frame->Timeline, &completed)
 		{
-			for (uint32_t i = 0; i < g_Context->FramesInFlight; ++i)
-				DeInitFrameState(g_Context, &g_Context->Frames[i]);
-			delete[] g_Context->Frames;
+			return 0;
 		}
-		vkDestroyDevice(g_Context->Device, nullptr);
-		vkDestroyInstance(g_Context->Instance, nullptr);
-		delete g_Context;
-		g_Context = nullptr;
+		return DestroyRetired(frame->Destroys, completed);
 	}
 
-	void NextFrame()
+	uint32_t BeginGpuMarker(FrameState* frame, VkCommandBuffer cmdBuf, const char* name)
 	{
-		if (!g_Context)
+		if (!frame || !cmdBuf || !frame->Profiler.Pool)
+			return c_InvalidGpuMarker;
+
+		auto& profiler = frame->Profiler;
+		if (profiler.MarkerCount)
+		{
+			// Markers of an earlier submit that has not been resolved yet still own the queries
+			if (profiler.RecordValue != frame->TimelineValue || profiler.MarkerCount >= c_MaxGpuMarkers)
+			{
+				++profiler.Dropped;
+				return c_InvalidGpuMarker;
+			}
+		}
+		else
+		{
+			profiler.RecordValue = frame->TimelineValue;
+		}
+
+		uint32_t marker        = profiler.MarkerCount++;
+		profiler.Names[marker] = name;
+		vkCmdWriteTimestamp2(cmdBuf, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, profiler.Pool, 2 * marker);
+		return marker;
+	}
+
+	void EndGpuMarker(FrameState* frame, VkCommandBuffer cmdBuf, uint32_t marker)
+	{
+		if (!frame || !cmdBuf || marker >= frame->Profiler.MarkerCount)
 			return;
-		g_Context->CurrentFrame = (g_Context->CurrentFrame + 1) % g_Context->FramesInFlight;
+		vkCmdWriteTimestamp2(cmdBuf, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, frame->Profiler.Pool, 2 * marker + 1);
 	}
 
-	bool InitSwapchainState(SwapchainState* swapchain, Wnd::Handle* window, bool withFrames)
+	bool ResolveGpuTimestamps(FrameState* frame)
 	{
-		if (!g_Context || !swapchain || !window)
+		if (!g_Context || !frame || !frame->Profiler.Pool || !frame->Profiler.MarkerCount)
 			return false;
 
-		swapchain->Window = window;
-		VK_INVALID(createSurface, window, &swapchain->Surface)
+		auto& profiler = frame->Profiler;
+		if (frame->TimelineValue > profiler.RecordValue)
 		{
-			swapchain->Window = nullptr;
-			return false;
-		}
-
-		VkSurfaceCapabilitiesKHR caps {};
-		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(g_Context->PhysicalDevice, swapchain->Surface, &caps);
+			uint64_t completed = 0;
+			VK_INVALID(vkGetSemaphoreCounterValue, g_Context->Device, frame->Timeline, &completed)
+			{
+				return false;
+			}
+			if (completed <= profiler.RecordValue)
+				return false;
 
-		swapchain->Extents = caps.currentExtent;
-		VkSwapchainCreateInfoKHR createInfo {
-			.sType                 = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-			.pNext                 = nullptr,
-			.flags                 = 0,
-			.surface               = swapchain->Surface,
-			.minImageCount         = std::min<uint32_t>(caps.minImageCount + 1, caps.maxImageCount),
-			.imageFormat           = VK_FORMAT_B8G8R8A8_UNORM,
-			.imageColorSpace       = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
-			.imageExtent           = swapchain->Extents,
-			.imageArrayLayers      = 1,
-			.imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-			.imageSharingMode      = VK_SHARING_MODE_EXCLUSIVE,
-			.queueFamilyIndexCount = 0,
-			.pQueueFamilyIndices   = nullptr,
-			.preTransform          = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
-			.compositeAlpha        = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-			.presentMode           = VK_PRESENT_MODE_MAILBOX_KHR,
-			.clipped               = VK_FALSE,
-			.oldSwapchain          = nullptr
+			// Timestamp and availability for every query, markers that were never ended stay unavailable and are left out
+			uint64_t values[4 * c_MaxGpuMarkers];
+			VkResult result = vkGetQueryPoolResults(g_Context->Device,
+													profiler.Pool,
+													0,
+													2 * profiler.MarkerCount,
+													sizeof(values),
+													values,
+													2 * sizeof(uint64_t),
+													VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+			profiler.ResultCount = 0;
+			if (Helpers::VkValidate(result, "vkGetQueryPoolResults"))
+			{
+				for (uint32_t i = 0; i < profiler.MarkerCount; ++i)
+				{
+					uint64_t* begin = &values[4 * i];
+					uint64_t* end   = &values[4 * i + 2];
+					if (!begin[1] || !end[1])
+						continue;
+					uint64_t ticks = (end[0] - begin[0]) & g_Context->TimestampMask;
+
+					profiler.Results[profiler.ResultCount++] = {
+						.Name     = profiler.Names[i],
+						.Duration = (uint64_t) (ticks * (double) g_Context->TimestampPeriod)
+					};
+				}
+			}
+		}
+		else
+		{
+			// The markers were recorded but never submitted, nothing will ever write them
+			profiler.ResultCount = 0;
+		}
+
+		vkResetQueryPool(g_Context->Device, profiler.Pool, 0, 2 * profiler.MarkerCount);
+		profiler.MarkerCount = 0;
+		return profiler.ResultCount > 0;
+	}
+
+	// Pipeline cache files are this header followed by the vkGetPipelineCacheData blob
+	struct PipelineCacheFileHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t VendorID;
+		uint32_t DeviceID;
+		uint32_t DriverVersion;
+		uint8_t  PipelineCacheUUID[VK_UUID_SIZE];
+		uint64_t DataSize;
+		uint64_t DataHash; // FNV-1a of the blob, catches truncated or corrupted files
+	};
+
+	static uint64_t HashPipelineCacheData(const uint8_t* data, size_t size)
+	{
+		uint64_t hash = 0xCBF2'9CE4'8422'2325ULL;
+		for (size_t i = 0; i < size; ++i)
+			hash = (hash ^ data[i]) * 0x0000'0100'0000'01B3ULL;
+		return hash;
+	}
+
+	static bool ValidatePipelineCache(const VkPhysicalDeviceProperties& props, const uint8_t* file, size_t fileSize)
+	{
+		auto header = (const PipelineCacheFileHeader*) file;
+		if (fileSize < sizeof(PipelineCacheFileHeader) ||
+			header->Magic != c_PipelineCacheMagic ||
+			header->Version != c_PipelineCacheVersion ||
+			header->DataSize != fileSize - sizeof(PipelineCacheFileHeader))
+			return false;
+		if (header->VendorID != props.vendorID ||
+			header->DeviceID != props.deviceID ||
+			header->DriverVersion != props.driverVersion ||
+			memcmp(header->PipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+			return false;
+
+		// The blob carries the same identity in its own header, a driver that disagrees with it would reject the data anyway
+		const uint8_t* data = file + sizeof(PipelineCacheFileHeader);
+		VkPipelineCacheHeaderVersionOne vkHeader {};
+		if (header->DataSize < sizeof(vkHeader))
+			return false;
+		memcpy(&vkHeader, data, sizeof(vkHeader));
+		if (vkHeader.headerSize < sizeof(vkHeader) ||
+			vkHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+			vkHeader.vendorID != props.vendorID ||
+			vkHeader.deviceID != props.deviceID ||
+			memcmp(vkHeader.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+			return false;
+		return HashPipelineCacheData(data, header->DataSize) == header->DataHash;
+	}
+
+	// Maps the cache file read only and hands the blob to vkCreatePipelineCache when it belongs to this device and driver, a bad file is a cold start
+	static bool InitPipelineCache(Context* context, const char* path)
+	{
+		VkPhysicalDeviceProperties props {};
+		vkGetPhysicalDeviceProperties(context->PhysicalDevice, &props);
+
+		MappedFile file {};
+		if (path && *path)
+		{
+			context->PipelineCachePath = path;
+			file                       = MapFileReadOnly(context->PipelineCachePath);
+		}
+
+		VkPipelineCacheCreateInfo createInfo {
+			.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+			.pNext           = nullptr,
+			.flags           = 0,
+			.initialDataSize = 0,
+			.pInitialData    = nullptr
 		};
-		VK_INVALID(vkCreateSwapchainKHR, g_Context->Device, &createInfo, nullptr, &swapchain->Swapchain)
+		if (file.Data && ValidatePipelineCache(props, file.Data, file.Size))
+		{
+			createInfo.initialDataSize = file.Size - sizeof(PipelineCacheFileHeader);
+			createInfo.pInitialData    = file.Data + sizeof(PipelineCacheFileHeader);
+		}
+		else if (file.Data)
+		{
+			std::cout << std::format("Ignoring pipeline cache '{}', it was written by another device or driver or is damaged\n", context->PipelineCachePath);
+		}
+
+		VkResult result = vkCreatePipelineCache(context->Device, &createInfo, nullptr, &context->PipelineCache);
+		if (result < VK_SUCCESS && createInfo.pInitialData)
+		{
+			// Drivers may still refuse data that passed validation, start cold instead
+			createInfo.initialDataSize = 0;
+			createInfo.pInitialData    = nullptr;
+			result                     = vkCreatePipelineCache(context->Device, &createInfo, nullptr, &context->PipelineCache);
+		}
+		context->PipelineCacheLoaded = result >= VK_SUCCESS ? createInfo.initialDataSize : 0;
+
+		UnmapFile(file);
+		return Helpers::VkValidate(result, "vkCreatePipelineCache");
+	}
+
+	bool SavePipelineCache()
+	{
+		if (!g_Context || !g_Context->PipelineCache || g_Context->PipelineCachePath.empty())
+			return false;
+
+		size_t dataSize = 0;
+		VK_INVALID(vkGetPipelineCacheData, g_Context->Device, g_Context->PipelineCache, &dataSize, nullptr)
 		{
-			vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
-			swapchain->Surface = nullptr;
-			swapchain->Window  = nullptr;
-			swapchain->Extents = {};
 			return false;
 		}
-		uint32_t imageCount = 0;
-		VK_INVALID(vkGetSwapchainImagesKHR, g_Context->Device, swapchain->Swapchain, &imageCount, nullptr)
+		std::vector<uint8_t> contents(sizeof(PipelineCacheFileHeader) + dataSize);
+		VK_INVALID(vkGetPipelineCacheData, g_Context->Device, g_Context->PipelineCache, &dataSize, contents.data() + sizeof(PipelineCacheFileHeader))
 		{
-			vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-			vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
-			swapchain->Swapchain = nullptr;
-			swapchain->Surface   = nullptr;
-			swapchain->Window    = nullptr;
-			swapchain->Extents   = {};
 			return false;
 		}
-		swapchain->Images.resize(imageCount);
-		VK_INVALID(vkGetSwapchainImagesKHR, g_Context->Device, swapchain->Swapchain, &imageCount, swapchain->Images.column<0>())
+		contents.resize(sizeof(PipelineCacheFileHeader) + dataSize);
+
+		VkPhysicalDeviceProperties props {};
+		vkGetPhysicalDeviceProperties(g_Context->PhysicalDevice, &props);
+		PipelineCacheFileHeader header {
+			.Magic             = c_PipelineCacheMagic,
+			.Version           = c_PipelineCacheVersion,
+			.VendorID          = props.vendorID,
+			.DeviceID          = props.deviceID,
+			.DriverVersion     = props.driverVersion,
+			.PipelineCacheUUID = {},
+			.DataSize          = dataSize,
+			.DataHash          = HashPipelineCacheData(contents.data() + sizeof(PipelineCacheFileHeader), dataSize)
+		};
+		memcpy(header.PipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE);
+		memcpy(contents.data(), &header, sizeof(header));
+
+		if (!WriteFileAtomic(g_Context->PipelineCachePath, contents.data(), contents.size()))
 		{
-			vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-			vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
-			swapchain->Swapchain = nullptr;
-			swapchain->Surface   = nullptr;
-			swapchain->Window    = nullptr;
-			swapchain->Extents   = {};
+			std::cout << std::format("Failed to write pipeline cache '{}'\n", g_Context->PipelineCachePath);
 			return false;
 		}
-		VkImageViewCreateInfo ivCreateInfo {
-			.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-			.pNext            = nullptr,
-			.flags            = 0,
-			.image            = nullptr,
-			.viewType         = VK_IMAGE_VIEW_TYPE_2D,
-			.format           = VK_FORMAT_B8G8R8A8_UNORM,
-			.components       = {},
-			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+		return true;
+	}
+
+	struct PhysicalDeviceCandidate
+	{
+		uint64_t    Score       = 0; // Zero when the device can not run the tests
+		uint32_t    QueueFamily = 0;
+		std::string UUID;            // deviceUUID in hex, accepted by ContextSpec::Device
+		std::string Reason;          // Why the device was rejected
+	};
+
+	static bool FeaturesSupported(const VkBool32* requested, const VkBool32* supported, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (requested[i] && !supported[i])
+				return false;
+		}
+		return true;
+	}
+
+	// Checks the core feature structs in the requested chain, extension structs are left to vkCreateDevice
+	static bool DeviceFeaturesSupported(VkPhysicalDevice device, const VkPhysicalDeviceFeatures2* requested)
+	{
+		VkPhysicalDeviceVulkan13Features vk13 {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+			.pNext = nullptr
 		};
-		for (uint32_t i = 0; i < imageCount; ++i)
+		VkPhysicalDeviceVulkan12Features vk12 {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+			.pNext = &vk13
+		};
+		VkPhysicalDeviceVulkan11Features vk11 {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES,
+			.pNext = &vk12
+		};
+		VkPhysicalDeviceFeatures2 features {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = &vk11
+		};
+		vkGetPhysicalDeviceFeatures2(device, &features);
+
+		for (auto next = (const VkBaseInStructure*) requested; next; next = next->pNext)
 		{
-			ivCreateInfo.image = swapchain->Images.entry<0>(i);
-			VK_INVALID(vkCreateImageView, g_Context->Device, &ivCreateInfo, nullptr, &swapchain->Images.entry<1>(i))
+			bool supported = true;
+			switch (next->sType)
 			{
-				for (uint32_t j = 0; j < i; ++j)
-					vkDestroyImageView(g_Context->Device, swapchain->Images.entry<1>(j), nullptr);
-				swapchain->Images.clear();
-				vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-				vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
-				swapchain->Swapchain = nullptr;
-				swapchain->Surface   = nullptr;
-				swapchain->Window    = nullptr;
-				swapchain->Extents   = {};
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2:
+				supported = FeaturesSupported(&((const VkPhysicalDeviceFeatures2*) next)->features.robustBufferAccess, &features.features.robustBufferAccess, sizeof(VkPhysicalDeviceFeatures) / sizeof(VkBool32));
+				break;
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES:
+				supported = FeaturesSupported(&((const VkPhysicalDeviceVulkan11Features*) next)->storageBuffer16BitAccess, &vk11.storageBuffer16BitAccess, c_Vk11FeatureCount);
+				break;
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES:
+				supported = FeaturesSupported(&((const VkPhysicalDeviceVulkan12Features*) next)->samplerMirrorClampToEdge, &vk12.samplerMirrorClampToEdge, c_Vk12FeatureCount);
+				break;
+			case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES:
+				supported = FeaturesSupported(&((const VkPhysicalDeviceVulkan13Features*) next)->robustImageAccess, &vk13.robustImageAccess, c_Vk13FeatureCount);
+				break;
+			default: break;
+			}
+			if (!supported)
+				return false;
+		}
+		return true;
+	}
+
+	// Returns the first extension the device is missing, nullptr when it has all of them
+	static const char* MissingDeviceExtension(VkPhysicalDevice device, uint32_t extCount, const char* const* exts)
+	{
+		uint32_t count = 0;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &count, nullptr);
+		std::vector<VkExtensionProperties> props(count);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &count, props.data());
+		for (uint32_t i = 0; i < extCount; ++i)
+		{
+			bool found = false;
+			for (uint32_t j = 0; j < count && !found; ++j)
+				found = strcmp(exts[i], props[j].extensionName) == 0;
+			if (!found)
+				return exts[i];
+		}
+		return nullptr;
+	}
+
+	// name matches a case insensitive part of the device name, or the whole deviceUUID in hex with or without dashes
+	static bool DeviceMatches(const char* deviceName, std::string_view uuidHex, std::string_view name)
+	{
+		auto lower = [](char c) -> char { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; };
+
+		std::string match;
+		std::string stripped;
+		for (char c : name)
+		{
+			match += lower(c);
+			if (c != '-')
+				stripped += lower(c);
+		}
+		if (stripped == uuidHex)
+			return true;
+
+		std::string lowerName;
+		for (const char* c = deviceName; *c; ++c)
+			lowerName += lower(*c);
+		return lowerName.find(match) != std::string::npos;
+	}
+
+	// Device type decides first so software devices like lavapipe only run when nothing else can, device local memory breaks ties
+	static uint64_t DeviceTypeScore(VkPhysicalDeviceType type)
+	{
+		switch (type)
+		{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 5;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 4;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return 3;
+		case VK_PHYSICAL_DEVICE_TYPE_CPU: return 2;
+		default: return 1;
+		}
+	}
+
+	static PhysicalDeviceCandidate ScorePhysicalDevice(VkPhysicalDevice device, const ContextSpec* spec)
+	{
+		PhysicalDeviceCandidate candidate {};
+
+		VkPhysicalDeviceIDProperties idProps {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+			.pNext = nullptr
+		};
+		VkPhysicalDeviceProperties2 props {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+			.pNext = &idProps
+		};
+		vkGetPhysicalDeviceProperties2(device, &props);
+		for (uint8_t b : idProps.deviceUUID)
+			candidate.UUID += std::format("{:02x}", b);
+		if (spec->Device && !DeviceMatches(props.properties.deviceName, candidate.UUID, spec->Device))
+		{
+			candidate.Reason = std::format("does not match '{}'", spec->Device);
+			return candidate;
+		}
+		if (props.properties.apiVersion < VK_API_VERSION_1_3)
+		{
+			candidate.Reason = std::format("only supports Vulkan {}.{}", VK_API_VERSION_MAJOR(props.properties.apiVersion), VK_API_VERSION_MINOR(props.properties.apiVersion));
+			return candidate;
+		}
+		if (const char* missing = MissingDeviceExtension(device, spec->DeviceExtCount, spec->DeviceExts))
+		{
+			candidate.Reason = std::format("does not support {}", missing);
+			return candidate;
+		}
+		if (!DeviceFeaturesSupported(device, &spec->DeviceFeatures))
+		{
+			candidate.Reason = "does not support the requested features";
+			return candidate;
+		}
+
+		// Everything is submitted to one graphics and compute queue, prefer a family with timestamps for the GPU profiler
+		constexpr VkQueueFlags c_RequiredQueueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+
+		VkQueueFamilyProperties families[c_MaxQueueFamilies] {};
+		uint32_t                familyCount = c_MaxQueueFamilies;
+		uint32_t                family      = ~0U;
+		vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families);
+		for (uint32_t i = 0; i < familyCount; ++i)
+		{
+			if ((families[i].queueFlags & c_RequiredQueueFlags) != c_RequiredQueueFlags)
+				continue;
+			if (family == ~0U || (!families[family].timestampValidBits && families[i].timestampValidBits))
+				family = i;
+		}
+		if (family == ~0U)
+		{
+			candidate.Reason = "has no graphics and compute queue family";
+			return candidate;
+		}
+
+		VkPhysicalDeviceMemoryProperties memProps {};
+		vkGetPhysicalDeviceMemoryProperties(device, &memProps);
+		uint64_t deviceLocal = 0;
+		for (uint32_t i = 0; i < memProps.memoryHeapCount; ++i)
+		{
+			if (memProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+				deviceLocal += memProps.memoryHeaps[i].size;
+		}
+
+		candidate.QueueFamily = family;
+		candidate.Score       = DeviceTypeScore(props.properties.deviceType) << 48 | std::min<uint64_t>(deviceLocal >> 20, (1ULL << 48) - 1);
+		return candidate;
+	}
+
+	// Takes the next unused queue of a family supporting any of required, preferring families with the fewest avoided flags.
+	// Returns false when every such queue is taken
+	static bool PickQueue(const VkQueueFamilyProperties* families, uint32_t familyCount, uint32_t* usedQueues, VkQueueFlags required, VkQueueFlags avoided, QueueState& queue)
+	{
+		uint32_t best        = ~0U;
+		uint32_t bestAvoided = ~0U;
+		for (uint32_t i = 0; i < familyCount; ++i)
+		{
+			if (!(families[i].queueFlags & required) || usedQueues[i] >= families[i].queueCount)
+				continue;
+			uint32_t avoidedCount = (uint32_t) std::popcount(families[i].queueFlags & avoided);
+			if (avoidedCount < bestAvoided)
+			{
+				best        = i;
+				bestAvoided = avoidedCount;
+			}
+		}
+		if (best == ~0U)
+			return false;
+		queue.Family = best;
+		queue.Index  = usedQueues[best]++;
+		return true;
+	}
+
+	static void DestroyQueueTimelines(Context* context)
+	{
+		for (auto& queue : context->Queues)
+		{
+			if (queue.Timeline)
+				vkDestroySemaphore(context->Device, queue.Timeline, nullptr);
+			queue.Timeline = nullptr;
+		}
+	}
+
+	// Waits for every submit that read from partition and empties it, only called between frames so no thread is allocating or submitting.
+	// A frame that allocated and then never submitted again has nothing on the GPU reading the data, its value would never be signaled
+	static void WaitUploadPartition(UploadPartition& partition)
+	{
+		uint32_t    registered = std::min(partition.WaitCount.load(std::memory_order_relaxed), c_MaxUploadWaits);
+		uint32_t    waitCount  = 0;
+		VkSemaphore timelines[c_MaxUploadWaits];
+		uint64_t    values[c_MaxUploadWaits];
+		for (uint32_t i = 0; i < registered; ++i)
+		{
+			FrameState* frame = partition.Frames[i];
+			if (frame->TimelineValue < partition.Values[i])
+				continue;
+			timelines[waitCount] = frame->Timeline;
+			values[waitCount]    = partition.Values[i];
+			++waitCount;
+		}
+		if (waitCount)
+		{
+			VkSemaphoreWaitInfo waitInfo {
+				.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+				.pNext          = nullptr,
+				.flags          = 0,
+				.semaphoreCount = waitCount,
+				.pSemaphores    = timelines,
+				.pValues        = values
+			};
+			VK_VALIDATE(vkWaitSemaphores, g_Context->Device, &waitInfo, ~0ULL);
+		}
+		partition.Used.store(0, std::memory_order_relaxed);
+		partition.WaitCount.store(0, std::memory_order_relaxed);
+		partition.Failed.store(0, std::memory_order_relaxed);
+	}
+
+	static bool InitUploadRing(VkDeviceSize size)
+	{
+		auto& ring = g_Context->Uploads;
+		if (!size)
+			return true;
+
+		VkPhysicalDeviceProperties props {};
+		vkGetPhysicalDeviceProperties(g_Context->PhysicalDevice, &props);
+		ring.Alignment     = std::max({ props.limits.minUniformBufferOffsetAlignment, props.limits.minStorageBufferOffsetAlignment, props.limits.minTexelBufferOffsetAlignment, (VkDeviceSize) 16 });
+		ring.PartitionSize = size / g_Context->FramesInFlight / ring.Alignment * ring.Alignment;
+		if (!ring.PartitionSize)
+			return false;
+
+		VkBufferCreateInfo createInfo {
+			.sType                 = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext                 = nullptr,
+			.flags                 = 0,
+			.size                  = ring.PartitionSize * g_Context->FramesInFlight,
+			.usage                 = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			.sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 0,
+			.pQueueFamilyIndices   = nullptr
+		};
+		VK_INVALID(vkCreateBuffer, g_Context->Device, &createInfo, nullptr, &ring.Buffer)
+		{
+			return false;
+		}
+		// Device local host visible memory lets the GPU read uploads without a copy, plain host memory works everywhere
+		VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		VkMemoryRequirements  requirements {};
+		vkGetBufferMemoryRequirements(g_Context->Device, ring.Buffer, &requirements);
+		if (FindDeviceMemoryIndex(requirements.memoryTypeBits, flags | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != ~0U)
+			flags |= VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		ring.Memory = AllocateBufferMemory(ring.Buffer, flags);
+		if (!ring.Memory || !ring.Memory->Mapped)
+			return false;
+		ring.Partitions = new UploadPartition[g_Context->FramesInFlight];
+		return true;
+	}
+
+	static void DestroyUploadRing(Context* context)
+	{
+		// Every frame that read from the ring waited for its timeline in DeInitFrameState already
+		auto& ring = context->Uploads;
+		delete[] ring.Partitions;
+		if (ring.Buffer)
+			vkDestroyBuffer(context->Device, ring.Buffer, nullptr);
+		FreeDeviceMemory(ring.Memory);
+		ring = {};
+	}
+
+	// Everything still allocated is a leak by now, it is reported and the blocks go regardless
+	static void DestroyDeviceMemoryPools(Context* context)
+	{
+		uint32_t leaked = 0;
+		for (auto& pools : context->MemoryPools)
+		{
+			for (auto& pool : pools)
+			{
+				for (auto block : pool.Blocks)
+				{
+					leaked += block->Allocator.AllocationCount();
+					vkFreeMemory(context->Device, block->Memory, nullptr);
+					delete block;
+				}
+				pool.Blocks.clear();
+			}
+		}
+		leaked += context->DedicatedCount;
+		if (leaked)
+			std::cout << std::format("{} device memory allocations were never freed\n", leaked);
+		delete context->AllocationPool;
+		context->AllocationPool = nullptr;
+	}
+
+	bool Init(const ContextSpec* spec)
+	{
+		ContextSpec defaultSpec {};
+		if (!spec)
+			spec = &defaultSpec;
+		if (spec->FramesInFlight < 1)
+			return false;
+
+		Context* context = new Context();
+
+		// Create Instance
+		{
+			VkApplicationInfo appInfo {
+				.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+				.pNext              = nullptr,
+				.pApplicationName   = spec->AppName,
+				.applicationVersion = spec->AppVersion,
+				.pEngineName        = "Tests",
+				.engineVersion      = VK_MAKE_API_VERSION(0, 1, 0, 0),
+				.apiVersion         = VK_API_VERSION_1_3
+			};
+			VkInstanceCreateInfo createInfo {
+				.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+				.pNext                   = nullptr,
+				.flags                   = 0,
+				.pApplicationInfo        = &appInfo,
+				.enabledLayerCount       = 0,
+				.ppEnabledLayerNames     = nullptr,
+				.enabledExtensionCount   = spec->InstanceExtCount,
+				.ppEnabledExtensionNames = spec->InstanceExts
+			};
+			VK_INVALID(vkCreateInstance, &createInfo, nullptr, &context->Instance)
+			{
+				delete context;
 				return false;
 			}
 		}
+		// Select Physical Device
+		{
+			VkPhysicalDevice devices[c_MaxPhysicalDevices];
+			uint32_t         count = c_MaxPhysicalDevices;
+			VK_INVALID(vkEnumeratePhysicalDevices, context->Instance, &count, devices)
+			{
+				vkDestroyInstance(context->Instance, nullptr);
+				delete context;
+				return false;
+			}
+			PhysicalDeviceCandidate candidates[c_MaxPhysicalDevices];
+			uint32_t                best = ~0U;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				candidates[i] = ScorePhysicalDevice(devices[i], spec);
+				if (candidates[i].Score && (best == ~0U || candidates[i].Score > candidates[best].Score))
+					best = i;
+			}
+			if (best == ~0U)
+			{
+				std::cout << "Failed to find appropriate Vulkan Physical Device\n";
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					VkPhysicalDeviceProperties props {};
+					vkGetPhysicalDeviceProperties(devices[i], &props);
+					std::cout << std::format("  '{}' ({}) {}\n", props.deviceName, candidates[i].UUID, candidates[i].Reason);
+				}
+				vkDestroyInstance(context->Instance, nullptr);
+				delete context;
+				return false;
+			}
+			context->PhysicalDevice = devices[best];
+			context->QueueFamily    = candidates[best].QueueFamily;
 
-		if (withFrames)
+			VkPhysicalDeviceProperties props {};
+			vkGetPhysicalDeviceProperties(context->PhysicalDevice, &props);
+			std::cout << std::format("Using Vulkan Physical Device '{}' ({}, {})\n", props.deviceName, string_VkPhysicalDeviceType(props.deviceType), candidates[best].UUID);
+		}
+		// Select Queues, graphics is always the first queue of QueueFamily
+		uint32_t queueCounts[c_MaxQueueFamilies] {};
+		{
+			VkQueueFamilyProperties families[c_MaxQueueFamilies] {};
+			uint32_t                familyCount = c_MaxQueueFamilies;
+			vkGetPhysicalDeviceQueueFamilyProperties(context->PhysicalDevice, &familyCount, families);
+
+			auto& graphics = context->Queues[(uint32_t) QueueType::Graphics];
+			auto& compute  = context->Queues[(uint32_t) QueueType::Compute];
+			auto& transfer = context->Queues[(uint32_t) QueueType::Transfer];
+
+			graphics.Family              = context->QueueFamily;
+			graphics.Index               = 0;
+			queueCounts[graphics.Family] = 1;
+			if (!PickQueue(families, familyCount, queueCounts, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT, compute))
+			{
+				compute.Family = graphics.Family;
+				compute.Shared = true;
+			}
+			// Graphics and compute queues can always transfer, even without VK_QUEUE_TRANSFER_BIT
+			if (!PickQueue(families, familyCount, queueCounts, VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT, transfer))
+			{
+				transfer.Family = graphics.Family;
+				transfer.Shared = true;
+			}
+		}
+		// Create Device
 		{
+			float                   prios[c_QueueTypeCount] { 1.0f, 1.0f, 1.0f };
+			VkDeviceQueueCreateInfo qCreateInfos[c_QueueTypeCount] {};
+			uint32_t                qCreateInfoCount = 0;
+			for (uint32_t i = 0; i < c_MaxQueueFamilies; ++i)
+			{
+				if (!queueCounts[i])
+					continue;
+				qCreateInfos[qCreateInfoCount++] = {
+					.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+					.pNext            = nullptr,
+					.flags            = 0,
+					.queueFamilyIndex = i,
+					.queueCount       = queueCounts[i],
+					.pQueuePriorities = prios
+				};
+			}
+			VkDeviceCreateInfo createInfo {
+				.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+				.pNext                   = &spec->DeviceFeatures,
+				.flags                   = 0,
+				.queueCreateInfoCount    = qCreateInfoCount,
+				.pQueueCreateInfos       = qCreateInfos,
+				.enabledLayerCount       = 0,
+				.ppEnabledLayerNames     = nullptr,
+				.enabledExtensionCount   = spec->DeviceExtCount,
+				.ppEnabledExtensionNames = spec->DeviceExts,
+				.pEnabledFeatures        = nullptr
+			};
+			VK_INVALID(vkCreateDevice, context->PhysicalDevice, &createInfo, nullptr, &context->Device)
+			{
+				vkDestroyInstance(context->Instance, nullptr);
+				delete context;
+				return false;
+			}
+			for (auto& queue : context->Queues)
+				vkGetDeviceQueue(context->Device, queue.Family, queue.Index, &queue.Queue);
+			context->Queue = context->Queues[(uint32_t) QueueType::Graphics].Queue;
+		}
+		// Queue timelines
+		{
+			VkSemaphoreTypeCreateInfo stCreateInfo {
+				.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+				.pNext         = nullptr,
+				.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+				.initialValue  = 0
+			};
 			VkSemaphoreCreateInfo sCreateInfo {
 				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-				.pNext = nullptr,
+				.pNext = &stCreateInfo,
 				.flags = 0
 			};
+			for (auto& queue : context->Queues)
+			{
+				VK_INVALID(vkCreateSemaphore, context->Device, &sCreateInfo, nullptr, &queue.Timeline)
+				{
+					DestroyQueueTimelines(context);
+					vkDestroyDevice(context->Device, nullptr);
+					vkDestroyInstance(context->Instance, nullptr);
+					delete context;
+					return false;
+				}
+			}
+		}
+		// Timestamp support of the queue
+		{
+			VkPhysicalDeviceProperties props {};
+			vkGetPhysicalDeviceProperties(context->PhysicalDevice, &props);
+			VkQueueFamilyProperties families[c_MaxQueueFamilies] {};
+			uint32_t                familyCount = c_MaxQueueFamilies;
+			vkGetPhysicalDeviceQueueFamilyProperties(context->PhysicalDevice, &familyCount, families);
+			uint32_t validBits = context->QueueFamily < familyCount ? families[context->QueueFamily].timestampValidBits : 0;
+			if (validBits && props.limits.timestampPeriod > 0.0f)
+			{
+				context->TimestampPeriod = props.limits.timestampPeriod;
+				context->TimestampMask   = validBits >= 64 ? ~0ULL : (1ULL << validBits) - 1;
+			}
+		}
+		if (!InitPipelineCache(context, spec->PipelineCachePath))
+		{
+			DestroyQueueTimelines(context);
+			vkDestroyDevice(context->Device, nullptr);
+			vkDestroyInstance(context->Instance, nullptr);
+			delete context;
+			return false;
+		}
+		context->Headless       = spec->Headless;
+		context->FramesInFlight = spec->FramesInFlight;
+		context->CurrentFrame   = 0;
+		context->FramePool      = new FixedBlockPool(sizeof(SwapchainFrameState) * context->FramesInFlight, alignof(SwapchainFrameState), 8);
+		context->Frames         = AllocateFrames<FrameState>(context);
+		for (uint32_t i = 0; i < context->FramesInFlight; ++i)
+		{
+			if (!InitFrameState(context, &context->Frames[i]))
+			{
+				for (uint32_t j = 0; j < i; ++j)
+					DeInitFrameState(context, &context->Frames[j]);
+				FreeFrames(context, context->Frames);
+				delete context->FramePool;
+				vkDestroyPipelineCache(context->Device, context->PipelineCache, nullptr);
+				DestroyQueueTimelines(context);
+				vkDestroyDevice(context->Device, nullptr);
+				vkDestroyInstance(context->Instance, nullptr);
+				delete context;
+				return false;
+			}
+		}
+		vkGetPhysicalDeviceMemoryProperties(context->PhysicalDevice, &context->MemoryProperties);
+		context->MemoryBlockSize     = std::max<VkDeviceSize>(spec->MemoryBlockSize, TLSFAllocator::c_Granularity);
+		context->AllocationPool      = new FixedBlockPool(sizeof(DeviceAllocation), alignof(DeviceAllocation));
+		context->LastAllocationCount = g_AllocationStats.Allocations;
+		g_Context                    = context;
+		// The ring goes through the device memory allocator, which works on g_Context
+		if (!InitUploadRing(spec->UploadRingSize))
+		{
+			std::cout << "Failed to create the upload ring\n";
+			DeInit();
+			return false;
+		}
+		return true;
+	}
+
+	void DeInit()
+	{
+		if (!g_Context)
+			return;
+		if (g_Context->Frames)
+		{
+			for (uint32_t i = 0; i < g_Context->FramesInFlight; ++i)
+				DeInitFrameState(g_Context, &g_Context->Frames[i]);
+			FreeFrames(g_Context, g_Context->Frames);
+		}
+		delete g_Context->FramePool;
+		DestroyUploadRing(g_Context);
+		DestroyDeviceMemoryPools(g_Context);
+		if (g_Context->PipelineCache)
+		{
+			SavePipelineCache();
+			vkDestroyPipelineCache(g_Context->Device, g_Context->PipelineCache, nullptr);
+		}
+		DestroyQueueTimelines(g_Context);
+		vkDestroyDevice(g_Context->Device, nullptr);
+		vkDestroyInstance(g_Context->Instance, nullptr);
+		delete g_Context;
+		g_Context = nullptr;
+	}
+
+	uint64_t SubmitQueue(QueueType type, uint32_t cmdBufCount, const VkCommandBuffer* cmdBufs, uint32_t waitCount, const VkSemaphoreSubmitInfo* waits, uint32_t signalCount, const VkSemaphoreSubmitInfo* signals)
+	{
+		if (!g_Context || type >= QueueType::Count || cmdBufCount > c_MaxSubmitCommandBuffers || signalCount >= c_MaxSubmitSignals)
+			return 0;
+
+		auto&                     queue = g_Context->Queues[(uint32_t) type];
+		VkCommandBufferSubmitInfo cmdBufInfos[c_MaxSubmitCommandBuffers];
+		VkSemaphoreSubmitInfo     signalInfos[c_MaxSubmitSignals];
+		for (uint32_t i = 0; i < cmdBufCount; ++i)
+		{
+			cmdBufInfos[i] = {
+				.sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+				.pNext         = nullptr,
+				.commandBuffer = cmdBufs[i],
+				.deviceMask    = 0
+			};
+		}
+		for (uint32_t i = 0; i < signalCount; ++i)
+			signalInfos[i] = signals[i];
+		signalInfos[signalCount] = {
+			.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.pNext       = nullptr,
+			.semaphore   = queue.Timeline,
+			.value       = queue.Value + 1,
+			.stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.deviceIndex = 0
+		};
+		VkSubmitInfo2 submit {
+			.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+			.pNext                    = nullptr,
+			.flags                    = 0,
+			.waitSemaphoreInfoCount   = waitCount,
+			.pWaitSemaphoreInfos      = waits,
+			.commandBufferInfoCount   = cmdBufCount,
+			.pCommandBufferInfos      = cmdBufInfos,
+			.signalSemaphoreInfoCount = signalCount + 1,
+			.pSignalSemaphoreInfos    = signalInfos
+		};
+		VK_INVALID(vkQueueSubmit2, queue.Queue, 1, &submit, nullptr)
+		{
+			return 0;
+		}
+		return ++queue.Value;
+	}
+
+	VkSemaphoreSubmitInfo QueueWaitInfo(QueueType type, uint64_t value, VkPipelineStageFlags2 stages)
+	{
+		return {
+			.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.pNext       = nullptr,
+			.semaphore   = g_Context->Queues[(uint32_t) type].Timeline,
+			.value       = value,
+			.stageMask   = stages,
+			.deviceIndex = 0
+		};
+	}
+
+	bool WaitQueue(QueueType type, uint64_t value, uint64_t timeout)
+	{
+		if (!g_Context || type >= QueueType::Count)
+			return false;
+		VkSemaphoreWaitInfo waitInfo {
+			.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.pNext          = nullptr,
+			.flags          = 0,
+			.semaphoreCount = 1,
+			.pSemaphores    = &g_Context->Queues[(uint32_t) type].Timeline,
+			.pValues        = &value
+		};
+		return vkWaitSemaphores(g_Context->Device, &waitInfo, timeout) == VK_SUCCESS;
+	}
+
+	static constexpr double c_PacerSmoothing = 0.1; // Weight of the newest sample in CpuTime and GpuTime
+
+	// Records the completion of frame at time, the GPU time is what the frame took after the previous one finished or it was submitted
+	static void PacerComplete(FramePacer* pacer, uint64_t frame, uint64_t time)
+	{
+		uint32_t slot  = (uint32_t) (frame % c_MaxPacedFrames);
+		uint64_t begin = std::max(pacer->LastCompletion, pacer->EndTimes[slot]);
+		if (time > begin)
+			pacer->GpuTime = pacer->GpuTime > 0.0 ? pacer->GpuTime + (time - begin - pacer->GpuTime) * c_PacerSmoothing : (double) (time - begin);
+		pacer->Latency.Add(time - pacer->StartTimes[slot]);
+		pacer->LastCompletion = time;
+		++pacer->Completed;
+	}
+
+	// Marks every ended frame the graphics queue Timeline has passed as completed at time
+	static void PacerPoll(FramePacer* pacer, uint64_t time)
+	{
+		auto&    queue   = g_Context->Queues[(uint32_t) QueueType::Graphics];
+		uint64_t reached = 0;
+		if (!VK_VALIDATE(vkGetSemaphoreCounterValue, g_Context->Device, queue.Timeline, &reached))
+			return;
+		while (pacer->Completed < pacer->FrameNumber && pacer->Values[pacer->Completed % c_MaxPacedFrames] <= reached)
+			PacerComplete(pacer, pacer->Completed, time);
+	}
+
+	// Waits up to timeout ns for the oldest frame in flight, returns false on timeout
+	static bool PacerWaitOldest(FramePacer* pacer, uint64_t timeout)
+	{
+		uint64_t value = pacer->Values[pacer->Completed % c_MaxPacedFrames];
+		if (value == ~0ULL)
+			return false;
+		bool done = WaitQueue(QueueType::Graphics, value, timeout);
+		PacerPoll(pacer, FrameTimings::Now());
+		return done;
+	}
+
+	void InitFramePacer(FramePacer* pacer, PacingMode mode, uint64_t latencyTarget)
+	{
+		if (!pacer || !g_Context)
+			return;
+		*pacer                 = {};
+		pacer->Mode            = mode;
+		pacer->LatencyTarget   = latencyTarget;
+		pacer->MaxFrames       = std::min(g_Context->FramesInFlight, c_MaxPacedFrames);
+		pacer->EffectiveFrames = pacer->MaxFrames;
+	}
+
+	uint64_t PacerBeginFrame(FramePacer* pacer)
+	{
+		if (!pacer || !g_Context)
+			return 0;
+
+		uint64_t start = FrameTimings::Now();
+		PacerPoll(pacer, start);
+
+		// Every frame in flight adds about one frame interval of latency, so the target caps how many may be queued
+		if (pacer->Mode == PacingMode::Latency && pacer->GpuTime > 0.0)
+		{
+			double interval        = std::max(pacer->GpuTime, pacer->CpuTime);
+			pacer->EffectiveFrames = (uint32_t) std::clamp(pacer->LatencyTarget / interval, 1.0, (double) pacer->MaxFrames);
+		}
+		uint32_t limit = pacer->Mode == PacingMode::Latency ? pacer->EffectiveFrames : pacer->MaxFrames;
+		while (pacer->FrameNumber - pacer->Completed >= limit)
+		{
+			if (!PacerWaitOldest(pacer, ~0ULL))
+				break;
+		}
 
-			swapchain->Frames = new SwapchainFrameState[g_Context->FramesInFlight];
-			for (uint32_t i = 0; i < g_Context->FramesInFlight; ++i)
+		// A frame starting now finishes its own GPU time after both its CPU time and the queued frames are done.
+		// Starting later than the moment the GPU runs dry would only cost throughput, so the delay never goes past it
+		if (pacer->Mode == PacingMode::Latency)
+		{
+			uint64_t delayStart = FrameTimings::Now();
+			while (pacer->FrameNumber > pacer->Completed && pacer->GpuTime > 0.0)
 			{
-				if (!InitFrameState(g_Context, &swapchain->Frames[i]))
-				{
-					for (uint32_t j = 0; j < i; ++j)
-					{
-						vkDestroySemaphore(g_Context->Device, swapchain->Frames[i].ImageReady, nullptr);
-						DeInitFrameState(g_Context, &swapchain->Frames[j]);
-					}
-					delete[] swapchain->Frames;
-					for (uint32_t j = 0; j < swapchain->Images.size(); ++j)
-						vkDestroyImageView(g_Context->Device, swapchain->Images.entry<1>(j), nullptr);
-					swapchain->Images.clear();
-					vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-					vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
-					swapchain->Swapchain = nullptr;
-					swapchain->Surface   = nullptr;
-					swapchain->Window    = nullptr;
-					swapchain->Extents   = {};
-					return false;
-				}
-				VK_INVALID(vkCreateSemaphore, g_Context->Device, &sCreateInfo, nullptr, &swapchain->Frames[i].ImageReady)
-				{
-					for (uint32_t j = 0; j < i; ++j)
-					{
-						vkDestroySemaphore(g_Context->Device, swapchain->Frames[i].ImageReady, nullptr);
-						DeInitFrameState(g_Context, &swapchain->Frames[j]);
-					}
-					DeInitFrameState(g_Context, &swapchain->Frames[i]);
-					delete[] swapchain->Frames;
-					for (uint32_t j = 0; j < swapchain->Images.size(); ++j)
-						vkDestroyImageView(g_Context->Device, swapchain->Images.entry<1>(j), nullptr);
-					swapchain->Images.clear();
-					vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-					vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
-					swapchain->Swapchain = nullptr;
-					swapchain->Surface   = nullptr;
-					swapchain->Window    = nullptr;
-					swapchain->Extents   = {};
-					return false;
-				}
-				swapchain->Frames->ImageIndex = 0;
+				uint64_t now       = FrameTimings::Now();
+				double   queued    = (pacer->FrameNumber - pacer->Completed) * pacer->GpuTime - (double) (now - std::min(now, pacer->LastCompletion));
+				double   gpuIdle   = std::max(queued, 0.0);
+				double   predicted = std::max(pacer->CpuTime, gpuIdle) + pacer->GpuTime;
+				double   delay     = std::min(predicted - (double) pacer->LatencyTarget, gpuIdle - pacer->CpuTime);
+				if (delay < 1'000.0)
+					break;
+				// Waiting on the oldest frame instead of sleeping notices its completion the moment it happens
+				PacerWaitOldest(pacer, (uint64_t) delay);
 			}
+			pacer->Delayed += FrameTimings::Now() - delayStart;
 		}
-		return true;
+
+		uint64_t now            = FrameTimings::Now();
+		uint32_t slot           = (uint32_t) (pacer->FrameNumber % c_MaxPacedFrames);
+		pacer->StartTimes[slot] = now;
+		pacer->Values[slot]     = ~0ULL; // Not ended yet
+		++pacer->FrameNumber;
+		return now - start;
 	}
 
-	void DeInitSwapchainState(SwapchainState* swapchain)
+	bool PacerEndFrame(FramePacer* pacer)
 	{
-		if (!g_Context || !swapchain)
+		if (!pacer || !g_Context || pacer->FrameNumber == pacer->Completed)
+			return false;
+
+		uint32_t slot  = (uint32_t) ((pacer->FrameNumber - 1) % c_MaxPacedFrames);
+		uint64_t now   = FrameTimings::Now();
+		uint64_t value = SubmitQueue(QueueType::Graphics, 0, nullptr);
+
+		// A failed signal would stall the pacer forever, the frame counts as done with whatever the queue reached so far
+		pacer->Values[slot]   = value ? value : g_Context->Queues[(uint32_t) QueueType::Graphics].Value;
+		pacer->EndTimes[slot] = now;
+		double cpuTime        = (double) (now - pacer->StartTimes[slot]);
+		pacer->CpuTime        = pacer->CpuTime > 0.0 ? pacer->CpuTime + (cpuTime - pacer->CpuTime) * c_PacerSmoothing : cpuTime;
+		return value != 0;
+	}
+
+	void NextFrame()
+	{
+		if (!g_Context)
 			return;
+		g_Context->CurrentFrame = (g_Context->CurrentFrame + 1) % g_Context->FramesInFlight;
+		g_Context->Frames[g_Context->CurrentFrame].Arena.Reset();
+		if (g_Context->Uploads.Partitions)
+		{
+			++g_Context->Uploads.Epoch;
+			WaitUploadPartition(g_Context->Uploads.Partitions[g_Context->CurrentFrame]);
+		}
 
-		if (swapchain->Frames)
+		uint64_t allocations           = g_AllocationStats.Allocations;
+		g_Context->FrameAllocations    = allocations - g_Context->LastAllocationCount;
+		g_Context->LastAllocationCount = allocations;
+	}
+
+	void* FrameAllocate(size_t size, size_t alignment)
+	{
+		if (!g_Context)
+			return nullptr;
+		return g_Context->Frames[g_Context->CurrentFrame].Arena.Allocate(size, alignment);
+	}
+
+	UploadAllocation UploadAllocate(FrameState* frame, VkDeviceSize size, VkDeviceSize alignment)
+	{
+		if (!g_Context || !frame || !g_Context->Uploads.Partitions)
+			return {};
+
+		auto& ring      = g_Context->Uploads;
+		auto& partition = ring.Partitions[g_Context->CurrentFrame];
+		if (!alignment)
+			alignment = ring.Alignment;
+
+		// Registering first means any thread that sees the frame registered also sees the wait it added
+		uint64_t retire = frame->TimelineValue + 1;
+		if (frame->UploadEpoch.load(std::memory_order_acquire) != ring.Epoch || frame->UploadRetire.load(std::memory_order_relaxed) < retire)
 		{
-			for (uint32_t i = 0; i < g_Context->FramesInFlight; ++i)
+			uint32_t wait = partition.WaitCount.fetch_add(1, std::memory_order_relaxed);
+			if (wait >= c_MaxUploadWaits)
 			{
-				DeInitFrameState(g_Context, &swapchain->Frames[i]);
-				vkDestroySemaphore(g_Context->Device, swapchain->Frames[i].ImageReady, nullptr);
+				partition.Failed.fetch_add(1, std::memory_order_relaxed);
+				return {};
 			}
-			delete[] swapchain->Frames;
+			partition.Frames[wait] = frame;
+			partition.Values[wait] = retire;
+			frame->UploadRetire.store(retire, std::memory_order_relaxed);
+			frame->UploadEpoch.store(ring.Epoch, std::memory_order_release);
 		}
-		for (uint32_t i = 0; i < swapchain->Images.size(); ++i)
-			vkDestroyImageView(g_Context->Device, swapchain->Images.entry<1>(i), nullptr);
-		swapchain->Images.clear();
-		vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-		vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
-		swapchain->Swapchain = nullptr;
-		swapchain->Surface   = nullptr;
-		swapchain->Window    = nullptr;
-		swapchain->Extents   = {};
+
+		VkDeviceSize used   = partition.Used.load(std::memory_order_relaxed);
+		VkDeviceSize offset = 0;
+		do
+		{
+			offset = (used + alignment - 1) & ~(alignment - 1);
+			if (offset + size > ring.PartitionSize)
+			{
+				partition.Failed.fetch_add(1, std::memory_order_relaxed);
+				return {};
+			}
+		}
+		while (!partition.Used.compare_exchange_weak(used, offset + size, std::memory_order_relaxed));
+
+		offset += g_Context->CurrentFrame * ring.PartitionSize;
+		return {
+			.Data   = (uint8_t*) ring.Memory->Mapped + offset,
+			.Buffer = ring.Buffer,
+			.Offset = offset
+		};
 	}
 
-	bool SwapchainAcquireImage(SwapchainState* swapchain)
+	// Tried in order when the spec does not force a present mode, FIFO is always supported so every list ends with it
+	static constexpr VkPresentModeKHR c_PreferredPresentModes[(uint32_t) PresentPreference::Count][3] {
+		{ VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_FIFO_KHR },
+		{ VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR }
+	};
+	static constexpr VkFormat c_FallbackSurfaceFormats[] { VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM };
+
+	// VK_INCOMPLETE still fills the arrays, modes and formats past them are never picked
+	static void QuerySwapchainSupport(SwapchainState* swapchain)
 	{
-		if (!g_Context || !swapchain)
-			return false;
+		auto& policy            = swapchain->Policy;
+		policy.PresentModeCount = c_MaxSurfacePresentModes;
+		policy.FormatCount      = c_MaxSurfaceFormats;
+		if (vkGetPhysicalDeviceSurfacePresentModesKHR(g_Context->PhysicalDevice, swapchain->Surface, &policy.PresentModeCount, policy.PresentModes) < VK_SUCCESS)
+			policy.PresentModeCount = 0;
+		if (vkGetPhysicalDeviceSurfaceFormatsKHR(g_Context->PhysicalDevice, swapchain->Surface, &policy.FormatCount, policy.Formats) < VK_SUCCESS)
+			policy.FormatCount = 0;
+	}
 
-		if (swapchain->Invalidated &&
-			!SwapchainResize(swapchain))
-			return false;
+	static bool SupportsPresentMode(const SwapchainPolicy& policy, VkPresentModeKHR mode)
+	{
+		for (uint32_t i = 0; i < policy.PresentModeCount; ++i)
+		{
+			if (policy.PresentModes[i] == mode)
+				return true;
+		}
+		return mode == VK_PRESENT_MODE_FIFO_KHR;
+	}
 
-		auto&    frame  = swapchain->Frames[g_Context->CurrentFrame];
-		VkResult result = vkAcquireNextImageKHR(g_Context->Device, swapchain->Swapchain, ~0ULL, frame.ImageReady, nullptr, &frame.ImageIndex);
-		switch (result)
+	static const VkSurfaceFormatKHR* FindSurfaceFormat(const SwapchainPolicy& policy, VkFormat format)
+	{
+		for (uint32_t i = 0; i < policy.FormatCount; ++i)
 		{
-		case VK_ERROR_OUT_OF_DATE_KHR:
-		case VK_SUBOPTIMAL_KHR:
-			if (!SwapchainResize(swapchain))
-				return false;
-			VK_INVALID(vkAcquireNextImageKHR, g_Context->Device, swapchain->Swapchain, ~0ULL, frame.ImageReady, nullptr, &frame.ImageIndex)
-			{
-				return false;
-			}
-			break;
-		default:
-			if (!Helpers::VkValidate(result, "vkAcquireNextImageKHR"))
-				return false;
-			break;
+			if (policy.Formats[i].format == format && policy.Formats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
+				return &policy.Formats[i];
 		}
-		return true;
+		return nullptr;
 	}
 
-	bool SwapchainPresent(SwapchainState* swapchain)
+	// Selects image count, present mode and format from the spec, the cached support and caps, returns true when any of them changed
+	static bool SelectSwapchainConfig(SwapchainPolicy& policy, const VkSurfaceCapabilitiesKHR& caps)
 	{
-		if (!g_Context || !swapchain)
-			return false;
+		auto& spec           = policy.Spec;
+		auto  preference     = spec.Preference < PresentPreference::Count ? spec.Preference : PresentPreference::Latency;
+		policy.MinImageCount = caps.minImageCount;
+		policy.MaxImageCount = caps.maxImageCount;
 
-		auto& frame = swapchain->Frames[g_Context->CurrentFrame];
+		uint32_t imageCount = spec.ImageCount ? spec.ImageCount : caps.minImageCount + (preference == PresentPreference::Throughput ? 2 : 1);
+		imageCount          = std::max(imageCount, caps.minImageCount);
+		if (caps.maxImageCount)
+			imageCount = std::min(imageCount, caps.maxImageCount);
 
-		VkPresentInfoKHR presentInfo {
-			.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-			.pNext              = nullptr,
-			.waitSemaphoreCount = 1,
-			.pWaitSemaphores    = &frame.RenderDone,
-			.swapchainCount     = 1,
-			.pSwapchains        = &swapchain->Swapchain,
-			.pImageIndices      = &frame.ImageIndex,
-			.pResults           = nullptr
-		};
-		VkResult result = vkQueuePresentKHR(g_Context->Queue, &presentInfo);
-		switch (result)
+		VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+		if (spec.PresentMode != VK_PRESENT_MODE_MAX_ENUM_KHR && SupportsPresentMode(policy, spec.PresentMode))
 		{
-		case VK_ERROR_OUT_OF_DATE_KHR:
-		case VK_SUBOPTIMAL_KHR:
-			swapchain->Invalidated = true;
-			break;
-		default:
-			if (!Helpers::VkValidate(result, "vkQueuePresentKHR"))
-				return false;
-			break;
+			presentMode = spec.PresentMode;
 		}
-		return true;
+		else
+		{
+			for (auto mode : c_PreferredPresentModes[(uint32_t) preference])
+			{
+				if (SupportsPresentMode(policy, mode))
+				{
+					presentMode = mode;
+					break;
+				}
+			}
+		}
+
+		// A lone VK_FORMAT_UNDEFINED means the surface takes any format
+		VkSurfaceFormatKHR format = { spec.Format, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+		if (!(policy.FormatCount == 1 && policy.Formats[0].format == VK_FORMAT_UNDEFINED) && !FindSurfaceFormat(policy, spec.Format))
+		{
+			const VkSurfaceFormatKHR* fallback = nullptr;
+			for (size_t i = 0; i < sizeof(c_FallbackSurfaceFormats) / sizeof(*c_FallbackSurfaceFormats) && !fallback; ++i)
+				fallback = FindSurfaceFormat(policy, c_FallbackSurfaceFormats[i]);
+			if (!fallback && policy.FormatCount)
+				fallback = &policy.Formats[0];
+			if (fallback)
+				format = *fallback;
+		}
+
+		bool changed = imageCount != policy.ImageCount ||
+					   presentMode != policy.PresentMode ||
+					   format.format != policy.Format.format ||
+					   format.colorSpace != policy.Format.colorSpace;
+
+		policy.ImageCount  = imageCount;
+		policy.PresentMode = presentMode;
+		policy.Format      = format;
+		return changed;
 	}
 
-	bool SwapchainResize(SwapchainState* swapchain)
+	static bool InitSurfaceSwapchain(SwapchainState* swapchain)
 	{
-		if (!g_Context || !swapchain)
+		VK_INVALID(createSurface, swapchain->Window, &swapchain->Surface)
+		{
+			swapchain->Window = nullptr;
 			return false;
+		}
 
-		auto oldSwapchain = swapchain->Swapchain;
+		VkBool32 presentSupported = VK_FALSE;
+		vkGetPhysicalDeviceSurfaceSupportKHR(g_Context->PhysicalDevice, g_Context->QueueFamily, swapchain->Surface, &presentSupported);
+		if (!presentSupported)
+		{
+			std::cout << "Vulkan queue family can not present to the window surface\n";
+			vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
+			swapchain->Surface = nullptr;
+			swapchain->Window  = nullptr;
+			return false;
+		}
 
 		VkSurfaceCapabilitiesKHR caps {};
 		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(g_Context->PhysicalDevice, swapchain->Surface, &caps);
+		QuerySwapchainSupport(swapchain);
+		SelectSwapchainConfig(swapchain->Policy, caps);
 
 		swapchain->Extents = caps.currentExtent;
 		VkSwapchainCreateInfoKHR createInfo {
@@ -528,9 +1636,9 @@ namespace Vk
 			.pNext                 = nullptr,
 			.flags                 = 0,
 			.surface               = swapchain->Surface,
-			.minImageCount         = std::min<uint32_t>(caps.minImageCount + 1, caps.maxImageCount),
-			.imageFormat           = VK_FORMAT_B8G8R8A8_UNORM,
-			.imageColorSpace       = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
+			.minImageCount         = swapchain->Policy.ImageCount,
+			.imageFormat           = swapchain->Policy.Format.format,
+			.imageColorSpace       = swapchain->Policy.Format.colorSpace,
 			.imageExtent           = swapchain->Extents,
 			.imageArrayLayers      = 1,
 			.imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
@@ -539,1190 +1647,900 @@ namespace Vk
 			.pQueueFamilyIndices   = nullptr,
 			.preTransform          = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
 			.compositeAlpha        = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-			.presentMode           = VK_PRESENT_MODE_MAILBOX_KHR,
+			.presentMode           = swapchain->Policy.PresentMode,
 			.clipped               = VK_FALSE,
-			.oldSwapchain          = oldSwapchain
+			.oldSwapchain          = nullptr
 		};
 		VK_INVALID(vkCreateSwapchainKHR, g_Context->Device, &createInfo, nullptr, &swapchain->Swapchain)
 		{
+			vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
+			swapchain->Surface = nullptr;
+			swapchain->Window  = nullptr;
+			swapchain->Extents = {};
 			return false;
 		}
-		if (swapchain->Frames)
-		{
-			swapchain->Frames[g_Context->CurrentFrame].Destroys.emplace_back(
-				[oldSwapchain, images = std::move(swapchain->Images)]() {
-					for (auto [image, view] : images)
-						vkDestroyImageView(g_Context->Device, view, nullptr);
-					vkDestroySwapchainKHR(g_Context->Device, oldSwapchain, nullptr);
-				});
-		}
-		else
-		{
-			g_Context->Frames[g_Context->CurrentFrame].Destroys.emplace_back(
-				[oldSwapchain, images = std::move(swapchain->Images)]() {
-					for (auto [image, view] : images)
-						vkDestroyImageView(g_Context->Device, view, nullptr);
-					vkDestroySwapchainKHR(g_Context->Device, oldSwapchain, nullptr);
-				});
-		}
 		uint32_t imageCount = 0;
 		VK_INVALID(vkGetSwapchainImagesKHR, g_Context->Device, swapchain->Swapchain, &imageCount, nullptr)
 		{
 			vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-			swapchain->Swapchain   = nullptr;
-			swapchain->Invalidated = true;
+			vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
+			swapchain->Swapchain = nullptr;
+			swapchain->Surface   = nullptr;
+			swapchain->Window    = nullptr;
+			swapchain->Extents   = {};
 			return false;
 		}
 		swapchain->Images.resize(imageCount);
 		VK_INVALID(vkGetSwapchainImagesKHR, g_Context->Device, swapchain->Swapchain, &imageCount, swapchain->Images.column<0>())
 		{
-			vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-			swapchain->Swapchain   = nullptr;
-			swapchain->Invalidated = true;
-			return false;
-		}
-		VkImageViewCreateInfo ivCreateInfo {
-			.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-			.pNext            = nullptr,
-			.flags            = 0,
-			.image            = nullptr,
-			.viewType         = VK_IMAGE_VIEW_TYPE_2D,
-			.format           = VK_FORMAT_B8G8R8A8_UNORM,
-			.components       = {},
-			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
-		};
-		for (uint32_t i = 0; i < imageCount; ++i)
-		{
-			ivCreateInfo.image = swapchain->Images.entry<0>(i);
-			VK_INVALID(vkCreateImageView, g_Context->Device, &ivCreateInfo, nullptr, &swapchain->Images.entry<1>(i))
-			{
-				for (uint32_t j = 0; j < i; ++j)
-					vkDestroyImageView(g_Context->Device, swapchain->Images.entry<1>(j), nullptr);
-				swapchain->Images.clear();
-				vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
-				swapchain->Swapchain   = nullptr;
-				swapchain->Invalidated = true;
-				return false;
-			}
-		}
-
-		swapchain->Invalidated = false;
-		return true;
-	}
-
-	uint32_t FindDeviceMemoryIndex(uint32_t typeBits, VkMemoryPropertyFlags flags)
-	{
-		if (!g_Context)
-			return ~0U;
-
-		VkPhysicalDeviceMemoryProperties props {};
-		vkGetPhysicalDeviceMemoryProperties(g_Context->PhysicalDevice, &props);
-
-		for (uint32_t i = 0; i < props.memoryTypeCount; ++i)
-		{
-			if ((typeBits & (1U << i)) != 0 && (props.memoryTypes[i].propertyFlags & flags) == flags)
-				return i;
-		}
-		return ~0U;
-	}
-
-	VkResult createSurface(Wnd::Handle* window, VkSurfaceKHR* surface)
-	{
-		VkWin32SurfaceCreateInfoKHR createInfo {
-			.sType     = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
-			.pNext     = nullptr,
-			.flags     = 0,
-			.hinstance = Wnd::GetInstance(),
-			.hwnd      = Wnd::GetNativeHandle(window)
-		};
-		return vkCreateWin32SurfaceKHR(g_Context->Instance, &createInfo, nullptr, surface);
-	}
-} // namespace Vk
-
-namespace DX
-{
-	Context* g_Context = nullptr;
-
-	bool Init(const ContextSpec* spec)
-	{
-		Context* context = new Context();
-
-		UINT d3d11DeviceFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
-		if (spec && spec->WithPresentation)
-			d3d11DeviceFlags |= D3D11_CREATE_DEVICE_SINGLETHREADED | D3D11_CREATE_DEVICE_PREVENT_INTERNAL_THREADING_OPTIMIZATIONS;
-
-		ID3D11Device*        d3d11Device        = nullptr;
-		ID3D11DeviceContext* d3d11DeviceContext = nullptr;
-		HR_INVALID(D3D11CreateDevice, nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, d3d11DeviceFlags, nullptr, 0, D3D11_SDK_VERSION, &d3d11Device, nullptr, &d3d11DeviceContext)
-		{
-			delete context;
-			return false;
-		}
-		HR_INVALID(d3d11Device->QueryInterface, &context->D3D11Device)
-		{
-			std::cout << "Failed to Query ID3D11Device5\n";
-			d3d11Device->Release();
-			d3d11DeviceContext->Release();
-			delete context;
-			return false;
-		}
-		d3d11Device->Release();
-		HR_INVALID(d3d11DeviceContext->QueryInterface, &context->D3D11DeviceContext)
-		{
-			std::cout << "Failed to Query ID3D11DeviceContext4\n";
-			context->DXGIDevice->Release();
-			context->D3D11Device->Release();
-			d3d11DeviceContext->Release();
-			delete context;
-			return false;
-		}
-		d3d11DeviceContext->Release();
-		HR_INVALID(d3d11Device->QueryInterface, &context->DXGIDevice)
-		{
-			std::cout << "Failed to Query IDXGIDevice4\n";
-			context->D3D11Device->Release();
-			delete context;
-			return false;
-		}
-		HR_INVALID(CreateDXGIFactory2, 0, __uuidof(IDXGIFactory7), (void**) &context->DXGIFactory)
-		{
-			context->DXGIDevice->Release();
-			context->D3D11DeviceContext->Release();
-			context->D3D11Device->Release();
-			delete context;
-			return false;
-		}
-		if (spec && spec->WithComposition)
-		{
-			HR_INVALID(DCompositionCreateDevice3, context->DXGIDevice, __uuidof(IDCompositionDevice4), (void**) &context->DCompDevice2)
-			{
-				context->DXGIFactory->Release();
-				context->DXGIDevice->Release();
-				context->D3D11DeviceContext->Release();
-				context->D3D11Device->Release();
-				delete context;
-				return false;
-			}
-			HR_INVALID(context->DCompDevice2->QueryInterface, &context->DCompDevice)
-			{
-				context->DCompDevice2->Release();
-				context->DXGIFactory->Release();
-				context->DXGIDevice->Release();
-				context->D3D11DeviceContext->Release();
-				context->D3D11Device->Release();
-				delete context;
-				return false;
-			}
-			BOOL supportsCompositionTextures = false;
-			HR_INVALID(context->DCompDevice2->CheckCompositionTextureSupport, context->D3D11Device, &supportsCompositionTextures)
-			{
-				context->DCompDevice->Release();
-				context->DCompDevice2->Release();
-				context->DXGIFactory->Release();
-				context->DXGIDevice->Release();
-				context->D3D11DeviceContext->Release();
-				context->D3D11Device->Release();
-				delete context;
-				return false;
-			}
-			if (!supportsCompositionTextures)
-			{
-				context->DCompDevice->Release();
-				context->DCompDevice2->Release();
-				context->DXGIFactory->Release();
-				context->DXGIDevice->Release();
-				context->D3D11DeviceContext->Release();
-				context->D3D11Device->Release();
-				delete context;
-				return false;
-			}
+			vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
+			vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
+			swapchain->Swapchain = nullptr;
+			swapchain->Surface   = nullptr;
+			swapchain->Window    = nullptr;
+			swapchain->Extents   = {};
+			return false;
 		}
-		if (spec && spec->WithPresentation)
+		VkImageViewCreateInfo ivCreateInfo {
+			.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.pNext            = nullptr,
+			.flags            = 0,
+			.image            = nullptr,
+			.viewType         = VK_IMAGE_VIEW_TYPE_2D,
+			.format           = swapchain->Policy.Format.format,
+			.components       = {},
+			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+		};
+		for (uint32_t i = 0; i < imageCount; ++i)
 		{
-			HR_INVALID(CreatePresentationFactory, context->D3D11Device, __uuidof(IPresentationFactory), (void**) &context->PresentationFactory)
-			{
-				if (context->DCompDevice)
-					context->DCompDevice->Release();
-				if (context->DCompDevice2)
-					context->DCompDevice2->Release();
-				context->DXGIFactory->Release();
-				context->DXGIDevice->Release();
-				context->D3D11DeviceContext->Release();
-				context->D3D11Device->Release();
-				delete context;
-				return false;
-			}
-			if (!context->PresentationFactory->IsPresentationSupportedWithIndependentFlip())
+			ivCreateInfo.image = swapchain->Images.entry<0>(i);
+			VK_INVALID(vkCreateImageView, g_Context->Device, &ivCreateInfo, nullptr, &swapchain->Images.entry<1>(i))
 			{
-				context->PresentationFactory->Release();
-				if (context->DCompDevice)
-					context->DCompDevice->Release();
-				if (context->DCompDevice2)
-					context->DCompDevice2->Release();
-				context->DXGIFactory->Release();
-				context->DXGIDevice->Release();
-				context->D3D11DeviceContext->Release();
-				context->D3D11Device->Release();
-				delete context;
+				for (uint32_t j = 0; j < i; ++j)
+					vkDestroyImageView(g_Context->Device, swapchain->Images.entry<1>(j), nullptr);
+				swapchain->Images.clear();
+				vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
+				vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
+				swapchain->Swapchain = nullptr;
+				swapchain->Surface   = nullptr;
+				swapchain->Window    = nullptr;
+				swapchain->Extents   = {};
 				return false;
 			}
 		}
-
-		g_Context = context;
 		return true;
 	}
 
-	void DeInit()
+	static void DeInitSurfaceSwapchain(SwapchainState* swapchain)
 	{
-		if (!g_Context)
-			return;
-
-		if (g_Context->DCompDevice2)
-			g_Context->DCompDevice2->Release();
-		if (g_Context->DCompDevice)
-			g_Context->DCompDevice->Release();
-		if (g_Context->DXGIFactory)
-			g_Context->DXGIFactory->Release();
-		if (g_Context->DXGIDevice)
-			g_Context->DXGIDevice->Release();
-		if (g_Context->D3D11DeviceContext)
-			g_Context->D3D11DeviceContext->Release();
-		if (g_Context->D3D11Device)
-			g_Context->D3D11Device->Release();
-		delete g_Context;
-		g_Context = nullptr;
+		for (uint32_t i = 0; i < swapchain->Images.size(); ++i)
+			vkDestroyImageView(g_Context->Device, swapchain->Images.entry<1>(i), nullptr);
+		swapchain->Images.clear();
+		vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
+		vkDestroySurfaceKHR(g_Context->Instance, swapchain->Surface, nullptr);
+		swapchain->Swapchain = nullptr;
+		swapchain->Surface   = nullptr;
 	}
-} // namespace DX
-
-namespace Wnd
-{
-	static constexpr UINT Wnd_WM_CREATE_WINDOW  = WM_APP + 1;
-	static constexpr UINT Wnd_WM_DESTROY_WINDOW = WM_APP + 2;
-	static constexpr UINT Wnd_WM_DEINIT         = WM_APP + 3;
-
-	namespace WindowFlag
-	{
-		static constexpr uint64_t None       = 0x0000;
-		static constexpr uint64_t Maximized  = 0x0001;
-		static constexpr uint64_t Minimized  = 0x0002;
-		static constexpr uint64_t Visible    = 0x0004;
-		static constexpr uint64_t Decorated  = 0x0008;
-		static constexpr uint64_t WantsClose = 0x8000;
-
-		static constexpr uint64_t MinMax = Maximized | Minimized;
-	} // namespace WindowFlag
-
-	struct Handle
-	{
-		virtual ~Handle() = default;
-
-		HWND HWnd = nullptr;
-
-		int32_t  x, y;
-		uint32_t w, h;
-
-		int32_t  rawX, rawY;
-		uint32_t rawW, rawH;
-
-		int32_t rawMarginX;
-		int32_t rawMarginY;
-		int32_t rawMarginW;
-		int32_t rawMarginH;
-
-		std::string Title;
-	};
-
-	struct SameThreadHandle : public Handle
-	{
-		uint64_t Flags = 0;
-	};
 
-	struct SeparateThreadHandle : public Handle
+	static bool InitSwapchainFrames(SwapchainState* swapchain)
 	{
-		std::atomic_uint64_t Flags = 0;
-
-		Concurrency::SharedMutex Mtx;
-	};
-
-	struct Context
-	{
-		virtual ~Context() = default;
-
-		bool SeparateThread = false;
-
-		HINSTANCE HInstance  = nullptr;
-		HWND      HelperHWnd = nullptr;
-
-		std::vector<Handle*> Windows;
-	};
-
-	struct SameThreadContext : public Context
-	{
-	public:
-		bool QuitSignaled = false;
-	};
-
-	struct SeparateThreadContext : public Context
-	{
-	public:
-		std::atomic_bool   QuitSignaled      = false;
-		std::atomic_bool   Status            = false;
-		std::atomic_bool   Loaded            = false;
-		std::atomic_bool   Running           = false;
-		std::atomic_bool   AcceptingMessages = false;
-		std::atomic_size_t MessageCount      = 0;
-		std::thread        WindowThread;
-
-		Concurrency::SharedMutex Mtx;
-	};
-
-	Context* g_Context = nullptr;
-
-	static bool    InitCommon(Context* context);
-	static void    DeInitCommon(Context* context);
-	static void    WindowThreadFunc();
-	static bool    IntInitHandle(Context* context, Handle* handle, const Spec* spec);
-	static void    IntDeInitHandle(Context* context, Handle* handle);
-	static LRESULT HelperWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
-	static LRESULT WndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
-
-	static LRESULT SendWindowMessage(UINT Msg, WPARAM wParam, LPARAM lParam)
-	{
-		if (!g_Context || !g_Context->SeparateThread)
-			return FALSE;
-		((SeparateThreadContext*) g_Context)->AcceptingMessages.wait(false);
-		return SendMessageW(g_Context->HelperHWnd, Msg, wParam, lParam);
-	}
+		VkSemaphoreCreateInfo sCreateInfo {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0
+		};
 
-	bool Init(const ContextSpec* spec)
-	{
-		if (spec && spec->SeparateThread)
+		swapchain->Frames = AllocateFrames<SwapchainFrameState>(g_Context);
+		for (uint32_t i = 0; i < g_Context->FramesInFlight; ++i)
 		{
-			SeparateThreadContext* context = new SeparateThreadContext();
-			g_Context                      = context;
-
-			context->SeparateThread = true;
-			context->HInstance      = (HINSTANCE) GetModuleHandleW(nullptr);
-			context->Running        = true;
-			context->WindowThread   = std::thread(&WindowThreadFunc);
-			context->Loaded.wait(false);
-			if (!context->Status)
+			if (!InitFrameState(g_Context, &swapchain->Frames[i]))
 			{
-				delete context;
-				g_Context = nullptr;
+				for (uint32_t j = 0; j < i; ++j)
+				{
+					vkDestroySemaphore(g_Context->Device, swapchain->Frames[j].ImageReady, nullptr);
+					DeInitFrameState(g_Context, &swapchain->Frames[j]);
+				}
+				FreeFrames(g_Context, swapchain->Frames);
+				swapchain->Frames = nullptr;
 				return false;
 			}
-			return true;
+			VK_INVALID(vkCreateSemaphore, g_Context->Device, &sCreateInfo, nullptr, &swapchain->Frames[i].ImageReady)
+			{
+				for (uint32_t j = 0; j < i; ++j)
+				{
+					vkDestroySemaphore(g_Context->Device, swapchain->Frames[j].ImageReady, nullptr);
+					DeInitFrameState(g_Context, &swapchain->Frames[j]);
+				}
+				DeInitFrameState(g_Context, &swapchain->Frames[i]);
+				FreeFrames(g_Context, swapchain->Frames);
+				swapchain->Frames = nullptr;
+				return false;
+			}
+			swapchain->Frames[i].ImageIndex = 0;
 		}
+		return true;
+	}
+
+	bool InitSwapchainState(SwapchainState* swapchain, Wnd::Handle* window, bool withFrames)
+	{
+		if (!g_Context || !swapchain || (!window && !g_Context->Headless))
+			return false;
 
-		SameThreadContext* context = new SameThreadContext();
-		context->SeparateThread    = false;
-		context->HInstance         = (HINSTANCE) GetModuleHandleW(nullptr);
-		if (!InitCommon(context))
+		swapchain->Window = window;
+		if (!(g_Context->Headless ? InitHeadlessSwapchain(swapchain) : InitSurfaceSwapchain(swapchain)))
 		{
-			delete context;
+			swapchain->Window  = nullptr;
+			swapchain->Extents = {};
+			return false;
+		}
+		if (withFrames && !InitSwapchainFrames(swapchain))
+		{
+			if (g_Context->Headless)
+				DeInitHeadlessSwapchain(swapchain);
+			else
+				DeInitSurfaceSwapchain(swapchain);
+			swapchain->Window  = nullptr;
+			swapchain->Extents = {};
 			return false;
 		}
-		g_Context = context;
 		return true;
 	}
 
-	void DeInit()
+	void DeInitSwapchainState(SwapchainState* swapchain)
 	{
-		if (!g_Context)
+		if (!g_Context || !swapchain)
 			return;
-		if (g_Context->SeparateThread)
+
+		// Headless presents wait on the frames' RenderDone, so the last one has to retire before the frames are destroyed
+		if (g_Context->Headless)
+			DeInitHeadlessSwapchain(swapchain);
+		if (swapchain->Frames)
 		{
-			SeparateThreadContext* stContext = (SeparateThreadContext*) g_Context;
-			if (stContext->Running)
+			for (uint32_t i = 0; i < g_Context->FramesInFlight; ++i)
 			{
-				SendWindowMessage(Wnd_WM_DEINIT, 0, 0);
-				stContext->WindowThread.join();
+				DeInitFrameState(g_Context, &swapchain->Frames[i]);
+				vkDestroySemaphore(g_Context->Device, swapchain->Frames[i].ImageReady, nullptr);
 			}
+			FreeFrames(g_Context, swapchain->Frames);
+			swapchain->Frames = nullptr;
 		}
-		else
-		{
-			DeInitCommon(g_Context);
-		}
-		delete g_Context;
-		g_Context = nullptr;
+		if (!g_Context->Headless)
+			DeInitSurfaceSwapchain(swapchain);
+		swapchain->Window  = nullptr;
+		swapchain->Extents = {};
 	}
 
-	void PollEvents()
+	// Round robin, the next image is handed out once the GPU finished its previous present
+	static bool HeadlessAcquireImage(SwapchainState* swapchain)
 	{
-		if (!g_Context || g_Context->SeparateThread)
-			return;
-
-		MSG msg {};
-		while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE))
-		{
-			if (msg.message == WM_QUIT)
-				((SameThreadContext*) g_Context)->QuitSignaled = true;
-			TranslateMessage(&msg);
-			DispatchMessageW(&msg);
-		}
+		auto& headless = swapchain->Headless;
+		auto& frame    = swapchain->Frames[g_Context->CurrentFrame];
+
+		frame.ImageIndex   = headless.NextImage;
+		headless.NextImage = (headless.NextImage + 1) % c_HeadlessImageCount;
+
+		VkSemaphoreSubmitInfo wait {
+			.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.pNext       = nullptr,
+			.semaphore   = headless.Timeline,
+			.value       = headless.PresentValues[frame.ImageIndex],
+			.stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.deviceIndex = 0
+		};
+		VkSemaphoreSubmitInfo signal {
+			.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.pNext       = nullptr,
+			.semaphore   = frame.ImageReady,
+			.value       = 0,
+			.stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+			.deviceIndex = 0
+		};
+		VkSubmitInfo2 submit {
+			.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+			.pNext                    = nullptr,
+			.flags                    = 0,
+			.waitSemaphoreInfoCount   = wait.value ? 1U : 0U,
+			.pWaitSemaphoreInfos      = &wait,
+			.commandBufferInfoCount   = 0,
+			.pCommandBufferInfos      = nullptr,
+			.signalSemaphoreInfoCount = 1,
+			.pSignalSemaphoreInfos    = &signal
+		};
+		return VK_VALIDATE(vkQueueSubmit2, g_Context->Queue, 1, &submit, nullptr);
 	}
 
-	void WaitForEvent()
+	// Consumes RenderDone like vkQueuePresentKHR would and marks the image as presented on the timeline, all swapchains go in a single vkQueueSubmit2
+	static bool HeadlessPresentMany(SwapchainState* const* swapchains, uint32_t count)
 	{
-		if (!g_Context)
-			return;
-		if (g_Context->SeparateThread)
-		{
-			SeparateThreadContext* stContext = (SeparateThreadContext*) g_Context;
-			stContext->MessageCount.wait(stContext->MessageCount.load());
-			return;
+		auto waits   = FrameAllocate<VkSemaphoreSubmitInfo>(count);
+		auto signals = FrameAllocate<VkSemaphoreSubmitInfo>(count);
+		auto submits = FrameAllocate<VkSubmitInfo2>(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			auto& headless = swapchains[i]->Headless;
+			auto& frame    = swapchains[i]->Frames[g_Context->CurrentFrame];
+
+			waits[i] = {
+				.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.pNext       = nullptr,
+				.semaphore   = frame.RenderDone,
+				.value       = 0,
+				.stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.deviceIndex = 0
+			};
+			signals[i] = {
+				.sType       = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+				.pNext       = nullptr,
+				.semaphore   = headless.Timeline,
+				.value       = headless.Value + 1,
+				.stageMask   = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+				.deviceIndex = 0
+			};
+			submits[i] = {
+				.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+				.pNext                    = nullptr,
+				.flags                    = 0,
+				.waitSemaphoreInfoCount   = 1,
+				.pWaitSemaphoreInfos      = &waits[i],
+				.commandBufferInfoCount   = 0,
+				.pCommandBufferInfos      = nullptr,
+				.signalSemaphoreInfoCount = 1,
+				.pSignalSemaphoreInfos    = &signals[i]
+			};
 		}
-
-		MSG  msg {};
-		BOOL result = GetMessageW(&msg, nullptr, 0, 0);
-		if (result > 0)
+		VK_INVALID(vkQueueSubmit2, g_Context->Queue, count, submits, nullptr)
 		{
-			TranslateMessage(&msg);
-			DispatchMessageW(&msg);
+			return false;
 		}
-		else if (result <= 0)
+		for (uint32_t i = 0; i < count; ++i)
 		{
-			SameThreadContext* stContext = (SameThreadContext*) g_Context;
-			stContext->QuitSignaled      = true;
+			auto& headless = swapchains[i]->Headless;
+			auto& frame    = swapchains[i]->Frames[g_Context->CurrentFrame];
+
+			headless.PresentValues[frame.ImageIndex] = ++headless.Value;
 		}
+		return true;
 	}
 
-	bool QuitSignaled()
+	// Recreates the images at Extents
+	static bool HeadlessResize(SwapchainState* swapchain)
 	{
-		if (!g_Context)
-			return false;
-		return g_Context->SeparateThread
-				   ? ((SeparateThreadContext*) g_Context)->QuitSignaled.load()
-				   : ((SameThreadContext*) g_Context)->QuitSignaled;
-	}
+		auto& headless = swapchain->Headless;
 
-	void SignalQuit()
-	{
-		if (!g_Context)
-			return;
-		if (QuitSignaled())
-			return;
-		if (g_Context->SeparateThread)
-			((SeparateThreadContext*) g_Context)->QuitSignaled = true;
-		else
-			((SameThreadContext*) g_Context)->QuitSignaled = true;
+		// Presents complete after their render, so once the last one is done no old image is in use anymore
+		VkSemaphoreWaitInfo waitInfo {
+			.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.pNext          = nullptr,
+			.flags          = 0,
+			.semaphoreCount = 1,
+			.pSemaphores    = &headless.Timeline,
+			.pValues        = &headless.Value
+		};
+		vkWaitSemaphores(g_Context->Device, &waitInfo, ~0ULL);
+		DestroyHeadlessImages(headless.Memory, swapchain->Images);
+		headless.Memory = nullptr;
+		if (!CreateHeadlessImages(swapchain))
+		{
+			swapchain->Invalidated = true;
+			return false;
+		}
+		swapchain->Invalidated = false;
+		return true;
 	}
 
-	HINSTANCE GetInstance()
+	bool SwapchainAcquireImage(SwapchainState* swapchain)
 	{
-		return g_Context ? g_Context->HInstance : nullptr;
-	}
+		if (!g_Context || !swapchain)
+			return false;
 
-	Handle* Create(const Spec* spec)
-	{
-		if (!g_Context || !spec)
-			return nullptr;
-		if (g_Context->SeparateThread)
-		{
-			Handle* handle = nullptr;
-			if (!SendWindowMessage(Wnd_WM_CREATE_WINDOW, (WPARAM) &handle, (LPARAM) spec))
-				return nullptr;
-			return handle;
-		}
-		Handle* handle = new SameThreadHandle();
-		if (!IntInitHandle(g_Context, handle, spec))
+		if (swapchain->Frames)
 		{
-			delete handle;
-			return nullptr;
+			for (uint32_t i = 0; i < g_Context->FramesInFlight; ++i)
+				ReclaimDestroys(&swapchain->Frames[i]);
 		}
-		g_Context->Windows.emplace_back(handle);
-		return handle;
-	}
 
-	void Destroy(Handle* window)
-	{
-		if (!g_Context || !window)
-			return;
-		if (g_Context->SeparateThread)
+		if (swapchain->Invalidated &&
+			!SwapchainResize(swapchain))
+			return false;
+
+		if (g_Context->Headless)
+			return HeadlessAcquireImage(swapchain);
+
+		auto&    frame  = swapchain->Frames[g_Context->CurrentFrame];
+		VkResult result = vkAcquireNextImageKHR(g_Context->Device, swapchain->Swapchain, ~0ULL, frame.ImageReady, nullptr, &frame.ImageIndex);
+		switch (result)
 		{
-			SendWindowMessage(Wnd_WM_DESTROY_WINDOW, (WPARAM) window, 0);
-			return;
+		case VK_ERROR_OUT_OF_DATE_KHR:
+		case VK_SUBOPTIMAL_KHR:
+			if (!SwapchainResize(swapchain))
+				return false;
+			VK_INVALID(vkAcquireNextImageKHR, g_Context->Device, swapchain->Swapchain, ~0ULL, frame.ImageReady, nullptr, &frame.ImageIndex)
+			{
+				return false;
+			}
+			break;
+		default:
+			if (!Helpers::VkValidate(result, "vkAcquireNextImageKHR"))
+				return false;
+			break;
 		}
-		IntDeInitHandle(g_Context, window);
-		std::erase(g_Context->Windows, window);
-		delete window;
+		return true;
 	}
 
-	HWND GetNativeHandle(Handle* window)
+	bool SwapchainPresent(SwapchainState* swapchain)
 	{
-		if (!g_Context || !window)
-			return nullptr;
-		return window->HWnd;
-	}
+		if (!g_Context || !swapchain)
+			return false;
 
-	void Show(Handle* window)
-	{
-		if (!g_Context || !window)
-			return;
-		uint64_t type = 0;
-		if (g_Context->SeparateThread)
-		{
-			SeparateThreadHandle* stHandle = (SeparateThreadHandle*) window;
-			if (stHandle->Flags & WindowFlag::Visible)
-				return;
-			stHandle->Flags |= WindowFlag::Visible;
-			type             = stHandle->Flags & WindowFlag::MinMax;
-			if (type == WindowFlag::MinMax)
-				stHandle->Flags &= ~WindowFlag::MinMax;
-		}
-		else
-		{
-			SameThreadHandle* stHandle = (SameThreadHandle*) window;
-			if (stHandle->Flags & WindowFlag::Visible)
-				return;
-			stHandle->Flags |= WindowFlag::Visible;
-			type             = stHandle->Flags & WindowFlag::MinMax;
-			if (type == WindowFlag::MinMax)
-				stHandle->Flags &= ~WindowFlag::MinMax;
-		}
-		switch (type)
+		if (g_Context->Headless)
+			return HeadlessPresentMany(&swapchain, 1);
+
+		auto& frame = swapchain->Frames[g_Context->CurrentFrame];
+
+		VkPresentInfoKHR presentInfo {
+			.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+			.pNext              = nullptr,
+			.waitSemaphoreCount = 1,
+			.pWaitSemaphores    = &frame.RenderDone,
+			.swapchainCount     = 1,
+			.pSwapchains        = &swapchain->Swapchain,
+			.pImageIndices      = &frame.ImageIndex,
+			.pResults           = nullptr
+		};
+		VkResult result = vkQueuePresentKHR(g_Context->Queue, &presentInfo);
+		switch (result)
 		{
-		case WindowFlag::Maximized: ShowWindow(window->HWnd, SW_MAXIMIZE); break;
-		case WindowFlag::Minimized: ShowWindow(window->HWnd, SW_MINIMIZE); break;
-		default: ShowWindow(window->HWnd, SW_NORMAL); break;
+		case VK_ERROR_OUT_OF_DATE_KHR:
+		case VK_SUBOPTIMAL_KHR:
+			swapchain->Invalidated = true;
+			break;
+		default:
+			if (!Helpers::VkValidate(result, "vkQueuePresentKHR"))
+				return false;
+			break;
 		}
+		return true;
 	}
 
-	void Hide(Handle* window)
+	bool SwapchainPresentMany(SwapchainState* const* swapchains, uint32_t count)
 	{
-		if (!g_Context || !window)
-			return;
-		if (g_Context->SeparateThread)
-		{
-			SeparateThreadHandle* stHandle = (SeparateThreadHandle*) window;
-			if (!(stHandle->Flags & WindowFlag::Visible))
-				return;
-			stHandle->Flags &= ~WindowFlag::Visible;
-		}
-		else
+		if (!g_Context || (!swapchains && count))
+			return false;
+		if (!count)
+			return true;
+
+		if (g_Context->Headless)
+			return HeadlessPresentMany(swapchains, count);
+
+		auto renderDones  = FrameAllocate<VkSemaphore>(count);
+		auto handles      = FrameAllocate<VkSwapchainKHR>(count);
+		auto imageIndices = FrameAllocate<uint32_t>(count);
+		auto results      = FrameAllocate<VkResult>(count);
+		for (uint32_t i = 0; i < count; ++i)
 		{
-			SameThreadHandle* stHandle = (SameThreadHandle*) window;
-			if (!(stHandle->Flags & WindowFlag::Visible))
-				return;
-			stHandle->Flags &= ~WindowFlag::Visible;
+			auto& frame     = swapchains[i]->Frames[g_Context->CurrentFrame];
+			renderDones[i]  = frame.RenderDone;
+			handles[i]      = swapchains[i]->Swapchain;
+			imageIndices[i] = frame.ImageIndex;
+			results[i]      = VK_SUCCESS;
 		}
-		ShowWindow(window->HWnd, SW_HIDE);
-	}
 
-	void Maximize(Handle* window)
-	{
-		if (!g_Context || !window)
-			return;
-		if (g_Context->SeparateThread)
+		VkPresentInfoKHR presentInfo {
+			.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+			.pNext              = nullptr,
+			.waitSemaphoreCount = count,
+			.pWaitSemaphores    = renderDones,
+			.swapchainCount     = count,
+			.pSwapchains        = handles,
+			.pImageIndices      = imageIndices,
+			.pResults           = results
+		};
+		VkResult result = vkQueuePresentKHR(g_Context->Queue, &presentInfo);
+		switch (result)
 		{
-			SeparateThreadHandle* stHandle = (SeparateThreadHandle*) window;
-			if ((stHandle->Flags & WindowFlag::MinMax) == WindowFlag::Maximized)
-				return;
-			stHandle->Flags &= ~WindowFlag::MinMax;
-			stHandle->Flags |= WindowFlag::Maximized;
-			if (!(stHandle->Flags & WindowFlag::Visible))
-				return;
+		case VK_ERROR_OUT_OF_DATE_KHR:
+		case VK_SUBOPTIMAL_KHR:
+			break; // pResults tells which swapchains need resizing
+		default:
+			if (!Helpers::VkValidate(result, "vkQueuePresentKHR"))
+				return false;
+			break;
 		}
-		else
+
+		bool success = true;
+		for (uint32_t i = 0; i < count; ++i)
 		{
-			SameThreadHandle* stHandle = (SameThreadHandle*) window;
-			if ((stHandle->Flags & WindowFlag::MinMax) == WindowFlag::Maximized)
-				return;
-			stHandle->Flags &= ~WindowFlag::MinMax;
-			stHandle->Flags |= WindowFlag::Maximized;
-			if (!(stHandle->Flags & WindowFlag::Visible))
-				return;
+			switch (results[i])
+			{
+			case VK_ERROR_OUT_OF_DATE_KHR:
+			case VK_SUBOPTIMAL_KHR:
+				swapchains[i]->Invalidated = true;
+				break;
+			default:
+				success = Helpers::VkValidate(results[i], "vkQueuePresentKHR") && success;
+				break;
+			}
 		}
-		ShowWindow(window->HWnd, SW_MAXIMIZE);
+		return success;
 	}
 
-	void Minimize(Handle* window)
+	bool SwapchainResize(SwapchainState* swapchain)
 	{
-		if (!g_Context || !window)
-			return;
-		if (g_Context->SeparateThread)
+		if (!g_Context || !swapchain)
+			return false;
+
+		if (g_Context->Headless)
+			return HeadlessResize(swapchain);
+
+		auto oldSwapchain = swapchain->Swapchain;
+
+		VkSurfaceCapabilitiesKHR caps {};
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(g_Context->PhysicalDevice, swapchain->Surface, &caps);
+		SelectSwapchainConfig(swapchain->Policy, caps);
+
+		swapchain->Extents = caps.currentExtent;
+		VkSwapchainCreateInfoKHR createInfo {
+			.sType                 = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+			.pNext                 = nullptr,
+			.flags                 = 0,
+			.surface               = swapchain->Surface,
+			.minImageCount         = swapchain->Policy.ImageCount,
+			.imageFormat           = swapchain->Policy.Format.format,
+			.imageColorSpace       = swapchain->Policy.Format.colorSpace,
+			.imageExtent           = swapchain->Extents,
+			.imageArrayLayers      = 1,
+			.imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+			.imageSharingMode      = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 0,
+			.pQueueFamilyIndices   = nullptr,
+			.preTransform          = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR,
+			.compositeAlpha        = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+			.presentMode           = swapchain->Policy.PresentMode,
+			.clipped               = VK_FALSE,
+			.oldSwapchain          = oldSwapchain
+		};
+		VK_INVALID(vkCreateSwapchainKHR, g_Context->Device, &createInfo, nullptr, &swapchain->Swapchain)
 		{
-			SeparateThreadHandle* stHandle = (SeparateThreadHandle*) window;
-			if ((stHandle->Flags & WindowFlag::MinMax) == WindowFlag::Minimized)
-				return;
-			stHandle->Flags &= ~WindowFlag::MinMax;
-			stHandle->Flags |= WindowFlag::Minimized;
-			if (!(stHandle->Flags & WindowFlag::Visible))
-				return;
+			return false;
 		}
-		else
 		{
-			SameThreadHandle* stHandle = (SameThreadHandle*) window;
-			if ((stHandle->Flags & WindowFlag::MinMax) == WindowFlag::Minimized)
-				return;
-			stHandle->Flags &= ~WindowFlag::MinMax;
-			stHandle->Flags |= WindowFlag::Minimized;
-			if (!(stHandle->Flags & WindowFlag::Visible))
-				return;
+			// The old images are only referenced by work submitted before this, which the frame's next submit is ordered after
+			FrameState* frame       = swapchain->Frames ? &swapchain->Frames[g_Context->CurrentFrame] : &g_Context->Frames[g_Context->CurrentFrame];
+			uint64_t    retireValue = frame->TimelineValue + 1;
+			for (auto [image, view] : swapchain->Images)
+				DeferDestroy(frame, DestroyType::ImageView, (uint64_t) view, retireValue);
+			DeferDestroy(frame, DestroyType::Swapchain, (uint64_t) oldSwapchain, retireValue);
+			swapchain->Images.clear();
 		}
-		ShowWindow(window->HWnd, SW_MINIMIZE);
-	}
-
-	void Restore(Handle* window)
-	{
-		if (!g_Context || !window)
-			return;
-		if (g_Context->SeparateThread)
+		uint32_t imageCount = 0;
+		VK_INVALID(vkGetSwapchainImagesKHR, g_Context->Device, swapchain->Swapchain, &imageCount, nullptr)
 		{
-			SeparateThreadHandle* stHandle = (SeparateThreadHandle*) window;
-			if ((stHandle->Flags & WindowFlag::MinMax) == 0)
-				return;
-			stHandle->Flags &= ~WindowFlag::MinMax;
-			if (!(stHandle->Flags & WindowFlag::Visible))
-				return;
+			vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
+			swapchain->Swapchain   = nullptr;
+			swapchain->Invalidated = true;
+			return false;
 		}
-		else
+		swapchain->Images.resize(imageCount);
+		VK_INVALID(vkGetSwapchainImagesKHR, g_Context->Device, swapchain->Swapchain, &imageCount, swapchain->Images.column<0>())
+		{
+			vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
+			swapchain->Swapchain   = nullptr;
+			swapchain->Invalidated = true;
+			return false;
+		}
+		VkImageViewCreateInfo ivCreateInfo {
+			.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.pNext            = nullptr,
+			.flags            = 0,
+			.image            = nullptr,
+			.viewType         = VK_IMAGE_VIEW_TYPE_2D,
+			.format           = swapchain->Policy.Format.format,
+			.components       = {},
+			.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 }
+		};
+		for (uint32_t i = 0; i < imageCount; ++i)
 		{
-			SameThreadHandle* stHandle = (SameThreadHandle*) window;
-			if ((stHandle->Flags & WindowFlag::MinMax) == 0)
-				return;
-			stHandle->Flags &= ~WindowFlag::MinMax;
-			if (!(stHandle->Flags & WindowFlag::Visible))
-				return;
+			ivCreateInfo.image = swapchain->Images.entry<0>(i);
+			VK_INVALID(vkCreateImageView, g_Context->Device, &ivCreateInfo, nullptr, &swapchain->Images.entry<1>(i))
+			{
+				for (uint32_t j = 0; j < i; ++j)
+					vkDestroyImageView(g_Context->Device, swapchain->Images.entry<1>(j), nullptr);
+				swapchain->Images.clear();
+				vkDestroySwapchainKHR(g_Context->Device, swapchain->Swapchain, nullptr);
+				swapchain->Swapchain   = nullptr;
+				swapchain->Invalidated = true;
+				return false;
+			}
 		}
-		ShowWindow(window->HWnd, SW_NORMAL);
+
+		swapchain->Invalidated = false;
+		return true;
 	}
 
-	bool IsMaximized(Handle* window)
+	bool SwapchainSetPolicy(SwapchainState* swapchain, const SwapchainPolicySpec* spec)
 	{
-		if (!g_Context || !window)
+		if (!g_Context || !swapchain || !spec)
 			return false;
-		return g_Context->SeparateThread
-				   ? (((SeparateThreadHandle*) window)->Flags & WindowFlag::MinMax) == WindowFlag::Maximized
-				   : (((SameThreadHandle*) window)->Flags & WindowFlag::MinMax) == WindowFlag::Maximized;
-	}
 
-	bool IsMinimized(Handle* window)
-	{
-		if (!g_Context || !window)
+		swapchain->Policy.Spec = *spec;
+		// Stored but nothing to recreate, headless swapchains have no present mode and uncreated ones select on creation
+		if (g_Context->Headless || !swapchain->Swapchain)
+			return false;
+
+		// Selecting with the cached limits only decides whether to recreate, the recreation selects again with fresh caps
+		VkSurfaceCapabilitiesKHR caps {};
+		caps.minImageCount = swapchain->Policy.MinImageCount;
+		caps.maxImageCount = swapchain->Policy.MaxImageCount;
+		if (!SelectSwapchainConfig(swapchain->Policy, caps))
 			return false;
-		return g_Context->SeparateThread
-				   ? (((SeparateThreadHandle*) window)->Flags & WindowFlag::MinMax) == WindowFlag::Minimized
-				   : (((SameThreadHandle*) window)->Flags & WindowFlag::MinMax) == WindowFlag::Minimized;
+		swapchain->Invalidated = true;
+		return true;
 	}
 
-	void SetWindowTitle(Handle* window, std::string_view title)
+	uint32_t FindDeviceMemoryIndex(uint32_t typeBits, VkMemoryPropertyFlags flags)
 	{
-		if (!g_Context || !window)
-			return;
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.Lock();
-		window->Title = title;
-		if (g_Context->SeparateThread)
-		{
-			((SeparateThreadHandle*) window)->Mtx.Unlock();
+		if (!g_Context)
+			return ~0U;
 
-			SeparateThreadHandle* stHandle = (SeparateThreadHandle*) window;
-			if (!(stHandle->Flags & WindowFlag::Decorated))
-				return;
-		}
-		else
+		auto& props = g_Context->MemoryProperties;
+		for (uint32_t i = 0; i < props.memoryTypeCount; ++i)
 		{
-			SameThreadHandle* stHandle = (SameThreadHandle*) window;
-			if (!(stHandle->Flags & WindowFlag::Decorated))
-				return;
+			if ((typeBits & (1U << i)) != 0 && (props.memoryTypes[i].propertyFlags & flags) == flags)
+				return i;
 		}
-
-		auto titleW = UTF::Convert<wchar_t, char>(title);
-		SetWindowTextW(window->HWnd, titleW.c_str());
+		return ~0U;
 	}
 
-	void GetWindowTitle(Handle* window, std::string& title)
+	// Allocates memory of type, mapping it when host visible. image or buffer makes it a dedicated allocation for that resource
+	static VkDeviceMemory AllocateMemoryObject(uint32_t type, VkDeviceSize size, VkImage image, VkBuffer buffer, void** mapped)
 	{
-		if (!g_Context || !window)
-			return;
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.LockShared();
-		title = window->Title;
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.UnlockShared();
+		VkMemoryDedicatedAllocateInfo dedicatedInfo {
+			.sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+			.pNext  = nullptr,
+			.image  = image,
+			.buffer = buffer
+		};
+		VkMemoryAllocateInfo allocInfo {
+			.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.pNext           = image || buffer ? &dedicatedInfo : nullptr,
+			.allocationSize  = size,
+			.memoryTypeIndex = type
+		};
+		VkDeviceMemory memory = nullptr;
+		VK_INVALID(vkAllocateMemory, g_Context->Device, &allocInfo, nullptr, &memory)
+		{
+			return nullptr;
+		}
+		*mapped = nullptr;
+		if (g_Context->MemoryProperties.memoryTypes[type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			VK_INVALID(vkMapMemory, g_Context->Device, memory, 0, VK_WHOLE_SIZE, 0, mapped)
+			{
+				vkFreeMemory(g_Context->Device, memory, nullptr);
+				return nullptr;
+			}
+		}
+		return memory;
 	}
 
-	bool GetWantsClose(Handle* window)
+	static bool AllocateFromBlock(DeviceMemoryBlock* block, DeviceAllocation* allocation)
 	{
-		if (!g_Context || !window)
+		uint32_t node = block->Allocator.Allocate(allocation->Size, allocation->Alignment, allocation);
+		if (node == TLSFAllocator::c_InvalidNode)
 			return false;
-		return g_Context->SeparateThread
-				   ? ((SeparateThreadHandle*) window)->Flags & WindowFlag::WantsClose
-				   : ((SameThreadHandle*) window)->Flags & WindowFlag::WantsClose;
+		allocation->Memory = block->Memory;
+		allocation->Offset = block->Allocator.Offset(node);
+		allocation->Mapped = block->Mapped ? (uint8_t*) block->Mapped + allocation->Offset : nullptr;
+		allocation->Block  = block;
+		allocation->Node   = node;
+		return true;
 	}
 
-	void SetWantsClose(Handle* window, bool wantsClose)
+	// Sub-allocates from pool, adding a block when none of them fits unless skip is set. MemoryMutex has to be held
+	static bool SubAllocate(DeviceMemoryPool& pool, uint32_t type, DeviceAllocation* allocation, const DeviceMemoryBlock* skip = nullptr)
 	{
-		if (!g_Context || !window)
-			return;
-		if (g_Context->SeparateThread)
+		for (auto block : pool.Blocks)
 		{
-			if (wantsClose)
-				((SeparateThreadHandle*) window)->Flags |= WindowFlag::WantsClose;
-			else
-				((SeparateThreadHandle*) window)->Flags &= ~WindowFlag::WantsClose;
+			if (block != skip && AllocateFromBlock(block, allocation))
+				return true;
 		}
-		else
+		// Defragmenting only moves allocations into blocks that already exist
+		if (skip)
+			return false;
+
+		DeviceMemoryBlock* block = new DeviceMemoryBlock();
+		block->Memory            = AllocateMemoryObject(type, g_Context->MemoryBlockSize, nullptr, nullptr, &block->Mapped);
+		if (!block->Memory)
 		{
-			if (wantsClose)
-				((SameThreadHandle*) window)->Flags |= WindowFlag::WantsClose;
-			else
-				((SameThreadHandle*) window)->Flags &= ~WindowFlag::WantsClose;
+			delete block;
+			return false;
 		}
+		block->Allocator.Init(g_Context->MemoryBlockSize);
+		pool.Blocks.push_back(block);
+		return AllocateFromBlock(block, allocation);
 	}
 
-	void GetWindowPos(Handle* window, int32_t& x, int32_t& y, bool raw)
+	// image or buffer is what a dedicated allocation gets bound to, both null allocates plain memory
+	static DeviceAllocation* AllocateMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags flags, bool linear, bool dedicated, void* userData, VkImage image, VkBuffer buffer)
 	{
-		if (!g_Context || !window)
+		if (!g_Context || !requirements.size)
+			return nullptr;
+		uint32_t type = FindDeviceMemoryIndex(requirements.memoryTypeBits, flags);
+		if (type == ~0U)
 		{
-			x = 0;
-			y = 0;
-			return;
+			std::cout << std::format("Failed to find memory type {:08X} with flags {}\n", requirements.memoryTypeBits, string_VkMemoryPropertyFlags(flags));
+			return nullptr;
 		}
+		dedicated |= requirements.size >= g_Context->MemoryBlockSize / 2;
 
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.LockShared();
-		x = raw ? window->rawX : window->x;
-		y = raw ? window->rawY : window->y;
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.UnlockShared();
-	}
+		g_Context->MemoryMutex.Lock();
+		DeviceAllocation* allocation = new (g_Context->AllocationPool->Allocate()) DeviceAllocation();
+		allocation->Size             = requirements.size;
+		allocation->Alignment        = requirements.alignment;
+		allocation->UserData         = userData;
+		allocation->MemoryType       = type;
+		allocation->Linear           = linear;
 
-	void GetWindowSize(Handle* window, uint32_t& w, uint32_t& h, bool raw)
-	{
-		if (!g_Context || !window)
+		bool valid = false;
+		if (dedicated)
 		{
-			w = 0;
-			h = 0;
-			return;
+			allocation->Memory = AllocateMemoryObject(type, requirements.size, image, buffer, &allocation->Mapped);
+			valid              = allocation->Memory != nullptr;
+			if (valid)
+			{
+				++g_Context->DedicatedCount;
+				g_Context->DedicatedBytes += requirements.size;
+			}
 		}
-
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.LockShared();
-		w = raw ? window->rawW : window->w;
-		h = raw ? window->rawH : window->h;
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.UnlockShared();
-	}
-
-	void GetWindowRect(Handle* window, int32_t& x, int32_t& y, uint32_t& w, uint32_t& h, bool raw)
-	{
-		if (!g_Context || !window)
+		else
 		{
-			x = 0;
-			y = 0;
-			w = 0;
-			h = 0;
-			return;
+			valid = SubAllocate(g_Context->MemoryPools[type][linear], type, allocation);
 		}
-
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.LockShared();
-		x = raw ? window->rawX : window->x;
-		y = raw ? window->rawY : window->y;
-		w = raw ? window->rawW : window->w;
-		h = raw ? window->rawH : window->h;
-		if (g_Context->SeparateThread)
-			((SeparateThreadHandle*) window)->Mtx.UnlockShared();
+		if (!valid)
+		{
+			g_Context->AllocationPool->Free(allocation);
+			allocation = nullptr;
+		}
+		g_Context->MemoryMutex.Unlock();
+		return allocation;
 	}
 
-	void SetWindowPos(Handle* window, int32_t x, int32_t y, bool raw)
+	DeviceAllocation* AllocateDeviceMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags flags, bool linear, bool dedicated, void* userData)
 	{
-		if (!g_Context || !window)
-			return;
-
-		if (raw)
-			::SetWindowPos(window->HWnd, nullptr, (int) (x + window->rawMarginX), (int) (y + window->rawMarginY), 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOSENDCHANGING);
-		else
-			::SetWindowPos(window->HWnd, nullptr, (int) x, (int) y, 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOSENDCHANGING);
+		return AllocateMemory(requirements, flags, linear, dedicated, userData, nullptr, nullptr);
 	}
 
-	void SetWindowSize(Handle* window, uint32_t w, uint32_t h, bool raw)
+	DeviceAllocation* AllocateImageMemory(VkImage image, VkMemoryPropertyFlags flags, bool linear, void* userData)
 	{
-		if (!g_Context || !window)
-			return;
+		if (!g_Context || !image)
+			return nullptr;
 
-		if (raw)
-			::SetWindowPos(window->HWnd, nullptr, 0, 0, (int) (w - window->rawMarginW), (int) (h - window->rawMarginH), SWP_NOMOVE | SWP_NOZORDER | SWP_NOSENDCHANGING);
-		else
-			::SetWindowPos(window->HWnd, nullptr, 0, 0, (int) w, (int) h, SWP_NOMOVE | SWP_NOZORDER | SWP_NOSENDCHANGING);
+		VkMemoryDedicatedRequirements dedicatedReqs {
+			.sType                       = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+			.pNext                       = nullptr,
+			.prefersDedicatedAllocation  = VK_FALSE,
+			.requiresDedicatedAllocation = VK_FALSE
+		};
+		VkMemoryRequirements2 requirements {
+			.sType              = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+			.pNext              = &dedicatedReqs,
+			.memoryRequirements = {}
+		};
+		VkImageMemoryRequirementsInfo2 requirementsInfo {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2,
+			.pNext = nullptr,
+			.image = image
+		};
+		vkGetImageMemoryRequirements2(g_Context->Device, &requirementsInfo, &requirements);
+		bool              dedicated  = dedicatedReqs.prefersDedicatedAllocation || dedicatedReqs.requiresDedicatedAllocation;
+		DeviceAllocation* allocation = AllocateMemory(requirements.memoryRequirements, flags, linear, dedicated, userData, dedicated ? image : nullptr, nullptr);
+		if (!allocation)
+			return nullptr;
+		VK_INVALID(vkBindImageMemory, g_Context->Device, image, allocation->Memory, allocation->Offset)
+		{
+			FreeDeviceMemory(allocation);
+			return nullptr;
+		}
+		return allocation;
 	}
 
-	void SetWindowRect(Handle* window, int32_t x, int32_t y, uint32_t w, uint32_t h, bool raw)
+	DeviceAllocation* AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags flags, void* userData)
 	{
-		if (!g_Context || !window)
-			return;
-
-		if (raw)
-			::SetWindowPos(window->HWnd, nullptr, (int) (x + window->rawMarginX), (int) (y + window->rawMarginY), (int) (w - window->rawMarginW), (int) (h - window->rawMarginH), SWP_NOZORDER | SWP_NOSENDCHANGING);
-		else
-			::SetWindowPos(window->HWnd, nullptr, (int) x, (int) y, (int) w, (int) h, SWP_NOZORDER | SWP_NOSENDCHANGING);
-	}
+		if (!g_Context || !buffer)
+			return nullptr;
 
-	bool InitCommon(Context* context)
-	{
-		if (!context)
-			return false;
-		WNDCLASSEXW wndClass {
-			.cbSize        = sizeof(wndClass),
-			.style         = CS_HREDRAW | CS_VREDRAW | CS_OWNDC,
-			.lpfnWndProc   = &WndProc,
-			.cbClsExtra    = 0,
-			.cbWndExtra    = 0,
-			.hInstance     = context->HInstance,
-			.hIcon         = nullptr,
-			.hCursor       = LoadCursorW(nullptr, IDC_ARROW),
-			.hbrBackground = nullptr,
-			.lpszMenuName  = nullptr,
-			.lpszClassName = L"TestWindow",
-			.hIconSm       = nullptr
+		VkMemoryDedicatedRequirements dedicatedReqs {
+			.sType                       = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS,
+			.pNext                       = nullptr,
+			.prefersDedicatedAllocation  = VK_FALSE,
+			.requiresDedicatedAllocation = VK_FALSE
 		};
-		RegisterClassExW(&wndClass);
-		wndClass.style         = 0;
-		wndClass.lpfnWndProc   = &HelperWndProc;
-		wndClass.hCursor       = nullptr;
-		wndClass.lpszClassName = L"TestHelperWindow";
-		RegisterClassExW(&wndClass);
-
-		context->HelperHWnd = CreateWindowExW(
-			WS_EX_OVERLAPPEDWINDOW,
-			L"TestHelperWindow",
-			L"TestHelperWindow",
-			WS_CLIPSIBLINGS | WS_CLIPCHILDREN,
-			0,
-			0,
-			1,
-			1,
-			nullptr,
-			nullptr,
-			context->HInstance,
-			nullptr);
-		if (!context->HelperHWnd)
-		{
-			UnregisterClassW(L"TestHelperWindow", context->HInstance);
-			UnregisterClassW(L"TestWindow", context->HInstance);
-			return false;
+		VkMemoryRequirements2 requirements {
+			.sType              = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2,
+			.pNext              = &dedicatedReqs,
+			.memoryRequirements = {}
+		};
+		VkBufferMemoryRequirementsInfo2 requirementsInfo {
+			.sType  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2,
+			.pNext  = nullptr,
+			.buffer = buffer
+		};
+		vkGetBufferMemoryRequirements2(g_Context->Device, &requirementsInfo, &requirements);
+		bool              dedicated  = dedicatedReqs.prefersDedicatedAllocation || dedicatedReqs.requiresDedicatedAllocation;
+		DeviceAllocation* allocation = AllocateMemory(requirements.memoryRequirements, flags, true, dedicated, userData, nullptr, dedicated ? buffer : nullptr);
+		if (!allocation)
+			return nullptr;
+		VK_INVALID(vkBindBufferMemory, g_Context->Device, buffer, allocation->Memory, allocation->Offset)
+		{
+			FreeDeviceMemory(allocation);
+			return nullptr;
 		}
-		ShowWindow(context->HelperHWnd, SW_HIDE);
-		return true;
+		return allocation;
 	}
 
-	void DeInitCommon(Context* context)
+	void FreeDeviceMemory(DeviceAllocation* allocation)
 	{
-		if (!context)
+		if (!g_Context || !allocation)
 			return;
-		if (context->SeparateThread)
-			((SeparateThreadContext*) context)->Mtx.Lock();
-		for (auto window : context->Windows)
-			IntDeInitHandle(context, window);
-		context->Windows.clear();
-		if (context->SeparateThread)
-			((SeparateThreadContext*) context)->Mtx.Unlock();
-		DestroyWindow(context->HelperHWnd);
-		context->HelperHWnd = nullptr;
-		UnregisterClassW(L"TestHelperWindow", context->HInstance);
-		UnregisterClassW(L"TestWindow", context->HInstance);
-	}
-
-	void WindowThreadFunc()
-	{
-		SeparateThreadContext* stContext = (SeparateThreadContext*) g_Context;
-		if (!InitCommon(g_Context))
-		{
-			stContext->Status = false;
-			stContext->Loaded = true;
-			stContext->Loaded.notify_one();
-			return;
-		}
-
-		stContext->Status = true;
-		stContext->Loaded = true;
-		stContext->Loaded.notify_one();
-
-		MSG msg {};
-		PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
-		stContext->AcceptingMessages = true;
-		stContext->AcceptingMessages.notify_all();
 
-		while (stContext->Running)
+		g_Context->MemoryMutex.Lock();
+		if (auto block = allocation->Block)
 		{
-			BOOL result = GetMessageW(&msg, nullptr, 0, 0);
-			if (result <= 0)
+			block->Allocator.Free(allocation->Node);
+			// Keeping one empty block around stops a pool from allocating and freeing a block every time it crosses a block boundary
+			auto& pool = g_Context->MemoryPools[allocation->MemoryType][allocation->Linear];
+			if (block->Allocator.Empty() && pool.Blocks.size() > 1)
 			{
-				stContext->QuitSignaled = true;
-				stContext->Running      = false;
-				break;
+				pool.Blocks.erase(std::find(pool.Blocks.begin(), pool.Blocks.end(), block));
+				vkFreeMemory(g_Context->Device, block->Memory, nullptr);
+				delete block;
 			}
-			TranslateMessage(&msg);
-			DispatchMessageW(&msg);
-		}
-
-		stContext->Running           = false;
-		stContext->AcceptingMessages = false;
-
-		DeInitCommon(g_Context);
-	}
-
-	bool IntInitHandle(Context* context, Handle* handle, const Spec* spec)
-	{
-		if (!context || !handle || !spec)
-			return false;
-
-		int32_t windowX = spec->x;
-		int32_t windowY = spec->y;
-		if (windowX == c_CenterX ||
-			windowY == c_CenterY)
-		{
-			// auto primaryMonitor = GetPrimaryMonitor();
-			// if (windowX == c_CenterX)
-			//	windowX = primaryMonitor.WorkX + (primaryMonitor.WorkW - spec->w) / 2;
-			// if (windowY == c_CenterY)
-			//	windowY = primaryMonitor.WorkY + (primaryMonitor.WorkH - spec->h) / 2;
-		}
-		DWORD    exStyle = WS_EX_APPWINDOW;
-		DWORD    style   = WS_CLIPSIBLINGS | WS_CLIPCHILDREN | WS_SYSMENU | WS_MINIMIZEBOX;
-		uint64_t flags   = 0;
-		if (spec->Flags & WindowCreateFlag::NoBitmap)
-			exStyle |= WS_EX_NOREDIRECTIONBITMAP;
-		if (spec->Flags & WindowCreateFlag::Decorated)
-		{
-			flags |= WindowFlag::Decorated;
-			style |= WS_MAXIMIZEBOX | WS_THICKFRAME;
-		}
-		if (spec->Flags & WindowCreateFlag::Visible)
-			flags |= WindowFlag::Visible;
-		if (spec->Flags & WindowCreateFlag::Maximized)
-			flags |= WindowFlag::Maximized;
-		else if (spec->Flags & WindowCreateFlag::Minimized)
-			flags |= WindowFlag::Minimized;
-		auto titleW  = UTF::Convert<wchar_t, char>(spec->Title);
-		handle->HWnd = CreateWindowExW(
-			exStyle,
-			L"TestWindow",
-			titleW.c_str(),
-			style,
-			(int) windowX,
-			(int) windowY,
-			(int) spec->w,
-			(int) spec->h,
-			nullptr,
-			nullptr,
-			context->HInstance,
-			nullptr);
-		if (!handle->HWnd)
-			return false;
-		SetPropW(handle->HWnd, L"TestHandle", handle);
-		handle->Title = spec->Title;
-		if (context->SeparateThread)
-			((SeparateThreadHandle*) handle)->Flags = flags;
-		else
-			((SameThreadHandle*) handle)->Flags = flags;
-
-		WINDOWINFO wi {};
-		wi.cbSize = sizeof(wi);
-		GetWindowInfo(handle->HWnd, &wi);
-		handle->x          = (int32_t) wi.rcClient.left;
-		handle->y          = (int32_t) wi.rcClient.top;
-		handle->w          = (uint32_t) (wi.rcClient.right - wi.rcClient.left);
-		handle->h          = (uint32_t) (wi.rcClient.bottom - wi.rcClient.top);
-		handle->rawX       = (int32_t) wi.rcWindow.left;
-		handle->rawY       = (int32_t) wi.rcWindow.top;
-		handle->rawW       = (uint32_t) (wi.rcWindow.right - wi.rcWindow.left);
-		handle->rawH       = (uint32_t) (wi.rcWindow.bottom - wi.rcWindow.top);
-		handle->rawMarginX = handle->x - handle->rawX;
-		handle->rawMarginY = handle->y - handle->rawY;
-		handle->rawMarginW = handle->w - handle->rawW;
-		handle->rawMarginH = handle->h - handle->rawH;
-
-		if (spec->Flags & WindowFlag::Visible)
-		{
-			if (spec->Flags & WindowFlag::Maximized)
-				ShowWindow(handle->HWnd, SW_MAXIMIZE);
-			else if (spec->Flags & WindowFlag::Minimized)
-				ShowWindow(handle->HWnd, SW_MINIMIZE);
-			else
-				ShowWindow(handle->HWnd, SW_NORMAL);
 		}
-		else
+		else if (allocation->Memory)
 		{
-			ShowWindow(handle->HWnd, SW_HIDE);
+			vkFreeMemory(g_Context->Device, allocation->Memory, nullptr);
+			--g_Context->DedicatedCount;
+			g_Context->DedicatedBytes -= allocation->Size;
 		}
-		return true;
+		allocation->~DeviceAllocation();
+		g_Context->AllocationPool->Free(allocation);
+		g_Context->MemoryMutex.Unlock();
 	}
 
-	void IntDeInitHandle(Context* context, Handle* handle)
+	DeviceMemoryStats GetDeviceMemoryStats()
 	{
-		if (!context || !handle)
-			return;
-		RemovePropW(handle->HWnd, L"TestHandle");
-		DestroyWindow(handle->HWnd);
-		handle->HWnd = nullptr;
-	}
+		DeviceMemoryStats stats {};
+		if (!g_Context)
+			return stats;
 
-	LRESULT HelperWndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
-	{
-		if (g_Context && g_Context->SeparateThread)
-		{
-			++((SeparateThreadContext*) g_Context)->MessageCount;
-			((SeparateThreadContext*) g_Context)->MessageCount.notify_all();
-		}
-		switch (Msg)
+		g_Context->MemoryMutex.Lock();
+		for (auto& pools : g_Context->MemoryPools)
 		{
-		case Wnd_WM_CREATE_WINDOW:
-		{
-			if (!wParam || !lParam)
-				return FALSE;
-
-			SeparateThreadHandle* stHandle = new SeparateThreadHandle();
-			if (!IntInitHandle(g_Context, stHandle, (const Spec*) lParam))
+			for (auto& pool : pools)
 			{
-				delete stHandle;
-				return FALSE;
+				for (auto block : pool.Blocks)
+				{
+					auto blockStats = block->Allocator.GetStats();
+					++stats.BlockCount;
+					stats.BlockBytes      += blockStats.Size;
+					stats.UsedBytes       += blockStats.Used;
+					stats.LargestFree      = std::max(stats.LargestFree, blockStats.LargestFree);
+					stats.AllocationCount += blockStats.AllocationCount;
+					stats.FreeRangeCount  += blockStats.FreeBlockCount;
+				}
 			}
-			SeparateThreadContext* stContext = (SeparateThreadContext*) g_Context;
-			stContext->Mtx.Lock();
-			stContext->Windows.emplace_back(stHandle);
-			stContext->Mtx.Unlock();
-			*(Handle**) wParam = stHandle;
-			return TRUE;
-		}
-		case Wnd_WM_DESTROY_WINDOW:
-		{
-			if (!wParam)
-				return TRUE;
-
-			IntDeInitHandle(g_Context, (Handle*) wParam);
-			SeparateThreadContext* stContext = (SeparateThreadContext*) g_Context;
-			stContext->Mtx.Lock();
-			std::erase(stContext->Windows, (Handle*) wParam);
-			stContext->Mtx.Unlock();
-			delete (SeparateThreadHandle*) wParam;
-			return TRUE;
-		}
-		case Wnd_WM_DEINIT:
-			PostQuitMessage(0);
-			return TRUE;
 		}
-		return DefWindowProcW(hWnd, Msg, wParam, lParam);
+		stats.DedicatedCount = g_Context->DedicatedCount;
+		stats.DedicatedBytes = g_Context->DedicatedBytes;
+		g_Context->MemoryMutex.Unlock();
+		return stats;
 	}
 
-	LRESULT WndProc(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam)
+	uint32_t PlanDefragment(DeviceMemoryMove* moves, uint32_t maxMoves)
 	{
-		if (g_Context && g_Context->SeparateThread)
-		{
-			++((SeparateThreadContext*) g_Context)->MessageCount;
-			((SeparateThreadContext*) g_Context)->MessageCount.notify_all();
-		}
-		Handle* window = (Handle*) GetPropW(hWnd, L"TestHandle");
-		if (!window)
-			return DefWindowProcW(hWnd, Msg, wParam, lParam);
+		if (!g_Context || !moves)
+			return 0;
 
-		switch (Msg)
+		uint32_t moveCount = 0;
+		g_Context->MemoryMutex.Lock();
+		for (uint32_t type = 0; type < g_Context->MemoryProperties.memoryTypeCount && moveCount < maxMoves; ++type)
 		{
-		case WM_CLOSE:
-			if (g_Context->SeparateThread)
-				((SeparateThreadHandle*) window)->Flags |= WindowFlag::WantsClose;
-			else
-				((SameThreadHandle*) window)->Flags |= WindowFlag::WantsClose;
-			return 0;
-		case WM_MOVE:
-			if (g_Context->SeparateThread)
-				((SeparateThreadHandle*) window)->Mtx.Lock();
-			window->x    = (int32_t) (short) LOWORD(lParam);
-			window->y    = (int32_t) (short) HIWORD(lParam);
-			window->rawX = window->x - window->rawMarginX;
-			window->rawY = window->y - window->rawMarginY;
-			if (g_Context->SeparateThread)
-				((SeparateThreadHandle*) window)->Mtx.Unlock();
-			return 0;
-		case WM_SIZE:
-			if (g_Context->SeparateThread)
-			{
-				SeparateThreadHandle* stHandle = (SeparateThreadHandle*) window;
-				switch (wParam)
-				{
-				case SIZE_RESTORED:
-					stHandle->Flags &= ~WindowFlag::MinMax;
-					break;
-				case SIZE_MINIMIZED:
-					stHandle->Flags &= ~WindowFlag::MinMax;
-					stHandle->Flags |= WindowFlag::Minimized;
-					break;
-				case SIZE_MAXIMIZED:
-					stHandle->Flags &= ~WindowFlag::MinMax;
-					stHandle->Flags |= WindowFlag::Maximized;
-					break;
-				}
-				stHandle->Mtx.Lock();
-			}
-			else
+			for (uint32_t linear = 0; linear < 2 && moveCount < maxMoves; ++linear)
 			{
-				SameThreadHandle* stHandle = (SameThreadHandle*) window;
-				switch (wParam)
+				auto& pool = g_Context->MemoryPools[type][linear];
+				if (pool.Blocks.size() < 2)
+					continue;
+
+				// Emptying the least used block frees the most memory for the fewest copies
+				DeviceMemoryBlock* source = nullptr;
+				for (auto block : pool.Blocks)
 				{
-				case SIZE_RESTORED:
-					stHandle->Flags &= ~WindowFlag::MinMax;
-					break;
-				case SIZE_MINIMIZED:
-					stHandle->Flags &= ~WindowFlag::MinMax;
-					stHandle->Flags |= WindowFlag::Minimized;
-					break;
-				case SIZE_MAXIMIZED:
-					stHandle->Flags &= ~WindowFlag::MinMax;
-					stHandle->Flags |= WindowFlag::Maximized;
-					break;
+					if (!block->Allocator.Empty() && (!source || block->Allocator.UsedSize() < source->Allocator.UsedSize()))
+						source = block;
 				}
+				if (!source)
+					continue;
+
+				source->Allocator.ForEachAllocation([&](uint32_t node) {
+					if (moveCount >= maxMoves)
+						return;
+					auto from = (DeviceAllocation*) source->Allocator.UserData(node);
+					auto to   = new (g_Context->AllocationPool->Allocate()) DeviceAllocation(*from);
+					if (!SubAllocate(pool, type, to, source))
+					{
+						g_Context->AllocationPool->Free(to);
+						return;
+					}
+					moves[moveCount++] = { from, to };
+				});
 			}
-			window->w    = (uint32_t) (short) LOWORD(lParam);
-			window->h    = (uint32_t) (short) HIWORD(lParam);
-			window->rawW = window->w + window->rawMarginW;
-			window->rawH = window->h + window->rawMarginH;
-			if (g_Context->SeparateThread)
-				((SeparateThreadHandle*) window)->Mtx.Unlock();
-			return 0;
 		}
-		return DefWindowProcW(hWnd, Msg, wParam, lParam);
+		g_Context->MemoryMutex.Unlock();
+		return moveCount;
 	}
-} // namespace Wnd
+} // namespace Vk
 
-extern "C" VkResult vkGetMemoryWin32HandleKHR(VkDevice device, const VkMemoryGetWin32HandleInfoKHR* pGetWin32HandleInfo, HANDLE* pHandle)
+#if !BUILD_IS_SYSTEM_WINDOWS
+namespace Vk
 {
-	auto func = (PFN_vkGetMemoryWin32HandleKHR) vkGetDeviceProcAddr(device, "vkGetMemoryWin32HandleKHR");
-	if (!func)
+	VkResult createSurface([[maybe_unused]] Wnd::Handle* window, [[maybe_unused]] VkSurfaceKHR* surface)
+	{
 		return VK_ERROR_EXTENSION_NOT_PRESENT;
-	return func(device, pGetWin32HandleInfo, pHandle);
-}
+	}
+} // namespace Vk
 
-extern "C" VkResult vkGetMemoryWin32HandlePropertiesKHR(VkDevice device, VkExternalMemoryHandleTypeFlagBits handleType, HANDLE handle, VkMemoryWin32HandlePropertiesKHR* pMemoryWin32HandleProperties)
+namespace Wnd
 {
-	auto func = (PFN_vkGetMemoryWin32HandlePropertiesKHR) vkGetDeviceProcAddr(device, "vkGetMemoryWin32HandlePropertiesKHR");
-	if (!func)
-		return VK_ERROR_EXTENSION_NOT_PRESENT;
-	return func(device, handleType, handle, pMemoryWin32HandleProperties);
-}
+	Context* g_Context = nullptr;
 
-extern "C" VkResult vkCreateWin32SurfaceKHR(VkInstance instance, const VkWin32SurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface)
-{
-	auto func = (PFN_vkCreateWin32SurfaceKHR) vkGetInstanceProcAddr(instance, "vkCreateWin32SurfaceKHR");
-	if (!func)
-		return VK_ERROR_EXTENSION_NOT_PRESENT;
-	return func(instance, pCreateInfo, pAllocator, pSurface);
-}
+	bool Init([[maybe_unused]] const ContextSpec* spec)
+	{
+		std::cout << "Windows are only implemented on Win32, run the test with '--headless'\n";
+		return false;
+	}
 
-extern "C" VkResult vkGetSemaphoreWin32HandleKHR(VkDevice device, const VkSemaphoreGetWin32HandleInfoKHR* pGetWin32HandleInfo, HANDLE* pHandle)
-{
-	auto func = (PFN_vkGetSemaphoreWin32HandleKHR) vkGetDeviceProcAddr(device, "vkGetSemaphoreWin32HandleKHR");
-	if (!func)
-		return VK_ERROR_EXTENSION_NOT_PRESENT;
-	return func(device, pGetWin32HandleInfo, pHandle);
-}
+	void DeInit() {}
+	void PollEvents() {}
+	void WaitForEvent() {}
+	bool QuitSignaled() { return true; }
+	void SignalQuit() {}
+
+	Handle* Create([[maybe_unused]] const Spec* spec) { return nullptr; }
+	void    Destroy([[maybe_unused]] Handle* window) {}
+	void    Show([[maybe_unused]] Handle* window) {}
+	void    Hide([[maybe_unused]] Handle* window) {}
+	void    Maximize([[maybe_unused]] Handle* window) {}
+	void    Minimize([[maybe_unused]] Handle* window) {}
+	void    Restore([[maybe_unused]] Handle* window) {}
+	bool    IsMaximized([[maybe_unused]] Handle* window) { return false; }
+	bool    IsMinimized([[maybe_unused]] Handle* window) { return false; }
+	void    SetWindowTitle([[maybe_unused]] Handle* window, [[maybe_unused]] std::string_view title) {}
+	void    GetWindowTitle([[maybe_unused]] Handle* window, std::string& title) { title.clear(); }
+	bool    GetWantsClose([[maybe_unused]] Handle* window) { return true; }
+	void    SetWantsClose([[maybe_unused]] Handle* window, [[maybe_unused]] bool wantsClose) {}
+
+	void GetWindowPos([[maybe_unused]] Handle* window, int32_t& x, int32_t& y, [[maybe_unused]] bool raw)
+	{
+		x = 0;
+		y = 0;
+	}
 
-extern "C" VkResult vkImportSemaphoreWin32HandleKHR(VkDevice device, const VkImportSemaphoreWin32HandleInfoKHR* pImportSemaphoreWin32HandleInfo)
-{
-	auto func = (PFN_vkImportSemaphoreWin32HandleKHR) vkGetDeviceProcAddr(device, "vkImportSemaphoreWin32HandleKHR");
-	if (!func)
-		return VK_ERROR_EXTENSION_NOT_PRESENT;
-	return func(device, pImportSemaphoreWin32HandleInfo);
-}
\ No newline at end of file
+	void GetWindowSize([[maybe_unused]] Handle* window, uint32_t& w, uint32_t& h, [[maybe_unused]] bool raw)
+	{
+		w = 0;
+		h = 0;
+	}
+
+	void GetWindowRect([[maybe_unused]] Handle* window, int32_t& x, int32_t& y, uint32_t& w, uint32_t& h, [[maybe_unused]] bool raw)
+	{
+		x = 0;
+		y = 0;
+		w = 0;
+		h = 0;
+	}
+
+	void SetWindowPos([[maybe_unused]] Handle* window, [[maybe_unused]] int32_t x, [[maybe_unused]] int32_t y, [[maybe_unused]] bool raw) {}
+	void SetWindowSize([[maybe_unused]] Handle* window, [[maybe_unused]] uint32_t w, [[maybe_unused]] uint32_t h, [[maybe_unused]] bool raw) {}
+	void SetWindowRect([[maybe_unused]] Handle* window, [[maybe_unused]] int32_t x, [[maybe_unused]] int32_t y, [[maybe_unused]] uint32_t w, [[maybe_unused]] uint32_t h, [[maybe_unused]] bool raw) {}
+} // namespace Wnd
+#endif
\ No newline at end of file
@@ -1,22 +1,29 @@
 #pragma once
 
+#include <Build.h>
+
+#include "Utils/Allocators.h"
+#include "Utils/FrameTimings.h"
+#include "Utils/TLSF.h"
 #include "Utils/TupleVector.h"
 
+#include <atomic>
 #include <format>
-#include <functional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <thread>
 #include <vector>
 
-#include <Windows.h>
+#if BUILD_IS_SYSTEM_WINDOWS
+	#include <Windows.h>
 
-#include <d3d11_4.h>
-#include <dcomp.h>
-#include <dwmapi.h>
-#include <dxgi1_6.h>
-#include <Presentation.h>
+	#include <d3d11_4.h>
+	#include <dcomp.h>
+	#include <dwmapi.h>
+	#include <dxgi1_6.h>
+	#include <Presentation.h>
+#endif
 
 #include <vulkan/vk_enum_string_helper.h>
 #include <vulkan/vulkan.h>
@@ -33,7 +40,7 @@ namespace Helpers
 			  m_Func(func),
 			  m_Message(std::format("{} returned {}", func, string_VkResult(result))) {}
 
-		virtual const char* what() const { return m_Message.c_str(); }
+		virtual const char* what() const noexcept { return m_Message.c_str(); }
 
 		auto  GetResult() const { return m_Result; }
 		auto& GetFunc() const { return m_Func; }
@@ -45,6 +52,7 @@ namespace Helpers
 		std::string m_Message;
 	};
 
+#if BUILD_IS_SYSTEM_WINDOWS
 	struct HrExcept : std::exception
 	{
 	public:
@@ -53,7 +61,7 @@ namespace Helpers
 			  m_Func(func),
 			  m_Message(std::format("{} returned {:08X}", func, (uint32_t) result)) {}
 
-		virtual const char* what() const { return m_Message.c_str(); }
+		virtual const char* what() const noexcept { return m_Message.c_str(); }
 
 		auto  GetResult() const { return m_Result; }
 		auto& GetFunc() const { return m_Func; }
@@ -64,9 +72,12 @@ namespace Helpers
 		std::string m_Func;
 		std::string m_Message;
 	};
+#endif
 
 	void VkReport(VkResult result, std::string_view func);
+#if BUILD_IS_SYSTEM_WINDOWS
 	void HrReport(HRESULT result, std::string_view func);
+#endif
 
 	inline void VkExpect(VkResult result, std::string_view func)
 	{
@@ -105,6 +116,7 @@ namespace Helpers
 		return result;
 	}
 
+#if BUILD_IS_SYSTEM_WINDOWS
 	inline void HrExpect(HRESULT result, std::string_view func)
 	{
 		if (result >= S_OK)
@@ -141,15 +153,18 @@ namespace Helpers
 		HrReport(result, func);
 		return result;
 	}
+#endif
 } // namespace Helpers
 
 #define VK_EXPECT(func, ...)   ::Helpers::VkExpect(func(__VA_ARGS__), #func)
 #define VK_VALIDATE(func, ...) ::Helpers::VkValidate(func(__VA_ARGS__), #func)
 #define VK_INVALID(func, ...)  if (!::Helpers::VkValidate(func(__VA_ARGS__), #func))
 
-#define HR_EXPECT(func, ...)   ::Helpers::HrExpect(func(__VA_ARGS__), #func)
-#define HR_VALIDATE(func, ...) ::Helpers::HrValidate(func(__VA_ARGS__), #func)
-#define HR_INVALID(func, ...)  if (!::Helpers::HrValidate(func(__VA_ARGS__), #func))
+#if BUILD_IS_SYSTEM_WINDOWS
+	#define HR_EXPECT(func, ...)   ::Helpers::HrExpect(func(__VA_ARGS__), #func)
+	#define HR_VALIDATE(func, ...) ::Helpers::HrValidate(func(__VA_ARGS__), #func)
+	#define HR_INVALID(func, ...)  if (!::Helpers::HrValidate(func(__VA_ARGS__), #func))
+#endif
 
 namespace Vk
 {
@@ -159,10 +174,12 @@ namespace Vk
 	struct Context;
 } // namespace Vk
 
+#if BUILD_IS_SYSTEM_WINDOWS
 namespace DX
 {
 	struct Context;
 } // namespace DX
+#endif
 
 namespace Wnd
 {
@@ -172,15 +189,199 @@ namespace Wnd
 
 namespace Vk
 {
-	struct FrameState
+	static constexpr uint32_t c_HeadlessImageCount      = 3;
+	static constexpr uint32_t c_MaxRecordThreads        = 64;
+	static constexpr uint32_t c_CommandBufferChunkSize  = 16;
+	static constexpr uint32_t c_MaxGpuMarkers           = 32;
+	static constexpr uint32_t c_InvalidGpuMarker        = ~0U;
+	static constexpr uint32_t c_MaxSubmitCommandBuffers = 16;
+	static constexpr uint32_t c_MaxSubmitSignals        = 8; // Including the queue's own Timeline
+	static constexpr uint32_t c_MaxUploadWaits          = 64;
+	static constexpr uint32_t c_MaxPacedFrames          = 16;
+	static constexpr uint32_t c_MaxSurfacePresentModes  = 8;
+	static constexpr uint32_t c_MaxSurfaceFormats       = 32;
+
+	// Command buffers are allocated in chunks that are never moved or freed before the pool, so handed out handles stay valid
+	struct CommandBufferChunk
 	{
-		std::vector<std::function<void()>> Destroys;
+		CommandBufferChunk* Next = nullptr;
+		VkCommandBuffer     CmdBufs[c_CommandBufferChunkSize] {};
+	};
 
-		VkCommandPool   Pool          = nullptr;
-		VkCommandBuffer CmdBuf        = nullptr;
-		VkSemaphore     Timeline      = nullptr;
-		uint64_t        TimelineValue = 0;
-		VkSemaphore     RenderDone    = nullptr;
+	// One recording thread's pool, only ever touched by that thread and by ResetCommandBuffers
+	struct CommandPoolSlot
+	{
+		VkCommandPool       Pool    = nullptr; // Created on the first AcquireCommandBuffer from this thread
+		CommandBufferChunk* Chunks  = nullptr;
+		CommandBufferChunk* Current = nullptr;
+		uint32_t            Used    = 0;       // Command buffers handed out from Current
+	};
+
+	struct CommandRecycler
+	{
+		CommandPoolSlot Slots[c_MaxRecordThreads];
+	};
+
+	struct GpuMarkerTiming
+	{
+		const char* Name     = nullptr;
+		uint64_t    Duration = 0; // ns
+	};
+
+	// Timestamp pairs written by the frame's command buffers, read back once the frame's Timeline has passed the submit that wrote them
+	struct GpuProfiler
+	{
+		VkQueryPool     Pool        = nullptr; // Null when QueueFamily has no timestamps
+		uint32_t        MarkerCount = 0;       // Markers begun since the last resolve
+		uint64_t        RecordValue = 0;       // Frame TimelineValue while the markers were recorded, they land in the submit after it
+		const char*     Names[c_MaxGpuMarkers] {};
+		GpuMarkerTiming Results[c_MaxGpuMarkers] {}; // Markers of the last resolved frame
+		uint32_t        ResultCount = 0;
+		uint64_t        Dropped     = 0; // Markers skipped because the pool was full or still in flight
+	};
+
+	enum class QueueType : uint32_t
+	{
+		Graphics, // Renders and presents, everything the frames submit goes here
+		Compute,  // Async compute, prefers a family without graphics
+		Transfer, // Uploads, prefers a family with neither graphics nor compute
+		Count
+	};
+
+	static constexpr uint32_t c_QueueTypeCount = (uint32_t) QueueType::Count;
+
+	// Compute and Transfer share the graphics VkQueue when the device has no queue left for them, submits to a shared queue still signal their own Timeline.
+	// Only one thread may submit to a VkQueue at a time, so shared queues are submitted from the same thread as the graphics queue
+	struct QueueState
+	{
+		VkQueue     Queue    = nullptr;
+		uint32_t    Family   = 0;
+		uint32_t    Index    = 0;
+		VkSemaphore Timeline = nullptr; // Signaled by every SubmitQueue
+		uint64_t    Value    = 0;       // Last value SubmitQueue signaled
+		bool        Shared   = false;   // Uses the graphics VkQueue
+	};
+
+	// Sub-allocated VkDeviceMemory, host visible blocks stay mapped until the block is released
+	struct DeviceMemoryBlock
+	{
+		VkDeviceMemory Memory = nullptr;
+		void*          Mapped = nullptr;
+		TLSFAllocator  Allocator;
+	};
+
+	// Blocks of one memory type. Linear resources (buffers, linear images) and optimal images get separate pools,
+	// so neighbouring sub-allocations never need bufferImageGranularity padding
+	struct DeviceMemoryPool
+	{
+		std::vector<DeviceMemoryBlock*> Blocks;
+	};
+
+	// Handed out by AllocateDeviceMemory and owned by the context until FreeDeviceMemory
+	struct DeviceAllocation
+	{
+		VkDeviceMemory     Memory     = nullptr;
+		VkDeviceSize       Offset     = 0;
+		VkDeviceSize       Size       = 0;
+		VkDeviceSize       Alignment  = 0;
+		void*              Mapped     = nullptr; // Already offset, null when the memory type is not host visible
+		void*              UserData   = nullptr; // Handed back through PlanDefragment to find the resource bound to the allocation
+		DeviceMemoryBlock* Block      = nullptr; // Null for dedicated allocations
+		uint32_t           Node       = 0;
+		uint32_t           MemoryType = 0;
+		bool               Linear     = false;
+	};
+
+	struct DeviceMemoryStats
+	{
+		uint32_t     BlockCount      = 0;
+		VkDeviceSize BlockBytes      = 0;
+		VkDeviceSize UsedBytes       = 0; // Sub-allocated bytes inside the blocks
+		VkDeviceSize LargestFree     = 0; // Largest free range of any block
+		uint32_t     AllocationCount = 0; // Sub-allocations
+		uint32_t     FreeRangeCount  = 0;
+		uint32_t     DedicatedCount  = 0;
+		VkDeviceSize DedicatedBytes  = 0;
+	};
+
+	// From should be copied to To, To is already allocated and has From's UserData
+	struct DeviceMemoryMove
+	{
+		DeviceAllocation* From = nullptr;
+		DeviceAllocation* To   = nullptr;
+	};
+
+	enum class PacingMode : uint32_t
+	{
+		Throughput, // Only waits when every frame in flight is still queued, keeps the GPU as busy as possible
+		Latency,    // Limits frames in flight and delays frame starts so frame start to GPU completion stays near LatencyTarget
+		Count
+	};
+
+	// Paces frame starts off the graphics queue Timeline, every frame ends with a signal of it so no fences are needed.
+	// Completions are noticed when PacerBeginFrame polls or waits, so latencies measured while not waiting can be late by up to a frame
+	struct FramePacer
+	{
+		PacingMode Mode            = PacingMode::Throughput;
+		uint64_t   LatencyTarget   = 0; // ns
+		uint32_t   MaxFrames       = 0; // Never more than FramesInFlight, so a frame's slot is free once the pacer lets it start
+		uint32_t   EffectiveFrames = 0; // Frames in flight the latency mode currently allows
+
+		uint64_t FrameNumber    = 0; // Frames begun
+		uint64_t Completed      = 0; // Frames whose completion has been seen
+		uint64_t LastCompletion = 0;
+		uint64_t StartTimes[c_MaxPacedFrames] {};
+		uint64_t EndTimes[c_MaxPacedFrames] {};
+		uint64_t Values[c_MaxPacedFrames] {}; // Graphics queue Timeline value signaled after each frame's submits
+
+		double CpuTime = 0.0; // Smoothed ns from PacerBeginFrame to PacerEndFrame
+		double GpuTime = 0.0; // Smoothed ns the GPU spends per frame
+
+		FrameTimingHistogram Latency;     // Frame start to GPU completion, ns
+		uint64_t             Delayed = 0; // ns spent delaying frame starts on top of waiting for frames in flight
+	};
+
+	enum class DestroyType : uint32_t
+	{
+		ImageView,
+		Image,
+		Buffer,
+		DeviceMemory,
+		Allocation, // DeviceAllocation* from AllocateDeviceMemory
+		Semaphore,
+		CommandPool,
+		Swapchain
+	};
+
+	// Handle that is destroyed once its frame's Timeline reaches RetireValue
+	struct DeferredDestroy
+	{
+		DestroyType Type;
+		uint64_t    Handle;
+		uint64_t    RetireValue;
+	};
+
+	// Entries are pushed in retire order so reclaiming pops from the front, the capacity is kept so a steady workload stops allocating
+	struct DestroyQueue
+	{
+		std::vector<DeferredDestroy> Entries;
+		size_t                       Head = 0;
+	};
+
+	struct FrameState
+	{
+		DestroyQueue    Destroys; // Keyed on Timeline
+		LinearArena     Arena;    // Per frame scratch, reset when NextFrame comes back around to this frame
+		CommandRecycler Commands;
+		GpuProfiler     Profiler;
+
+		VkSemaphore Timeline      = nullptr;
+		uint64_t    TimelineValue = 0;
+		VkSemaphore RenderDone    = nullptr;
+
+		// Upload ring epoch and retire value this frame last registered with the current partition, lets UploadAllocate skip registering again
+		std::atomic_uint64_t UploadEpoch  = 0;
+		std::atomic_uint64_t UploadRetire = 0;
 	};
 
 	struct SwapchainFrameState : public FrameState
@@ -189,15 +390,90 @@ namespace Vk
 		uint32_t    ImageIndex = 0;
 	};
 
+	// App owned images used instead of a VkSwapchainKHR when the context is headless, presenting signals Timeline once rendering is done
+	struct HeadlessSwapchain
+	{
+		VkDeviceMemory Memory    = nullptr;
+		VkSemaphore    Timeline  = nullptr;
+		uint64_t       Value     = 0;
+		uint32_t       NextImage = 0;
+		uint64_t       PresentValues[c_HeadlessImageCount] {}; // Timeline value each image was last presented with
+	};
+
+	enum class PresentPreference : uint32_t
+	{
+		Latency,    // MAILBOX, then IMMEDIATE, then FIFO, with one image over the surface minimum
+		Throughput, // IMMEDIATE, then MAILBOX, then FIFO, with two images over the surface minimum so acquiring never waits on presents
+		Count
+	};
+
+	struct SwapchainPolicySpec
+	{
+		PresentPreference Preference  = PresentPreference::Latency;
+		VkPresentModeKHR  PresentMode = VK_PRESENT_MODE_MAX_ENUM_KHR; // Used instead of Preference's order when the surface supports it
+		uint32_t          ImageCount  = 0;                            // Zero lets Preference pick, clamped to the surface limits
+		VkFormat          Format      = VK_FORMAT_B8G8R8A8_UNORM;     // Falls back to another 8 bit UNORM format, then the surface's first one
+	};
+
+	// Surface support is queried once when the swapchain is first created, every recreation selects from the cached lists again.
+	// Headless swapchains ignore the policy
+	struct SwapchainPolicy
+	{
+		SwapchainPolicySpec Spec;
+
+		VkPresentModeKHR   PresentModes[c_MaxSurfacePresentModes] {};
+		VkSurfaceFormatKHR Formats[c_MaxSurfaceFormats] {};
+		uint32_t           PresentModeCount = 0;
+		uint32_t           FormatCount      = 0;
+		uint32_t           MinImageCount    = 0; // From the surface capabilities of the last recreation
+		uint32_t           MaxImageCount    = 0; // Zero means no limit
+
+		// Selected for the current swapchain
+		VkPresentModeKHR   PresentMode = VK_PRESENT_MODE_FIFO_KHR;
+		VkSurfaceFormatKHR Format      = { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR };
+		uint32_t           ImageCount  = 0;
+	};
+
 	struct SwapchainState
 	{
 		Wnd::Handle*                      Window    = nullptr;
 		VkSurfaceKHR                      Surface   = nullptr;
 		VkSwapchainKHR                    Swapchain = nullptr;
-		VkExtent2D                        Extents   = {};
+		VkExtent2D                        Extents   = {}; // Headless swapchains are created at this size, zero picks the window size or 1280x720
 		TupleVector<VkImage, VkImageView> Images;
 		SwapchainFrameState*              Frames      = nullptr;
 		bool                              Invalidated = false;
+		HeadlessSwapchain                 Headless;
+		SwapchainPolicy                   Policy; // Set Policy.Spec before InitSwapchainState, SwapchainSetPolicy afterwards
+	};
+
+	// One FramesInFlight share of the upload ring. Allocations bump Used, every frame allocating from it adds the Timeline value
+	// its next submit signals, and NextFrame waits for the ones the frames went on to submit before the partition is reused
+	struct UploadPartition
+	{
+		std::atomic<VkDeviceSize> Used      = 0;
+		std::atomic_uint32_t      WaitCount = 0;
+		std::atomic_uint32_t      Failed    = 0; // Allocations that did not fit since the partition was last reused
+		FrameState*               Frames[c_MaxUploadWaits] {};
+		uint64_t                  Values[c_MaxUploadWaits] {};
+	};
+
+	// Persistently mapped host visible buffer for transient uniform, vertex and staging data, device local as well when the device has such memory
+	struct UploadRing
+	{
+		VkBuffer          Buffer        = nullptr;
+		DeviceAllocation* Memory        = nullptr;
+		VkDeviceSize      PartitionSize = 0;
+		VkDeviceSize      Alignment     = 0;       // Default alignment, covers uniform and storage buffer offsets
+		uint64_t          Epoch         = 1;       // Bumped by every NextFrame
+		UploadPartition*  Partitions    = nullptr; // FramesInFlight, indexed like Frames
+	};
+
+	struct UploadAllocation
+	{
+		void*        Data   = nullptr; // Null when the allocation did not fit
+		VkBuffer     Buffer = nullptr;
+		VkDeviceSize Offset = 0;
 	};
 
 	struct Context
@@ -206,10 +482,36 @@ namespace Vk
 		VkPhysicalDevice PhysicalDevice = nullptr;
 		VkDevice         Device         = nullptr;
 		VkQueue          Queue          = nullptr;
+		uint32_t         QueueFamily    = 0; // Graphics and compute family Queue and every command pool use
+		bool             Headless       = false;
+
+		QueueState Queues[c_QueueTypeCount] {}; // Queue and QueueFamily are the Graphics entry
+
+		float    TimestampPeriod = 0.0f; // ns per timestamp tick, zero when QueueFamily has no timestamps
+		uint64_t TimestampMask   = 0;
+
+		VkPhysicalDeviceMemoryProperties MemoryProperties {};
+		VkDeviceSize                     MemoryBlockSize = 0;
+		Concurrency::Mutex               MemoryMutex;                         // Guards MemoryPools, AllocationPool and the dedicated counters
+		DeviceMemoryPool                 MemoryPools[VK_MAX_MEMORY_TYPES][2]; // Optimal and linear pool of every memory type
+		FixedBlockPool*                  AllocationPool = nullptr;            // DeviceAllocation handles
+		uint32_t                         DedicatedCount = 0;
+		VkDeviceSize                     DedicatedBytes = 0;
+
+		std::string     PipelineCachePath;             // Written back in DeInit when not empty
+		VkPipelineCache PipelineCache       = nullptr; // Internally synchronized, every thread creating pipelines can pass it directly
+		size_t          PipelineCacheLoaded = 0;       // Bytes of cache data accepted from disk, zero on a cold start
 
 		uint32_t    FramesInFlight = 0;
 		uint32_t    CurrentFrame   = 0;
 		FrameState* Frames         = nullptr;
+
+		FixedBlockPool* FramePool = nullptr; // Blocks of FramesInFlight SwapchainFrameStates, Frames takes one as well
+
+		UploadRing Uploads;
+
+		uint64_t FrameAllocations    = 0; // Heap allocations made by any thread during the previous frame, see g_AllocationStats
+		uint64_t LastAllocationCount = 0;
 	};
 
 	extern Context* g_Context;
@@ -233,6 +535,7 @@ namespace Vk
 		VkPhysicalDeviceVulkan12Features Vk12DeviceFeatures = {
 			.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
 			.pNext             = &Vk13DeviceFeatures,
+			.hostQueryReset    = VK_TRUE,
 			.timelineSemaphore = VK_TRUE
 		};
 		VkPhysicalDeviceVulkan11Features Vk11DeviceFeatures = {
@@ -245,27 +548,117 @@ namespace Vk
 		};
 
 		uint32_t FramesInFlight = 1;
+		bool     Headless       = false; // Swapchains render to offscreen images, no window or surface extensions needed
+
+		const char* PipelineCachePath = nullptr; // Pipeline cache file loaded in Init and saved in DeInit, null keeps the cache in memory only
+		const char* Device            = nullptr; // Case insensitive part of the device name or its deviceUUID in hex, null picks the highest scoring device
+
+		VkDeviceSize MemoryBlockSize = 64ULL << 20; // Size of the VkDeviceMemory blocks AllocateDeviceMemory sub-allocates from
+		VkDeviceSize UploadRingSize  = 0;           // Split evenly between FramesInFlight, zero leaves the context without an upload ring
 	};
 
 	bool InitFrameState(Context* context, FrameState* frame);
 	void DeInitFrameState(Context* context, FrameState* frame);
+	// Hands out an unrecorded primary command buffer from thread's pool, thread is any index below c_MaxRecordThreads unique to the calling thread (e.g. a JobPool worker)
+	VkCommandBuffer AcquireCommandBuffer(FrameState* frame, uint32_t thread = 0);
+	// Resets every pool that handed out command buffers once frame->TimelineValue has completed, returns false without waiting if it has not.
+	// Must not run while other threads acquire from the same frame
+	bool ResetCommandBuffers(FrameState* frame);
+	// Queues handle for destruction once frame->Timeline reaches retireValue
+	void DeferDestroy(FrameState* frame, DestroyType type, uint64_t handle, uint64_t retireValue);
+	// Destroys every queued handle whose retire value frame->Timeline has passed without waiting, returns how many were destroyed
+	size_t ReclaimDestroys(FrameState* frame);
+	// Writes a timestamp pair around GPU work, returns c_InvalidGpuMarker when the marker is dropped. Only one thread may record markers into a frame
+	uint32_t BeginGpuMarker(FrameState* frame, VkCommandBuffer cmdBuf, const char* name);
+	void     EndGpuMarker(FrameState* frame, VkCommandBuffer cmdBuf, uint32_t marker);
+	// Reads the markers of the frame's previous submit into Profiler.Results if its timeline has passed them, never waits.
+	// Call before recording the frame, returns true when Results were refreshed
+	bool ResolveGpuTimestamps(FrameState* frame);
+
+	struct GpuScope
+	{
+	public:
+		GpuScope(FrameState* frame, VkCommandBuffer cmdBuf, const char* name)
+			: m_Frame(frame),
+			  m_CmdBuf(cmdBuf),
+			  m_Marker(BeginGpuMarker(frame, cmdBuf, name))
+		{
+		}
+		GpuScope(const GpuScope&) = delete;
+		~GpuScope() { EndGpuMarker(m_Frame, m_CmdBuf, m_Marker); }
+
+		GpuScope& operator=(const GpuScope&) = delete;
+
+	private:
+		FrameState*     m_Frame;
+		VkCommandBuffer m_CmdBuf;
+		uint32_t        m_Marker;
+	};
 
 	bool Init(const ContextSpec* spec = nullptr);
 	void DeInit();
 
+	// Writes the pipeline cache to PipelineCachePath through a temporary file that replaces the old one, so readers never see a partial file
+	bool SavePipelineCache();
+
+	// Submits cmdBufs to the queue of type, signaling its Timeline with the next value on top of signals. Returns that value, 0 on failure
+	uint64_t SubmitQueue(QueueType type, uint32_t cmdBufCount, const VkCommandBuffer* cmdBufs, uint32_t waitCount = 0, const VkSemaphoreSubmitInfo* waits = nullptr, uint32_t signalCount = 0, const VkSemaphoreSubmitInfo* signals = nullptr);
+	// Makes a submit to another queue wait at stages until the queue of type reached value
+	VkSemaphoreSubmitInfo QueueWaitInfo(QueueType type, uint64_t value, VkPipelineStageFlags2 stages);
+	// Returns true once the queue of type reached value, waiting up to timeout ns
+	bool WaitQueue(QueueType type, uint64_t value, uint64_t timeout = ~0ULL);
+
+	// Moves on to the next frame, waiting for the GPU to finish with the upload partition it reuses
 	void NextFrame();
 
+	void InitFramePacer(FramePacer* pacer, PacingMode mode, uint64_t latencyTarget);
+	// Call before the frame samples input and waits on its frame timelines, returns the ns spent waiting and delaying
+	uint64_t PacerBeginFrame(FramePacer* pacer);
+	// Call after the frame's last submit to the graphics queue, from the thread that submits to it
+	bool PacerEndFrame(FramePacer* pacer);
+
+	// Sub-allocates transient data from the current frame's upload partition without locking, safe from any number of recording threads.
+	// The data has to be consumed by frame's next submit, zero alignment picks UploadRing::Alignment
+	UploadAllocation UploadAllocate(FrameState* frame, VkDeviceSize size, VkDeviceSize alignment = 0);
+
+	void* FrameAllocate(size_t size, size_t alignment);
+	template <class T>
+	T* FrameAllocate(size_t count)
+	{
+		return (T*) FrameAllocate(sizeof(T) * count, alignof(T));
+	}
+
 	bool InitSwapchainState(SwapchainState* swapchain, Wnd::Handle* window, bool withFrames = false);
 	void DeInitSwapchainState(SwapchainState* swapchain);
 	bool SwapchainAcquireImage(SwapchainState* swapchain);
 	bool SwapchainPresent(SwapchainState* swapchain);
+	// Presents every swapchain's current frame with a single vkQueuePresentKHR, each swapchain may only appear once
+	bool SwapchainPresentMany(SwapchainState* const* swapchains, uint32_t count);
 	bool SwapchainResize(SwapchainState* swapchain);
+	// Stores spec in Policy.Spec whenever the arguments are valid, a swapchain that is not created yet selects from it on creation and headless ones ignore it.
+	// Returns true only when a recreate was scheduled, the swapchain is then recreated through oldSwapchain on its next acquire so presenting never waits for idle
+	bool SwapchainSetPolicy(SwapchainState* swapchain, const SwapchainPolicySpec* spec);
 
 	uint32_t FindDeviceMemoryIndex(uint32_t typeBits, VkMemoryPropertyFlags flags);
 
+	// Sub-allocates requirements from the first memory type with flags, linear marks buffers and linear tiled images.
+	// Allocations of half MemoryBlockSize or more and dedicated ones get their own VkDeviceMemory, returns null on failure
+	DeviceAllocation* AllocateDeviceMemory(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags flags, bool linear, bool dedicated = false, void* userData = nullptr);
+	// Allocates and binds memory for image or buffer, dedicated when the driver prefers it
+	DeviceAllocation* AllocateImageMemory(VkImage image, VkMemoryPropertyFlags flags, bool linear = false, void* userData = nullptr);
+	DeviceAllocation* AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags flags, void* userData = nullptr);
+	// The GPU must be done with the allocation, use DestroyType::Allocation otherwise. Emptied blocks are released unless they are the last of their pool
+	void              FreeDeviceMemory(DeviceAllocation* allocation);
+	DeviceMemoryStats GetDeviceMemoryStats();
+	// Plans moving the allocations of each pool's emptiest block into its other blocks, returns the number of moves written.
+	// For every move the caller binds a new resource to To, copies From into it and frees From once the copy completed, which releases the emptied block
+	uint32_t PlanDefragment(DeviceMemoryMove* moves, uint32_t maxMoves);
+
+	// Only Win32 windows get a surface, elsewhere this fails and the tests have to run headless
 	VkResult createSurface(Wnd::Handle* window, VkSurfaceKHR* surface);
 } // namespace Vk
 
+#if BUILD_IS_SYSTEM_WINDOWS
 namespace DX
 {
 	struct Context
@@ -301,6 +694,7 @@ namespace DX
 	bool Init(const ContextSpec* spec = nullptr);
 	void DeInit();
 } // namespace DX
+#endif
 
 namespace Wnd
 {
@@ -326,6 +720,7 @@ namespace Wnd
 		bool SeparateThread = false;
 	};
 
+	// Windows are only implemented on Win32, elsewhere Init fails and every other function is a no-op
 	bool Init(const ContextSpec* spec = nullptr);
 	void DeInit();
 	void PollEvents();
@@ -333,7 +728,9 @@ namespace Wnd
 	bool QuitSignaled();
 	void SignalQuit();
 
+#if BUILD_IS_SYSTEM_WINDOWS
 	HINSTANCE GetInstance();
+#endif
 
 	struct Spec
 	{
@@ -345,7 +742,9 @@ namespace Wnd
 
 	Handle* Create(const Spec* spec);
 	void    Destroy(Handle* window);
+#if BUILD_IS_SYSTEM_WINDOWS
 	HWND    GetNativeHandle(Handle* window);
+#endif
 	void    Show(Handle* window);
 	void    Hide(Handle* window);
 	void    Maximize(Handle* window);
@@ -365,6 +764,7 @@ namespace Wnd
 	void    SetWindowRect(Handle* window, int32_t x, int32_t y, uint32_t w, uint32_t h, bool raw = false);
 } // namespace Wnd
 
+#if BUILD_IS_SYSTEM_WINDOWS
 typedef struct VkImportMemoryWin32HandleInfoKHR
 {
 	VkStructureType                    sType;
@@ -435,4 +835,5 @@ extern "C" VkResult vkGetMemoryWin32HandleKHR(VkDevice device, const VkMemoryGet
 extern "C" VkResult vkGetMemoryWin32HandlePropertiesKHR(VkDevice device, VkExternalMemoryHandleTypeFlagBits handleType, HANDLE handle, VkMemoryWin32HandlePropertiesKHR* pMemoryWin32HandleProperties);
 extern "C" VkResult vkCreateWin32SurfaceKHR(VkInstance instance, const VkWin32SurfaceCreateInfoKHR* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkSurfaceKHR* pSurface);
 extern "C" VkResult vkGetSemaphoreWin32HandleKHR(VkDevice device, const VkSemaphoreGetWin32HandleInfoKHR* pGetWin32HandleInfo, HANDLE* pHandle);
-extern "C" VkResult vkImportSemaphoreWin32HandleKHR(VkDevice device, const VkImportSemaphoreWin32HandleInfoKHR* pImportSemaphoreWin32HandleInfo);
\ No newline at end of file
+extern "C" VkResult vkImportSemaphoreWin32HandleKHR(VkDevice device, const VkImportSemaphoreWin32HandleInfoKHR* pImportSemaphoreWin32HandleInfo);
+#endif
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "Utils/SlotMap.h"
+
+#include <cstdlib>
+
+#include <format>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Payload column plus a second column that must always travel with it
+using TestMap = SlotMap<uint64_t, uint32_t>;
+
+static uint32_t Tag(uint64_t value)
+{
+	return (uint32_t) (value * 0x9E37'79B9ULL >> 7);
+}
+
+static bool Fail(std::string_view what)
+{
+	std::cout << std::format("SlotMap {}\n", what);
+	return false;
+}
+
+static bool IsStale(const TestMap& map, SlotMapHandle handle)
+{
+	return !map.contains(handle) &&
+		   map.index_of(handle) == TestMap::npos &&
+		   map.get<0>(handle) == nullptr &&
+		   map.get<1>(handle) == nullptr;
+}
+
+// Every dense row must map back to itself through its hidden owner slot
+static bool CheckDense(const TestMap& map)
+{
+	const uint64_t* values = map.column<0>();
+	const uint32_t* tags   = map.column<1>();
+	for (size_t i = 0; i < map.size(); ++i)
+	{
+		SlotMapHandle handle = map.handle_at(i);
+		if (!handle || map.index_of(handle) != i || map.get<0>(handle) != values + i || tags[i] != Tag(values[i]))
+			return false;
+	}
+	return !map.handle_at(map.size());
+}
+
+static bool TestNullHandle()
+{
+	TestMap map;
+	if (SlotMapHandle::Null() || SlotMapHandle {} != SlotMapHandle::Null() || !IsStale(map, SlotMapHandle::Null()))
+		return Fail("accepted the zero handle on an empty map");
+
+	// Slot 0 with generation 0 is the zero handle, it must stay invalid once slot 0 is in use
+	SlotMapHandle first = map.insert(1, Tag(1));
+	if (first.Index() != 0 || first.Generation() == 0 || !first)
+		return Fail("handed out a zero generation handle");
+	if (!IsStale(map, SlotMapHandle::Null()) || !IsStale(map, SlotMapHandle { 0U, 0U }))
+		return Fail("accepted the zero handle with slot 0 occupied");
+	if (map.handle_at(1))
+		return Fail("returned a handle past the end");
+	return true;
+}
+
+static bool TestReuse()
+{
+	TestMap       map;
+	SlotMapHandle a = map.insert(10, Tag(10));
+	SlotMapHandle b = map.insert(20, Tag(20));
+	SlotMapHandle c = map.insert(30, Tag(30));
+	if (!map.erase(b))
+		return Fail("failed to erase a live handle");
+
+	SlotMapHandle d = map.insert(40, Tag(40));
+	if (d.Index() != b.Index() || d.Generation() == b.Generation() || d == b)
+		return Fail("did not reuse the freed slot with a new generation");
+	if (!IsStale(map, b) || map.erase(b))
+		return Fail("accepted a handle whose slot was reused");
+	if (map.size() != 3 || *map.get<0>(a) != 10 || *map.get<0>(c) != 30 || *map.get<0>(d) != 40)
+		return Fail("lost a row across erase and reinsert");
+
+	// Free list is LIFO, the most recently freed slot comes back first
+	map.erase(a);
+	map.erase(c);
+	SlotMapHandle e = map.emplace();
+	SlotMapHandle f = map.emplace();
+	if (e.Index() != c.Index() || f.Index() != a.Index())
+		return Fail("did not reuse freed slots in LIFO order");
+	*map.get<1>(e) = Tag(0);
+	*map.get<1>(f) = Tag(0);
+	if (*map.get<0>(e) != 0 || *map.get<0>(f) != 0 || !CheckDense(map))
+		return Fail("emplace did not value initialize its row");
+	return true;
+}
+
+static bool TestSwapAndPop()
+{
+	TestMap                    map;
+	std::vector<SlotMapHandle> handles;
+	for (uint64_t i = 0; i < 8; ++i)
+		handles.emplace_back(map.insert(i, Tag(i)));
+
+	// Erasing the front moves the last row into row 0 and repoints its slot
+	map.erase(handles[0]);
+	if (map.index_of(handles[7]) != 0 || map.handle_at(0) != handles[7] || map.column<0>()[0] != 7 || map.column<1>()[0] != Tag(7))
+		return Fail("did not move the last row into the erased row");
+
+	// Erasing the last row must not touch any other row
+	map.erase(handles[6]);
+	if (map.size() != 6 || map.index_of(handles[5]) != 5)
+		return Fail("moved a row when erasing the last row");
+
+	// Erase a moved row again, the owner column must follow both moves
+	map.erase(handles[7]);
+	if (map.index_of(handles[5]) != 0 || map.column<0>()[0] != 5)
+		return Fail("lost the owner of a row moved twice");
+	if (!CheckDense(map))
+		return Fail("owner column out of sync after swap and pop");
+
+	for (size_t i : { 0, 6, 7 })
+	{
+		if (!IsStale(map, handles[i]) || map.erase(handles[i]))
+			return Fail("accepted a handle after erase");
+	}
+	return true;
+}
+
+static bool TestClear()
+{
+	TestMap                    map;
+	std::vector<SlotMapHandle> handles;
+	for (uint64_t i = 0; i < 16; ++i)
+		handles.emplace_back(map.insert(i, Tag(i)));
+	map.erase(handles[3]);
+	map.clear();
+	if (!map.empty() || map.handle_at(0))
+		return Fail("kept rows after clear");
+	for (auto handle : handles)
+	{
+		if (!IsStale(map, handle))
+			return Fail("accepted a handle after clear");
+	}
+
+	// Refilling reuses every slot, none of the old handles may alias the new ones
+	std::vector<SlotMapHandle> refilled;
+	for (uint64_t i = 0; i < 16; ++i)
+		refilled.emplace_back(map.insert(100 + i, Tag(100 + i)));
+	for (auto handle : handles)
+	{
+		if (!IsStale(map, handle))
+			return Fail("accepted a pre-clear handle after refilling");
+	}
+	for (size_t i = 0; i < refilled.size(); ++i)
+	{
+		if (refilled[i].Index() >= handles.size() || *map.get<0>(refilled[i]) != 100 + i)
+			return Fail("grew the slot table instead of reusing cleared slots");
+	}
+	return CheckDense(map) || Fail("owner column out of sync after clear");
+}
+
+// Random interleaved inserts and erases checked against a reference map, dense iteration must see exactly the live rows
+static bool TestInterleaved(int64_t ops, uint32_t seed)
+{
+	std::mt19937_64                        rng(seed);
+	TestMap                                map;
+	std::unordered_map<uint64_t, uint64_t> reference;
+	std::vector<SlotMapHandle>             live;
+	std::vector<SlotMapHandle>             dead;
+	uint64_t                               nextValue = 1;
+
+	for (int64_t op = 0; op < ops; ++op)
+	{
+		// Bias towards inserting in the first half and erasing in the second so the map grows and drains
+		uint64_t insertBias = op < ops / 2 ? 6 : 3;
+		if (live.empty() || rng() % 10 < insertBias)
+		{
+			uint64_t      value  = nextValue++;
+			SlotMapHandle handle = map.insert(value, Tag(value));
+			if (!handle || reference.contains(handle.Value))
+				return Fail("returned a null or live handle from insert");
+			reference.emplace(handle.Value, value);
+			live.emplace_back(handle);
+		}
+		else
+		{
+			size_t        pick   = rng() % live.size();
+			SlotMapHandle handle = live[pick];
+			live[pick]           = live.back();
+			live.pop_back();
+			if (!map.erase(handle))
+				return Fail("failed to erase a live handle");
+			reference.erase(handle.Value);
+			dead.emplace_back(handle);
+		}
+
+		if (op % 1024 != 1023 && op != ops - 1)
+			continue;
+
+		if (map.size() != reference.size() || !CheckDense(map))
+			return Fail(std::format("out of sync with the reference after {} operations", op + 1));
+		const uint64_t* values = map.column<0>();
+		uint64_t        sum    = 0;
+		uint64_t        refSum = 0;
+		for (size_t i = 0; i < map.size(); ++i)
+		{
+			auto it = reference.find(map.handle_at(i).Value);
+			if (it == reference.end() || it->second != values[i])
+				return Fail(std::format("iterated a row the reference does not hold after {} operations", op + 1));
+			sum += values[i];
+		}
+		for (auto& [handle, value] : reference)
+			refSum += value;
+		if (sum != refSum)
+			return Fail("dense iteration missed live rows");
+		for (auto handle : dead)
+		{
+			if (map.contains(handle))
+				return Fail(std::format("accepted an erased handle after {} operations", op + 1));
+		}
+	}
+	std::cout << std::format("  {:<12} {:>10} ops {:>8} live {:>8} erased\n", "Interleaved", ops, live.size(), dead.size());
+	return true;
+}
+
+int SlotMapTest(size_t argc, const std::string_view* argv)
+{
+	int64_t opCount = 100'000;
+	int64_t seed    = 1;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "SlotMapTest Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':  Shows this help info\n"
+						 "  '-o' | '--ops':   Set number of interleaved inserts and erases, default 100000, minimum 1\n"
+						 "  '--seed' <seed>:  Set the interleaved workload seed, default 1\n";
+			return 0;
+		}
+		else if (argv[i] == "-o" || argv[i] == "--ops")
+		{
+			if (++i >= argc)
+				break;
+			opCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (opCount < 1)
+			{
+				std::cout << "Number of operations needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--seed")
+		{
+			if (++i >= argc)
+				break;
+			seed = std::strtoll(argv[i].data(), nullptr, 10);
+		}
+	}
+
+	if (!TestNullHandle() ||
+		!TestReuse() ||
+		!TestSwapAndPop() ||
+		!TestClear() ||
+		!TestInterleaved(opCount, (uint32_t) seed))
+		return 1;
+	std::cout << "SlotMap invariants hold\n";
+	return 0;
+}
@@ -0,0 +1,380 @@
+#include "CSwap/MockCompositor.h"
+#include "CSwap/SwapchainStateMachine.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string_view>
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct SwapchainSimSpec
+{
+	uint32_t             BufferCount = 3;
+	SwapchainPresentMode PresentMode = SwapchainPresentMode::Fifo;
+	uint64_t             Frames      = 1000;
+	uint64_t             VBlankTime  = 16'666'667; // ns
+	uint64_t             CPUTime     = 1'000'000;  // ns spent recording a frame
+	uint64_t             GPUTime     = 8'000'000;  // ns spent rendering a frame, the GPU renders one frame at a time
+
+	uint64_t ResizeInterval = 0;         // ns between window resizes, zero disables the resize storm
+	uint64_t RecreateTime   = 2'000'000; // ns spent recreating one buffer at the new size
+	bool     Staggered      = true;      // Recreate stale buffers one at a time as they are acquired, otherwise wait for the GPU and recreate all of them
+};
+
+struct SwapchainSimResult
+{
+	SwapchainStateMachineStats Stats;
+	uint64_t                   SimTime     = 0; // ns
+	uint64_t                   StarvedTime = 0; // ns the app spent blocked in Acquire
+	uint64_t                   ResizeTime  = 0; // ns the app spent recreating buffers
+	uint64_t                   MaxStall    = 0; // Longest ns between two scan outs
+	uint32_t                   PeakBuffers = 0; // Most buffers alive at once
+	double                     WallTime    = 0.0;
+};
+
+// Discrete event simulation of one app thread, one GPU queue and the compositor clock, driven entirely by MockSwapchainClock
+static bool RunSwapchainSim(const SwapchainSimSpec& spec, SwapchainSimResult& result)
+{
+	struct RenderEvent
+	{
+		uint64_t Time;
+		uint32_t ImageIndex;
+		uint64_t Value;
+	};
+
+	MockSwapchainClock    clock;
+	MockCompositor        compositor;
+	SwapchainStateMachine state;
+	compositor.State = &state;
+
+	SwapchainStateMachineSpec stateSpec {
+		.BufferCount = spec.BufferCount,
+		.PresentMode = spec.PresentMode,
+		.Compositor  = &compositor,
+		.Clock       = &clock
+	};
+	if (!state.Init(&stateSpec))
+	{
+		std::cout << std::format("Invalid swapchain state with {} buffers\n", spec.BufferCount);
+		return false;
+	}
+
+	RenderEvent renders[2 * c_SwapchainMaxBufferCount];
+	uint32_t    renderCount = 0;
+	uint64_t    gpuIdleAt   = 0;
+	uint64_t    nextVBlank  = spec.VBlankTime;
+	uint64_t    appReadyAt  = 0;
+	uint64_t    starvedAt   = ~0ULL;
+	uint64_t    frames      = 0;
+	uint64_t    nextResize  = spec.ResizeInterval ? spec.ResizeInterval : ~0ULL;
+	uint64_t    lastScanOut = ~0ULL;
+	uint64_t    resizedAt   = ~0ULL; // Frame the last resize was handled in
+	result.PeakBuffers      = spec.BufferCount;
+
+	auto start = Clock::now();
+	while (frames < spec.Frames)
+	{
+		// App runs whenever it is not blocked, a blocked app retries after every other event
+		uint64_t next = nextVBlank;
+		for (uint32_t i = 0; i < renderCount; ++i)
+			next = std::min(next, renders[i].Time);
+		if (starvedAt == ~0ULL)
+			next = std::min(next, appReadyAt);
+		clock.AdvanceTo(next);
+
+		// Events that came due while the app was busy are replayed in time order before it runs again
+		while (true)
+		{
+			uint64_t due = std::min(clock.Time, nextVBlank);
+			for (uint32_t i = 0; i < renderCount;)
+			{
+				if (renders[i].Time > due)
+				{
+					++i;
+					continue;
+				}
+				state.OnBufferRendered(renders[i].ImageIndex, renders[i].Value);
+				renders[i] = renders[--renderCount];
+			}
+			if (nextVBlank > clock.Time)
+				break;
+
+			uint64_t now = clock.Time;
+			clock.Time   = nextVBlank;
+			if (state.OnVBlank())
+			{
+				if (lastScanOut != ~0ULL)
+					result.MaxStall = std::max(result.MaxStall, nextVBlank - lastScanOut);
+				lastScanOut = nextVBlank;
+			}
+			clock.Time  = now;
+			nextVBlank += spec.VBlankTime;
+		}
+		if (appReadyAt > clock.Time)
+			continue;
+
+		// Resizes are coalesced, the app only looks at the window size once per frame
+		bool resized = false;
+		while (resizedAt != frames && nextResize <= clock.Time)
+		{
+			nextResize += spec.ResizeInterval;
+			resized     = true;
+		}
+		if (resized)
+		{
+			resizedAt = frames;
+			if (starvedAt != ~0ULL)
+			{
+				result.StarvedTime += clock.Time - starvedAt;
+				starvedAt           = ~0ULL;
+			}
+			state.Invalidate();
+			if (!spec.Staggered)
+			{
+				// Waits for the GPU, then creates every buffer while the old ones stay alive for the compositor
+				uint64_t stall      = std::max(clock.Time, gpuIdleAt) - clock.Time + spec.BufferCount * spec.RecreateTime;
+				result.ResizeTime  += stall;
+				result.PeakBuffers  = 2 * spec.BufferCount;
+				clock.Advance(stall);
+				for (uint32_t i = 0; i < spec.BufferCount; ++i)
+					state.OnBufferRecreated(i);
+				continue;
+			}
+		}
+
+		uint32_t imageIndex = 0;
+		uint64_t waitValue  = 0;
+		if (!state.Acquire(&imageIndex, &waitValue))
+		{
+			if (starvedAt == ~0ULL)
+				starvedAt = clock.Time;
+			continue;
+		}
+		if (starvedAt != ~0ULL)
+		{
+			result.StarvedTime += clock.Time - starvedAt;
+			starvedAt           = ~0ULL;
+		}
+		if (state.IsStale(imageIndex))
+		{
+			// Nothing renders to or scans out a stale buffer Acquire hands out, so it is replaced in place
+			result.ResizeTime += spec.RecreateTime;
+			clock.Advance(spec.RecreateTime);
+			state.OnBufferRecreated(imageIndex);
+		}
+
+		uint64_t renderValue = 0;
+		clock.Advance(spec.CPUTime);
+		if (!state.Present(imageIndex, true, &renderValue))
+		{
+			std::cout << std::format("Present of acquired buffer {} failed\n", imageIndex);
+			return false;
+		}
+
+		// A re-acquired Waiting buffer renders after its previous frame, which the serial GPU already guarantees
+		uint64_t renderStart = std::max(clock.Time, gpuIdleAt);
+		gpuIdleAt            = renderStart + spec.GPUTime;
+		if (renderCount >= sizeof(renders) / sizeof(*renders))
+		{
+			std::cout << "Too many renders in flight\n";
+			return false;
+		}
+		renders[renderCount++] = { gpuIdleAt, imageIndex, renderValue };
+		appReadyAt             = clock.Time;
+		++frames;
+	}
+	auto end = Clock::now();
+
+	result.Stats    = state.Stats();
+	result.SimTime  = clock.Time;
+	result.WallTime = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+	return true;
+}
+
+static void PrintSimResult(const SwapchainSimSpec& spec, const SwapchainSimResult& result)
+{
+	const auto& stats    = result.Stats;
+	double      simTime  = result.SimTime * 1e-9;
+	double      avgLat   = stats.ScanOuts ? stats.TotalLatency / (double) stats.ScanOuts * 1e-6 : 0.0;
+	double      dropRate = stats.Presents ? stats.MailboxDrops * 100.0 / (double) stats.Presents : 0.0;
+	double      idleRate = stats.VBlanks ? stats.IdleVBlanks * 100.0 / (double) stats.VBlanks : 0.0;
+	double      starved  = result.SimTime ? result.StarvedTime * 100.0 / (double) result.SimTime : 0.0;
+	double      overhead = result.WallTime * 1e9 / (double) spec.Frames;
+	std::cout << std::format("  {:<7} {} buffers{}: {:>7.2f} FPS shown, latency avg {:>7.3f} ms max {:>7.3f} ms, dropped {:>5.1f}%, idle VBlanks {:>5.1f}%, starved {:>5.1f}%, {:>7.1f} ns/frame\n",
+							 spec.PresentMode == SwapchainPresentMode::Mailbox ? "Mailbox" : "FIFO",
+							 spec.BufferCount,
+							 spec.ResizeInterval ? (spec.Staggered ? " staggered" : " blocking ") : "",
+							 stats.ScanOuts / simTime,
+							 avgLat,
+							 stats.MaxLatency * 1e-6,
+							 dropRate,
+							 idleRate,
+							 starved,
+							 overhead);
+	if (!spec.ResizeInterval)
+		return;
+
+	std::cout << std::format("          {} resizes, {} recreations, {:.3f} ms resizing, missed VBlanks {}, longest stall {:.3f} ms, peak buffers {}\n",
+							 stats.Invalidations,
+							 stats.Recreations,
+							 result.ResizeTime * 1e-6,
+							 stats.IdleVBlanks,
+							 result.MaxStall * 1e-6,
+							 result.PeakBuffers);
+}
+
+int SwapchainSim(size_t argc, const std::string_view* argv)
+{
+	SwapchainSimSpec spec {};
+	int64_t          bufferCount = 0;
+	int64_t          mode        = -1;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "SwapchainSim Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':     Shows this help info\n"
+						 "  '-b' | '--buffers':  Only simulate this buffer count, default simulates 2 to 4\n"
+						 "  '-m' | '--mode':     Only simulate 'fifo' or 'mailbox', default simulates both\n"
+						 "  '-f' | '--frames':   Set number of frames rendered per simulation, default 1000, minimum 1\n"
+						 "  '-r' | '--refresh':  Set compositor refresh rate in Hz, default 60, minimum 1\n"
+						 "  '-c' | '--cpu-time': Set CPU time per frame in us, default 1000\n"
+						 "  '-g' | '--gpu-time': Set GPU time per frame in us, default 8000\n"
+						 "  '-z' | '--resize':   Resize the window every this many us, simulates both staggered and blocking recreation\n"
+						 "  '-x' | '--recreate': Set time to recreate one buffer in us, default 2000\n";
+			return 0;
+		}
+		else if (argv[i] == "-b" || argv[i] == "--buffers")
+		{
+			if (++i >= argc)
+				break;
+			bufferCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (bufferCount < 2 || bufferCount > c_SwapchainMaxBufferCount)
+			{
+				std::cout << std::format("Number of buffers needs to be between 2 and {}!\n", c_SwapchainMaxBufferCount);
+				return 1;
+			}
+		}
+		else if (argv[i] == "-m" || argv[i] == "--mode")
+		{
+			if (++i >= argc)
+				break;
+			if (argv[i] == "fifo")
+			{
+				mode = (int64_t) SwapchainPresentMode::Fifo;
+			}
+			else if (argv[i] == "mailbox")
+			{
+				mode = (int64_t) SwapchainPresentMode::Mailbox;
+			}
+			else
+			{
+				std::cout << "Mode needs to be 'fifo' or 'mailbox'!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-f" || argv[i] == "--frames")
+		{
+			if (++i >= argc)
+				break;
+			int64_t frames = std::strtoll(argv[i].data(), nullptr, 10);
+			if (frames < 1)
+			{
+				std::cout << "Number of frames needs to be 1 or higher!\n";
+				return 1;
+			}
+			spec.Frames = (uint64_t) frames;
+		}
+		else if (argv[i] == "-r" || argv[i] == "--refresh")
+		{
+			if (++i >= argc)
+				break;
+			int64_t refresh = std::strtoll(argv[i].data(), nullptr, 10);
+			if (refresh < 1)
+			{
+				std::cout << "Refresh rate needs to be 1 or higher!\n";
+				return 1;
+			}
+			spec.VBlankTime = 1'000'000'000ULL / (uint64_t) refresh;
+		}
+		else if (argv[i] == "-c" || argv[i] == "--cpu-time")
+		{
+			if (++i >= argc)
+				break;
+			int64_t cpuTime = std::strtoll(argv[i].data(), nullptr, 10);
+			if (cpuTime < 0)
+			{
+				std::cout << "CPU time needs to be 0 or higher!\n";
+				return 1;
+			}
+			spec.CPUTime = (uint64_t) cpuTime * 1000;
+		}
+		else if (argv[i] == "-g" || argv[i] == "--gpu-time")
+		{
+			if (++i >= argc)
+				break;
+			int64_t gpuTime = std::strtoll(argv[i].data(), nullptr, 10);
+			if (gpuTime < 1)
+			{
+				std::cout << "GPU time needs to be 1 or higher!\n";
+				return 1;
+			}
+			spec.GPUTime = (uint64_t) gpuTime * 1000;
+		}
+		else if (argv[i] == "-z" || argv[i] == "--resize")
+		{
+			if (++i >= argc)
+				break;
+			int64_t resizeInterval = std::strtoll(argv[i].data(), nullptr, 10);
+			if (resizeInterval < 1)
+			{
+				std::cout << "Resize interval needs to be 1 or higher!\n";
+				return 1;
+			}
+			spec.ResizeInterval = (uint64_t) resizeInterval * 1000;
+		}
+		else if (argv[i] == "-x" || argv[i] == "--recreate")
+		{
+			if (++i >= argc)
+				break;
+			int64_t recreateTime = std::strtoll(argv[i].data(), nullptr, 10);
+			if (recreateTime < 0)
+			{
+				std::cout << "Recreate time needs to be 0 or higher!\n";
+				return 1;
+			}
+			spec.RecreateTime = (uint64_t) recreateTime * 1000;
+		}
+	}
+
+	std::cout << std::format("SwapchainSim, {} frames, VBlank {:.3f} ms, CPU {:.3f} ms, GPU {:.3f} ms\n", spec.Frames, spec.VBlankTime * 1e-6, spec.CPUTime * 1e-6, spec.GPUTime * 1e-6);
+	if (spec.ResizeInterval)
+		std::cout << std::format("Resize storm, every {:.3f} ms, {:.3f} ms per buffer recreation\n", spec.ResizeInterval * 1e-6, spec.RecreateTime * 1e-6);
+	int64_t firstBufferCount = bufferCount ? bufferCount : 2;
+	int64_t lastBufferCount  = bufferCount ? bufferCount : 4;
+	for (int64_t m = 0; m < 2; ++m)
+	{
+		if (mode >= 0 && m != mode)
+			continue;
+		spec.PresentMode = (SwapchainPresentMode) m;
+		for (int64_t b = firstBufferCount; b <= lastBufferCount; ++b)
+		{
+			spec.BufferCount = (uint32_t) b;
+			for (int64_t s = spec.ResizeInterval ? 0 : 1; s < 2; ++s)
+			{
+				spec.Staggered = s != 0;
+
+				SwapchainSimResult result {};
+				if (!RunSwapchainSim(spec, result))
+					return 1;
+				PrintSimResult(spec, result);
+			}
+		}
+	}
+	return 0;
+}
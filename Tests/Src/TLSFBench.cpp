@@ -0,0 +1,307 @@
+#include "Utils/TLSF.h"
+
+#include <cmath>
+#include <cstdlib>
+
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string_view>
+#include <vector>
+
+//
+// CPU only benchmark of the device memory sub-allocator.
+// Replays a GPU like workload, log uniform sizes from 256 B to 4 MiB with buffer and image alignments, against TLSF and a
+// best fit allocator built on ordered maps. The workload allocates until the pool is at the target occupancy, then frees
+// random allocations, so both end up running at a fragmented steady state.
+//
+
+using Clock = std::chrono::high_resolution_clock;
+
+static constexpr uint64_t c_MinAllocationSize = 256;
+static constexpr uint64_t c_MaxAllocationSize = 4ULL << 20;
+static constexpr uint64_t c_Alignments[]      = { 256, 4096, 65536 };
+static constexpr uint64_t c_Invalid           = ~0ULL;
+
+// Best fit over a size ordered map of free ranges, neighbours are found through the offset ordered map
+struct BestFitAllocator
+{
+public:
+	explicit BestFitAllocator(uint64_t size)
+	{
+		m_FreeByOffset.emplace(0, size);
+		m_FreeBySize.emplace(size, 0);
+	}
+
+	uint64_t Allocate(uint64_t size, uint64_t alignment)
+	{
+		size = (size + c_MinAllocationSize - 1) / c_MinAllocationSize * c_MinAllocationSize;
+		for (auto itr = m_FreeBySize.lower_bound(size); itr != m_FreeBySize.end(); ++itr)
+		{
+			uint64_t offset  = itr->second;
+			uint64_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+			if (aligned + size > offset + itr->first)
+				continue;
+			uint64_t end = offset + itr->first;
+			m_FreeBySize.erase(itr);
+			m_FreeByOffset.erase(offset);
+			if (aligned > offset)
+				InsertFree(offset, aligned - offset);
+			if (aligned + size < end)
+				InsertFree(aligned + size, end - aligned - size);
+			m_Used[aligned]  = size;
+			m_UsedSize      += size;
+			return aligned;
+		}
+		return c_Invalid;
+	}
+
+	void Free(uint64_t offset)
+	{
+		auto used = m_Used.find(offset);
+		if (used == m_Used.end())
+			return;
+		uint64_t size  = used->second;
+		m_UsedSize    -= size;
+		m_Used.erase(used);
+
+		auto next = m_FreeByOffset.lower_bound(offset);
+		if (next != m_FreeByOffset.begin())
+		{
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == offset)
+			{
+				offset  = prev->first;
+				size   += prev->second;
+				EraseFree(prev);
+			}
+		}
+		if (next != m_FreeByOffset.end() && next->first == offset + size)
+		{
+			size += next->second;
+			EraseFree(next);
+		}
+		InsertFree(offset, size);
+	}
+
+	uint64_t UsedSize() const { return m_UsedSize; }
+	uint64_t LargestFree() const { return m_FreeBySize.empty() ? 0 : m_FreeBySize.rbegin()->first; }
+
+private:
+	void InsertFree(uint64_t offset, uint64_t size)
+	{
+		m_FreeByOffset.emplace(offset, size);
+		m_FreeBySize.emplace(size, offset);
+	}
+
+	void EraseFree(std::map<uint64_t, uint64_t>::iterator itr)
+	{
+		auto [begin, end] = m_FreeBySize.equal_range(itr->second);
+		for (; begin != end; ++begin)
+		{
+			if (begin->second == itr->first)
+			{
+				m_FreeBySize.erase(begin);
+				break;
+			}
+		}
+		m_FreeByOffset.erase(itr);
+	}
+
+private:
+	std::map<uint64_t, uint64_t>      m_FreeByOffset;
+	std::multimap<uint64_t, uint64_t> m_FreeBySize;
+	std::map<uint64_t, uint64_t>      m_Used;
+	uint64_t                          m_UsedSize = 0;
+};
+
+struct TLSFBenchOp
+{
+	uint64_t Size;      // Zero frees Slot
+	uint64_t Alignment;
+	uint32_t Slot;
+};
+
+struct TLSFBenchResult
+{
+	double   Seconds     = 0.0;
+	uint64_t Failed      = 0;
+	uint64_t Used        = 0;
+	uint64_t LargestFree = 0;
+};
+
+// Both allocators replay the same operations, a slot freed while its allocation had failed is skipped by both
+static std::vector<TLSFBenchOp> BuildOps(uint64_t poolSize, int64_t opCount, double occupancy, uint32_t seed)
+{
+	std::mt19937_64                        rng(seed);
+	std::uniform_real_distribution<double> logSize(std::log2((double) c_MinAllocationSize), std::log2((double) c_MaxAllocationSize));
+	std::vector<TLSFBenchOp>               ops;
+	std::vector<uint32_t>                  live;
+	std::vector<uint64_t>                  sizes;
+	uint64_t                               used = 0;
+	ops.reserve((size_t) opCount);
+	for (int64_t i = 0; i < opCount; ++i)
+	{
+		if (live.empty() || used < (uint64_t) (poolSize * occupancy))
+		{
+			uint64_t size = (uint64_t) std::exp2(logSize(rng));
+			uint32_t slot = (uint32_t) sizes.size();
+			sizes.push_back(size);
+			live.push_back(slot);
+			used += size;
+			ops.push_back({ size, c_Alignments[rng() % std::size(c_Alignments)], slot });
+		}
+		else
+		{
+			size_t index = rng() % live.size();
+			used        -= sizes[live[index]];
+			ops.push_back({ 0, 0, live[index] });
+			live[index] = live.back();
+			live.pop_back();
+		}
+	}
+	return ops;
+}
+
+template <class Allocate, class Free>
+static TLSFBenchResult Replay(const std::vector<TLSFBenchOp>& ops, uint64_t invalid, Allocate&& allocate, Free&& free)
+{
+	TLSFBenchResult       result {};
+	std::vector<uint64_t> slots(ops.size(), invalid);
+
+	auto start = Clock::now();
+	for (auto& op : ops)
+	{
+		if (op.Size)
+		{
+			slots[op.Slot] = allocate(op.Size, op.Alignment);
+			if (slots[op.Slot] == invalid)
+				++result.Failed;
+		}
+		else if (slots[op.Slot] != invalid)
+		{
+			free(slots[op.Slot]);
+			slots[op.Slot] = invalid;
+		}
+	}
+	result.Seconds = std::chrono::duration_cast<std::chrono::duration<double>>(Clock::now() - start).count();
+	return result;
+}
+
+static void PrintResult(std::string_view name, const TLSFBenchResult& result, uint64_t poolSize, size_t opCount)
+{
+	uint64_t freeBytes     = poolSize - result.Used;
+	double   fragmentation = freeBytes ? 100.0 * (1.0 - (double) result.LargestFree / (double) freeBytes) : 0.0;
+	std::cout << std::format("  {:<10} {:>10.3f} ms {:>8.1f} ns/op {:>8} failed {:>6.1f}% used {:>6.1f}% fragmented\n",
+							 name,
+							 result.Seconds * 1e3,
+							 result.Seconds * 1e9 / (double) opCount,
+							 result.Failed,
+							 100.0 * (double) result.Used / (double) poolSize,
+							 fragmentation);
+}
+
+int TLSFBench(size_t argc, const std::string_view* argv)
+{
+	int64_t poolMiB   = 256;
+	int64_t opCount   = 1'000'000;
+	int64_t occupancy = 75;
+	int64_t seed      = 1;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "TLSFBench Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':      Shows this help info\n"
+						 "  '-p' | '--pool':      Set pool size in MiB, default 256, minimum 8\n"
+						 "  '-o' | '--ops':       Set number of allocations and frees to replay, default 1000000, minimum 1\n"
+						 "  '-u' | '--occupancy': Set percentage of the pool the workload keeps allocated, default 75, 1 to 100\n"
+						 "  '--seed' <seed>:      Set the workload seed, default 1\n";
+			return 0;
+		}
+		else if (argv[i] == "-p" || argv[i] == "--pool")
+		{
+			if (++i >= argc)
+				break;
+			poolMiB = std::strtoll(argv[i].data(), nullptr, 10);
+			if (poolMiB < 8)
+			{
+				std::cout << "Pool size needs to be 8 MiB or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-o" || argv[i] == "--ops")
+		{
+			if (++i >= argc)
+				break;
+			opCount = std::strtoll(argv[i].data(), nullptr, 10);
+			if (opCount < 1)
+			{
+				std::cout << "Number of operations needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-u" || argv[i] == "--occupancy")
+		{
+			if (++i >= argc)
+				break;
+			occupancy = std::strtoll(argv[i].data(), nullptr, 10);
+			if (occupancy < 1 || occupancy > 100)
+			{
+				std::cout << "Occupancy needs to be between 1 and 100!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--seed")
+		{
+			if (++i >= argc)
+				break;
+			seed = std::strtoll(argv[i].data(), nullptr, 10);
+		}
+	}
+
+	uint64_t poolSize = (uint64_t) poolMiB << 20;
+	auto     ops      = BuildOps(poolSize, opCount, occupancy / 100.0, (uint32_t) seed);
+
+	TLSFAllocator tlsf;
+	tlsf.Init(poolSize);
+	auto tlsfResult = Replay(
+		ops,
+		TLSFAllocator::c_InvalidNode,
+		[&](uint64_t size, uint64_t alignment) -> uint64_t { return tlsf.Allocate(size, alignment); },
+		[&](uint64_t node) { tlsf.Free((uint32_t) node); });
+	auto tlsfStats         = tlsf.GetStats();
+	tlsfResult.Used        = tlsfStats.Used;
+	tlsfResult.LargestFree = tlsfStats.LargestFree;
+
+	// Every allocation has to sit inside the pool without overlapping the one before it
+	bool     valid   = true;
+	uint64_t lastEnd = 0;
+	tlsf.ForEachAllocation([&](uint32_t node) {
+		valid   &= tlsf.Offset(node) >= lastEnd && tlsf.Offset(node) + tlsf.Size(node) <= poolSize;
+		lastEnd  = tlsf.Offset(node) + tlsf.Size(node);
+	});
+
+	BestFitAllocator bestFit(poolSize);
+	auto             bestFitResult = Replay(
+		ops,
+		c_Invalid,
+		[&](uint64_t size, uint64_t alignment) { return bestFit.Allocate(size, alignment); },
+		[&](uint64_t offset) { bestFit.Free(offset); });
+	bestFitResult.Used        = bestFit.UsedSize();
+	bestFitResult.LargestFree = bestFit.LargestFree();
+
+	std::cout << std::format("TLSFBench, {} MiB pool, {} ops at {}% occupancy\n", poolMiB, ops.size(), occupancy);
+	PrintResult("TLSF", tlsfResult, poolSize, ops.size());
+	PrintResult("Best fit", bestFitResult, poolSize, ops.size());
+	if (!valid)
+	{
+		std::cout << "TLSF handed out overlapping allocations\n";
+		return 1;
+	}
+	return 0;
+}
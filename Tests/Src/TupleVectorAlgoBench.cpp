@@ -0,0 +1,297 @@
+#include "Utils/Bench.h"
+#include "Utils/TupleVectorAlgorithms.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <execution>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using TupleVectorAlgo::c_TupleVectorParallelThreshold;
+
+// Key, tag, name and the row the entry started in, every column is derived from that origin so a torn row is detectable
+using CheckTable  = TupleVector<uint64_t, uint32_t, std::string, uint64_t>;
+// Key, tag and a scratch column for transform
+using TimingTable = TupleVector<uint64_t, uint32_t, uint64_t>;
+
+static constexpr size_t   c_MinTimingRows = c_TupleVectorParallelThreshold / 16;
+static constexpr size_t   c_MaxTimingRows = c_TupleVectorParallelThreshold * 16;
+static constexpr uint64_t c_KeyMultiplier = 0x9E37'79B9'7F4A'7C15ULL;
+
+// Roughly four rows per key so the sort has runs of equal keys to keep stable
+static uint64_t Key(uint64_t origin, uint64_t rows)
+{
+	return (origin * c_KeyMultiplier >> 17) % (rows / 4 + 1);
+}
+
+static uint32_t Tag(uint64_t origin)
+{
+	return (uint32_t) (origin * c_KeyMultiplier >> 40);
+}
+
+static void FillCheckTable(CheckTable& table, size_t rows)
+{
+	table.clear();
+	table.reserve(rows);
+	for (size_t i = 0; i < rows; ++i)
+		table.push_back(Key(i, rows), Tag(i), std::to_string(i), (uint64_t) i);
+}
+
+static void FillTimingTable(TimingTable& table, size_t rows)
+{
+	table.clear();
+	table.reserve(rows);
+	for (size_t i = 0; i < rows; ++i)
+		table.push_back(Key(i, rows), Tag(i), 0ULL);
+}
+
+// Every origin must appear exactly once and its row must still hold the columns it was created with
+static bool CheckRowsIntact(const CheckTable& table, std::string_view what)
+{
+	std::vector<bool> seen(table.size(), false);
+	for (size_t i = 0; i < table.size(); ++i)
+	{
+		uint64_t origin = table.entry<3>(i);
+		if (origin >= table.size() || seen[origin] ||
+			table.entry<0>(i) != Key(origin, table.size()) ||
+			table.entry<1>(i) != Tag(origin) ||
+			table.entry<2>(i) != std::to_string(origin))
+		{
+			std::cout << std::format("{} tore row {} of {}\n", what, i, table.size());
+			return false;
+		}
+		seen[origin] = true;
+	}
+	return true;
+}
+
+static bool CheckSort(size_t rows)
+{
+	CheckTable table;
+	FillCheckTable(table, rows);
+	TupleVectorAlgo::sort_by_column<0>(table);
+	if (!CheckRowsIntact(table, "sort_by_column"))
+		return false;
+	for (size_t i = 1; i < rows; ++i)
+	{
+		uint64_t prevKey = table.entry<0>(i - 1);
+		uint64_t key     = table.entry<0>(i);
+		if (prevKey > key || (prevKey == key && table.entry<3>(i - 1) > table.entry<3>(i)))
+		{
+			std::cout << std::format("sort_by_column is not a stable sort at row {} of {}\n", i, rows);
+			return false;
+		}
+	}
+
+	TupleVectorAlgo::sort_by_column<1>(table, std::greater<> {});
+	if (!CheckRowsIntact(table, "sort_by_column with comparator"))
+		return false;
+	for (size_t i = 1; i < rows; ++i)
+	{
+		if (table.entry<1>(i - 1) < table.entry<1>(i))
+		{
+			std::cout << std::format("sort_by_column ignored the comparator at row {} of {}\n", i, rows);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool CheckPermutation(size_t rows, uint32_t seed)
+{
+	CheckTable table;
+	FillCheckTable(table, rows);
+	std::vector<size_t> permutation(rows);
+	std::iota(permutation.begin(), permutation.end(), size_t { 0 });
+	std::shuffle(permutation.begin(), permutation.end(), std::mt19937_64(seed));
+	auto expected = permutation;
+
+	TupleVectorAlgo::apply_permutation(table, permutation);
+	if (!CheckRowsIntact(table, "apply_permutation"))
+		return false;
+	for (size_t i = 0; i < rows; ++i)
+	{
+		if (table.entry<3>(i) != expected[i])
+		{
+			std::cout << std::format("apply_permutation put row {} at {} instead of row {}\n", table.entry<3>(i), i, expected[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool CheckReduceFind(size_t rows)
+{
+	CheckTable table;
+	FillCheckTable(table, rows);
+
+	uint64_t keySum = 0;
+	uint64_t tagSum = 0;
+	uint32_t tagMax = 0;
+	for (size_t i = 0; i < rows; ++i)
+	{
+		keySum += table.entry<0>(i);
+		tagSum += table.entry<1>(i);
+		tagMax  = std::max(tagMax, table.entry<1>(i));
+	}
+	if (TupleVectorAlgo::reduce<0>(table, uint64_t { 0 }) != keySum ||
+		TupleVectorAlgo::reduce<1>(table, uint64_t { 0 }) != tagSum ||
+		TupleVectorAlgo::reduce<1>(table, uint32_t { 0 }, [](uint32_t lhs, uint32_t rhs) { return std::max(lhs, rhs); }) != tagMax)
+	{
+		std::cout << std::format("reduce disagrees with a serial loop over {} rows\n", rows);
+		return false;
+	}
+
+	// Keys repeat, find must return the first matching row rather than any match
+	for (size_t target : { rows / 2, rows - rows / 8, rows ? rows - 1 : 0 })
+	{
+		uint64_t key    = Key(target, rows);
+		size_t   serial = 0;
+		while (serial < rows && table.entry<0>(serial) != key)
+			++serial;
+		if (TupleVectorAlgo::find<0>(table, key) != serial)
+		{
+			std::cout << std::format("find returned a different row than a serial loop over {} rows\n", rows);
+			return false;
+		}
+	}
+	if (TupleVectorAlgo::find<0>(table, std::numeric_limits<uint64_t>::max()) != rows)
+	{
+		std::cout << std::format("find matched a missing key in {} rows\n", rows);
+		return false;
+	}
+
+	auto   pred   = [](uint32_t tag) { return tag % 61 == 60; };
+	size_t serial = 0;
+	while (serial < rows && !pred(table.entry<1>(serial)))
+		++serial;
+	if (TupleVectorAlgo::find_if<1>(table, pred) != serial)
+	{
+		std::cout << std::format("find_if returned a different row than a serial loop over {} rows\n", rows);
+		return false;
+	}
+	return true;
+}
+
+// Runs func with unseq and par_unseq on tables from a sixteenth to sixteen times the threshold.
+// Smaller tables run proportionally more iterations so every size processes the same number of rows
+template <class Func>
+static bool ComparePolicies(std::string_view name, int64_t iterations, Func&& func)
+{
+	std::cout << std::format("{}\n", name);
+	TimingTable table;
+	for (size_t rows = c_MinTimingRows; rows <= c_MaxTimingRows; rows *= 2)
+	{
+		FillTimingTable(table, rows);
+		int64_t scaled   = iterations * (int64_t) (c_MaxTimingRows / rows);
+		auto    unseq    = RunBench(scaled, [&]() { return func(std::execution::unseq, table); });
+		auto    parUnseq = RunBench(scaled, [&]() { return func(std::execution::par_unseq, table); });
+		if (unseq.Checksum != parUnseq.Checksum)
+		{
+			std::cout << std::format("{} produced different results with unseq and par_unseq over {} rows\n", name, rows);
+			return false;
+		}
+		double unseqNs    = unseq.Seconds * 1e9 / (double) (scaled * rows);
+		double parUnseqNs = parUnseq.Seconds * 1e9 / (double) (scaled * rows);
+		std::cout << std::format("  {:>8} rows {:>8.3f} ns/row unseq {:>8.3f} ns/row par_unseq {:>6.2f}x{}\n",
+								 rows,
+								 unseqNs,
+								 parUnseqNs,
+								 unseqNs / parUnseqNs,
+								 rows >= c_TupleVectorParallelThreshold ? " (dispatched par_unseq)" : "");
+	}
+	return true;
+}
+
+int TupleVectorAlgoBench(size_t argc, const std::string_view* argv)
+{
+	int64_t numRows       = 100'000;
+	int64_t numIterations = 10;
+	int64_t seed          = 1;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "TupleVectorAlgoBench Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':       Shows this help info\n"
+						 "  '-r' | '--rows':       Set number of rows in the largest correctness check, default 100000, minimum 1\n"
+						 "  '-i' | '--iterations': Set number of iterations at the largest timed table, default 10, minimum 1\n"
+						 "  '--seed' <seed>:       Set the apply_permutation shuffle seed, default 1\n";
+			return 0;
+		}
+		else if (argv[i] == "-r" || argv[i] == "--rows")
+		{
+			if (++i >= argc)
+				break;
+			numRows = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numRows < 1)
+			{
+				std::cout << "Number of rows needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-i" || argv[i] == "--iterations")
+		{
+			if (++i >= argc)
+				break;
+			numIterations = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numIterations < 1)
+			{
+				std::cout << "Number of iterations needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "--seed")
+		{
+			if (++i >= argc)
+				break;
+			seed = std::strtoll(argv[i].data(), nullptr, 10);
+		}
+	}
+
+	// Sizes straddle the threshold so both dispatch paths are checked
+	size_t checkRows[] = { 0, 1, 7, c_TupleVectorParallelThreshold - 1, c_TupleVectorParallelThreshold, c_TupleVectorParallelThreshold * 2 + 3, (size_t) numRows };
+	for (size_t rows : checkRows)
+	{
+		if (!CheckSort(rows) ||
+			!CheckPermutation(rows, (uint32_t) seed) ||
+			!CheckReduceFind(rows))
+			return 1;
+	}
+	std::cout << "TupleVector algorithms match serial results\n";
+
+	std::cout << std::format("TupleVector algorithms unseq versus par_unseq, threshold {} rows\n", c_TupleVectorParallelThreshold);
+	bool ok = ComparePolicies("reduce",
+							  numIterations,
+							  [](auto&& policy, const TimingTable& table) {
+								  auto* keys = table.column<0>();
+								  return std::reduce(policy, keys, keys + table.size(), uint64_t { 0 });
+							  }) &&
+			  ComparePolicies("transform",
+							  numIterations,
+							  [](auto&& policy, TimingTable& table) {
+								  auto* tags = table.column<1>();
+								  auto* out  = table.column<2>();
+								  std::transform(policy, tags, tags + table.size(), out, [](uint32_t tag) { return (uint64_t) tag * tag >> 3; });
+								  return out[0] + out[table.size() - 1];
+							  }) &&
+			  ComparePolicies("sort_permutation",
+							  numIterations,
+							  [](auto&& policy, const TimingTable& table) {
+								  auto*               keys = table.column<0>();
+								  std::vector<size_t> permutation(table.size());
+								  std::iota(permutation.begin(), permutation.end(), size_t { 0 });
+								  std::stable_sort(policy, permutation.begin(), permutation.end(), [keys](size_t lhs, size_t rhs) { return keys[lhs] < keys[rhs]; });
+								  return (uint64_t) (permutation[0] + permutation[table.size() / 2]);
+							  });
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+#include "Utils/Bench.h"
+#include "Utils/TupleVector.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Same layout as the VkSemaphore/value timeline tables built by the tests
+template <class Growth>
+using TimelineTable = BasicTupleVector<TupleVectorSpec<Growth>, void*, uint64_t>;
+
+static void PrintResult(std::string_view name, const BenchResult& result, int64_t iterations, int64_t rows)
+{
+	double perRow = result.Seconds * 1e9 / (double) (iterations * rows);
+	std::cout << std::format("  {:<28} {:>10.3f} ms {:>8.3f} ns/row (checksum {})\n", name, result.Seconds * 1e3, perRow, result.Checksum);
+}
+
+struct Odd3
+{
+	uint8_t Bytes[3];
+};
+
+// Odd sized column mixes, every column must start on max(alignof(T), Alignment)
+static_assert(Details::TupleVectorLayout<1, uint8_t, uint64_t>().Offset(1, 3) % alignof(uint64_t) == 0);
+static_assert(Details::TupleVectorLayout<32, uint8_t, Odd3, uint16_t, uint64_t>().Offset(1, 7) % 32 == 0);
+static_assert(Details::TupleVectorLayout<32, uint8_t, Odd3, uint16_t, uint64_t>().Offset(2, 7) % 32 == 0);
+static_assert(Details::TupleVectorLayout<32, uint8_t, Odd3, uint16_t, uint64_t>().Offset(3, 7) % 32 == 0);
+static_assert(Details::TupleVectorLayout<64, Odd3, uint8_t>().AllocationSize(5) == 64 + 5);
+
+template <size_t Alignment, class... Ts, size_t... Indices>
+static bool CheckColumnAlignment(const AlignedTupleVector<Alignment, Ts...>& table, std::index_sequence<Indices...>)
+{
+	return ((((uintptr_t) table.template column<Indices>()) % std::max<size_t>(Alignment, alignof(Ts)) == 0) && ...);
+}
+
+template <size_t Alignment, class... Ts>
+static bool CheckAlignment()
+{
+	AlignedTupleVector<Alignment, Ts...> table;
+	for (size_t i = 0; i < 67; ++i)
+	{
+		table.append_n(1);
+		if (!CheckColumnAlignment(table, std::index_sequence_for<Ts...> {}))
+		{
+			std::cout << std::format("Misaligned column with alignment {} at capacity {}\n", Alignment, table.capacity());
+			return false;
+		}
+	}
+	return true;
+}
+
+template <class Growth>
+static uint64_t PushBackRows(int64_t rows)
+{
+	TimelineTable<Growth> table;
+	for (int64_t i = 0; i < rows; ++i)
+		table.push_back(nullptr, (uint64_t) i);
+	return table.size() + table.capacity();
+}
+
+// Relocates every row per iteration, twice for reserve and shrink_to_fit, once each for insert and erase at the front
+template <class... Ts>
+static void RelocationBench(std::string_view name, int64_t iterations, int64_t rows)
+{
+	TupleVector<Ts...> table;
+	table.append_n((size_t) rows);
+	std::cout << std::format("{}\n", name);
+	PrintResult("reserve + shrink_to_fit",
+				RunBench(iterations,
+						 [&]() {
+							 table.reserve(table.capacity() * 2);
+							 table.shrink_to_fit();
+							 return (uint64_t) table.capacity();
+						 }),
+				iterations,
+				rows);
+	PrintResult("insert + erase front",
+				RunBench(iterations,
+						 [&]() {
+							 table.emplace(table.cbegin());
+							 table.erase(table.cbegin());
+							 return (uint64_t) table.size();
+						 }),
+				iterations,
+				rows);
+}
+
+int TupleVectorBench(size_t argc, const std::string_view* argv)
+{
+	int64_t numRows       = 4096;
+	int64_t numIterations = 100;
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i] == "-h" || argv[i] == "--help")
+		{
+			std::cout << "TupleVectorBench Help\n"
+						 "Options:\n"
+						 "  '-h' | '--help':       Shows this help info\n"
+						 "  '-r' | '--rows':       Set number of rows appended per iteration, default 4096, minimum 1\n"
+						 "  '-i' | '--iterations': Set number of iterations per benchmark, default 100, minimum 1\n";
+			return 0;
+		}
+		else if (argv[i] == "-r" || argv[i] == "--rows")
+		{
+			if (++i >= argc)
+				break;
+			numRows = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numRows < 1)
+			{
+				std::cout << "Number of rows needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+		else if (argv[i] == "-i" || argv[i] == "--iterations")
+		{
+			if (++i >= argc)
+				break;
+			numIterations = std::strtoll(argv[i].data(), nullptr, 10);
+			if (numIterations < 1)
+			{
+				std::cout << "Number of iterations needs to be 1 or higher!\n";
+				return 1;
+			}
+		}
+	}
+
+	if (!CheckAlignment<1, uint8_t, uint64_t, Odd3, uint16_t>() ||
+		!CheckAlignment<32, uint8_t, Odd3, uint64_t>() ||
+		!CheckAlignment<64, Odd3, uint8_t, uint16_t, uint32_t, uint64_t>())
+		return 1;
+
+	std::vector<std::tuple<void*, uint64_t>> source((size_t) numRows);
+	for (int64_t i = 0; i < numRows; ++i)
+		source[i] = { nullptr, (uint64_t) i };
+
+	std::cout << std::format("TupleVector append, {} rows x {} iterations\n", numRows, numIterations);
+	PrintResult("push_back (exact growth)", RunBench(numIterations, [=]() { return PushBackRows<TupleVectorGrowth::Exact>(numRows); }), numIterations, numRows);
+	PrintResult("push_back (1.5x growth)", RunBench(numIterations, [=]() { return PushBackRows<TupleVectorGrowth::OneAndHalf>(numRows); }), numIterations, numRows);
+	PrintResult("push_back (pow2 growth)", RunBench(numIterations, [=]() { return PushBackRows<TupleVectorGrowth::PowerOfTwo>(numRows); }), numIterations, numRows);
+	PrintResult("append_n",
+				RunBench(numIterations,
+						 [=]() {
+							 TupleVector<void*, uint64_t> table;
+							 table.append_n((size_t) numRows, nullptr, 0);
+							 return (uint64_t) (table.size() + table.capacity());
+						 }),
+				numIterations,
+				numRows);
+	PrintResult("append_range",
+				RunBench(numIterations,
+						 [&]() {
+							 TupleVector<void*, uint64_t> table;
+							 table.append_range(source.begin(), source.end());
+							 return (uint64_t) (table.size() + table.entry<1>(table.size() - 1));
+						 }),
+				numIterations,
+				numRows);
+
+	std::cout << "TupleVector relocation\n";
+	RelocationBench<void*, uint64_t>("Handles (trivially relocatable)", numIterations, numRows);
+	RelocationBench<uint8_t, Odd3, uint32_t>("Odd sized PODs (trivially relocatable)", numIterations, numRows);
+	RelocationBench<std::string, uint64_t>("Strings (element wise)", numIterations, numRows);
+	return 0;
+}
@@ -0,0 +1,42 @@
+#include "Allocators.h"
+
+// Replacing the global operator new and delete puts the standard library's allocations into g_AllocationStats as well.
+// The array and nothrow forms default to calling these, the aligned forms go through HeapAllocator which counts on its own
+
+void* operator new(size_t size)
+{
+	void* data = Memory::Malloc(size ? size : 1);
+	if (!data)
+		throw std::bad_alloc();
+	++g_AllocationStats.Allocations;
+	g_AllocationStats.Bytes += size;
+	return data;
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	return HeapAllocator {}.Allocate(size ? size : 1, (size_t) alignment);
+}
+
+void operator delete(void* data) noexcept
+{
+	if (!data)
+		return;
+	++g_AllocationStats.Frees;
+	Memory::Free(data);
+}
+
+void operator delete(void* data, [[maybe_unused]] size_t size) noexcept
+{
+	operator delete(data);
+}
+
+void operator delete(void* data, [[maybe_unused]] std::align_val_t alignment) noexcept
+{
+	HeapAllocator {}.Free(data);
+}
+
+void operator delete(void* data, [[maybe_unused]] size_t size, [[maybe_unused]] std::align_val_t alignment) noexcept
+{
+	HeapAllocator {}.Free(data);
+}
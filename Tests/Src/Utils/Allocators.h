@@ -0,0 +1,321 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+#include <Memory/Memory.h>
+
+// Counts every heap allocation, the allocators in this file and the global operator new in Allocators.cpp feed it.
+// Arenas and pools only show up when they grab new blocks
+struct AllocationStats
+{
+	std::atomic_uint64_t Allocations = 0;
+	std::atomic_uint64_t Frees       = 0;
+	std::atomic_uint64_t Bytes       = 0;
+};
+
+inline AllocationStats g_AllocationStats;
+
+namespace Details
+{
+	constexpr size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+} // namespace Details
+
+// Memory::Malloc backed allocator, aligns by over allocating and keeping the original pointer just before the returned block
+struct HeapAllocator
+{
+public:
+	void* Allocate(size_t size, size_t alignment)
+	{
+		alignment = std::max<size_t>(alignment, alignof(void*));
+		void* raw = Memory::Malloc(size + sizeof(void*) + alignment - 1);
+		if (!raw)
+			throw std::bad_alloc();
+		void* data          = (void*) Details::AlignUp((uintptr_t) raw + sizeof(void*), alignment);
+		((void**) data)[-1] = raw;
+		++g_AllocationStats.Allocations;
+		g_AllocationStats.Bytes += size;
+		return data;
+	}
+
+	void Free(void* data)
+	{
+		if (!data)
+			return;
+		++g_AllocationStats.Frees;
+		Memory::Free(((void**) data)[-1]);
+	}
+
+	bool operator==(const HeapAllocator&) const { return true; }
+};
+
+// Bump allocator for scratch memory that dies all at once.
+// Overflowing the current block chains a new one, the next Reset coalesces the chain so a steady workload stops allocating
+struct LinearArena
+{
+public:
+	static constexpr size_t c_DefaultBlockSize = 64 << 10;
+
+public:
+	explicit LinearArena(size_t blockSize = c_DefaultBlockSize);
+	LinearArena(const LinearArena&) = delete;
+	LinearArena(LinearArena&& move) noexcept;
+	~LinearArena();
+
+	LinearArena& operator=(const LinearArena&) = delete;
+	LinearArena& operator=(LinearArena&& move) noexcept;
+
+	void* Allocate(size_t size, size_t alignment);
+	template <class T>
+	requires(std::is_trivially_destructible_v<T>)
+	T* Allocate(size_t count)
+	{
+		return (T*) Allocate(sizeof(T) * count, alignof(T));
+	}
+	void Reset();
+
+	size_t   Used() const { return m_Used; }
+	size_t   Capacity() const { return m_Capacity; }
+	uint64_t BlockAllocations() const { return m_BlockAllocations; }
+
+private:
+	struct Block
+	{
+		Block* Next;
+		size_t Size;
+	};
+
+	void AddBlock(size_t minSize);
+	void FreeBlocks();
+
+private:
+	HeapAllocator m_Heap;
+	Block*        m_Blocks;
+	uint8_t*      m_Current;
+	uint8_t*      m_End;
+	size_t        m_BlockSize;
+	size_t        m_Used;
+	size_t        m_Capacity;
+	uint64_t      m_BlockAllocations;
+};
+
+// TupleVector allocator that bump allocates from a LinearArena, freeing is deferred to LinearArena::Reset
+struct ArenaAllocator
+{
+public:
+	ArenaAllocator() : Arena(nullptr) {}
+	ArenaAllocator(LinearArena* arena) : Arena(arena) {}
+
+	void* Allocate(size_t size, size_t alignment) { return Arena->Allocate(size, alignment); }
+	void  Free(void* data) { (void) data; }
+
+	bool operator==(const ArenaAllocator& other) const { return Arena == other.Arena; }
+
+public:
+	LinearArena* Arena;
+};
+
+// Free list of equally sized blocks carved out of larger pages, not thread safe
+struct FixedBlockPool
+{
+public:
+	FixedBlockPool(size_t blockSize, size_t blockAlignment = alignof(std::max_align_t), size_t blocksPerPage = 64);
+	FixedBlockPool(const FixedBlockPool&) = delete;
+	~FixedBlockPool();
+
+	FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+	void* Allocate();
+	void  Free(void* block);
+
+	size_t BlockSize() const { return m_BlockSize; }
+	size_t LiveBlocks() const { return m_LiveBlocks; }
+
+private:
+	struct Page
+	{
+		Page* Next;
+	};
+
+	void AddPage();
+
+private:
+	HeapAllocator m_Heap;
+	Page*         m_Pages;
+	void*         m_FreeList;
+	size_t        m_BlockSize;
+	size_t        m_BlockAlignment;
+	size_t        m_BlocksPerPage;
+	size_t        m_LiveBlocks;
+};
+
+inline LinearArena::LinearArena(size_t blockSize)
+	: m_Blocks(nullptr),
+	  m_Current(nullptr),
+	  m_End(nullptr),
+	  m_BlockSize(blockSize),
+	  m_Used(0),
+	  m_Capacity(0),
+	  m_BlockAllocations(0)
+{
+}
+
+inline LinearArena::LinearArena(LinearArena&& move) noexcept
+	: m_Blocks(move.m_Blocks),
+	  m_Current(move.m_Current),
+	  m_End(move.m_End),
+	  m_BlockSize(move.m_BlockSize),
+	  m_Used(move.m_Used),
+	  m_Capacity(move.m_Capacity),
+	  m_BlockAllocations(move.m_BlockAllocations)
+{
+	move.m_Blocks   = nullptr;
+	move.m_Current  = nullptr;
+	move.m_End      = nullptr;
+	move.m_Used     = 0;
+	move.m_Capacity = 0;
+}
+
+inline LinearArena::~LinearArena()
+{
+	FreeBlocks();
+}
+
+inline LinearArena& LinearArena::operator=(LinearArena&& move) noexcept
+{
+	FreeBlocks();
+	m_Blocks           = move.m_Blocks;
+	m_Current          = move.m_Current;
+	m_End              = move.m_End;
+	m_BlockSize        = move.m_BlockSize;
+	m_Used             = move.m_Used;
+	m_Capacity         = move.m_Capacity;
+	m_BlockAllocations = move.m_BlockAllocations;
+	move.m_Blocks      = nullptr;
+	move.m_Current     = nullptr;
+	move.m_End         = nullptr;
+	move.m_Used        = 0;
+	move.m_Capacity    = 0;
+	return *this;
+}
+
+inline void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+	uint8_t* ptr = (uint8_t*) Details::AlignUp((uintptr_t) m_Current, alignment);
+	if (!m_Current || ptr + size > m_End)
+	{
+		AddBlock(size + alignment);
+		ptr = (uint8_t*) Details::AlignUp((uintptr_t) m_Current, alignment);
+	}
+	m_Used    += (ptr + size) - m_Current;
+	m_Current  = ptr + size;
+	return ptr;
+}
+
+inline void LinearArena::Reset()
+{
+	if (!m_Blocks)
+		return;
+
+	if (m_Blocks->Next)
+	{
+		// Overflowed last time, replace the chain with one block big enough for all of it
+		size_t capacity = m_Capacity;
+		FreeBlocks();
+		m_BlockSize = std::max<size_t>(m_BlockSize, capacity);
+		AddBlock(m_BlockSize);
+	}
+	m_Current = (uint8_t*) (m_Blocks + 1);
+	m_End     = m_Current + m_Blocks->Size;
+	m_Used    = 0;
+}
+
+inline void LinearArena::AddBlock(size_t minSize)
+{
+	size_t size  = std::max<size_t>(m_BlockSize, minSize);
+	Block* block = (Block*) m_Heap.Allocate(sizeof(Block) + size, alignof(std::max_align_t));
+	block->Next  = m_Blocks;
+	block->Size  = size;
+	m_Blocks     = block;
+	m_Current    = (uint8_t*) (block + 1);
+	m_End        = m_Current + size;
+	m_Capacity  += size;
+	++m_BlockAllocations;
+}
+
+inline void LinearArena::FreeBlocks()
+{
+	while (m_Blocks)
+	{
+		Block* next = m_Blocks->Next;
+		m_Heap.Free(m_Blocks);
+		m_Blocks = next;
+	}
+	m_Current  = nullptr;
+	m_End      = nullptr;
+	m_Used     = 0;
+	m_Capacity = 0;
+}
+
+inline FixedBlockPool::FixedBlockPool(size_t blockSize, size_t blockAlignment, size_t blocksPerPage)
+	: m_Pages(nullptr),
+	  m_FreeList(nullptr),
+	  m_BlockAlignment(std::max<size_t>(blockAlignment, alignof(void*))),
+	  m_BlocksPerPage(std::max<size_t>(blocksPerPage, 1)),
+	  m_LiveBlocks(0)
+{
+	m_BlockSize = Details::AlignUp(std::max<size_t>(blockSize, sizeof(void*)), m_BlockAlignment);
+}
+
+inline FixedBlockPool::~FixedBlockPool()
+{
+	while (m_Pages)
+	{
+		Page* next = m_Pages->Next;
+		m_Heap.Free(m_Pages);
+		m_Pages = next;
+	}
+}
+
+inline void* FixedBlockPool::Allocate()
+{
+	if (!m_FreeList)
+		AddPage();
+	void* block = m_FreeList;
+	m_FreeList  = *(void**) block;
+	++m_LiveBlocks;
+	return block;
+}
+
+inline void FixedBlockPool::Free(void* block)
+{
+	if (!block)
+		return;
+	*(void**) block = m_FreeList;
+	m_FreeList      = block;
+	--m_LiveBlocks;
+}
+
+inline void FixedBlockPool::AddPage()
+{
+	size_t headerSize = Details::AlignUp(sizeof(Page), m_BlockAlignment);
+	Page*  page       = (Page*) m_Heap.Allocate(headerSize + m_BlockSize * m_BlocksPerPage, m_BlockAlignment);
+	page->Next        = m_Pages;
+	m_Pages           = page;
+
+	uint8_t* blocks = (uint8_t*) page + headerSize;
+	for (size_t i = m_BlocksPerPage; i-- > 0;)
+	{
+		void* block     = blocks + i * m_BlockSize;
+		*(void**) block = m_FreeList;
+		m_FreeList      = block;
+	}
+}
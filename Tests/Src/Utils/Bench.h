@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+#include <chrono>
+
+struct BenchResult
+{
+	double   Seconds  = 0.0;
+	uint64_t Checksum = 0;
+};
+
+// Calls func iterations times, summing what it returns into Checksum so the work can not be optimized away
+template <class Func>
+BenchResult RunBench(int64_t iterations, Func&& func)
+{
+	using Clock = std::chrono::high_resolution_clock;
+
+	BenchResult result {};
+	auto        start = Clock::now();
+	for (int64_t i = 0; i < iterations; ++i)
+		result.Checksum += func();
+	auto end       = Clock::now();
+	result.Seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+	return result;
+}
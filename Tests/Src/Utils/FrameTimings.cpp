@@ -0,0 +1,341 @@
+#include "FrameTimings.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+static constexpr const char* c_FrameTimingStageNames[c_FrameTimingStageCount] {
+	"Acquire",
+	"Record",
+	"Submit",
+	"Present",
+	"Wait",
+	"Frame"
+};
+
+const char* FrameTimingStageName(FrameTimingStage stage)
+{
+	return (size_t) stage < c_FrameTimingStageCount ? c_FrameTimingStageNames[(size_t) stage] : "Unknown";
+}
+
+void FrameTimingHistogram::Add(uint64_t value)
+{
+	++Count;
+	Sum += value;
+	Min  = std::min(Min, value);
+	Max  = std::max(Max, value);
+	++Buckets[BucketIndex(value)];
+}
+
+void FrameTimingHistogram::Clear()
+{
+	Count = 0;
+	Sum   = 0;
+	Min   = ~0ULL;
+	Max   = 0;
+	std::fill(std::begin(Buckets), std::end(Buckets), 0ULL);
+}
+
+uint64_t FrameTimingHistogram::Percentile(double p) const
+{
+	if (!Count)
+		return 0;
+
+	uint64_t rank = std::max<uint64_t>(1, (uint64_t) std::ceil(std::clamp(p, 0.0, 1.0) * (double) Count));
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < c_BucketCount; ++i)
+	{
+		seen += Buckets[i];
+		if (seen < rank)
+			continue;
+
+		uint64_t lower = BucketLowerBound(i);
+		uint64_t upper = i + 1 < c_BucketCount ? BucketLowerBound(i + 1) - 1 : ~0ULL;
+		return std::clamp(lower + (upper - lower) / 2, Min, Max);
+	}
+	return Max;
+}
+
+uint32_t FrameTimingHistogram::BucketIndex(uint64_t value)
+{
+	if (value < c_SubBucketCount)
+		return (uint32_t) value;
+
+	uint32_t exponent = 63 - (uint32_t) std::countl_zero(value);
+	uint32_t sub      = (uint32_t) (value >> (exponent - c_SubBucketBits)) & (c_SubBucketCount - 1);
+	return (exponent - c_SubBucketBits + 1) * c_SubBucketCount + sub;
+}
+
+uint64_t FrameTimingHistogram::BucketLowerBound(uint32_t index)
+{
+	if (index < c_SubBucketCount)
+		return index;
+
+	uint32_t exponent = index / c_SubBucketCount + c_SubBucketBits - 1;
+	uint64_t sub      = index % c_SubBucketCount;
+	return (c_SubBucketCount + sub) << (exponent - c_SubBucketBits);
+}
+
+uint64_t FrameTimings::Now()
+{
+	return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameTimings::FrameTimings()
+	: m_SwapchainCount(0),
+	  m_MaxRawSamples(0),
+	  m_ReportSwapchains(true),
+	  m_Dropped(0),
+	  m_TruncatedSamples(0)
+{
+}
+
+bool FrameTimings::Init(const FrameTimingsSpec* spec)
+{
+	if (!spec || !spec->SwapchainCount)
+		return false;
+
+	m_Name             = spec->Name;
+	m_Path             = spec->Path;
+	m_SwapchainCount   = spec->SwapchainCount;
+	m_MaxRawSamples    = spec->Path.empty() ? 0 : spec->MaxRawSamples;
+	m_ReportSwapchains = spec->ReportSwapchains;
+	m_Ring             = std::make_unique<SampleRing>();
+	m_Dropped.store(0, std::memory_order_relaxed);
+	m_Histograms.assign((m_SwapchainCount + 1) * c_FrameTimingStageCount, FrameTimingHistogram {});
+	m_Samples.clear();
+	m_Samples.reserve(std::min<size_t>(m_MaxRawSamples, 65536));
+	m_TruncatedSamples = 0;
+	m_GpuPasses.clear();
+	return true;
+}
+
+void FrameTimings::DeInit()
+{
+	m_Ring.reset();
+	m_Histograms.clear();
+	m_Histograms.shrink_to_fit();
+	m_Samples.clear();
+	m_Samples.shrink_to_fit();
+	m_GpuPasses.clear();
+	m_SwapchainCount = 0;
+}
+
+bool FrameTimings::Record(const FrameTimingSample& sample)
+{
+	if (!m_Ring || sample.Swapchain >= m_SwapchainCount)
+		return false;
+	if (!m_Ring->try_push(sample))
+	{
+		m_Dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+void FrameTimings::Collect()
+{
+	if (!m_Ring)
+		return;
+
+	FrameTimingSample sample;
+	while (m_Ring->try_pop(sample))
+	{
+		FrameTimingHistogram* histograms = &m_Histograms[sample.Swapchain * c_FrameTimingStageCount];
+		FrameTimingHistogram* totals     = &m_Histograms[m_SwapchainCount * c_FrameTimingStageCount];
+		for (size_t i = 0; i < c_FrameTimingStageCount; ++i)
+		{
+			if (!sample.Has((FrameTimingStage) i))
+				continue;
+			histograms[i].Add(sample.Durations[i]);
+			totals[i].Add(sample.Durations[i]);
+		}
+
+		if (m_Samples.size() < m_MaxRawSamples)
+			m_Samples.emplace_back(sample);
+		else if (m_MaxRawSamples)
+			++m_TruncatedSamples;
+	}
+}
+
+void FrameTimings::RecordGpu(uint32_t swapchain, std::string_view pass, uint64_t duration)
+{
+	if (!m_Ring || swapchain >= m_SwapchainCount)
+		return;
+
+	auto itr = std::find_if(m_GpuPasses.begin(), m_GpuPasses.end(), [pass](const GpuPass& gpuPass) { return gpuPass.Name == pass; });
+	if (itr == m_GpuPasses.end())
+		itr = m_GpuPasses.insert(m_GpuPasses.end(), GpuPass { std::string(pass), std::vector<FrameTimingHistogram>(m_SwapchainCount + 1) });
+	itr->Histograms[swapchain].Add(duration);
+	itr->Histograms[m_SwapchainCount].Add(duration);
+}
+
+const FrameTimingHistogram* FrameTimings::GpuHistogram(std::string_view pass) const
+{
+	for (auto& gpuPass : m_GpuPasses)
+	{
+		if (gpuPass.Name == pass)
+			return &gpuPass.Histograms[m_SwapchainCount];
+	}
+	return nullptr;
+}
+
+bool FrameTimings::Report()
+{
+	if (!m_Ring)
+		return false;
+	Collect();
+
+	auto printRow = [](std::string_view label, const FrameTimingHistogram& histogram) {
+		if (!histogram.Count)
+			return;
+		std::cout << std::format("  {:<12} {:>9} {:>11.2f} {:>11.2f} {:>11.2f} {:>11.2f} {:>11.2f}\n",
+								 label,
+								 histogram.Count,
+								 histogram.Mean() * 1e-3,
+								 histogram.Percentile(0.50) * 1e-3,
+								 histogram.Percentile(0.95) * 1e-3,
+								 histogram.Percentile(0.99) * 1e-3,
+								 histogram.Max * 1e-3);
+	};
+
+	std::cout << std::format("{} frame timings, {} swapchains, {} samples dropped\n", m_Name, m_SwapchainCount, Dropped());
+	std::cout << std::format("  {:<12} {:>9} {:>11} {:>11} {:>11} {:>11} {:>11}\n", "Stage (us)", "Count", "Mean", "p50", "p95", "p99", "Max");
+	for (size_t i = 0; i < c_FrameTimingStageCount; ++i)
+		printRow(FrameTimingStageName((FrameTimingStage) i), Histogram((FrameTimingStage) i));
+	for (auto& gpuPass : m_GpuPasses)
+		printRow(std::format("GPU {}", gpuPass.Name), gpuPass.Histograms[m_SwapchainCount]);
+	if (m_ReportSwapchains && m_SwapchainCount > 1)
+	{
+		for (uint32_t j = 0; j < m_SwapchainCount; ++j)
+		{
+			for (size_t i = 0; i < c_FrameTimingStageCount; ++i)
+				printRow(std::format("{} {}", FrameTimingStageName((FrameTimingStage) i), j), Histogram(j, (FrameTimingStage) i));
+			for (auto& gpuPass : m_GpuPasses)
+				printRow(std::format("GPU {} {}", gpuPass.Name, j), gpuPass.Histograms[j]);
+		}
+	}
+
+	if (m_Path.empty())
+		return true;
+	if (m_TruncatedSamples)
+		std::cout << std::format("Only the first {} samples were written to '{}.csv', {} more were left out\n", m_Samples.size(), m_Path, m_TruncatedSamples);
+	bool success = WriteCSV(m_Path + ".csv");
+	success      = WriteJSON(m_Path + ".json") && success;
+	return success;
+}
+
+std::string FrameTimings::Summary(uint32_t swapchain) const
+{
+	if (swapchain >= m_SwapchainCount)
+		return {};
+
+	auto& frame   = Histogram(swapchain, FrameTimingStage::Frame);
+	auto& present = Histogram(swapchain, FrameTimingStage::Present);
+	auto& wait    = Histogram(swapchain, FrameTimingStage::Wait);
+	return std::format("FrameTime p50 {:.4} us p99 {:.4} us max {:.4} us, FPS {:.5}, PresentTime p50 {:.4} us p99 {:.4} us, WaitTime p50 {:.4} us p99 {:.4} us",
+					   frame.Percentile(0.50) * 1e-3,
+					   frame.Percentile(0.99) * 1e-3,
+					   frame.Count ? frame.Max * 1e-3 : 0.0,
+					   frame.Count ? 1e9 / frame.Mean() : 0.0,
+					   present.Percentile(0.50) * 1e-3,
+					   present.Percentile(0.99) * 1e-3,
+					   wait.Percentile(0.50) * 1e-3,
+					   wait.Percentile(0.99) * 1e-3);
+}
+
+bool FrameTimings::WriteCSV(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cout << std::format("Failed to open '{}' for writing\n", path);
+		return false;
+	}
+
+	file << "Frame,Swapchain";
+	for (size_t i = 0; i < c_FrameTimingStageCount; ++i)
+		file << ',' << FrameTimingStageName((FrameTimingStage) i) << "Ns";
+	file << '\n';
+	for (auto& sample : m_Samples)
+	{
+		file << sample.Frame << ',' << sample.Swapchain;
+		for (size_t i = 0; i < c_FrameTimingStageCount; ++i)
+		{
+			file << ',';
+			if (sample.Has((FrameTimingStage) i))
+				file << sample.Durations[i];
+		}
+		file << '\n';
+	}
+	return (bool) file;
+}
+
+bool FrameTimings::WriteJSON(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file)
+	{
+		std::cout << std::format("Failed to open '{}' for writing\n", path);
+		return false;
+	}
+
+	auto writeHistogram = [&](std::string_view indent, std::string_view name, const FrameTimingHistogram& histogram) {
+		file << std::format("{}\t\"{}\": {{ \"Count\": {}, \"Mean\": {:.1f}, \"P50\": {}, \"P95\": {}, \"P99\": {}, \"Min\": {}, \"Max\": {} }}",
+							indent,
+							name,
+							histogram.Count,
+							histogram.Mean(),
+							histogram.Percentile(0.50),
+							histogram.Percentile(0.95),
+							histogram.Percentile(0.99),
+							histogram.Min,
+							histogram.Max);
+	};
+	auto writeStages = [&](std::string_view indent, const FrameTimingHistogram* histograms) {
+		file << "{\n";
+		bool first = true;
+		for (size_t i = 0; i < c_FrameTimingStageCount; ++i)
+		{
+			auto& histogram = histograms[i];
+			if (!histogram.Count)
+				continue;
+			if (!first)
+				file << ",\n";
+			first = false;
+			writeHistogram(indent, FrameTimingStageName((FrameTimingStage) i), histogram);
+		}
+		file << std::format("\n{}}}", indent);
+	};
+
+	file << "{\n";
+	file << std::format("\t\"Name\": \"{}\",\n", m_Name);
+	file << "\t\"Units\": \"ns\",\n";
+	file << std::format("\t\"SwapchainCount\": {},\n", m_SwapchainCount);
+	file << std::format("\t\"Dropped\": {},\n", Dropped());
+	file << "\t\"All\": ";
+	writeStages("\t", &m_Histograms[m_SwapchainCount * c_FrameTimingStageCount]);
+	if (!m_GpuPasses.empty())
+	{
+		file << ",\n\t\"Gpu\": {\n";
+		for (size_t i = 0; i < m_GpuPasses.size(); ++i)
+		{
+			writeHistogram("\t", m_GpuPasses[i].Name, m_GpuPasses[i].Histograms[m_SwapchainCount]);
+			file << (i + 1 < m_GpuPasses.size() ? ",\n" : "\n");
+		}
+		file << "\t}";
+	}
+	file << ",\n\t\"Swapchains\": [\n";
+	for (uint32_t j = 0; j < m_SwapchainCount; ++j)
+	{
+		file << "\t\t";
+		writeStages("\t\t", &m_Histograms[j * c_FrameTimingStageCount]);
+		file << (j + 1 < m_SwapchainCount ? ",\n" : "\n");
+	}
+	file << "\t]\n}\n";
+	return (bool) file;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "Ring.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// Per frame, per swapchain timing samples.
+// Render threads Record samples into a lock free ring, the main thread Collects them once per frame into histograms.
+// GPU pass durations resolved from timestamp queries are added on the main thread and reported next to the CPU stages.
+// Report prints p50/p95/p99/max for every stage and optionally writes the raw samples as CSV and the summary as JSON.
+//
+
+enum class FrameTimingStage : uint8_t
+{
+	Acquire, // Acquiring the next swapchain image
+	Record,  // Resetting the pool and recording the command buffer
+	Submit,  // vkQueueSubmit2
+	Present, // Presenting, including any copies the present path needs
+	Wait,    // Waiting for the frame in flight to finish, shared by every swapchain rendered in that frame
+	Frame,   // Time since the previous frame started
+	Count
+};
+
+static constexpr size_t c_FrameTimingStageCount = (size_t) FrameTimingStage::Count;
+
+const char* FrameTimingStageName(FrameTimingStage stage);
+
+// Durations are in nanoseconds, stages that were not measured are left out of the histograms
+struct FrameTimingSample
+{
+public:
+	void Set(FrameTimingStage stage, uint64_t duration)
+	{
+		Durations[(size_t) stage]  = duration;
+		Stages                    |= 1U << (uint32_t) stage;
+	}
+
+	bool Has(FrameTimingStage stage) const { return Stages & (1U << (uint32_t) stage); }
+
+public:
+	uint64_t Frame                              = 0;
+	uint32_t Swapchain                          = 0;
+	uint32_t Stages                             = 0;
+	uint64_t Durations[c_FrameTimingStageCount] = {};
+};
+
+// Log linear histogram, values below 2^c_SubBucketBits are exact, larger values land in one of 2^c_SubBucketBits buckets per power of two (~3% error).
+// Count, Sum, Min and Max are exact
+struct FrameTimingHistogram
+{
+public:
+	static constexpr uint32_t c_SubBucketBits  = 5;
+	static constexpr uint32_t c_SubBucketCount = 1U << c_SubBucketBits;
+	static constexpr uint32_t c_BucketCount    = (64 - c_SubBucketBits + 1) * c_SubBucketCount;
+
+public:
+	void Add(uint64_t value);
+	void Clear();
+
+	// p in [0, 1], returns the midpoint of the bucket holding the p-th value, clamped to [Min, Max]
+	uint64_t Percentile(double p) const;
+	double   Mean() const { return Count ? (double) Sum / (double) Count : 0.0; }
+
+	static uint32_t BucketIndex(uint64_t value);
+	static uint64_t BucketLowerBound(uint32_t index);
+
+public:
+	uint64_t Count = 0;
+	uint64_t Sum   = 0;
+	uint64_t Min   = ~0ULL;
+	uint64_t Max   = 0;
+	uint64_t Buckets[c_BucketCount] {};
+};
+
+struct FrameTimingsSpec
+{
+	std::string_view Name;                          // Shown in the report
+	uint32_t         SwapchainCount   = 1;
+	std::string      Path;                          // Writes <Path>.csv and <Path>.json in Report when not empty
+	size_t           MaxRawSamples    = 1ULL << 20; // Raw samples kept for the CSV, histograms keep counting past it
+	bool             ReportSwapchains = true;       // Print every swapchain in Report, not just the combined table
+};
+
+struct FrameTimings
+{
+public:
+	static constexpr size_t c_RingCapacity = 4096;
+
+	using SampleRing = MPSCRing<FrameTimingSample, c_RingCapacity>;
+
+public:
+	static uint64_t Now();
+
+	FrameTimings();
+	FrameTimings(const FrameTimings&) = delete;
+
+	FrameTimings& operator=(const FrameTimings&) = delete;
+
+	bool Init(const FrameTimingsSpec* spec);
+	void DeInit();
+
+	// Any thread, never blocks or allocates. A full ring drops the sample and counts it
+	bool Record(const FrameTimingSample& sample);
+	// Main thread only, drains the ring into the histograms
+	void Collect();
+	// Main thread only, adds the GPU duration of a pass, passes are matched by name
+	void RecordGpu(uint32_t swapchain, std::string_view pass, uint64_t duration);
+	// Main thread only, collects the remaining samples, prints the summary and writes the CSV and JSON files
+	bool Report();
+
+	// One line of frame, present and wait percentiles for window titles
+	std::string Summary(uint32_t swapchain) const;
+
+	const FrameTimingHistogram& Histogram(uint32_t swapchain, FrameTimingStage stage) const { return m_Histograms[swapchain * c_FrameTimingStageCount + (size_t) stage]; }
+	// Histogram over every swapchain
+	const FrameTimingHistogram& Histogram(FrameTimingStage stage) const { return m_Histograms[m_SwapchainCount * c_FrameTimingStageCount + (size_t) stage]; }
+
+	// Histogram of a GPU pass over every swapchain, nullptr if the pass was never recorded
+	const FrameTimingHistogram* GpuHistogram(std::string_view pass) const;
+
+	uint32_t SwapchainCount() const { return m_SwapchainCount; }
+	uint64_t Dropped() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+private:
+	struct GpuPass
+	{
+		std::string                       Name;
+		std::vector<FrameTimingHistogram> Histograms; // SwapchainCount + 1, the last one covers every swapchain
+	};
+
+	bool WriteCSV(const std::string& path) const;
+	bool WriteJSON(const std::string& path) const;
+
+private:
+	std::string m_Name;
+	std::string m_Path;
+	uint32_t    m_SwapchainCount;
+	size_t      m_MaxRawSamples;
+	bool        m_ReportSwapchains;
+
+	std::unique_ptr<SampleRing>       m_Ring;
+	std::atomic_uint64_t              m_Dropped;
+	std::vector<FrameTimingHistogram> m_Histograms; // SwapchainCount + 1 rows of c_FrameTimingStageCount, the last row covers every swapchain
+	std::vector<FrameTimingSample>    m_Samples;
+	uint64_t                          m_TruncatedSamples;
+	std::vector<GpuPass>              m_GpuPasses;
+};
@@ -0,0 +1,152 @@
+#include "JobPool.h"
+
+JobPool::JobPool()
+	: m_Func(nullptr),
+	  m_UserData(nullptr),
+	  m_Remaining(0),
+	  m_Generation(0),
+	  m_Stop(false),
+	  m_Steals(0)
+{
+}
+
+JobPool::~JobPool()
+{
+	DeInit();
+}
+
+bool JobPool::Init(uint32_t workerCount)
+{
+	if (!workerCount || !m_Workers.empty())
+		return false;
+
+	m_Stop.store(false, std::memory_order_relaxed);
+	m_Steals.store(0, std::memory_order_relaxed);
+	m_Workers.reserve(workerCount);
+	for (uint32_t i = 0; i < workerCount; ++i)
+		m_Workers.emplace_back(std::make_unique<Worker>());
+	for (uint32_t i = 1; i < workerCount; ++i)
+		m_Workers[i]->Thread = std::thread(&JobPool::WorkerFunc, this, i);
+	return true;
+}
+
+void JobPool::DeInit()
+{
+	if (m_Workers.empty())
+		return;
+
+	m_Stop.store(true, std::memory_order_relaxed);
+	m_Generation.fetch_add(1, std::memory_order_release);
+	m_Generation.notify_all();
+	for (auto& worker : m_Workers)
+	{
+		if (worker->Thread.joinable())
+			worker->Thread.join();
+	}
+	m_Workers.clear();
+}
+
+void JobPool::Dispatch(uint32_t count, JobFunc func, void* userData)
+{
+	if (!count || !func)
+		return;
+	if (m_Workers.empty())
+	{
+		for (uint32_t i = 0; i < count; ++i)
+			func(userData, i, 0);
+		return;
+	}
+
+	// Every range is empty here, so no worker looks at m_Func until the ranges below are published
+	m_Func     = func;
+	m_UserData = userData;
+	m_Remaining.store(count, std::memory_order_relaxed);
+
+	uint32_t workerCount = (uint32_t) m_Workers.size();
+	uint32_t begin       = 0;
+	for (uint32_t i = 0; i < workerCount; ++i)
+	{
+		uint32_t end = (uint32_t) ((uint64_t) count * (i + 1) / workerCount);
+		m_Workers[i]->Range.store(PackRange(begin, end), std::memory_order_release);
+		begin = end;
+	}
+	m_Generation.fetch_add(1, std::memory_order_release);
+	m_Generation.notify_all();
+
+	RunJobs(0);
+	uint32_t remaining = m_Remaining.load(std::memory_order_acquire);
+	while (remaining)
+	{
+		m_Remaining.wait(remaining, std::memory_order_acquire);
+		remaining = m_Remaining.load(std::memory_order_acquire);
+	}
+}
+
+void JobPool::WorkerFunc(uint32_t worker)
+{
+	uint64_t generation = 0;
+	while (true)
+	{
+		m_Generation.wait(generation, std::memory_order_acquire);
+		generation = m_Generation.load(std::memory_order_acquire);
+		if (m_Stop.load(std::memory_order_relaxed))
+			break;
+		RunJobs(worker);
+	}
+}
+
+void JobPool::RunJobs(uint32_t worker)
+{
+	uint32_t index = 0;
+	while (TakeJob(worker, index) || StealJob(worker, index))
+	{
+		m_Func(m_UserData, index, worker);
+		if (m_Remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			m_Remaining.notify_all();
+	}
+}
+
+bool JobPool::TakeJob(uint32_t worker, uint32_t& index)
+{
+	auto&    range = m_Workers[worker]->Range;
+	uint64_t value = range.load(std::memory_order_acquire);
+	while (true)
+	{
+		uint32_t begin = (uint32_t) value;
+		uint32_t end   = (uint32_t) (value >> 32);
+		if (begin >= end)
+			return false;
+		if (range.compare_exchange_weak(value, PackRange(begin + 1, end), std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			index = begin;
+			return true;
+		}
+	}
+}
+
+bool JobPool::StealJob(uint32_t worker, uint32_t& index)
+{
+	uint32_t workerCount = (uint32_t) m_Workers.size();
+	for (uint32_t i = 1; i < workerCount; ++i)
+	{
+		auto&    range = m_Workers[(worker + i) % workerCount]->Range;
+		uint64_t value = range.load(std::memory_order_acquire);
+		while (true)
+		{
+			uint32_t begin = (uint32_t) value;
+			uint32_t end   = (uint32_t) (value >> 32);
+			if (begin >= end)
+				break;
+
+			// Take the last index, the victim keeps working from the front. Thieves never write their own range, so a late
+			// thief from the previous Dispatch can only ever claim a real job of the current one
+			if (!range.compare_exchange_weak(value, PackRange(begin, end - 1), std::memory_order_acq_rel, std::memory_order_acquire))
+				continue;
+
+			m_Steals.fetch_add(1, std::memory_order_relaxed);
+			index = end - 1;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Ring.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//
+// Fixed set of worker threads running parallel for loops.
+// Dispatch splits the index range evenly over the workers, every worker takes indices from the front of its own range
+// and once it runs dry steals indices from the back of the other workers' ranges. Ranges are a packed begin/end pair
+// changed with a single compare exchange, so neither taking nor stealing ever locks.
+// The thread calling Dispatch works as worker 0, jobs always see the index of the worker running them so per worker
+// resources (command pools, scratch memory) need no synchronization.
+//
+
+struct JobPool
+{
+public:
+	using JobFunc = void (*)(void* userData, uint32_t index, uint32_t worker);
+
+public:
+	JobPool();
+	JobPool(const JobPool&) = delete;
+	~JobPool();
+
+	JobPool& operator=(const JobPool&) = delete;
+
+	// workerCount includes the thread calling Dispatch
+	bool Init(uint32_t workerCount);
+	void DeInit();
+
+	// Runs func for every index in [0, count), returns once all of them finished. Only one thread may Dispatch at a time
+	void Dispatch(uint32_t count, JobFunc func, void* userData);
+	template <class F>
+	void Dispatch(uint32_t count, F&& func)
+	{
+		Dispatch(
+			count,
+			[](void* userData, uint32_t index, uint32_t worker) {
+				(*(std::remove_reference_t<F>*) userData)(index, worker);
+			},
+			(void*) &func);
+	}
+
+	uint32_t WorkerCount() const { return (uint32_t) m_Workers.size(); }
+	uint64_t Steals() const { return m_Steals.load(std::memory_order_relaxed); }
+
+private:
+	struct alignas(Details::c_CacheLineSize) Worker
+	{
+		std::atomic_uint64_t Range { 0 }; // begin in the low 32 bits, end in the high 32 bits
+		std::thread          Thread;
+	};
+
+	static uint64_t PackRange(uint32_t begin, uint32_t end) { return (uint64_t) end << 32 | begin; }
+
+	void WorkerFunc(uint32_t worker);
+	void RunJobs(uint32_t worker);
+	bool TakeJob(uint32_t worker, uint32_t& index);
+	bool StealJob(uint32_t worker, uint32_t& index);
+
+private:
+	std::vector<std::unique_ptr<Worker>> m_Workers;
+
+	JobFunc m_Func;
+	void*   m_UserData;
+
+	alignas(Details::c_CacheLineSize) std::atomic_uint32_t m_Remaining;
+	alignas(Details::c_CacheLineSize) std::atomic_uint64_t m_Generation;
+	std::atomic_bool     m_Stop;
+	std::atomic_uint64_t m_Steals;
+};
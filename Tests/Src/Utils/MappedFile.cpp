@@ -0,0 +1,133 @@
+#include <Build.h>
+
+#include "MappedFile.h"
+
+#include <string>
+
+#if BUILD_IS_SYSTEM_WINDOWS
+	#include <Windows.h>
+
+	#include <UTF/UTF.h>
+#else
+	#include <cerrno>
+
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#if BUILD_IS_SYSTEM_WINDOWS
+MappedFile MapFileReadOnly(std::string_view path)
+{
+	MappedFile mapped {};
+	auto       pathW = UTF::Convert<wchar_t, char>(path);
+	HANDLE     file  = CreateFileW(pathW.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return mapped;
+
+	// The view keeps the mapping alive, so both handles can go right away
+	LARGE_INTEGER fileSize {};
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+		{
+			mapped.Data = (const uint8_t*) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			mapped.Size = mapped.Data ? (size_t) fileSize.QuadPart : 0;
+			CloseHandle(mapping);
+		}
+	}
+	CloseHandle(file);
+	return mapped;
+}
+
+void UnmapFile(MappedFile& file)
+{
+	if (file.Data)
+		UnmapViewOfFile(file.Data);
+	file = {};
+}
+
+bool WriteFileAtomic(std::string_view path, const void* data, size_t size)
+{
+	auto   pathW = UTF::Convert<wchar_t, char>(path);
+	auto   tempW = pathW + L".tmp";
+	HANDLE file  = CreateFileW(tempW.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	DWORD written  = 0;
+	bool  complete = WriteFile(file, data, (DWORD) size, &written, nullptr) && written == size && FlushFileBuffers(file);
+	CloseHandle(file);
+	if (!complete || !MoveFileExW(tempW.c_str(), pathW.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		DeleteFileW(tempW.c_str());
+		return false;
+	}
+	return true;
+}
+#else
+MappedFile MapFileReadOnly(std::string_view path)
+{
+	MappedFile mapped {};
+	int        file = open(std::string(path).c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		return mapped;
+
+	// The mapping outlives the descriptor
+	struct stat info {};
+	if (fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		void* view = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (view != MAP_FAILED)
+		{
+			mapped.Data = (const uint8_t*) view;
+			mapped.Size = (size_t) info.st_size;
+		}
+	}
+	close(file);
+	return mapped;
+}
+
+void UnmapFile(MappedFile& file)
+{
+	if (file.Data)
+		munmap((void*) file.Data, file.Size);
+	file = {};
+}
+
+bool WriteFileAtomic(std::string_view path, const void* data, size_t size)
+{
+	std::string target(path);
+	std::string temp = target + ".tmp";
+	int         file = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (file < 0)
+		return false;
+
+	// write may return short counts, keep going until everything is out or it fails
+	const uint8_t* bytes    = (const uint8_t*) data;
+	size_t         left     = size;
+	bool           complete = true;
+	while (left)
+	{
+		ssize_t written = write(file, bytes, left);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			complete = false;
+			break;
+		}
+		bytes += written;
+		left  -= (size_t) written;
+	}
+	complete = complete && fsync(file) == 0;
+	complete = close(file) == 0 && complete;
+	if (!complete || rename(temp.c_str(), target.c_str()) != 0)
+	{
+		unlink(temp.c_str());
+		return false;
+	}
+	return true;
+}
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string_view>
+
+//
+// Read only file mapping and atomic file replacement, the only file system code the Vk layer needs.
+// Windows goes through CreateFileMappingW and MoveFileExW, everything else through mmap and rename.
+//
+
+// View of a whole file, Data is null when the file is missing, empty or could not be mapped
+struct MappedFile
+{
+	const uint8_t* Data = nullptr;
+	size_t         Size = 0;
+};
+
+MappedFile MapFileReadOnly(std::string_view path);
+void       UnmapFile(MappedFile& file);
+// Writes data to path + ".tmp", flushes it and renames it over path, so readers only ever see the old or the new contents
+bool       WriteFileAtomic(std::string_view path, const void* data, size_t size);
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <bit>
+#include <type_traits>
+
+// Lock free queues for handing small values (buffer indices, handles) between threads.
+// None of them ever block or allocate, a full ring simply refuses the push
+namespace Details
+{
+	static constexpr size_t c_CacheLineSize = 64;
+} // namespace Details
+
+// Bounded single producer single consumer FIFO
+template <class T, size_t Capacity>
+requires(std::is_trivially_copyable_v<T> && std::has_single_bit(Capacity))
+struct SPSCRing
+{
+public:
+	static constexpr size_t c_Mask = Capacity - 1;
+
+public:
+	SPSCRing() : m_Head(0), m_CachedTail(0), m_Tail(0), m_CachedHead(0) {}
+	SPSCRing(const SPSCRing&) = delete;
+
+	SPSCRing& operator=(const SPSCRing&) = delete;
+
+	// Producer only
+	bool try_push(const T& value)
+	{
+		size_t tail = m_Tail.load(std::memory_order_relaxed);
+		if (tail - m_CachedHead == Capacity)
+		{
+			m_CachedHead = m_Head.load(std::memory_order_acquire);
+			if (tail - m_CachedHead == Capacity)
+				return false;
+		}
+		m_Values[tail & c_Mask] = value;
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only
+	bool try_pop(T& value)
+	{
+		size_t head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_CachedTail)
+		{
+			m_CachedTail = m_Tail.load(std::memory_order_acquire);
+			if (head == m_CachedTail)
+				return false;
+		}
+		value = m_Values[head & c_Mask];
+		m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only
+	void clear()
+	{
+		m_Head.store(m_Tail.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	bool   empty() const { return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+	size_t size() const { return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); }
+
+	static constexpr size_t capacity() { return Capacity; }
+
+private:
+	alignas(Details::c_CacheLineSize) std::atomic_size_t m_Head;
+	size_t m_CachedTail;
+	alignas(Details::c_CacheLineSize) std::atomic_size_t m_Tail;
+	size_t m_CachedHead;
+	alignas(Details::c_CacheLineSize) T m_Values[Capacity];
+};
+
+// Bounded multiple producer single consumer FIFO, every cell carries a sequence number so producers only contend on the tail counter
+template <class T, size_t Capacity>
+requires(std::is_trivially_copyable_v<T> && std::has_single_bit(Capacity) && Capacity >= 2)
+struct MPSCRing
+{
+public:
+	static constexpr size_t c_Mask = Capacity - 1;
+
+public:
+	MPSCRing() : m_Tail(0), m_Head(0)
+	{
+		for (size_t i = 0; i < Capacity; ++i)
+			m_Cells[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+	MPSCRing(const MPSCRing&) = delete;
+
+	MPSCRing& operator=(const MPSCRing&) = delete;
+
+	// Any thread
+	bool try_push(const T& value)
+	{
+		size_t pos = m_Tail.load(std::memory_order_relaxed);
+		Cell*  cell;
+		while (true)
+		{
+			cell          = &m_Cells[pos & c_Mask];
+			size_t   seq  = cell->Sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+			if (diff == 0)
+			{
+				if (m_Tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+			{
+				return false; // Consumer has not freed this cell yet
+			}
+			else
+			{
+				pos = m_Tail.load(std::memory_order_relaxed);
+			}
+		}
+		cell->Value = value;
+		cell->Sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only
+	bool try_pop(T& value)
+	{
+		Cell*  cell = &m_Cells[m_Head & c_Mask];
+		size_t seq  = cell->Sequence.load(std::memory_order_acquire);
+		if (seq != m_Head + 1)
+			return false;
+		value = cell->Value;
+		cell->Sequence.store(m_Head + Capacity, std::memory_order_release);
+		++m_Head;
+		return true;
+	}
+
+	// Consumer only
+	bool empty() const { return m_Cells[m_Head & c_Mask].Sequence.load(std::memory_order_acquire) != m_Head + 1; }
+
+	static constexpr size_t capacity() { return Capacity; }
+
+private:
+	struct Cell
+	{
+		std::atomic_size_t Sequence;
+		T                  Value;
+	};
+
+private:
+	alignas(Details::c_CacheLineSize) std::atomic_size_t m_Tail;
+	alignas(Details::c_CacheLineSize) size_t m_Head;
+	alignas(Details::c_CacheLineSize) Cell m_Cells[Capacity];
+};
+
+// Single slot that always holds the newest value, posting over an unconsumed value hands the old one back to the caller
+template <class T, T Empty>
+requires(std::atomic<T>::is_always_lock_free)
+struct AtomicMailbox
+{
+public:
+	static constexpr T c_Empty = Empty;
+
+public:
+	AtomicMailbox() : m_Value(Empty) {}
+	AtomicMailbox(const AtomicMailbox&) = delete;
+
+	AtomicMailbox& operator=(const AtomicMailbox&) = delete;
+
+	// Returns the value that got replaced, or Empty
+	T    exchange(T value) { return m_Value.exchange(value, std::memory_order_acq_rel); }
+	// Returns the current value and leaves the slot Empty
+	T    take() { return m_Value.exchange(Empty, std::memory_order_acq_rel); }
+	T    peek() const { return m_Value.load(std::memory_order_acquire); }
+	void clear() { m_Value.store(Empty, std::memory_order_release); }
+
+	bool empty() const { return peek() == Empty; }
+
+private:
+	alignas(Details::c_CacheLineSize) std::atomic<T> m_Value;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Allocators.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <type_traits>
+
+// Short lived array that lives inline up to InlineCount elements and spills into a LinearArena beyond that.
+// Only the arena ever touches the heap, and only when it has to grow a block
+template <class T, size_t InlineCount>
+requires(std::is_trivially_destructible_v<T> && InlineCount > 0)
+struct ScratchArray
+{
+public:
+	ScratchArray(size_t count, LinearArena& fallback)
+		: m_Data(count <= InlineCount ? (T*) m_Inline : fallback.Allocate<T>(count)),
+		  m_Size(count)
+	{
+	}
+	ScratchArray(const ScratchArray&) = delete;
+
+	ScratchArray& operator=(const ScratchArray&) = delete;
+
+	T&       operator[](size_t index) { return m_Data[index]; }
+	const T& operator[](size_t index) const { return m_Data[index]; }
+
+	T*       data() { return m_Data; }
+	const T* data() const { return m_Data; }
+	size_t   size() const { return m_Size; }
+	bool     spilled() const { return m_Data != (const T*) m_Inline; }
+
+private:
+	alignas(T) uint8_t m_Inline[sizeof(T) * InlineCount];
+	T*     m_Data;
+	size_t m_Size;
+};
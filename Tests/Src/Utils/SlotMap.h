@@ -0,0 +1,258 @@
+#pragma once
+
+#include "TupleVector.h"
+
+#include <cstdint>
+
+#include <limits>
+#include <utility>
+
+// Generational handle into a SlotMap, lower 32 bits are the slot index and upper 32 bits the slot generation.
+// Generations start at 1, so a zero handle is never valid
+struct SlotMapHandle
+{
+public:
+	static constexpr SlotMapHandle Null() { return SlotMapHandle {}; }
+
+	constexpr SlotMapHandle() : Value(0) {}
+	constexpr explicit SlotMapHandle(uint64_t value) : Value(value) {}
+	constexpr SlotMapHandle(uint32_t index, uint32_t generation) : Value((uint64_t) generation << 32 | index) {}
+
+	constexpr uint32_t Index() const { return (uint32_t) Value; }
+	constexpr uint32_t Generation() const { return (uint32_t) (Value >> 32); }
+
+	constexpr explicit operator bool() const { return Value != 0; }
+	constexpr bool     operator==(const SlotMapHandle& other) const = default;
+
+public:
+	uint64_t Value;
+};
+
+// Dense SoA storage addressed through stable handles, erase swaps the last row into the hole so iteration over column<N>() stays packed.
+// The owning slot of each row lives in a hidden trailing column
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+struct SlotMap
+{
+public:
+	using Handle = SlotMapHandle;
+
+	static constexpr size_t   ColumnCount = sizeof...(Ts);
+	static constexpr size_t   npos        = std::numeric_limits<size_t>::max();
+	static constexpr uint32_t c_FreeEnd   = std::numeric_limits<uint32_t>::max();
+
+public:
+	SlotMap();
+
+	Handle insert(const Ts&... columns);
+	Handle insert(Ts&&... columns);
+	Handle emplace();
+	bool   erase(Handle handle);
+	void   clear();
+	void   reserve(size_t capacity);
+
+	bool   contains(Handle handle) const;
+	size_t index_of(Handle handle) const;
+	Handle handle_at(size_t index) const;
+
+	template <size_t Column>
+	NthType<Column, Ts...>* get(Handle handle);
+	template <size_t Column>
+	const NthType<Column, Ts...>* get(Handle handle) const;
+	template <size_t Column>
+	NthType<Column, Ts...>* column();
+	template <size_t Column>
+	const NthType<Column, Ts...>* column() const;
+
+	bool   empty() const { return m_Values.empty(); }
+	size_t size() const { return m_Values.size(); }
+	size_t capacity() const { return m_Values.capacity(); }
+
+private:
+	uint32_t AllocateSlot();
+	Handle   Link(uint32_t slot);
+	template <size_t... Indices>
+	void MoveRow(size_t dst, size_t src, std::index_sequence<Indices...>);
+
+private:
+	TupleVector<Ts..., uint32_t>    m_Values;
+	TupleVector<uint32_t, uint32_t> m_Slots; // Dense index (or next free slot), generation
+	uint32_t                        m_FreeHead;
+};
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+SlotMap<Ts...>::SlotMap()
+	: m_FreeHead(c_FreeEnd)
+{
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+SlotMap<Ts...>::Handle SlotMap<Ts...>::insert(const Ts&... columns)
+{
+	uint32_t slot = AllocateSlot();
+	m_Values.push_back(columns..., slot);
+	return Link(slot);
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+SlotMap<Ts...>::Handle SlotMap<Ts...>::insert(Ts&&... columns)
+{
+	uint32_t slot = AllocateSlot();
+	m_Values.push_back(std::move(columns)..., std::move(slot));
+	return Link(slot);
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+SlotMap<Ts...>::Handle SlotMap<Ts...>::emplace()
+{
+	uint32_t slot = AllocateSlot();
+	m_Values.emplace_back();
+	m_Values.template entry<ColumnCount>(m_Values.size() - 1) = slot;
+	return Link(slot);
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+bool SlotMap<Ts...>::erase(Handle handle)
+{
+	size_t index = index_of(handle);
+	if (index == npos)
+		return false;
+
+	size_t last = m_Values.size() - 1;
+	if (index != last)
+	{
+		MoveRow(index, last, std::make_index_sequence<ColumnCount + 1> {});
+		m_Slots.template entry<0>(m_Values.template entry<ColumnCount>(index)) = (uint32_t) index;
+	}
+	m_Values.pop_back();
+
+	uint32_t  slot       = handle.Index();
+	uint32_t& generation = m_Slots.template entry<1>(slot);
+	if (++generation == 0)
+		generation = 1;
+	m_Slots.template entry<0>(slot) = m_FreeHead;
+	m_FreeHead                      = slot;
+	return true;
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+void SlotMap<Ts...>::clear()
+{
+	for (size_t i = 0; i < m_Values.size(); ++i)
+	{
+		uint32_t  slot       = m_Values.template entry<ColumnCount>(i);
+		uint32_t& generation = m_Slots.template entry<1>(slot);
+		if (++generation == 0)
+			generation = 1;
+		m_Slots.template entry<0>(slot) = m_FreeHead;
+		m_FreeHead                      = slot;
+	}
+	m_Values.clear();
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+void SlotMap<Ts...>::reserve(size_t capacity)
+{
+	m_Values.reserve(capacity);
+	m_Slots.reserve(capacity);
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+bool SlotMap<Ts...>::contains(Handle handle) const
+{
+	return index_of(handle) != npos;
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+size_t SlotMap<Ts...>::index_of(Handle handle) const
+{
+	uint32_t slot = handle.Index();
+	if (slot >= m_Slots.size() || m_Slots.template entry<1>(slot) != handle.Generation())
+		return npos;
+	return m_Slots.template entry<0>(slot);
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+SlotMap<Ts...>::Handle SlotMap<Ts...>::handle_at(size_t index) const
+{
+	if (index >= m_Values.size())
+		return Handle::Null();
+	uint32_t slot = m_Values.template entry<ColumnCount>(index);
+	return Handle { slot, m_Slots.template entry<1>(slot) };
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+template <size_t Column>
+NthType<Column, Ts...>* SlotMap<Ts...>::get(Handle handle)
+{
+	size_t index = index_of(handle);
+	return index != npos ? &m_Values.template entry<Column>(index) : nullptr;
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+template <size_t Column>
+const NthType<Column, Ts...>* SlotMap<Ts...>::get(Handle handle) const
+{
+	size_t index = index_of(handle);
+	return index != npos ? &m_Values.template entry<Column>(index) : nullptr;
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+template <size_t Column>
+NthType<Column, Ts...>* SlotMap<Ts...>::column()
+{
+	return m_Values.template column<Column>();
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+template <size_t Column>
+const NthType<Column, Ts...>* SlotMap<Ts...>::column() const
+{
+	return m_Values.template column<Column>();
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+uint32_t SlotMap<Ts...>::AllocateSlot()
+{
+	if (m_FreeHead != c_FreeEnd)
+	{
+		uint32_t slot = m_FreeHead;
+		m_FreeHead    = m_Slots.template entry<0>(slot);
+		return slot;
+	}
+	if (m_Slots.size() >= c_FreeEnd)
+		throw std::length_error("SlotMap slot index space exhausted");
+	m_Slots.push_back(0U, 1U);
+	return (uint32_t) (m_Slots.size() - 1);
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+SlotMap<Ts...>::Handle SlotMap<Ts...>::Link(uint32_t slot)
+{
+	m_Slots.template entry<0>(slot) = (uint32_t) (m_Values.size() - 1);
+	return Handle { slot, m_Slots.template entry<1>(slot) };
+}
+
+template <class... Ts>
+requires(sizeof...(Ts) > 0)
+template <size_t... Indices>
+void SlotMap<Ts...>::MoveRow(size_t dst, size_t src, std::index_sequence<Indices...>)
+{
+	((m_Values.template entry<Indices>(dst) = std::move(m_Values.template entry<Indices>(src))), ...);
+}
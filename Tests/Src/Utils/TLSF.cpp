@@ -0,0 +1,258 @@
+#include "TLSF.h"
+
+#include <algorithm>
+#include <bit>
+
+TLSFAllocator::TLSFAllocator()
+	: m_UnusedNodes(c_InvalidNode),
+	  m_FLBitmap(0),
+	  m_SLBitmaps {},
+	  m_Size(0),
+	  m_Used(0),
+	  m_AllocationCount(0),
+	  m_FreeBlockCount(0)
+{
+	std::fill(&m_Heads[0][0], &m_Heads[0][0] + c_FLCount * c_SLCount, c_InvalidNode);
+}
+
+bool TLSFAllocator::Init(uint64_t size)
+{
+	size = size / c_Granularity * c_Granularity;
+	if (!size || !m_Nodes.empty())
+		return false;
+
+	m_Size = size;
+	m_Nodes.reserve(64);
+	uint32_t node        = NewNode();
+	m_Nodes[node].Offset = 0;
+	m_Nodes[node].Size   = size;
+	InsertFree(node);
+	return true;
+}
+
+void TLSFAllocator::DeInit()
+{
+	m_Nodes.clear();
+	m_Nodes.shrink_to_fit();
+	m_UnusedNodes = c_InvalidNode;
+	m_FLBitmap    = 0;
+	std::fill(m_SLBitmaps, m_SLBitmaps + c_FLCount, 0U);
+	std::fill(&m_Heads[0][0], &m_Heads[0][0] + c_FLCount * c_SLCount, c_InvalidNode);
+	m_Size            = 0;
+	m_Used            = 0;
+	m_AllocationCount = 0;
+	m_FreeBlockCount  = 0;
+}
+
+uint32_t TLSFAllocator::Allocate(uint64_t size, uint64_t alignment, void* userData)
+{
+	if (!size || m_Nodes.empty() || (alignment & (alignment - 1)))
+		return c_InvalidNode;
+
+	size      = (size + c_Granularity - 1) / c_Granularity * c_Granularity;
+	alignment = std::max(alignment, c_Granularity);
+	// Offsets are granularity aligned already, larger alignments may need up to alignment - granularity of padding in front
+	uint32_t node = FindFree(size + alignment - c_Granularity);
+	if (node == c_InvalidNode)
+		return c_InvalidNode;
+	RemoveFree(node);
+
+	// The padding keeps the original node, so the node at offset zero never goes away and ForEachAllocation can start there
+	uint64_t padding = ((m_Nodes[node].Offset + alignment - 1) & ~(alignment - 1)) - m_Nodes[node].Offset;
+	if (padding)
+	{
+		uint32_t block = NewNode();
+		auto&    front = m_Nodes[node];
+		auto&    back  = m_Nodes[block];
+		back.Offset    = front.Offset + padding;
+		back.Size      = front.Size - padding;
+		back.PrevPhys  = node;
+		back.NextPhys  = front.NextPhys;
+		front.Size     = padding;
+		front.NextPhys = block;
+		if (back.NextPhys != c_InvalidNode)
+			m_Nodes[back.NextPhys].PrevPhys = block;
+		InsertFree(node);
+		node = block;
+	}
+	if (m_Nodes[node].Size - size >= c_Granularity)
+	{
+		uint32_t rest  = NewNode();
+		auto&    block = m_Nodes[node];
+		auto&    tail  = m_Nodes[rest];
+		tail.Offset    = block.Offset + size;
+		tail.Size      = block.Size - size;
+		tail.PrevPhys  = node;
+		tail.NextPhys  = block.NextPhys;
+		block.Size     = size;
+		block.NextPhys = rest;
+		if (tail.NextPhys != c_InvalidNode)
+			m_Nodes[tail.NextPhys].PrevPhys = rest;
+		InsertFree(rest);
+	}
+
+	auto& block     = m_Nodes[node];
+	block.Free      = false;
+	block.UserData  = userData;
+	m_Used         += block.Size;
+	++m_AllocationCount;
+	return node;
+}
+
+void TLSFAllocator::Free(uint32_t node)
+{
+	if (node >= m_Nodes.size() || m_Nodes[node].Free)
+		return;
+
+	m_Used -= m_Nodes[node].Size;
+	--m_AllocationCount;
+	m_Nodes[node].UserData = nullptr;
+
+	uint32_t prev = m_Nodes[node].PrevPhys;
+	if (prev != c_InvalidNode && m_Nodes[prev].Free)
+	{
+		RemoveFree(prev);
+		m_Nodes[prev].Size     += m_Nodes[node].Size;
+		m_Nodes[prev].NextPhys  = m_Nodes[node].NextPhys;
+		if (m_Nodes[prev].NextPhys != c_InvalidNode)
+			m_Nodes[m_Nodes[prev].NextPhys].PrevPhys = prev;
+		ReleaseNode(node);
+		node = prev;
+	}
+	uint32_t next = m_Nodes[node].NextPhys;
+	if (next != c_InvalidNode && m_Nodes[next].Free)
+	{
+		RemoveFree(next);
+		m_Nodes[node].Size     += m_Nodes[next].Size;
+		m_Nodes[node].NextPhys  = m_Nodes[next].NextPhys;
+		if (m_Nodes[node].NextPhys != c_InvalidNode)
+			m_Nodes[m_Nodes[node].NextPhys].PrevPhys = node;
+		ReleaseNode(next);
+	}
+	InsertFree(node);
+}
+
+TLSFAllocator::Stats TLSFAllocator::GetStats() const
+{
+	Stats stats {
+		.Size            = m_Size,
+		.Used            = m_Used,
+		.LargestFree     = 0,
+		.AllocationCount = m_AllocationCount,
+		.FreeBlockCount  = m_FreeBlockCount
+	};
+	// Only the highest non empty size class can hold the largest block
+	if (m_FLBitmap)
+	{
+		uint32_t fl = 63 - (uint32_t) std::countl_zero(m_FLBitmap);
+		uint32_t sl = 31 - (uint32_t) std::countl_zero(m_SLBitmaps[fl]);
+		for (uint32_t node = m_Heads[fl][sl]; node != c_InvalidNode; node = m_Nodes[node].NextFree)
+			stats.LargestFree = std::max(stats.LargestFree, m_Nodes[node].Size);
+	}
+	return stats;
+}
+
+void TLSFAllocator::MapInsert(uint64_t size, uint32_t& fl, uint32_t& sl)
+{
+	uint64_t units = size / c_Granularity;
+	if (units < c_SLCount)
+	{
+		fl = 0;
+		sl = (uint32_t) units;
+		return;
+	}
+	uint32_t log2 = 63 - (uint32_t) std::countl_zero(units);
+	fl            = log2 - c_SLBits + 1;
+	sl            = (uint32_t) (units >> (log2 - c_SLBits)) - c_SLCount;
+}
+
+void TLSFAllocator::MapSearch(uint64_t size, uint32_t& fl, uint32_t& sl)
+{
+	uint64_t units = size / c_Granularity;
+	if (units >= c_SLCount)
+	{
+		uint32_t log2  = 63 - (uint32_t) std::countl_zero(units);
+		units         += (1ULL << (log2 - c_SLBits)) - 1;
+	}
+	MapInsert(units * c_Granularity, fl, sl);
+}
+
+uint32_t TLSFAllocator::NewNode()
+{
+	if (m_UnusedNodes != c_InvalidNode)
+	{
+		uint32_t node = m_UnusedNodes;
+		m_UnusedNodes = m_Nodes[node].PrevFree;
+		m_Nodes[node] = {};
+		return node;
+	}
+	m_Nodes.emplace_back();
+	return (uint32_t) (m_Nodes.size() - 1);
+}
+
+void TLSFAllocator::ReleaseNode(uint32_t node)
+{
+	m_Nodes[node]          = {};
+	m_Nodes[node].PrevFree = m_UnusedNodes;
+	m_UnusedNodes          = node;
+}
+
+void TLSFAllocator::InsertFree(uint32_t node)
+{
+	uint32_t fl, sl;
+	MapInsert(m_Nodes[node].Size, fl, sl);
+
+	auto& block    = m_Nodes[node];
+	block.Free     = true;
+	block.PrevFree = c_InvalidNode;
+	block.NextFree = m_Heads[fl][sl];
+	if (block.NextFree != c_InvalidNode)
+		m_Nodes[block.NextFree].PrevFree = node;
+	m_Heads[fl][sl]  = node;
+	m_SLBitmaps[fl] |= 1U << sl;
+	m_FLBitmap      |= 1ULL << fl;
+	++m_FreeBlockCount;
+}
+
+void TLSFAllocator::RemoveFree(uint32_t node)
+{
+	uint32_t fl, sl;
+	MapInsert(m_Nodes[node].Size, fl, sl);
+
+	auto& block = m_Nodes[node];
+	if (block.PrevFree != c_InvalidNode)
+		m_Nodes[block.PrevFree].NextFree = block.NextFree;
+	else
+		m_Heads[fl][sl] = block.NextFree;
+	if (block.NextFree != c_InvalidNode)
+		m_Nodes[block.NextFree].PrevFree = block.PrevFree;
+	block.Free     = false;
+	block.PrevFree = c_InvalidNode;
+	block.NextFree = c_InvalidNode;
+	if (m_Heads[fl][sl] == c_InvalidNode)
+	{
+		m_SLBitmaps[fl] &= ~(1U << sl);
+		if (!m_SLBitmaps[fl])
+			m_FLBitmap &= ~(1ULL << fl);
+	}
+	--m_FreeBlockCount;
+}
+
+uint32_t TLSFAllocator::FindFree(uint64_t size) const
+{
+	uint32_t fl, sl;
+	MapSearch(size, fl, sl);
+	if (fl >= c_FLCount)
+		return c_InvalidNode;
+
+	uint32_t slMap = m_SLBitmaps[fl] & (~0U << sl);
+	if (!slMap)
+	{
+		uint64_t flMap = fl + 1 < 64 ? m_FLBitmap & (~0ULL << (fl + 1)) : 0;
+		if (!flMap)
+			return c_InvalidNode;
+		fl    = (uint32_t) std::countr_zero(flMap);
+		slMap = m_SLBitmaps[fl];
+	}
+	return m_Heads[fl][(uint32_t) std::countr_zero(slMap)];
+}
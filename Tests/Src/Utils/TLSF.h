@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+//
+// Two level segregated fit allocator over an offset range, the memory itself is never touched so it can manage GPU memory.
+// Free blocks sit in c_FLCount x c_SLCount size class lists, a bitmap per level finds the first non empty list large enough
+// in O(1). Neighbouring free blocks are merged on Free, so a block's physical neighbours are never both free.
+// Sizes and offsets are multiples of c_Granularity, block metadata lives in a node array addressed by index.
+//
+
+struct TLSFAllocator
+{
+public:
+	static constexpr uint64_t c_Granularity = 256;
+	static constexpr uint32_t c_SLBits      = 5;
+	static constexpr uint32_t c_SLCount     = 1U << c_SLBits;
+	static constexpr uint32_t c_FLCount     = 64 - c_SLBits;
+	static constexpr uint32_t c_InvalidNode = ~0U;
+
+	struct Stats
+	{
+		uint64_t Size            = 0;
+		uint64_t Used            = 0;
+		uint64_t LargestFree     = 0;
+		uint32_t AllocationCount = 0;
+		uint32_t FreeBlockCount  = 0;
+	};
+
+public:
+	TLSFAllocator();
+
+	bool Init(uint64_t size);
+	void DeInit();
+
+	// Returns the node of the allocation or c_InvalidNode when no free block fits, alignment has to be a power of two
+	uint32_t Allocate(uint64_t size, uint64_t alignment, void* userData = nullptr);
+	void     Free(uint32_t node);
+
+	uint64_t Offset(uint32_t node) const { return m_Nodes[node].Offset; }
+	uint64_t Size(uint32_t node) const { return m_Nodes[node].Size; }
+	void*    UserData(uint32_t node) const { return m_Nodes[node].UserData; }
+
+	// Calls func(node) for every allocation in offset order
+	template <class F>
+	void ForEachAllocation(F&& func) const
+	{
+		if (m_Nodes.empty())
+			return;
+		for (uint32_t node = 0; node != c_InvalidNode; node = m_Nodes[node].NextPhys)
+		{
+			if (!m_Nodes[node].Free)
+				func(node);
+		}
+	}
+
+	Stats    GetStats() const;
+	uint64_t TotalSize() const { return m_Size; }
+	uint64_t UsedSize() const { return m_Used; }
+	uint32_t AllocationCount() const { return m_AllocationCount; }
+	bool     Empty() const { return m_AllocationCount == 0; }
+
+private:
+	struct Node
+	{
+		uint64_t Offset   = 0;
+		uint64_t Size     = 0;
+		uint32_t PrevPhys = c_InvalidNode;
+		uint32_t NextPhys = c_InvalidNode;
+		uint32_t PrevFree = c_InvalidNode; // Doubles as the next unused node while the node is unused
+		uint32_t NextFree = c_InvalidNode;
+		void*    UserData = nullptr;
+		bool     Free     = false;
+	};
+
+	// Size class holding blocks of size, rounded down for inserting and up for searching so any block found fits
+	static void MapInsert(uint64_t size, uint32_t& fl, uint32_t& sl);
+	static void MapSearch(uint64_t size, uint32_t& fl, uint32_t& sl);
+
+	uint32_t NewNode();
+	void     ReleaseNode(uint32_t node);
+	void     InsertFree(uint32_t node);
+	void     RemoveFree(uint32_t node);
+	uint32_t FindFree(uint64_t size) const;
+
+private:
+	std::vector<Node> m_Nodes;
+	uint32_t          m_UnusedNodes;
+
+	uint64_t m_FLBitmap;
+	uint32_t m_SLBitmaps[c_FLCount];
+	uint32_t m_Heads[c_FLCount][c_SLCount];
+
+	uint64_t m_Size;
+	uint64_t m_Used;
+	uint32_t m_AllocationCount;
+	uint32_t m_FreeBlockCount;
+};
@@ -1,47 +1,130 @@
 #pragma once
 
+#include "Allocators.h"
 #include "TypeTraits.h"
 
+#include <cstring>
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <new>
 #include <stdexcept>
 #include <tuple>
 
-#include <Memory/Memory.h>
 
 namespace Details
 {
-	template <class... Ts>
-	requires(sizeof...(Ts) > 0)
-	struct TupleVectorOffsets
+	template <size_t Alignment, class... Ts>
+	requires(sizeof...(Ts) > 0 && std::has_single_bit(Alignment))
+	struct TupleVectorLayout
 	{
 	public:
-		size_t Offsets[sizeof...(Ts) + 1];
+		size_t Sizes[sizeof...(Ts)];
+		size_t Alignments[sizeof...(Ts) + 1];
+
+		constexpr TupleVectorLayout()
+			: Sizes { sizeof(Ts)... },
+			  Alignments { std::max<size_t>(alignof(Ts), Alignment)..., 1 }
+		{
+		}
+
+		static constexpr size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
 
-		constexpr TupleVectorOffsets()
+		// Byte offset of the column from the start of the allocation, each column starts aligned to its own alignment
+		constexpr size_t Offset(size_t column, size_t capacity) const
 		{
-			Fill(std::make_index_sequence<sizeof...(Ts)> {});
+			size_t offset = 0;
+			for (size_t i = 0; i < column; ++i)
+				offset = AlignUp(offset + Sizes[i] * capacity, Alignments[i + 1]);
+			return offset;
 		}
 
-		template <size_t... Indices>
-		constexpr void Fill(std::index_sequence<Indices...>)
+		constexpr size_t AllocationSize(size_t capacity) const { return Offset(sizeof...(Ts), capacity); }
+
+		constexpr size_t MaxAlignment() const
 		{
-			Offsets[0] = 0;
-			((Offsets[Indices + 1] = Offsets[Indices] + sizeof(Ts)), ...);
+			size_t alignment = alignof(void*);
+			for (size_t i = 0; i < sizeof...(Ts); ++i)
+				alignment = std::max<size_t>(alignment, Alignments[i]);
+			return alignment;
 		}
 
-		constexpr size_t operator[](size_t index) const { return Offsets[index]; }
+		constexpr size_t RowSize() const
+		{
+			size_t size = 0;
+			for (size_t i = 0; i < sizeof...(Ts); ++i)
+				size += Sizes[i];
+			return size;
+		}
 	};
 } // namespace Details
 
+namespace TupleVectorGrowth
+{
+	// Doubles capacity, rounding up to the next power of two
+	struct PowerOfTwo
+	{
+		static constexpr size_t Grow(size_t capacity, size_t required)
+		{
+			(void) capacity;
+			return std::bit_ceil(required);
+		}
+	};
+
+	// Grows capacity by 1.5x, wastes less memory on large tables
+	struct OneAndHalf
+	{
+		static constexpr size_t Grow(size_t capacity, size_t required)
+		{
+			return std::max<size_t>(required, capacity + capacity / 2);
+		}
+	};
+
+	// Only ever allocates what is required, every append that exceeds capacity reallocates
+	struct Exact
+	{
+		static constexpr size_t Grow(size_t capacity, size_t required)
+		{
+			(void) capacity;
+			return required;
+		}
+	};
+} // namespace TupleVectorGrowth
+
+// Columns start on a cache line by default so column pointers can be fed to wide SIMD loads
+static constexpr size_t c_TupleVectorDefaultAlignment = 64;
+
+// Allocator needs 'void* Allocate(size_t size, size_t alignment)' and 'void Free(void* data)'
+template <class Growth = TupleVectorGrowth::PowerOfTwo, size_t ColumnAlignment = c_TupleVectorDefaultAlignment, class Alloc = HeapAllocator>
+struct TupleVectorSpec
+{
+	using GrowthPolicy = Growth;
+	using Allocator    = Alloc;
+
+	static constexpr size_t Alignment = ColumnAlignment;
+};
+
+template <class Spec, class... Ts>
+struct BasicTupleVector;
+
+template <class... Ts>
+using TupleVector = BasicTupleVector<TupleVectorSpec<>, Ts...>;
+
+template <size_t Alignment, class... Ts>
+using AlignedTupleVector = BasicTupleVector<TupleVectorSpec<TupleVectorGrowth::PowerOfTwo, Alignment>, Ts...>;
+
 template <class... Ts>
-struct TupleVector;
+using ArenaTupleVector = BasicTupleVector<TupleVectorSpec<TupleVectorGrowth::PowerOfTwo, c_TupleVectorDefaultAlignment, ArenaAllocator>, Ts...>;
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 struct TupleVectorIter
 {
 public:
-	using Vec            = std::conditional_t<Const, const TupleVector<Ts...>*, TupleVector<Ts...>*>;
+	using Vec            = std::conditional_t<Const, const BasicTupleVector<Spec, Ts...>*, BasicTupleVector<Spec, Ts...>*>;
 	using ref_tuple_type = std::conditional_t<Const, std::tuple<const Ts&...>, std::tuple<Ts&...>>;
 	template <size_t... Columns>
 	using ref_sub_tuple_type = std::conditional_t<Const, std::tuple<const NthType<Columns, Ts...>&...>, std::tuple<NthType<Columns, Ts...>&...>>;
@@ -62,46 +145,51 @@ public:
 	TupleVectorIter        operator--(int);
 	TupleVectorIter&       operator+=(ptrdiff_t n);
 	TupleVectorIter&       operator-=(ptrdiff_t n);
-	friend TupleVectorIter operator+(TupleVectorIter iter, ptrdiff_t n);
-	friend TupleVectorIter operator+(ptrdiff_t n, TupleVectorIter iter);
-	friend TupleVectorIter operator-(TupleVectorIter iter, ptrdiff_t n);
-	friend ptrdiff_t       operator-(TupleVectorIter lhs, TupleVectorIter rhs);
+	friend TupleVectorIter operator+(TupleVectorIter iter, ptrdiff_t n) { return iter += n; }
+	friend TupleVectorIter operator+(ptrdiff_t n, TupleVectorIter iter) { return iter += n; }
+	friend TupleVectorIter operator-(TupleVectorIter iter, ptrdiff_t n) { return iter -= n; }
+	friend ptrdiff_t operator-(TupleVectorIter lhs, TupleVectorIter rhs)
+	{
+		if (lhs.m_Vec != rhs.m_Vec)
+			throw std::runtime_error("Incompatible iterators");
+		return lhs.m_Row - rhs.m_Row;
+	}
 
 	bool operator==(TupleVectorIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row == m_Row;
+		return m_Row == other.m_Row;
 	}
 	bool operator!=(TupleVectorIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row != m_Row;
+		return m_Row != other.m_Row;
 	}
 	bool operator<(TupleVectorIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row < m_Row;
+		return m_Row < other.m_Row;
 	}
 	bool operator<=(TupleVectorIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row <= m_Row;
+		return m_Row <= other.m_Row;
 	}
 	bool operator>(TupleVectorIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row > m_Row;
+		return m_Row > other.m_Row;
 	}
 	bool operator>=(TupleVectorIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row >= m_Row;
+		return m_Row >= other.m_Row;
 	}
 
 private:
@@ -109,12 +197,12 @@ private:
 	size_t m_Row;
 };
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 struct TupleVectorReverseIter
 {
 public:
-	using Vec            = std::conditional_t<Const, const TupleVector<Ts...>*, TupleVector<Ts...>*>;
+	using Vec            = std::conditional_t<Const, const BasicTupleVector<Spec, Ts...>*, BasicTupleVector<Spec, Ts...>*>;
 	using ref_tuple_type = std::conditional_t<Const, std::tuple<const Ts&...>, std::tuple<Ts&...>>;
 	template <size_t... Columns>
 	using ref_sub_tuple_type = std::conditional_t<Const, std::tuple<const NthType<Columns, Ts...>&...>, std::tuple<NthType<Columns, Ts...>&...>>;
@@ -135,46 +223,51 @@ public:
 	TupleVectorReverseIter        operator--(int);
 	TupleVectorReverseIter&       operator+=(ptrdiff_t n);
 	TupleVectorReverseIter&       operator-=(ptrdiff_t n);
-	friend TupleVectorReverseIter operator+(TupleVectorReverseIter iter, ptrdiff_t n);
-	friend TupleVectorReverseIter operator+(ptrdiff_t n, TupleVectorReverseIter iter);
-	friend TupleVectorReverseIter operator-(TupleVectorReverseIter iter, ptrdiff_t n);
-	friend ptrdiff_t              operator-(TupleVectorReverseIter lhs, TupleVectorReverseIter rhs);
+	friend TupleVectorReverseIter operator+(TupleVectorReverseIter iter, ptrdiff_t n) { return iter += n; }
+	friend TupleVectorReverseIter operator+(ptrdiff_t n, TupleVectorReverseIter iter) { return iter += n; }
+	friend TupleVectorReverseIter operator-(TupleVectorReverseIter iter, ptrdiff_t n) { return iter -= n; }
+	friend ptrdiff_t operator-(TupleVectorReverseIter lhs, TupleVectorReverseIter rhs)
+	{
+		if (lhs.m_Vec != rhs.m_Vec)
+			throw std::runtime_error("Incompatible iterators");
+		return lhs.m_Row - rhs.m_Row;
+	}
 
 	bool operator==(TupleVectorReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row == m_Row;
+		return m_Row == other.m_Row;
 	}
 	bool operator!=(TupleVectorReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row != m_Row;
+		return m_Row != other.m_Row;
 	}
 	bool operator<(TupleVectorReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row < m_Row;
+		return m_Row < other.m_Row;
 	}
 	bool operator<=(TupleVectorReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row <= m_Row;
+		return m_Row <= other.m_Row;
 	}
 	bool operator>(TupleVectorReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row > m_Row;
+		return m_Row > other.m_Row;
 	}
 	bool operator>=(TupleVectorReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row >= m_Row;
+		return m_Row >= other.m_Row;
 	}
 
 private:
@@ -202,46 +295,51 @@ public:
 	TupleVectorSubIter        operator--(int);
 	TupleVectorSubIter&       operator+=(ptrdiff_t n);
 	TupleVectorSubIter&       operator-=(ptrdiff_t n);
-	friend TupleVectorSubIter operator+(TupleVectorSubIter iter, ptrdiff_t n);
-	friend TupleVectorSubIter operator+(ptrdiff_t n, TupleVectorSubIter iter);
-	friend TupleVectorSubIter operator-(TupleVectorSubIter iter, ptrdiff_t n);
-	friend ptrdiff_t          operator-(TupleVectorSubIter lhs, TupleVectorSubIter rhs);
+	friend TupleVectorSubIter operator+(TupleVectorSubIter iter, ptrdiff_t n) { return iter += n; }
+	friend TupleVectorSubIter operator+(ptrdiff_t n, TupleVectorSubIter iter) { return iter += n; }
+	friend TupleVectorSubIter operator-(TupleVectorSubIter iter, ptrdiff_t n) { return iter -= n; }
+	friend ptrdiff_t operator-(TupleVectorSubIter lhs, TupleVectorSubIter rhs)
+	{
+		if (lhs.m_Vec != rhs.m_Vec)
+			throw std::runtime_error("Incompatible iterators");
+		return lhs.m_Row - rhs.m_Row;
+	}
 
 	bool operator==(TupleVectorSubIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row == m_Row;
+		return m_Row == other.m_Row;
 	}
 	bool operator!=(TupleVectorSubIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row != m_Row;
+		return m_Row != other.m_Row;
 	}
 	bool operator<(TupleVectorSubIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row < m_Row;
+		return m_Row < other.m_Row;
 	}
 	bool operator<=(TupleVectorSubIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row <= m_Row;
+		return m_Row <= other.m_Row;
 	}
 	bool operator>(TupleVectorSubIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row > m_Row;
+		return m_Row > other.m_Row;
 	}
 	bool operator>=(TupleVectorSubIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row >= m_Row;
+		return m_Row >= other.m_Row;
 	}
 
 private:
@@ -269,46 +367,51 @@ public:
 	TupleVectorSubReverseIter        operator--(int);
 	TupleVectorSubReverseIter&       operator+=(ptrdiff_t n);
 	TupleVectorSubReverseIter&       operator-=(ptrdiff_t n);
-	friend TupleVectorSubReverseIter operator+(TupleVectorSubReverseIter iter, ptrdiff_t n);
-	friend TupleVectorSubReverseIter operator+(ptrdiff_t n, TupleVectorSubReverseIter iter);
-	friend TupleVectorSubReverseIter operator-(TupleVectorSubReverseIter iter, ptrdiff_t n);
-	friend ptrdiff_t                 operator-(TupleVectorSubReverseIter lhs, TupleVectorSubReverseIter rhs);
+	friend TupleVectorSubReverseIter operator+(TupleVectorSubReverseIter iter, ptrdiff_t n) { return iter += n; }
+	friend TupleVectorSubReverseIter operator+(ptrdiff_t n, TupleVectorSubReverseIter iter) { return iter += n; }
+	friend TupleVectorSubReverseIter operator-(TupleVectorSubReverseIter iter, ptrdiff_t n) { return iter -= n; }
+	friend ptrdiff_t operator-(TupleVectorSubReverseIter lhs, TupleVectorSubReverseIter rhs)
+	{
+		if (lhs.m_Vec != rhs.m_Vec)
+			throw std::runtime_error("Incompatible iterators");
+		return lhs.m_Row - rhs.m_Row;
+	}
 
 	bool operator==(TupleVectorSubReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row == m_Row;
+		return m_Row == other.m_Row;
 	}
 	bool operator!=(TupleVectorSubReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row != m_Row;
+		return m_Row != other.m_Row;
 	}
 	bool operator<(TupleVectorSubReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row < m_Row;
+		return m_Row < other.m_Row;
 	}
 	bool operator<=(TupleVectorSubReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row <= m_Row;
+		return m_Row <= other.m_Row;
 	}
 	bool operator>(TupleVectorSubReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row > m_Row;
+		return m_Row > other.m_Row;
 	}
 	bool operator>=(TupleVectorSubReverseIter other) const
 	{
 		if (m_Vec != other.m_Vec)
 			throw std::runtime_error("Incompatible iterators");
-		return m_Row >= m_Row;
+		return m_Row >= other.m_Row;
 	}
 
 private:
@@ -316,9 +419,9 @@ private:
 	size_t m_Row;
 };
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-struct TupleVector<Ts...>
+struct BasicTupleVector<Spec, Ts...>
 {
 public:
 	using tuple_type               = std::tuple<Ts...>;
@@ -338,44 +441,47 @@ public:
 
 	using size_type              = size_t;
 	using difference_type        = ptrdiff_t;
-	using iterator               = TupleVectorIter<false, Ts...>;
-	using const_iterator         = TupleVectorIter<true, Ts...>;
-	using reverse_iterator       = TupleVectorReverseIter<false, Ts...>;
-	using const_reverse_iterator = TupleVectorReverseIter<true, Ts...>;
+	using allocator_type         = typename Spec::Allocator;
+	using iterator               = TupleVectorIter<false, Spec, Ts...>;
+	using const_iterator         = TupleVectorIter<true, Spec, Ts...>;
+	using reverse_iterator       = TupleVectorReverseIter<false, Spec, Ts...>;
+	using const_reverse_iterator = TupleVectorReverseIter<true, Spec, Ts...>;
 	template <size_t... Columns>
-	using sub_iterator = TupleVectorSubIter<false, TupleVector, Columns...>;
+	using sub_iterator = TupleVectorSubIter<false, BasicTupleVector, Columns...>;
 	template <size_t... Columns>
-	using sub_const_iterator = TupleVectorSubIter<true, TupleVector, Columns...>;
+	using sub_const_iterator = TupleVectorSubIter<true, BasicTupleVector, Columns...>;
 	template <size_t... Columns>
-	using sub_reverse_iterator = TupleVectorSubReverseIter<false, TupleVector, Columns...>;
+	using sub_reverse_iterator = TupleVectorSubReverseIter<false, BasicTupleVector, Columns...>;
 	template <size_t... Columns>
-	using sub_const_reverse_iterator = TupleVectorSubReverseIter<true, TupleVector, Columns...>;
+	using sub_const_reverse_iterator = TupleVectorSubReverseIter<true, BasicTupleVector, Columns...>;
 
 	static constexpr size_t ColumnCount = sizeof...(Ts);
-	static constexpr auto   Offsets     = Details::TupleVectorOffsets<Ts...> {};
-	static constexpr size_t RowSize     = Offsets[ColumnCount];
+	static constexpr size_t Alignment   = Spec::Alignment;
+	static constexpr auto   Layout      = Details::TupleVectorLayout<Alignment, Ts...> {};
+	static constexpr size_t RowSize     = Layout.RowSize();
 
 public:
-	TupleVector();
-	TupleVector(size_t count, const tuple_type& value);
-	TupleVector(size_t count, const Ts&... columns);
-	explicit TupleVector(size_t count);
+	BasicTupleVector();
+	explicit BasicTupleVector(const allocator_type& allocator);
+	BasicTupleVector(size_t count, const tuple_type& value);
+	BasicTupleVector(size_t count, const Ts&... columns);
+	explicit BasicTupleVector(size_t count);
 	template <class InputIt>
-	requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename TupleVector<Ts...>::tuple_type>)
-	TupleVector(InputIt first, InputIt last);
-	TupleVector(std::initializer_list<tuple_type> init);
-	TupleVector(const TupleVector& copy);
-	TupleVector(TupleVector&& move) noexcept;
-	~TupleVector();
+	requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename BasicTupleVector<Spec, Ts...>::tuple_type>)
+	BasicTupleVector(InputIt first, InputIt last);
+	BasicTupleVector(std::initializer_list<tuple_type> init);
+	BasicTupleVector(const BasicTupleVector& copy);
+	BasicTupleVector(BasicTupleVector&& move) noexcept;
+	~BasicTupleVector();
 
-	TupleVector& operator=(std::initializer_list<tuple_type> init);
-	TupleVector& operator=(const TupleVector& copy);
-	TupleVector& operator=(TupleVector&& move) noexcept;
+	BasicTupleVector& operator=(std::initializer_list<tuple_type> init);
+	BasicTupleVector& operator=(const BasicTupleVector& copy);
+	BasicTupleVector& operator=(BasicTupleVector&& move) noexcept;
 
 	void assign(size_t count, const tuple_type& value);
 	void assign(size_t count, const Ts&... columns);
 	template <class InputIt>
-	requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename TupleVector<Ts...>::tuple_type>)
+	requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename BasicTupleVector<Spec, Ts...>::tuple_type>)
 	void assign(InputIt first, InputIt last);
 	void assign(std::initializer_list<tuple_type> init);
 
@@ -493,7 +599,7 @@ public:
 	iterator insert(const_iterator pos, Ts&&... columns);
 	iterator insert(const_iterator pos, size_t count, const tuple_type& value);
 	template <class InputIt>
-	requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename TupleVector<Ts...>::tuple_type>)
+	requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename BasicTupleVector<Spec, Ts...>::tuple_type>)
 	iterator       insert(const_iterator pos, InputIt first, InputIt last);
 	iterator       insert(const_iterator pos, std::initializer_list<tuple_type> init);
 	iterator       emplace(const_iterator pos);
@@ -504,11 +610,17 @@ public:
 	void           push_back(const Ts&... columns);
 	void           push_back(Ts&&... columns);
 	ref_tuple_type emplace_back();
+	template <class InputIt>
+	requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename BasicTupleVector<Spec, Ts...>::tuple_type>)
+	iterator       append_range(InputIt first, InputIt last);
+	iterator       append_n(size_t count);
+	iterator       append_n(size_t count, const tuple_type& value);
+	iterator       append_n(size_t count, const Ts&... columns);
 	void           pop_back();
 	void           resize(size_t newSize);
 	void           resize(size_t newSize, const tuple_type& value);
 	void           resize(size_t newSize, const Ts&... columns);
-	void           swap(TupleVector& other) noexcept;
+	void           swap(BasicTupleVector& other) noexcept;
 
 private:
 	template <size_t... Indices>
@@ -520,6 +632,18 @@ private:
 	template <size_t... Indices>
 	const_pointer_tuple_type data_internal(std::index_sequence<Indices...>) const;
 
+	void grow(size_t required);
+
+	void* AllocateColumns(size_t capacity);
+	void  FreeColumns(void* data);
+
+	static void FillColumns(void* data, size_t capacity, size_t start, size_t count);
+	static void FillColumns(void* data, size_t capacity, size_t start, size_t count, const Ts&... columns);
+	template <size_t... Indices>
+	static void FillColumns2(void* data, size_t capacity, size_t start, size_t count, std::index_sequence<Indices...>);
+	template <size_t... Indices>
+	static void FillColumns2(void* data, size_t capacity, size_t start, size_t count, const Ts&... columns, std::index_sequence<Indices...>);
+
 	static void ShiftColumns(void* data, size_t capacity, size_t start, size_t end, ptrdiff_t count);
 	template <size_t... Indices>
 	static void ShiftColumns2(void* data, size_t capacity, size_t start, size_t end, ptrdiff_t count, std::index_sequence<Indices...>);
@@ -564,20 +688,33 @@ private:
 	size_t m_Capacity;
 	size_t m_Size;
 	void*  m_Data;
+
+	[[no_unique_address]] allocator_type m_Allocator;
 };
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::TupleVector()
+BasicTupleVector<Spec, Ts...>::BasicTupleVector()
 	: m_Capacity(0),
 	  m_Size(0),
-	  m_Data(nullptr)
+	  m_Data(nullptr),
+	  m_Allocator()
 {
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::TupleVector(size_t count, const tuple_type& value)
+BasicTupleVector<Spec, Ts...>::BasicTupleVector(const allocator_type& allocator)
+	: m_Capacity(0),
+	  m_Size(0),
+	  m_Data(nullptr),
+	  m_Allocator(allocator)
+{
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+BasicTupleVector<Spec, Ts...>::BasicTupleVector(size_t count, const tuple_type& value)
 	: m_Capacity(0),
 	  m_Size(0),
 	  m_Data(nullptr)
@@ -585,9 +722,9 @@ TupleVector<Ts...>::TupleVector(size_t count, const tuple_type& value)
 	resize(count, value);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::TupleVector(size_t count, const Ts&... columns)
+BasicTupleVector<Spec, Ts...>::BasicTupleVector(size_t count, const Ts&... columns)
 	: m_Capacity(0),
 	  m_Size(0),
 	  m_Data(nullptr)
@@ -595,9 +732,9 @@ TupleVector<Ts...>::TupleVector(size_t count, const Ts&... columns)
 	resize(count, columns...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::TupleVector(size_t count)
+BasicTupleVector<Spec, Ts...>::BasicTupleVector(size_t count)
 	: m_Capacity(0),
 	  m_Size(0),
 	  m_Data(nullptr)
@@ -605,11 +742,11 @@ TupleVector<Ts...>::TupleVector(size_t count)
 	resize(count);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <class InputIt>
-requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename TupleVector<Ts...>::tuple_type>)
-TupleVector<Ts...>::TupleVector(InputIt first, InputIt last)
+requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename BasicTupleVector<Spec, Ts...>::tuple_type>)
+BasicTupleVector<Spec, Ts...>::BasicTupleVector(InputIt first, InputIt last)
 	: m_Capacity(0),
 	  m_Size(0),
 	  m_Data(nullptr)
@@ -619,9 +756,9 @@ TupleVector<Ts...>::TupleVector(InputIt first, InputIt last)
 		push_back(*it);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::TupleVector(std::initializer_list<tuple_type> init)
+BasicTupleVector<Spec, Ts...>::BasicTupleVector(std::initializer_list<tuple_type> init)
 	: m_Capacity(0),
 	  m_Size(0),
 	  m_Data(nullptr)
@@ -631,41 +768,43 @@ TupleVector<Ts...>::TupleVector(std::initializer_list<tuple_type> init)
 		push_back(*it);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::TupleVector(const TupleVector& copy)
+BasicTupleVector<Spec, Ts...>::BasicTupleVector(const BasicTupleVector& copy)
 	: m_Capacity(0),
 	  m_Size(0),
-	  m_Data(nullptr)
+	  m_Data(nullptr),
+	  m_Allocator(copy.m_Allocator)
 {
 	reserve(copy.size());
 	for (size_t i = 0; i < copy.size(); ++i)
 		push_back(copy[i]);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::TupleVector(TupleVector&& move) noexcept
+BasicTupleVector<Spec, Ts...>::BasicTupleVector(BasicTupleVector&& move) noexcept
 	: m_Capacity(move.m_Capacity),
 	  m_Size(move.m_Size),
-	  m_Data(move.m_Data)
+	  m_Data(move.m_Data),
+	  m_Allocator(std::move(move.m_Allocator))
 {
 	move.m_Capacity = 0;
 	move.m_Size     = 0;
 	move.m_Data     = nullptr;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::~TupleVector()
+BasicTupleVector<Spec, Ts...>::~BasicTupleVector()
 {
 	clear();
-	Memory::Free(m_Data);
+	FreeColumns(m_Data);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>& TupleVector<Ts...>::operator=(std::initializer_list<tuple_type> init)
+BasicTupleVector<Spec, Ts...>& BasicTupleVector<Spec, Ts...>::operator=(std::initializer_list<tuple_type> init)
 {
 	clear();
 	reserve(init.size());
@@ -674,9 +813,9 @@ TupleVector<Ts...>& TupleVector<Ts...>::operator=(std::initializer_list<tuple_ty
 	return *this;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>& TupleVector<Ts...>::operator=(const TupleVector& copy)
+BasicTupleVector<Spec, Ts...>& BasicTupleVector<Spec, Ts...>::operator=(const BasicTupleVector& copy)
 {
 	clear();
 	reserve(copy.size());
@@ -685,42 +824,43 @@ TupleVector<Ts...>& TupleVector<Ts...>::operator=(const TupleVector& copy)
 	return *this;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>& TupleVector<Ts...>::operator=(TupleVector&& move) noexcept
+BasicTupleVector<Spec, Ts...>& BasicTupleVector<Spec, Ts...>::operator=(BasicTupleVector&& move) noexcept
 {
 	clear();
-	Memory::Free(m_Data);
+	FreeColumns(m_Data);
 	m_Capacity      = move.m_Capacity;
 	m_Size          = move.m_Size;
 	m_Data          = move.m_Data;
+	m_Allocator     = std::move(move.m_Allocator);
 	move.m_Capacity = 0;
 	move.m_Size     = 0;
 	move.m_Data     = nullptr;
 	return *this;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::assign(size_t count, const tuple_type& value)
+void BasicTupleVector<Spec, Ts...>::assign(size_t count, const tuple_type& value)
 {
 	clear();
 	resize(count, value);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::assign(size_t count, const Ts&... columns)
+void BasicTupleVector<Spec, Ts...>::assign(size_t count, const Ts&... columns)
 {
 	clear();
 	resize(count, columns...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <class InputIt>
-requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename TupleVector<Ts...>::tuple_type>)
-void TupleVector<Ts...>::assign(InputIt first, InputIt last)
+requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename BasicTupleVector<Spec, Ts...>::tuple_type>)
+void BasicTupleVector<Spec, Ts...>::assign(InputIt first, InputIt last)
 {
 	clear();
 	reserve(std::distance(first, last));
@@ -728,9 +868,9 @@ void TupleVector<Ts...>::assign(InputIt first, InputIt last)
 		push_back(*it);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::assign(std::initializer_list<tuple_type> init)
+void BasicTupleVector<Spec, Ts...>::assign(std::initializer_list<tuple_type> init)
 {
 	clear();
 	reserve(init.size());
@@ -738,181 +878,180 @@ void TupleVector<Ts...>::assign(std::initializer_list<tuple_type> init)
 		push_back(*it);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::ref_tuple_type TupleVector<Ts...>::at(size_t row)
+BasicTupleVector<Spec, Ts...>::ref_tuple_type BasicTupleVector<Spec, Ts...>::at(size_t row)
 {
 	return at_internal(row, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::const_ref_tuple_type TupleVector<Ts...>::at(size_t row) const
+BasicTupleVector<Spec, Ts...>::const_ref_tuple_type BasicTupleVector<Spec, Ts...>::at(size_t row) const
 {
 	return at_internal(row, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::ref_tuple_type TupleVector<Ts...>::operator[](size_t row)
+BasicTupleVector<Spec, Ts...>::ref_tuple_type BasicTupleVector<Spec, Ts...>::operator[](size_t row)
 {
 	return at_internal(row, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::const_ref_tuple_type TupleVector<Ts...>::operator[](size_t row) const
+BasicTupleVector<Spec, Ts...>::const_ref_tuple_type BasicTupleVector<Spec, Ts...>::operator[](size_t row) const
 {
 	return at_internal(row, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::ref_tuple_type TupleVector<Ts...>::front()
+BasicTupleVector<Spec, Ts...>::ref_tuple_type BasicTupleVector<Spec, Ts...>::front()
 {
 	return at_internal(0, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::const_ref_tuple_type TupleVector<Ts...>::front() const
+BasicTupleVector<Spec, Ts...>::const_ref_tuple_type BasicTupleVector<Spec, Ts...>::front() const
 {
 	return at_internal(0, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::ref_tuple_type TupleVector<Ts...>::back()
+BasicTupleVector<Spec, Ts...>::ref_tuple_type BasicTupleVector<Spec, Ts...>::back()
 {
 	return at_internal(m_Size - 1, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::const_ref_tuple_type TupleVector<Ts...>::back() const
+BasicTupleVector<Spec, Ts...>::const_ref_tuple_type BasicTupleVector<Spec, Ts...>::back() const
 {
 	return at_internal(m_Size - 1, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::pointer_tuple_type TupleVector<Ts...>::data()
+BasicTupleVector<Spec, Ts...>::pointer_tuple_type BasicTupleVector<Spec, Ts...>::data()
 {
 	return data_internal(std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::const_pointer_tuple_type TupleVector<Ts...>::data() const
+BasicTupleVector<Spec, Ts...>::const_pointer_tuple_type BasicTupleVector<Spec, Ts...>::data() const
 {
 	return data_internal(std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Columns>
-TupleVector<Ts...>::ref_sub_tuple_type<Columns...> TupleVector<Ts...>::sub_row(size_t row)
+BasicTupleVector<Spec, Ts...>::ref_sub_tuple_type<Columns...> BasicTupleVector<Spec, Ts...>::sub_row(size_t row)
 {
 	return at_internal(row, std::index_sequence<Columns...> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Columns>
-TupleVector<Ts...>::const_ref_sub_tuple_type<Columns...> TupleVector<Ts...>::sub_row(size_t row) const
+BasicTupleVector<Spec, Ts...>::const_ref_sub_tuple_type<Columns...> BasicTupleVector<Spec, Ts...>::sub_row(size_t row) const
 {
 	return at_internal(row, std::index_sequence<Columns...> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Columns>
-TupleVector<Ts...>::pointer_sub_tuple_type<Columns...> TupleVector<Ts...>::sub_data()
+BasicTupleVector<Spec, Ts...>::pointer_sub_tuple_type<Columns...> BasicTupleVector<Spec, Ts...>::sub_data()
 {
 	return data_internal(std::index_sequence<Columns...> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Columns>
-TupleVector<Ts...>::const_pointer_sub_tuple_type<Columns...> TupleVector<Ts...>::sub_data() const
+BasicTupleVector<Spec, Ts...>::const_pointer_sub_tuple_type<Columns...> BasicTupleVector<Spec, Ts...>::sub_data() const
 {
 	return data_internal(std::index_sequence<Columns...> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t Column>
-NthType<Column, Ts...>& TupleVector<Ts...>::entry(size_t row)
+NthType<Column, Ts...>& BasicTupleVector<Spec, Ts...>::entry(size_t row)
 {
-	return ((NthType<Column, Ts...>*) ((uint8_t*) m_Data + Offsets[Column] * m_Capacity))[row];
+	return ((NthType<Column, Ts...>*) ((uint8_t*) m_Data + Layout.Offset(Column, m_Capacity)))[row];
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t Column>
-const NthType<Column, Ts...>& TupleVector<Ts...>::entry(size_t row) const
+const NthType<Column, Ts...>& BasicTupleVector<Spec, Ts...>::entry(size_t row) const
 {
-	return ((const NthType<Column, Ts...>*) ((const uint8_t*) m_Data + Offsets[Column] * m_Capacity))[row];
+	return ((const NthType<Column, Ts...>*) ((const uint8_t*) m_Data + Layout.Offset(Column, m_Capacity)))[row];
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t Column>
-NthType<Column, Ts...>* TupleVector<Ts...>::column()
+NthType<Column, Ts...>* BasicTupleVector<Spec, Ts...>::column()
 {
-	return (NthType<Column, Ts...>*) ((uint8_t*) m_Data + Offsets[Column] * m_Capacity);
+	return (NthType<Column, Ts...>*) ((uint8_t*) m_Data + Layout.Offset(Column, m_Capacity));
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t Column>
-const NthType<Column, Ts...>* TupleVector<Ts...>::column() const
+const NthType<Column, Ts...>* BasicTupleVector<Spec, Ts...>::column() const
 {
-	return (const NthType<Column, Ts...>*) ((const uint8_t*) m_Data + Offsets[Column] * m_Capacity);
+	return (const NthType<Column, Ts...>*) ((const uint8_t*) m_Data + Layout.Offset(Column, m_Capacity));
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::reserve(size_t newCapacity)
+void BasicTupleVector<Spec, Ts...>::reserve(size_t newCapacity)
 {
 	if (newCapacity <= m_Capacity)
 		return;
-	newCapacity   = std::bit_ceil(newCapacity);
-	void* newData = Memory::Malloc(RowSize * newCapacity);
+	void* newData = AllocateColumns(newCapacity);
 	MoveColumns(newData, newCapacity, m_Data, m_Capacity, m_Size);
-	Memory::Free(m_Data);
+	FreeColumns(m_Data);
 	m_Capacity = newCapacity;
 	m_Data     = newData;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::shrink_to_fit()
+void BasicTupleVector<Spec, Ts...>::shrink_to_fit()
 {
 	if (m_Capacity == m_Size)
 		return;
 
-	void* newData = Memory::Malloc(RowSize * m_Size);
+	void* newData = AllocateColumns(m_Size);
 	MoveColumns(newData, m_Size, m_Data, m_Capacity, m_Size);
-	Memory::Free(m_Data);
+	FreeColumns(m_Data);
 	m_Capacity = m_Size;
 	m_Data     = newData;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::clear()
+void BasicTupleVector<Spec, Ts...>::clear()
 {
 	DestroyColumns(m_Data, m_Capacity, m_Size);
 	m_Size = 0;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, const tuple_type& value)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::insert(const_iterator pos, const tuple_type& value)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	size_t row = pos - cbegin();
 	ShiftColumns(m_Data, m_Capacity, row, m_Size, 1);
 	CopyConstructRow(m_Data, m_Capacity, row, value);
@@ -920,11 +1059,11 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, cons
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, tuple_type&& value)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::insert(const_iterator pos, tuple_type&& value)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	size_t row = pos - cbegin();
 	ShiftColumns(m_Data, m_Capacity, row, m_Size, 1);
 	MoveConstructRow(m_Data, m_Capacity, row, std::move(value));
@@ -932,11 +1071,11 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, tupl
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, const Ts&... columns)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::insert(const_iterator pos, const Ts&... columns)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	size_t row = pos - cbegin();
 	ShiftColumns(m_Data, m_Capacity, row, m_Size, 1);
 	CopyConstructRow(m_Data, m_Capacity, row, columns...);
@@ -944,11 +1083,11 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, cons
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, Ts&&... columns)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::insert(const_iterator pos, Ts&&... columns)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	size_t row = pos - cbegin();
 	ShiftColumns(m_Data, m_Capacity, row, m_Size, 1);
 	MoveConstructRow(m_Data, m_Capacity, row, std::move(columns)...);
@@ -956,11 +1095,11 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, Ts&&
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, size_t count, const tuple_type& value)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::insert(const_iterator pos, size_t count, const tuple_type& value)
 {
-	reserve(m_Size + count);
+	grow(m_Size + count);
 	size_t row = pos - cbegin();
 	ShiftColumns(m_Data, m_Capacity, row, m_Size, count);
 	for (size_t i = 0; i < count; ++i)
@@ -969,14 +1108,14 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, size
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <class InputIt>
-requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename TupleVector<Ts...>::tuple_type>)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, InputIt first, InputIt last)
+requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename BasicTupleVector<Spec, Ts...>::tuple_type>)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::insert(const_iterator pos, InputIt first, InputIt last)
 {
 	size_t count = std::distance(first, last);
-	reserve(m_Size + count);
+	grow(m_Size + count);
 	size_t row = pos - cbegin();
 	ShiftColumns(m_Data, m_Capacity, row, m_Size, count);
 	size_t offset = row;
@@ -986,13 +1125,13 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, Inpu
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, std::initializer_list<tuple_type> init)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::insert(const_iterator pos, std::initializer_list<tuple_type> init)
 {
-	reserve(m_Size + init.size());
+	grow(m_Size + init.size());
 	size_t row = pos - cbegin();
-	ShiftColumns(m_Data, m_Capacity, row, init.size());
+	ShiftColumns(m_Data, m_Capacity, row, m_Size, init.size());
 	size_t offset = row;
 	for (auto it = init.begin(); it != init.end(); ++it, ++offset)
 		CopyConstructRow(m_Data, m_Capacity, offset, *it);
@@ -1000,21 +1139,21 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::insert(const_iterator pos, std:
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::emplace(const_iterator pos)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::emplace(const_iterator pos)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	size_t row = pos - cbegin();
-	ShiftColumns(m_Data, m_Capacity, row, 1);
+	ShiftColumns(m_Data, m_Capacity, row, m_Size, 1);
 	DefaultConstructRow(m_Data, m_Capacity, row);
 	++m_Size;
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::erase(const_iterator pos)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::erase(const_iterator pos)
 {
 	size_t row = pos - cbegin();
 	DestroyRow(m_Data, m_Capacity, row);
@@ -1023,9 +1162,9 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::erase(const_iterator pos)
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::iterator TupleVector<Ts...>::erase(const_iterator first, const_iterator last)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::erase(const_iterator first, const_iterator last)
 {
 	size_t    row   = first - cbegin();
 	ptrdiff_t count = last - first;
@@ -1038,63 +1177,113 @@ TupleVector<Ts...>::iterator TupleVector<Ts...>::erase(const_iterator first, con
 	return begin() + row;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::push_back(const tuple_type& value)
+void BasicTupleVector<Spec, Ts...>::push_back(const tuple_type& value)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	CopyConstructRow(m_Data, m_Capacity, m_Size, value);
 	++m_Size;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::push_back(tuple_type&& value)
+void BasicTupleVector<Spec, Ts...>::push_back(tuple_type&& value)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	MoveConstructRow(m_Data, m_Capacity, m_Size, std::move(value));
 	++m_Size;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::push_back(const Ts&... columns)
+void BasicTupleVector<Spec, Ts...>::push_back(const Ts&... columns)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	CopyConstructRow(m_Data, m_Capacity, m_Size, columns...);
 	++m_Size;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::push_back(Ts&&... columns)
+void BasicTupleVector<Spec, Ts...>::push_back(Ts&&... columns)
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	MoveConstructRow(m_Data, m_Capacity, m_Size, std::move(columns)...);
 	++m_Size;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVector<Ts...>::ref_tuple_type TupleVector<Ts...>::emplace_back()
+BasicTupleVector<Spec, Ts...>::ref_tuple_type BasicTupleVector<Spec, Ts...>::emplace_back()
 {
-	reserve(m_Size + 1);
+	grow(m_Size + 1);
 	DefaultConstructRow(m_Data, m_Capacity, m_Size);
 	return at(m_Size++);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+template <class InputIt>
+requires(std::convertible_to<decltype(*std::declval<InputIt>()), typename BasicTupleVector<Spec, Ts...>::tuple_type>)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::append_range(InputIt first, InputIt last)
+{
+	size_t row = m_Size;
+	if constexpr (std::forward_iterator<InputIt>)
+	{
+		grow(m_Size + (size_t) std::distance(first, last));
+		for (auto it = first; it != last; ++it, ++m_Size)
+			CopyConstructRow(m_Data, m_Capacity, m_Size, *it);
+	}
+	else
+	{
+		for (auto it = first; it != last; ++it)
+			push_back(*it);
+	}
+	return begin() + row;
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::append_n(size_t count)
+{
+	size_t row = m_Size;
+	grow(m_Size + count);
+	FillColumns(m_Data, m_Capacity, row, count);
+	m_Size += count;
+	return begin() + row;
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::append_n(size_t count, const tuple_type& value)
+{
+	return std::apply([this, count](const Ts&... columns) { return append_n(count, columns...); }, value);
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+BasicTupleVector<Spec, Ts...>::iterator BasicTupleVector<Spec, Ts...>::append_n(size_t count, const Ts&... columns)
+{
+	size_t row = m_Size;
+	grow(m_Size + count);
+	FillColumns(m_Data, m_Capacity, row, count, columns...);
+	m_Size += count;
+	return begin() + row;
+}
+
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::pop_back()
+void BasicTupleVector<Spec, Ts...>::pop_back()
 {
 	if (empty())
 		return;
-	DestroyRow(m_Data, m_Capacity, m_Size - 1);
+	DestroyRow(m_Data, m_Capacity, --m_Size);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::resize(size_t newSize)
+void BasicTupleVector<Spec, Ts...>::resize(size_t newSize)
 {
 	if (newSize < m_Size)
 	{
@@ -1103,16 +1292,16 @@ void TupleVector<Ts...>::resize(size_t newSize)
 	}
 	else
 	{
-		reserve(newSize);
+		grow(newSize);
 		for (size_t i = m_Size; i < newSize; ++i)
 			DefaultConstructRow(m_Data, m_Capacity, i);
 	}
 	m_Size = newSize;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::resize(size_t newSize, const tuple_type& value)
+void BasicTupleVector<Spec, Ts...>::resize(size_t newSize, const tuple_type& value)
 {
 	if (newSize < m_Size)
 	{
@@ -1121,16 +1310,16 @@ void TupleVector<Ts...>::resize(size_t newSize, const tuple_type& value)
 	}
 	else
 	{
-		reserve(newSize);
+		grow(newSize);
 		for (size_t i = m_Size; i < newSize; ++i)
 			CopyConstructRow(m_Data, m_Capacity, i, value);
 	}
 	m_Size = newSize;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::resize(size_t newSize, const Ts&... columns)
+void BasicTupleVector<Spec, Ts...>::resize(size_t newSize, const Ts&... columns)
 {
 	if (newSize < m_Size)
 	{
@@ -1139,56 +1328,114 @@ void TupleVector<Ts...>::resize(size_t newSize, const Ts&... columns)
 	}
 	else
 	{
-		reserve(newSize);
+		grow(newSize);
 		for (size_t i = m_Size; i < newSize; ++i)
 			CopyConstructRow(m_Data, m_Capacity, i, columns...);
 	}
+	m_Size = newSize;
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::swap(TupleVector& other) noexcept
+void BasicTupleVector<Spec, Ts...>::swap(BasicTupleVector& other) noexcept
 {
 	std::swap(m_Capacity, other.m_Capacity);
 	std::swap(m_Size, other.m_Size);
 	std::swap(m_Data, other.m_Data);
+	std::swap(m_Allocator, other.m_Allocator);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-TupleVector<Ts...>::ref_tuple_type TupleVector<Ts...>::at_internal(size_t row, std::index_sequence<Indices...>)
+BasicTupleVector<Spec, Ts...>::ref_tuple_type BasicTupleVector<Spec, Ts...>::at_internal(size_t row, std::index_sequence<Indices...>)
 {
-	return ref_tuple_type((((Ts*) ((uint8_t*) m_Data + Offsets[Indices] * m_Capacity))[row])...);
+	return ref_tuple_type((((Ts*) ((uint8_t*) m_Data + Layout.Offset(Indices, m_Capacity)))[row])...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-TupleVector<Ts...>::const_ref_tuple_type TupleVector<Ts...>::at_internal(size_t row, std::index_sequence<Indices...>) const
+BasicTupleVector<Spec, Ts...>::const_ref_tuple_type BasicTupleVector<Spec, Ts...>::at_internal(size_t row, std::index_sequence<Indices...>) const
 {
-	return const_ref_tuple_type((((const Ts*) ((const uint8_t*) m_Data + Offsets[Indices] * m_Capacity))[row])...);
+	return const_ref_tuple_type((((const Ts*) ((const uint8_t*) m_Data + Layout.Offset(Indices, m_Capacity)))[row])...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-TupleVector<Ts...>::pointer_tuple_type TupleVector<Ts...>::data_internal(std::index_sequence<Indices...>)
+BasicTupleVector<Spec, Ts...>::pointer_tuple_type BasicTupleVector<Spec, Ts...>::data_internal(std::index_sequence<Indices...>)
 {
-	return pointer_tuple_type((Ts*) ((uint8_t*) m_Data + Offsets[Indices] * m_Capacity)...);
+	return pointer_tuple_type((Ts*) ((uint8_t*) m_Data + Layout.Offset(Indices, m_Capacity))...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-TupleVector<Ts...>::const_pointer_tuple_type TupleVector<Ts...>::data_internal(std::index_sequence<Indices...>) const
+BasicTupleVector<Spec, Ts...>::const_pointer_tuple_type BasicTupleVector<Spec, Ts...>::data_internal(std::index_sequence<Indices...>) const
 {
-	return const_pointer_tuple_type((const Ts*) ((const uint8_t*) m_Data + Offsets[Indices] * m_Capacity)...);
+	return const_pointer_tuple_type((const Ts*) ((const uint8_t*) m_Data + Layout.Offset(Indices, m_Capacity))...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+void BasicTupleVector<Spec, Ts...>::grow(size_t required)
+{
+	if (required <= m_Capacity)
+		return;
+	reserve(std::max<size_t>(Spec::GrowthPolicy::Grow(m_Capacity, required), required));
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+void* BasicTupleVector<Spec, Ts...>::AllocateColumns(size_t capacity)
+{
+	if (capacity == 0)
+		return nullptr;
+	return m_Allocator.Allocate(Layout.AllocationSize(capacity), Layout.MaxAlignment());
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+void BasicTupleVector<Spec, Ts...>::FreeColumns(void* data)
+{
+	if (data)
+		m_Allocator.Free(data);
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+void BasicTupleVector<Spec, Ts...>::FillColumns(void* data, size_t capacity, size_t start, size_t count)
+{
+	FillColumns2(data, capacity, start, count, std::make_index_sequence<sizeof...(Ts)> {});
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+void BasicTupleVector<Spec, Ts...>::FillColumns(void* data, size_t capacity, size_t start, size_t count, const Ts&... columns)
+{
+	FillColumns2(data, capacity, start, count, columns..., std::make_index_sequence<sizeof...(Ts)> {});
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+template <size_t... Indices>
+void BasicTupleVector<Spec, Ts...>::FillColumns2(void* data, size_t capacity, size_t start, size_t count, std::index_sequence<Indices...>)
+{
+	(std::uninitialized_value_construct_n((Ts*) ((uint8_t*) data + Layout.Offset(Indices, capacity)) + start, count), ...);
+}
+
+template <class Spec, class... Ts>
+requires(sizeof...(Ts) > 0)
+template <size_t... Indices>
+void BasicTupleVector<Spec, Ts...>::FillColumns2(void* data, size_t capacity, size_t start, size_t count, const Ts&... columns, std::index_sequence<Indices...>)
+{
+	(std::uninitialized_fill_n((Ts*) ((uint8_t*) data + Layout.Offset(Indices, capacity)) + start, count, columns), ...);
+}
+
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::ShiftColumns(void* data, size_t capacity, size_t start, size_t end, ptrdiff_t count)
+void BasicTupleVector<Spec, Ts...>::ShiftColumns(void* data, size_t capacity, size_t start, size_t end, ptrdiff_t count)
 {
 	if (start == end)
 		return;
@@ -1196,423 +1443,382 @@ void TupleVector<Ts...>::ShiftColumns(void* data, size_t capacity, size_t start,
 	ShiftColumns2(data, capacity, start, end, count, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::ShiftColumns2(void* data, size_t capacity, size_t start, size_t end, ptrdiff_t count, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::ShiftColumns2(void* data, size_t capacity, size_t start, size_t end, ptrdiff_t count, std::index_sequence<Indices...>)
 {
-	(ShiftColumn<Indices>((uint8_t*) data + Offsets[Indices] * capacity, start, end, count), ...);
+	(ShiftColumn<Indices>((uint8_t*) data + Layout.Offset(Indices, capacity), start, end, count), ...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t Column>
-void TupleVector<Ts...>::ShiftColumn(void* column, size_t start, size_t end, ptrdiff_t count)
+void BasicTupleVector<Spec, Ts...>::ShiftColumn(void* column, size_t start, size_t end, ptrdiff_t count)
 {
 	using T = NthType<Column, Ts...>;
-	T* ptr0 = (T*) column + start + count;
-	T* ptr1 = (T*) column + end + count - 1;
-	if (count > 0)
+	T* ptr  = (T*) column;
+	if constexpr (TriviallyRelocatableV<T>)
 	{
-		for (ptrdiff_t i = 0; i < count; ++i, --ptr0, --ptr1)
-			new (ptr1) T(std::move(*ptr0));
+		std::memmove(ptr + start + count, ptr + start, (end - start) * sizeof(T));
+	}
+	else if (count > 0)
+	{
+		for (size_t i = end; i-- > start;)
+		{
+			new (ptr + i + count) T(std::move(ptr[i]));
+			std::destroy_at(ptr + i);
+		}
 	}
 	else
 	{
-		count = -count;
-		for (ptrdiff_t i = 0; i < count; ++i, ++ptr0, ++ptr1)
-			new (ptr0) T(std::move(*ptr1));
+		for (size_t i = start; i < end; ++i)
+		{
+			new (ptr + i + count) T(std::move(ptr[i]));
+			std::destroy_at(ptr + i);
+		}
 	}
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::MoveColumns(void* newData, size_t newCapacity, void* oldData, size_t oldCapacity, size_t count)
+void BasicTupleVector<Spec, Ts...>::MoveColumns(void* newData, size_t newCapacity, void* oldData, size_t oldCapacity, size_t count)
 {
 	MoveColumns2(newData, newCapacity, oldData, oldCapacity, count, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::MoveColumns2(void* newData, size_t newCapacity, void* oldData, size_t oldCapacity, size_t count, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::MoveColumns2(void* newData, size_t newCapacity, void* oldData, size_t oldCapacity, size_t count, std::index_sequence<Indices...>)
 {
-	(MoveColumn<Indices>((uint8_t*) newData + Offsets[Indices] * newCapacity, (uint8_t*) oldData + Offsets[Indices] * oldCapacity, count), ...);
+	(MoveColumn<Indices>((uint8_t*) newData + Layout.Offset(Indices, newCapacity), (uint8_t*) oldData + Layout.Offset(Indices, oldCapacity), count), ...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t Column>
-void TupleVector<Ts...>::MoveColumn(void* newColumn, void* oldColumn, size_t count)
+void BasicTupleVector<Spec, Ts...>::MoveColumn(void* newColumn, void* oldColumn, size_t count)
 {
 	using T      = NthType<Column, Ts...>;
 	T* newColPtr = (T*) newColumn;
 	T* oldColPtr = (T*) oldColumn;
-	for (size_t i = 0; i < count; ++i)
-		new (&newColPtr[i]) T(std::move(oldColPtr[i]));
+	if constexpr (TriviallyRelocatableV<T>)
+	{
+		if (count > 0)
+			std::memcpy(newColPtr, oldColPtr, count * sizeof(T));
+	}
+	else
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			new (&newColPtr[i]) T(std::move(oldColPtr[i]));
+			std::destroy_at(&oldColPtr[i]);
+		}
+	}
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::DestroyColumns(void* data, size_t capacity, size_t count)
+void BasicTupleVector<Spec, Ts...>::DestroyColumns(void* data, size_t capacity, size_t count)
 {
 	DestroyColumns2(data, capacity, count, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::DestroyColumns2(void* data, size_t capacity, size_t count, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::DestroyColumns2(void* data, size_t capacity, size_t count, std::index_sequence<Indices...>)
 {
-	(DestroyColumn<Indices>((uint8_t*) data + Offsets[Indices] * capacity, count), ...);
+	(DestroyColumn<Indices>((uint8_t*) data + Layout.Offset(Indices, capacity), count), ...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t Column>
-void TupleVector<Ts...>::DestroyColumn(void* column, size_t count)
+void BasicTupleVector<Spec, Ts...>::DestroyColumn(void* column, size_t count)
 {
 	using T = NthType<Column, Ts...>;
-	T* ptr  = (T*) column;
-	for (size_t i = 0; i < count; ++i)
-		ptr[i].~T();
+	if constexpr (!std::is_trivially_destructible_v<T>)
+		std::destroy_n((T*) column, count);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::DestroyRow(void* data, size_t capacity, size_t row)
+void BasicTupleVector<Spec, Ts...>::DestroyRow(void* data, size_t capacity, size_t row)
 {
 	DestroyRow2(data, capacity, row, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::DestroyRow2(void* data, size_t capacity, size_t row, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::DestroyRow2(void* data, size_t capacity, size_t row, std::index_sequence<Indices...>)
 {
-	(((Ts*) ((uint8_t*) data + Offsets[Indices] * capacity) + row)->~decltype(Ts)(), ...);
+	(std::destroy_at((Ts*) ((uint8_t*) data + Layout.Offset(Indices, capacity)) + row), ...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::DefaultConstructRow(void* data, size_t capacity, size_t row)
+void BasicTupleVector<Spec, Ts...>::DefaultConstructRow(void* data, size_t capacity, size_t row)
 {
 	DefaultConstructRow2(data, capacity, row, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::DefaultConstructRow2(void* data, size_t capacity, size_t row, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::DefaultConstructRow2(void* data, size_t capacity, size_t row, std::index_sequence<Indices...>)
 {
-	(new ((Ts*) ((uint8_t*) data + Offsets[Indices] * capacity) + row) Ts(), ...);
+	(new ((Ts*) ((uint8_t*) data + Layout.Offset(Indices, capacity)) + row) Ts(), ...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::CopyConstructRow(void* data, size_t capacity, size_t row, const tuple_type& value)
+void BasicTupleVector<Spec, Ts...>::CopyConstructRow(void* data, size_t capacity, size_t row, const tuple_type& value)
 {
 	CopyConstructRow2(data, capacity, row, value, std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::CopyConstructRow(void* data, size_t capacity, size_t row, const Ts&... columns)
+void BasicTupleVector<Spec, Ts...>::CopyConstructRow(void* data, size_t capacity, size_t row, const Ts&... columns)
 {
 	CopyConstructRow2(data, capacity, row, columns..., std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::CopyConstructRow2(void* data, size_t capacity, size_t row, const tuple_type& value, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::CopyConstructRow2(void* data, size_t capacity, size_t row, const tuple_type& value, std::index_sequence<Indices...>)
 {
-	(new ((Ts*) ((uint8_t*) data + Offsets[Indices] * capacity) + row) Ts(std::get<Indices>(value)), ...);
+	(new ((Ts*) ((uint8_t*) data + Layout.Offset(Indices, capacity)) + row) Ts(std::get<Indices>(value)), ...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::CopyConstructRow2(void* data, size_t capacity, size_t row, const Ts&... columns, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::CopyConstructRow2(void* data, size_t capacity, size_t row, const Ts&... columns, std::index_sequence<Indices...>)
 {
-	(new ((Ts*) ((uint8_t*) data + Offsets[Indices] * capacity) + row) Ts(columns), ...);
+	(new ((Ts*) ((uint8_t*) data + Layout.Offset(Indices, capacity)) + row) Ts(columns), ...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::MoveConstructRow(void* data, size_t capacity, size_t row, tuple_type&& value)
+void BasicTupleVector<Spec, Ts...>::MoveConstructRow(void* data, size_t capacity, size_t row, tuple_type&& value)
 {
 	MoveConstructRow2(data, capacity, row, std::move(value), std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-void TupleVector<Ts...>::MoveConstructRow(void* data, size_t capacity, size_t row, Ts&&... columns)
+void BasicTupleVector<Spec, Ts...>::MoveConstructRow(void* data, size_t capacity, size_t row, Ts&&... columns)
 {
 	MoveConstructRow2(data, capacity, row, std::move(columns)..., std::make_index_sequence<sizeof...(Ts)> {});
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::MoveConstructRow2(void* data, size_t capacity, size_t row, tuple_type&& value, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::MoveConstructRow2(void* data, size_t capacity, size_t row, tuple_type&& value, std::index_sequence<Indices...>)
 {
-	(new ((Ts*) ((uint8_t*) data + Offsets[Indices] * capacity) + row) Ts(std::move(std::get<Indices>(value))), ...);
+	(new ((Ts*) ((uint8_t*) data + Layout.Offset(Indices, capacity)) + row) Ts(std::move(std::get<Indices>(value))), ...);
 }
 
-template <class... Ts>
+template <class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Indices>
-void TupleVector<Ts...>::MoveConstructRow2(void* data, size_t capacity, size_t row, Ts&&... columns, std::index_sequence<Indices...>)
+void BasicTupleVector<Spec, Ts...>::MoveConstructRow2(void* data, size_t capacity, size_t row, Ts&&... columns, std::index_sequence<Indices...>)
 {
-	(new ((Ts*) ((uint8_t*) data + Offsets[Indices] * capacity) + row) Ts(std::move(columns)), ...);
+	(new ((Ts*) ((uint8_t*) data + Layout.Offset(Indices, capacity)) + row) Ts(std::move(columns)), ...);
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...>::TupleVectorIter()
+TupleVectorIter<Const, Spec, Ts...>::TupleVectorIter()
 	: m_Vec(nullptr),
 	  m_Row(0)
 {
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...>::TupleVectorIter(const TupleVectorIter& copy)
+TupleVectorIter<Const, Spec, Ts...>::TupleVectorIter(const TupleVectorIter& copy)
 	: m_Vec(copy.m_Vec),
 	  m_Row(copy.m_Row)
 {
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...>::TupleVectorIter(Vec vec, size_t row)
+TupleVectorIter<Const, Spec, Ts...>::TupleVectorIter(Vec vec, size_t row)
 	: m_Vec(vec),
 	  m_Row(row)
 {
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Columns>
-TupleVectorIter<Const, Ts...>::ref_sub_tuple_type<Columns...> TupleVectorIter<Const, Ts...>::columns()
+TupleVectorIter<Const, Spec, Ts...>::ref_sub_tuple_type<Columns...> TupleVectorIter<Const, Spec, Ts...>::columns()
 {
-	return (*m_Vec).sub_row<Columns...>(m_Row);
+	return m_Vec->template sub_row<Columns...>(m_Row);
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...>::ref_tuple_type TupleVectorIter<Const, Ts...>::operator*()
+TupleVectorIter<Const, Spec, Ts...>::ref_tuple_type TupleVectorIter<Const, Spec, Ts...>::operator*()
 {
 	return (*m_Vec)[m_Row];
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...>& TupleVectorIter<Const, Ts...>::operator++()
+TupleVectorIter<Const, Spec, Ts...>& TupleVectorIter<Const, Spec, Ts...>::operator++()
 {
 	if (++m_Row > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...> TupleVectorIter<Const, Ts...>::operator++(int)
+TupleVectorIter<Const, Spec, Ts...> TupleVectorIter<Const, Spec, Ts...>::operator++(int)
 {
 	auto copy = *this;
 	++(*this);
 	return copy;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...>& TupleVectorIter<Const, Ts...>::operator--()
+TupleVectorIter<Const, Spec, Ts...>& TupleVectorIter<Const, Spec, Ts...>::operator--()
 {
 	if (--m_Row > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...> TupleVectorIter<Const, Ts...>::operator--(int)
+TupleVectorIter<Const, Spec, Ts...> TupleVectorIter<Const, Spec, Ts...>::operator--(int)
 {
 	auto copy = *this;
 	--(*this);
 	return copy;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...>& TupleVectorIter<Const, Ts...>::operator+=(ptrdiff_t n)
+TupleVectorIter<Const, Spec, Ts...>& TupleVectorIter<Const, Spec, Ts...>::operator+=(ptrdiff_t n)
 {
 	if ((m_Row += n) > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...>& TupleVectorIter<Const, Ts...>::operator-=(ptrdiff_t n)
+TupleVectorIter<Const, Spec, Ts...>& TupleVectorIter<Const, Spec, Ts...>::operator-=(ptrdiff_t n)
 {
 	if ((m_Row -= n) > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
 }
 
-template <bool Const, class... Ts>
-requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...> operator+(TupleVectorIter<Const, Ts...> iter, ptrdiff_t n)
-{
-	return iter += n;
-}
-
-template <bool Const, class... Ts>
-TupleVectorIter<Const, Ts...> operator+(ptrdiff_t n, TupleVectorIter<Const, Ts...> iter)
-{
-	return iter += n;
-}
-
-template <bool Const, class... Ts>
-requires(sizeof...(Ts) > 0)
-TupleVectorIter<Const, Ts...> operator-(TupleVectorIter<Const, Ts...> iter, ptrdiff_t n)
-{
-	return iter -= n;
-}
-
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-ptrdiff_t operator-(TupleVectorIter<Const, Ts...> lhs, TupleVectorIter<Const, Ts...> rhs)
-{
-	if (lhs.m_Vec != rhs.m_Vec)
-		throw std::runtime_error("Incompatible iterators");
-	return lhs.m_Row - rhs.m_Row;
-}
-
-template <bool Const, class... Ts>
-requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...>::TupleVectorReverseIter()
+TupleVectorReverseIter<Const, Spec, Ts...>::TupleVectorReverseIter()
 	: m_Vec(nullptr),
 	  m_Row(0)
 {
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...>::TupleVectorReverseIter(const TupleVectorReverseIter& copy)
+TupleVectorReverseIter<Const, Spec, Ts...>::TupleVectorReverseIter(const TupleVectorReverseIter& copy)
 	: m_Vec(copy.m_Vec),
 	  m_Row(copy.m_Row)
 {
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...>::TupleVectorReverseIter(Vec vec, size_t row)
+TupleVectorReverseIter<Const, Spec, Ts...>::TupleVectorReverseIter(Vec vec, size_t row)
 	: m_Vec(vec),
 	  m_Row(row)
 {
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
 template <size_t... Columns>
-TupleVectorReverseIter<Const, Ts...>::ref_sub_tuple_type<Columns...> TupleVectorReverseIter<Const, Ts...>::columns()
+TupleVectorReverseIter<Const, Spec, Ts...>::ref_sub_tuple_type<Columns...> TupleVectorReverseIter<Const, Spec, Ts...>::columns()
 {
-	return (*m_Vec).sub_row<Columns...>(m_Vec->size() - m_Row - 1);
+	return m_Vec->template sub_row<Columns...>(m_Vec->size() - m_Row - 1);
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...>::ref_tuple_type TupleVectorReverseIter<Const, Ts...>::operator*()
+TupleVectorReverseIter<Const, Spec, Ts...>::ref_tuple_type TupleVectorReverseIter<Const, Spec, Ts...>::operator*()
 {
 	return (*m_Vec)[m_Vec->size() - m_Row - 1];
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...>& TupleVectorReverseIter<Const, Ts...>::operator++()
+TupleVectorReverseIter<Const, Spec, Ts...>& TupleVectorReverseIter<Const, Spec, Ts...>::operator++()
 {
 	if (++m_Row > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...> TupleVectorReverseIter<Const, Ts...>::operator++(int)
+TupleVectorReverseIter<Const, Spec, Ts...> TupleVectorReverseIter<Const, Spec, Ts...>::operator++(int)
 {
 	auto copy = *this;
 	++(*this);
 	return copy;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...>& TupleVectorReverseIter<Const, Ts...>::operator--()
+TupleVectorReverseIter<Const, Spec, Ts...>& TupleVectorReverseIter<Const, Spec, Ts...>::operator--()
 {
 	if (--m_Row > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...> TupleVectorReverseIter<Const, Ts...>::operator--(int)
+TupleVectorReverseIter<Const, Spec, Ts...> TupleVectorReverseIter<Const, Spec, Ts...>::operator--(int)
 {
 	auto copy = *this;
 	--(*this);
 	return copy;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...>& TupleVectorReverseIter<Const, Ts...>::operator+=(ptrdiff_t n)
+TupleVectorReverseIter<Const, Spec, Ts...>& TupleVectorReverseIter<Const, Spec, Ts...>::operator+=(ptrdiff_t n)
 {
 	if ((m_Row += n) > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
 }
 
-template <bool Const, class... Ts>
+template <bool Const, class Spec, class... Ts>
 requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...>& TupleVectorReverseIter<Const, Ts...>::operator-=(ptrdiff_t n)
+TupleVectorReverseIter<Const, Spec, Ts...>& TupleVectorReverseIter<Const, Spec, Ts...>::operator-=(ptrdiff_t n)
 {
 	if ((m_Row -= n) > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
 }
 
-template <bool Const, class... Ts>
-requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...> operator+(TupleVectorReverseIter<Const, Ts...> iter, ptrdiff_t n)
-{
-	return iter += n;
-}
-
-template <bool Const, class... Ts>
-requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...> operator+(ptrdiff_t n, TupleVectorReverseIter<Const, Ts...> iter)
-{
-	return iter += n;
-}
-
-template <bool Const, class... Ts>
-requires(sizeof...(Ts) > 0)
-TupleVectorReverseIter<Const, Ts...> operator-(TupleVectorReverseIter<Const, Ts...> iter, ptrdiff_t n)
-{
-	return iter -= n;
-}
-
-template <bool Const, class... Ts>
-requires(sizeof...(Ts) > 0)
-ptrdiff_t operator-(TupleVectorReverseIter<Const, Ts...> lhs, TupleVectorReverseIter<Const, Ts...> rhs)
-{
-	if (lhs.m_Vec != rhs.m_Vec)
-		throw std::runtime_error("Incompatible iterators");
-	return lhs.m_Row - rhs.m_Row;
-}
-
 template <bool Const, class Vec, size_t... Columns>
 requires(sizeof...(Columns) > 0)
 TupleVectorSubIter<Const, Vec, Columns...>::TupleVectorSubIter()
@@ -1641,7 +1847,7 @@ template <bool Const, class Vec, size_t... Columns>
 requires(sizeof...(Columns) > 0)
 TupleVectorSubIter<Const, Vec, Columns...>::ref_tuple_type TupleVectorSubIter<Const, Vec, Columns...>::operator*()
 {
-	return m_Vec->sub_row<Columns...>(m_Row);
+	return m_Vec->template sub_row<Columns...>(m_Row);
 }
 
 template <bool Const, class Vec, size_t... Columns>
@@ -1698,36 +1904,6 @@ TupleVectorSubIter<Const, Vec, Columns...>& TupleVectorSubIter<Const, Vec, Colum
 	return *this;
 }
 
-template <bool Const, class Vec, size_t... Columns>
-requires(sizeof...(Columns) > 0)
-TupleVectorSubIter<Const, Vec, Columns...> operator+(TupleVectorSubIter<Const, Vec, Columns...> iter, ptrdiff_t n)
-{
-	return iter += n;
-}
-
-template <bool Const, class Vec, size_t... Columns>
-requires(sizeof...(Columns) > 0)
-TupleVectorSubIter<Const, Vec, Columns...> operator+(ptrdiff_t n, TupleVectorSubIter<Const, Vec, Columns...> iter)
-{
-	return iter += n;
-}
-
-template <bool Const, class Vec, size_t... Columns>
-requires(sizeof...(Columns) > 0)
-TupleVectorSubIter<Const, Vec, Columns...> operator-(TupleVectorSubIter<Const, Vec, Columns...> iter, ptrdiff_t n)
-{
-	return iter -= n;
-}
-
-template <bool Const, class Vec, size_t... Columns>
-requires(sizeof...(Columns) > 0)
-ptrdiff_t operator-(TupleVectorSubIter<Const, Vec, Columns...> lhs, TupleVectorSubIter<Const, Vec, Columns...> rhs)
-{
-	if (lhs.m_Vec != rhs.m_Vec)
-		throw std::runtime_error("Incompatible iterators");
-	return lhs.m_Row - rhs.m_Row;
-}
-
 template <bool Const, class Vec, size_t... Columns>
 requires(sizeof...(Columns) > 0)
 TupleVectorSubReverseIter<Const, Vec, Columns...>::TupleVectorSubReverseIter()
@@ -1756,7 +1932,7 @@ template <bool Const, class Vec, size_t... Columns>
 requires(sizeof...(Columns) > 0)
 TupleVectorSubReverseIter<Const, Vec, Columns...>::ref_tuple_type TupleVectorSubReverseIter<Const, Vec, Columns...>::operator*()
 {
-	return m_Vec->sub_row<Columns...>(m_Vec->size() - m_Row - 1);
+	return m_Vec->template sub_row<Columns...>(m_Vec->size() - m_Row - 1);
 }
 
 template <bool Const, class Vec, size_t... Columns>
@@ -1811,34 +1987,4 @@ TupleVectorSubReverseIter<Const, Vec, Columns...>& TupleVectorSubReverseIter<Con
 	if ((m_Row -= n) > m_Vec->size())
 		m_Row = m_Vec->size(); // This is out of bounds
 	return *this;
-}
-
-template <bool Const, class Vec, size_t... Columns>
-requires(sizeof...(Columns) > 0)
-TupleVectorSubReverseIter<Const, Vec, Columns...> operator+(TupleVectorSubReverseIter<Const, Vec, Columns...> iter, ptrdiff_t n)
-{
-	return iter += n;
-}
-
-template <bool Const, class Vec, size_t... Columns>
-requires(sizeof...(Columns) > 0)
-TupleVectorSubReverseIter<Const, Vec, Columns...> operator+(ptrdiff_t n, TupleVectorSubReverseIter<Const, Vec, Columns...> iter)
-{
-	return iter += n;
-}
-
-template <bool Const, class Vec, size_t... Columns>
-requires(sizeof...(Columns) > 0)
-TupleVectorSubReverseIter<Const, Vec, Columns...> operator-(TupleVectorSubReverseIter<Const, Vec, Columns...> iter, ptrdiff_t n)
-{
-	return iter -= n;
-}
-
-template <bool Const, class Vec, size_t... Columns>
-requires(sizeof...(Columns) > 0)
-ptrdiff_t operator-(TupleVectorSubReverseIter<Const, Vec, Columns...> lhs, TupleVectorSubReverseIter<Const, Vec, Columns...> rhs)
-{
-	if (lhs.m_Vec != rhs.m_Vec)
-		throw std::runtime_error("Incompatible iterators");
-	return lhs.m_Row - rhs.m_Row;
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "TupleVector.h"
+
+#include <algorithm>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+// Column algorithms for TupleVector, they run with std::execution::par_unseq once a table reaches
+// c_TupleVectorParallelThreshold rows and unseq below that.
+// Callbacks may therefore run concurrently and interleaved, so they must not lock or allocate shared state.
+// libstdc++ implements the parallel policies on top of TBB, builds against it have to link tbb (-ltbb) or they fail to link.
+// TupleVectorAlgoBench times both policies around the threshold.
+namespace TupleVectorAlgo
+{
+	static constexpr size_t c_TupleVectorParallelThreshold = 16384;
+
+	namespace Details
+	{
+		template <class Func>
+		decltype(auto) Dispatch(size_t count, Func&& func)
+		{
+			if (count >= c_TupleVectorParallelThreshold)
+				return func(std::execution::par_unseq);
+			else
+				return func(std::execution::unseq);
+		}
+
+		template <class Vec, size_t... Indices>
+		void SwapRows(Vec& vec, size_t lhs, size_t rhs, std::index_sequence<Indices...>)
+		{
+			using std::swap;
+			(swap(vec.template entry<Indices>(lhs), vec.template entry<Indices>(rhs)), ...);
+		}
+	} // namespace Details
+
+	// Calls func(entry) for every row in Column
+	template <size_t Column, class Vec, class Func>
+	void for_each_column(Vec& vec, Func&& func)
+	{
+		auto* column = vec.template column<Column>();
+		Details::Dispatch(vec.size(), [&](auto&& policy) { std::for_each(policy, column, column + vec.size(), func); });
+	}
+
+	// Calls func(entries...) for every row with the entries of Columns
+	template <size_t... Columns, class Vec, class Func>
+	requires(sizeof...(Columns) > 0)
+	void for_each_row(Vec& vec, Func&& func)
+	{
+		auto  columns = std::make_tuple(vec.template column<Columns>()...);
+		auto* first   = std::get<0>(columns);
+		Details::Dispatch(vec.size(),
+						  [&](auto&& policy) {
+							  std::for_each(policy,
+											first,
+											first + vec.size(),
+											[&](auto& entry) {
+												size_t row = &entry - first;
+												std::apply([&](auto*... ptrs) { func(ptrs[row]...); }, columns);
+											});
+						  });
+	}
+
+	// Writes func(src) into DstColumn for every row of SrcColumn
+	template <size_t SrcColumn, size_t DstColumn, class Vec, class Func>
+	void transform(Vec& vec, Func&& func)
+	{
+		auto* src = vec.template column<SrcColumn>();
+		auto* dst = vec.template column<DstColumn>();
+		Details::Dispatch(vec.size(), [&](auto&& policy) { std::transform(policy, src, src + vec.size(), dst, func); });
+	}
+
+	template <size_t Column, class Vec, class T, class Op = std::plus<>>
+	T reduce(const Vec& vec, T init, Op op = {})
+	{
+		auto* column = vec.template column<Column>();
+		return Details::Dispatch(vec.size(), [&](auto&& policy) { return std::reduce(policy, column, column + vec.size(), std::move(init), op); });
+	}
+
+	// Returns the first row whose entry in Column matches pred, or vec.size()
+	template <size_t Column, class Vec, class Pred>
+	size_t find_if(const Vec& vec, Pred&& pred)
+	{
+		auto* column = vec.template column<Column>();
+		auto* found  = Details::Dispatch(vec.size(), [&](auto&& policy) { return std::find_if(policy, column, column + vec.size(), pred); });
+		return found - column;
+	}
+
+	template <size_t Column, class Vec, class T>
+	size_t find(const Vec& vec, const T& value)
+	{
+		return find_if<Column>(vec, [&value](const auto& entry) { return entry == value; });
+	}
+
+	// Returns the permutation that stably sorts vec by Column, permutation[i] is the row that should end up at i
+	template <size_t Column, class Vec, class Comp = std::less<>>
+	std::vector<size_t> sort_permutation(const Vec& vec, Comp comp = {})
+	{
+		std::vector<size_t> permutation(vec.size());
+		std::iota(permutation.begin(), permutation.end(), size_t { 0 });
+		auto* column = vec.template column<Column>();
+		Details::Dispatch(vec.size(),
+						  [&](auto&& policy) {
+							  std::stable_sort(policy, permutation.begin(), permutation.end(), [&](size_t lhs, size_t rhs) { return comp(column[lhs], column[rhs]); });
+						  });
+		return permutation;
+	}
+
+	// Reorders every column so row i holds what was in row permutation[i], consumes the permutation
+	template <class Vec>
+	void apply_permutation(Vec& vec, std::vector<size_t>& permutation)
+	{
+		for (size_t i = 0; i < permutation.size(); ++i)
+		{
+			size_t current = i;
+			while (permutation[current] != i)
+			{
+				size_t next = permutation[current];
+				Details::SwapRows(vec, current, next, std::make_index_sequence<Vec::ColumnCount> {});
+				permutation[current] = current;
+				current              = next;
+			}
+			permutation[current] = current;
+		}
+	}
+
+	template <size_t Column, class Vec, class Comp = std::less<>>
+	void sort_by_column(Vec& vec, Comp comp = {})
+	{
+		auto permutation = sort_permutation<Column>(vec, std::move(comp));
+		apply_permutation(vec, permutation);
+	}
+} // namespace TupleVectorAlgo
@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <type_traits>
 #include <utility>
 
 namespace Details
@@ -26,5 +27,15 @@ namespace Details
 	};
 } // namespace Details
 
+// Types that can be moved to a new address with memcpy and without running the destructor of the old object.
+// Specialize for types that are not trivially copyable but still relocate bitwise
+template <class T>
+struct TriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<T>>
+{
+};
+
+template <class T>
+inline constexpr bool TriviallyRelocatableV = TriviallyRelocatable<T>::value;
+
 template <size_t Index, class... Ts>
 using NthType = typename Details::NthTypeS<Index, Ts...>::Type;
\ No newline at end of file
@@ -26,4 +26,20 @@ workspace("Tests")
 
 		pkgdeps({ "commonbuild", "backtrace", "glfw", "vulkan-sdk" })
 
+		-- libstdc++ runs std::execution::par_unseq on TBB, TupleVectorAlgorithms.h does not link without it
+		filter("system:linux")
+			links({ "tbb" })
+		filter({})
+
+		-- DirectX, DirectComposition and the Win32 window backend, other systems only run the headless tests
+		filter("system:not windows")
+			removefiles({
+				"%{prj.location}/Src/CSwap/CSwap.cpp",
+				"%{prj.location}/Src/CSwapVK.cpp",
+				"%{prj.location}/Src/DCompVK.cpp",
+				"%{prj.location}/Src/DXGISwapVK.cpp",
+				"%{prj.location}/Src/SharedWin32.cpp"
+			})
+		filter({})
+
 		common:addActions()
\ No newline at end of file